@@ -473,6 +473,11 @@ void Adafruit_GFX::drawChar(int16_t x, int16_t y, unsigned char c,
   }
 }
 
+uint8_t Adafruit_GFX::glyphColumn(unsigned char c, uint8_t i) const {
+  if (i >= 5) return 0x0; // spacing column
+  return pgm_read_byte(font+(c*5)+i);
+}
+
 void Adafruit_GFX::setCursor(int16_t x, int16_t y) {
   cursor_x = x;
   cursor_y = y;
@@ -50,6 +50,9 @@ boolean Adafruit_FT6206::begin(uint8_t threshhold) {
     // change threshhold to be higher/lower
     writeRegister8(FT6206_REG_THRESHHOLD, threshhold);
 
+    // hold INT low for as long as the panel is touched
+    writeRegister8(FT6206_REG_GMODE, FT6206_GMODE_POLLING);
+
     if ((readRegister8(FT6206_REG_VENDID) != 17) || (readRegister8(FT6206_REG_CHIPID) != 6))
         return false;
 
@@ -93,18 +96,16 @@ boolean Adafruit_FT6206::touched(void) {
 /*****************************/
 
 void Adafruit_FT6206::readData(uint16_t *x, uint16_t *y) {
-    INT32U cpu_sr{};
-
     uint8_t address(FT6206_ADDR<<1);
     INT32U writeBufSize{1};
     INT32U readBufSize{16};
     uint8_t writeBuf[2] = {address, 0};
     uint8_t readBuf[16] = {address};
 
-    OS_ENTER_CRITICAL();
+    Ioctl(hI2C, PJDF_CTRL_I2C_WAIT_FOR_LOCK, 0, 0);
     Write(hI2C, writeBuf, &writeBufSize);
     Read(hI2C, readBuf, &readBufSize);
-    OS_EXIT_CRITICAL();
+    Ioctl(hI2C, PJDF_CTRL_I2C_RELEASE_LOCK, 0, 0);
 
     uint8_t* i2cdat{readBuf};
 
@@ -139,10 +140,18 @@ TS_Point Adafruit_FT6206::getPoint(void) {
     return TS_Point(x, y, 1);
 }
 
+// Number of touches (0..2) found by the last getPoint()/readData()
+uint8_t Adafruit_FT6206::getTouches(void) {
+    return touches;
+}
+
+// Controller ID of the first touch found by the last getPoint()/readData()
+uint8_t Adafruit_FT6206::getTouchID(void) {
+    return touchID[0];
+}
 
-uint8_t Adafruit_FT6206::readRegister8(uint8_t reg) {
-    INT32U cpu_sr{};
 
+uint8_t Adafruit_FT6206::readRegister8(uint8_t reg) {
     uint8_t address(FT6206_ADDR<<1);
     INT32U writeBufSize{1};
     INT32U readBufSize{1};
@@ -150,25 +159,23 @@ uint8_t Adafruit_FT6206::readRegister8(uint8_t reg) {
     uint8_t readBuf[1] = {address};
 
     // use i2c
-    OS_ENTER_CRITICAL();
+    Ioctl(hI2C, PJDF_CTRL_I2C_WAIT_FOR_LOCK, 0, 0);
     Write(hI2C, writeBuf, &writeBufSize);
     Read(hI2C, readBuf, &readBufSize);
-    OS_EXIT_CRITICAL();
+    Ioctl(hI2C, PJDF_CTRL_I2C_RELEASE_LOCK, 0, 0);
 
     return readBuf[0];
 }
 
 void Adafruit_FT6206::writeRegister8(uint8_t reg, uint8_t val) {
-    INT32U cpu_sr{};
-
     uint8_t address{FT6206_ADDR<<1};
     INT32U writeBufSize{2};
     uint8_t writeBuf[3] = {address, reg, val};
 
     // use i2c
-    OS_ENTER_CRITICAL();
+    Ioctl(hI2C, PJDF_CTRL_I2C_WAIT_FOR_LOCK, 0, 0);
     Write(hI2C, writeBuf, &writeBufSize);
-    OS_EXIT_CRITICAL();
+    Ioctl(hI2C, PJDF_CTRL_I2C_RELEASE_LOCK, 0, 0);
 }
 
 void Adafruit_FT6206::setPjdfHandle(HANDLE hI2C) {
@@ -37,11 +37,16 @@
 #define FT6206_REG_WORKMODE 0x00
 #define FT6206_REG_FACTORYMODE 0x40
 #define FT6206_REG_THRESHHOLD 0x80
+#define FT6206_REG_GMODE 0xA4
 #define FT6206_REG_POINTRATE 0x88
 #define FT6206_REG_FIRMVERS 0xA6
 #define FT6206_REG_CHIPID 0xA3
 #define FT6206_REG_VENDID 0xA8
 
+// G_MODE values: INT held low while touched, or pulsed once per report
+#define FT6206_GMODE_POLLING 0x00
+#define FT6206_GMODE_TRIGGER 0x01
+
 // calibrated for Adafruit 2.8" ctp screen
 #define FT6206_DEFAULT_THRESSHOLD 128
 
@@ -70,6 +75,8 @@ class Adafruit_FT6206 {
 
   boolean touched(void);
   TS_Point getPoint(void);
+  uint8_t getTouches(void);
+  uint8_t getTouchID(void);
 
   void setPjdfHandle(HANDLE hI2C);
 
@@ -251,22 +251,25 @@ void Adafruit_ILI9341::begin(void) {
 }
 
 
+// Sends the column, row and RAM write commands as one driver transaction
+// so the window costs one SPI lock instead of one per command and data run.
 void Adafruit_ILI9341::setAddrWindow(uint16_t x0, uint16_t y0, uint16_t x1,
  uint16_t y1) {
+  uint8_t caset = ILI9341_CASET; // Column addr set
+  uint8_t paset = ILI9341_PASET; // Row addr set
+  uint8_t ramwr = ILI9341_RAMWR; // write to RAM
+  uint8_t xs[4] = { (uint8_t)(x0 >> 8), (uint8_t)x0, (uint8_t)(x1 >> 8), (uint8_t)x1 }; // XSTART, XEND
+  uint8_t ys[4] = { (uint8_t)(y0 >> 8), (uint8_t)y0, (uint8_t)(y1 >> 8), (uint8_t)y1 }; // YSTART, YEND
+  PjdfSegment seg[5] = {
+    { &caset, 1, PJDF_SEG_COMMAND },
+    { xs,     4, PJDF_SEG_DATA },
+    { &paset, 1, PJDF_SEG_COMMAND },
+    { ys,     4, PJDF_SEG_DATA },
+    { &ramwr, 1, PJDF_SEG_COMMAND },
+  };
 
-  writecommand(ILI9341_CASET); // Column addr set
-  writedata(x0 >> 8);
-  writedata(x0 & 0xFF);     // XSTART 
-  writedata(x1 >> 8);
-  writedata(x1 & 0xFF);     // XEND
-
-  writecommand(ILI9341_PASET); // Row addr set
-  writedata(y0>>8);
-  writedata(y0);     // YSTART
-  writedata(y1>>8);
-  writedata(y1);     // YEND
-
-  writecommand(ILI9341_RAMWR); // write to RAM
+  spiFlush();
+  WriteV(hLcd, seg, 5);
 }
 
 
@@ -302,19 +305,12 @@ void Adafruit_ILI9341::drawFastVLine(int16_t x, int16_t y, int16_t h,
 
   if((y+h-1) >= _height) 
     h = _height-y;
+  if(h <= 0) return;
 
   if (hwSPI) spi_begin();
   setAddrWindow(x, y, x, y+h-1);
 
-  uint8_t hi = color >> 8, lo = color;
-
-
-
-  while (h--) {
-    writedata(hi);
-    writedata(lo);
-  }
-  spiFlush();
+  fillWindow(color, h);
   if (hwSPI) spi_end();
 }
 
@@ -325,19 +321,24 @@ void Adafruit_ILI9341::drawFastHLine(int16_t x, int16_t y, int16_t w,
   // Rudimentary clipping
   if((x >= _width) || (y >= _height)) return;
   if((x+w-1) >= _width)  w = _width-x;
+  if(w <= 0) return;
   if (hwSPI) spi_begin();
   setAddrWindow(x, y, x+w-1, y);
 
-  uint8_t hi = color >> 8, lo = color;
+  fillWindow(color, w);
+  if (hwSPI) spi_end();
+}
+
+// Write count pixels of one color to the current address window with a
+// single driver fill instead of streaming them through spiBuffer.
+void Adafruit_ILI9341::fillWindow(uint16_t color, uint32_t count) {
+  PjdfSpiFill fill;
+  INT32U size = sizeof(fill);
 
-  //digitalWrite(_dc, HIGH);
-  //digitalWrite(_cs, LOW);
-  while (w--) {
-    writedata(hi);
-    writedata(lo);
-  }
   spiFlush();
-  if (hwSPI) spi_end();
+  fill.value = color;
+  fill.count = count;
+  Ioctl(hLcd, PJDF_CTRL_LCD_FILL, (void*) &fill, &size);
 }
 
 void Adafruit_ILI9341::fillScreen(uint16_t color) {
@@ -352,23 +353,137 @@ void Adafruit_ILI9341::fillRect(int16_t x, int16_t y, int16_t w, int16_t h,
   if((x >= _width) || (y >= _height)) return;
   if((x + w - 1) >= _width)  w = _width  - x;
   if((y + h - 1) >= _height) h = _height - y;
+  if((w <= 0) || (h <= 0)) return;
 
   if (hwSPI) spi_begin();
   setAddrWindow(x, y, x+w-1, y+h-1);
 
-  uint8_t hi = color >> 8, lo = color;
+  fillWindow(color, (uint32_t)w * h);
+  if (hwSPI) spi_end();
+}
 
 
-  for(y=h; y>0; y--) {
-    for(x=w; x>0; x--) {
-      writedata(hi);
-      writedata(lo);
+// Draw a character. Opaque text (bg != color) goes out as one address
+// window covering the whole character cell and a single RAMWR burst
+// instead of one CASET/PASET/RAMWR per pixel. Transparent text is drawn
+// as one fillRect per vertical run of set pixels in each glyph column.
+// Cells that are not fully on screen fall back to the clipped GFX path.
+void Adafruit_ILI9341::drawChar(int16_t x, int16_t y, unsigned char c,
+  uint16_t color, uint16_t bg, uint8_t size) {
+
+  if((x < 0) || (y < 0) ||
+     ((x + 6 * size) > _width) || ((y + 8 * size) > _height)) {
+    Adafruit_GFX::drawChar(x, y, c, color, bg, size);
+    return;
+  }
+
+  if (bg != color) {
+    drawText(x, y, (const char *)&c, 1, color, bg, size);
+    return;
+  }
+
+  if(!_cp437 && (c >= 176)) c++; // Handle 'classic' charset behavior
+
+  for (int8_t i=0; i<5; i++) {
+    uint8_t line = glyphColumn(c, i);
+    int8_t j = 0;
+    while (line) {
+      while (!(line & 0x1)) {
+        line >>= 1;
+        j++;
+      }
+      int8_t run = 0;
+      while (line & 0x1) {
+        line >>= 1;
+        run++;
+      }
+      fillRect(x+i*size, y+j*size, size, run*size, color);
+      j += run;
+    }
+  }
+}
+
+// Draw len characters of s as one opaque text line: a single address
+// window spanning all the character cells, then the pixels row by row
+// through the SPI buffer. Characters past the right edge are dropped.
+void Adafruit_ILI9341::drawText(int16_t x, int16_t y, const char *s,
+  uint16_t len, uint16_t color, uint16_t bg, uint8_t size) {
+
+  if((x < 0) || (y < 0) || ((y + 8 * size) > _height) || (size == 0)) {
+    while (len--) {
+      Adafruit_GFX::drawChar(x, y, *s++, color, bg, size);
+      x += 6 * size;
+    }
+    return;
+  }
+
+  int16_t cellW = 6 * size;
+  if (x + cellW > _width) return;
+  if (len > (_width - x) / cellW) len = (_width - x) / cellW;
+  if (len == 0) return;
+
+  if (hwSPI) spi_begin();
+  setAddrWindow(x, y, x + len * cellW - 1, y + 8 * size - 1);
+
+  uint8_t fhi = color >> 8, flo = color;
+  uint8_t bhi = bg >> 8, blo = bg;
+
+  Ioctl(hLcd, PJDF_CTRL_LCD_SELECT_DATA, 0, 0);
+  for (uint8_t j=0; j<8; j++) {
+    for (uint8_t sy=0; sy<size; sy++) {
+      for (uint16_t k=0; k<len; k++) {
+        unsigned char c = s[k];
+        if(!_cp437 && (c >= 176)) c++; // Handle 'classic' charset behavior
+        for (uint8_t i=0; i<6; i++) {
+          boolean on = (glyphColumn(c, i) >> j) & 0x1;
+          for (uint8_t sx=0; sx<size; sx++) {
+            spiWriteByte(on ? fhi : bhi);
+            spiWriteByte(on ? flo : blo);
+          }
+        }
+      }
     }
   }
   spiFlush();
   if (hwSPI) spi_end();
 }
 
+// Redraw a fixed-position text field, sending only the characters that
+// differ from what is on screen. shown holds the text currently displayed
+// (NUL terminated, shownSize bytes including the terminator) and is
+// updated to s. Trailing characters of a shorter string are cleared to bg,
+// so bg must differ from color.
+void Adafruit_ILI9341::updateText(int16_t x, int16_t y, const char *s,
+  char *shown, uint16_t shownSize, uint16_t color, uint16_t bg,
+  uint8_t size) {
+
+  if (shownSize == 0) return;
+
+  uint16_t newLen = 0, oldLen = 0;
+  while (newLen < shownSize - 1 && s[newLen]) newLen++;
+  while (oldLen < shownSize - 1 && shown[oldLen]) oldLen++;
+
+  // first and last (exclusive) character positions that changed
+  uint16_t first = 0;
+  while (first < newLen && first < oldLen && s[first] == shown[first]) first++;
+  uint16_t last = newLen;
+  if (newLen == oldLen) {
+    while (last > first && s[last-1] == shown[last-1]) last--;
+  }
+  if ((first == last) && (newLen == oldLen)) return; // nothing changed
+
+  int16_t cellW = 6 * size;
+  if (first < last) {
+    drawText(x + first * cellW, y, s + first, last - first, color, bg, size);
+  }
+  if (oldLen > newLen) {
+    fillRect(x + newLen * cellW, y, (oldLen - newLen) * cellW, 8 * size, bg);
+  }
+
+  for (uint16_t k=0; k<newLen; k++) shown[k] = s[k];
+  shown[newLen] = 0;
+}
+
 
 // Pass 8-bit (each) R,G,B, get back 16-bit packed color
 uint16_t Adafruit_ILI9341::color565(uint8_t r, uint8_t g, uint8_t b) {
@@ -122,7 +122,13 @@ class Adafruit_ILI9341 : public Adafruit_GFX {
            fillRect(int16_t x, int16_t y, int16_t w, int16_t h,
              uint16_t color),
            setRotation(uint8_t r),
-           invertDisplay(boolean i);
+           invertDisplay(boolean i),
+           drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color,
+             uint16_t bg, uint8_t size),
+           drawText(int16_t x, int16_t y, const char *s, uint16_t len,
+             uint16_t color, uint16_t bg, uint8_t size),
+           updateText(int16_t x, int16_t y, const char *s, char *shown,
+             uint16_t shownSize, uint16_t color, uint16_t bg, uint8_t size);
   uint16_t color565(uint8_t r, uint8_t g, uint8_t b);
 
   /* These are not for current use, 8-bit protocol only! */
@@ -137,6 +143,7 @@ class Adafruit_ILI9341 : public Adafruit_GFX {
   void setPjdfHandle(HANDLE);
   void spiWriteByte(uint8_t);
   void spiFlush();
+  void fillWindow(uint16_t color, uint32_t count);
   void writecommand(uint8_t c);
   void writedata(uint8_t d);
   void commandList(uint8_t *addr);
@@ -0,0 +1,182 @@
+/*
+    bufUtil.c
+    Reference counted buffers from fixed-size pools built on uCOS memory
+    partitions.
+
+    A task takes a buffer with BufGet(), which waits while the pool is empty,
+    fills it, and posts it to one or more queues with BufPost(). Each queue
+    receives its own reference, so several consumers can read the same data
+    without copying it; the buffer goes back to the pool when the last of
+    them calls BufRelease(). Buffers can be chained with BufChain() into a
+    scatter list that is posted and released as one.
+
+    2026/10 written for the MP3Player project
+*/
+
+#include "bsp.h"
+#include "bufUtil.h"
+
+
+// Creates a pool of count buffers of size data bytes in pStorage, which must
+// be word aligned and hold count * BUF_BLOCK_SIZE(size) bytes, see
+// BUF_POOL_STORAGE(). Call after OSInit().
+void BufPoolCreate(BufPool *pPool, void *pStorage, INT16U count, INT16U size)
+{
+    INT8U err;
+
+    pPool->pMem = OSMemCreate(pStorage, count, BUF_BLOCK_SIZE(size), &err);
+    if (err != OS_ERR_NONE) while(1);  // not enough memory partitions
+
+    pPool->freeSem = OSSemCreate(count);
+    if (pPool->freeSem == NULL) while(1);  // not enough semaphores available
+
+    pPool->size = size;
+    pPool->used = 0;
+    pPool->usedMax = 0;
+}
+
+
+// Takes a buffer out of the partition once freeSem has been taken for it
+static Buf *BufTake(BufPool *pPool)
+{
+    OS_CPU_SR cpu_sr;
+    INT8U err;
+    Buf *pBuf;
+
+    pBuf = (Buf*) OSMemGet(pPool->pMem, &err);
+    if (err != OS_ERR_NONE) while(1);  // freeSem is out of step with the partition
+
+    pBuf->pPool = pPool;
+    pBuf->pNext = NULL;
+    pBuf->pData = (INT8U*)(pBuf + 1);
+    pBuf->length = 0;
+    pBuf->refCount = 1;
+
+    OS_ENTER_CRITICAL();
+    pPool->used++;
+    if (pPool->used > pPool->usedMax) pPool->usedMax = pPool->used;
+    OS_EXIT_CRITICAL();
+    return pBuf;
+}
+
+
+// Returns an empty buffer holding one reference, waiting up to timeout ticks
+// (0 waits forever) for one to be released while the pool is empty.
+// Returns NULL with the error of OSSemPend() in *pErr if none came free.
+Buf *BufGet(BufPool *pPool, INT32U timeout, INT8U *pErr)
+{
+    OSSemPend(pPool->freeSem, timeout, pErr);
+    if (*pErr != OS_ERR_NONE) return NULL;
+    return BufTake(pPool);
+}
+
+
+// As BufGet() but returns NULL at once if the pool is empty. Safe to call
+// from ISRs.
+Buf *BufAccept(BufPool *pPool)
+{
+    if (OSSemAccept(pPool->freeSem) == 0) return NULL;
+    return BufTake(pPool);
+}
+
+
+// Adds a reference to the buffer (the head of a scatter list), e.g. before
+// handing it to another consumer. Safe to call from ISRs.
+void BufRef(Buf *pBuf)
+{
+    OS_CPU_SR cpu_sr;
+
+    OS_ENTER_CRITICAL();
+    if (pBuf->refCount == 0xFF) while(1);  // reference count overflow
+    pBuf->refCount++;
+    OS_EXIT_CRITICAL();
+}
+
+
+// Drops a reference to the buffer. When the last one is dropped the buffer
+// goes back to its pool and the reference it held to the rest of the scatter
+// list is dropped in turn. Safe to call from ISRs.
+void BufRelease(Buf *pBuf)
+{
+    OS_CPU_SR cpu_sr;
+    BufPool *pPool;
+    Buf *pNext;
+    INT8U refCount;
+
+    while (pBuf != NULL)
+    {
+        OS_ENTER_CRITICAL();
+        if (pBuf->refCount == 0) while(1);  // released once too often
+        refCount = --pBuf->refCount;
+        OS_EXIT_CRITICAL();
+        if (refCount != 0) return;
+
+        pPool = pBuf->pPool;
+        pNext = pBuf->pNext;
+        if (OSMemPut(pPool->pMem, pBuf) != OS_ERR_NONE)
+        {
+            while(1);
+        }
+
+        OS_ENTER_CRITICAL();
+        pPool->used--;
+        OS_EXIT_CRITICAL();
+        OSSemPost(pPool->freeSem);
+
+        pBuf = pNext;
+    }
+}
+
+
+// Appends pTail (and whatever follows it) to the end of the scatter list
+// starting at pHead. The caller's reference to pTail passes to the list.
+void BufChain(Buf *pHead, Buf *pTail)
+{
+    while (pHead->pNext != NULL) pHead = pHead->pNext;
+    pHead->pNext = pTail;
+}
+
+
+// Returns the bytes in use in all the buffers of the scatter list
+INT32U BufChainLength(Buf *pHead)
+{
+    INT32U length = 0;
+
+    for (; pHead != NULL; pHead = pHead->pNext) length += pHead->length;
+    return length;
+}
+
+
+// Posts the buffer (the head of a scatter list) to each of count queues.
+// The caller's reference goes to the first queue and a reference is added
+// for each of the others; with no queues it is simply dropped. A reference
+// that could not be posted (the queue is full) is dropped again. Returns
+// OS_ERR_NONE if every post succeeded, otherwise the error of the last
+// failed OSQPost().
+INT8U BufPost(OS_EVENT **pQueues, INT8U count, Buf *pBuf)
+{
+    INT8U err;
+    INT8U result = OS_ERR_NONE;
+    INT8U i;
+
+    if (count == 0)
+    {
+        BufRelease(pBuf);
+        return OS_ERR_NONE;
+    }
+
+    // take all the references first so an early consumer cannot free the
+    // buffer under the later posts
+    for (i = 1; i < count; i++) BufRef(pBuf);
+
+    for (i = 0; i < count; i++)
+    {
+        err = OSQPost(pQueues[i], pBuf);
+        if (err != OS_ERR_NONE)
+        {
+            result = err;
+            BufRelease(pBuf);
+        }
+    }
+    return result;
+}
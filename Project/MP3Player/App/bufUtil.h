@@ -0,0 +1,51 @@
+/*
+    bufUtil.h
+    Reference counted buffers from fixed-size pools built on uCOS memory
+    partitions, for passing data between tasks through queues without copying.
+
+    2026/10 written for the MP3Player project
+*/
+
+#ifndef __BUFUTIL_H
+#define __BUFUTIL_H
+
+struct _BufPool;
+
+// Header of a buffer taken from a BufPool. The data follows the header in
+// the same partition block.
+typedef struct _Buf
+{
+    struct _BufPool *pPool;  // pool the buffer goes back to
+    struct _Buf *pNext;      // next buffer of a scatter list, or NULL
+    INT8U *pData;            // the pool's size bytes of data
+    INT16U length;           // bytes of data in use
+    INT8U refCount;          // owners, the buffer goes back to the pool when this drops to 0
+} Buf;
+
+// A pool of count buffers of size data bytes each
+typedef struct _BufPool
+{
+    OS_MEM *pMem;            // partition holding the buffers
+    OS_EVENT *freeSem;       // counts the buffers left in the partition
+    INT16U size;             // data bytes per buffer
+    INT16U used;             // buffers taken from the pool and not yet released
+    INT16U usedMax;          // high water mark of used
+} BufPool;
+
+// Bytes of partition storage per buffer of size data bytes
+#define BUF_BLOCK_SIZE(size)  ((sizeof(Buf) + (size) + 3u) & ~3u)
+
+// Declares word aligned storage for a pool of count buffers of size bytes
+#define BUF_POOL_STORAGE(name, count, size)  INT32U name[(count) * BUF_BLOCK_SIZE(size) / sizeof(INT32U)]
+
+void BufPoolCreate(BufPool *pPool, void *pStorage, INT16U count, INT16U size);
+Buf *BufGet(BufPool *pPool, INT32U timeout, INT8U *pErr);
+Buf *BufAccept(BufPool *pPool);
+void BufRef(Buf *pBuf);
+void BufRelease(Buf *pBuf);
+void BufChain(Buf *pHead, Buf *pTail);
+INT32U BufChainLength(Buf *pHead);
+INT8U BufPost(OS_EVENT **pQueues, INT8U count, Buf *pBuf);
+
+
+#endif
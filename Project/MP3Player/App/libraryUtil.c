@@ -0,0 +1,666 @@
+/*
+    libraryUtil.c
+    Catalog of the songs in a directory of the SD card.
+
+    Listing a directory with openNextFile() opens every file, which searches
+    the directory for its name again, and learning a song's title or length
+    means reading its tags and frames. The catalog does that once and keeps
+    the result in a LIBRARY_FILE in the directory: a header sector, then 64
+    byte entries sorted by name, 8 to a sector, so entry i is found with one
+    seek and one sector read whatever the number of songs.
+
+    On open the directory entries alone are read, 16 to a sector, and hashed.
+    FAT directory dates are not kept up to date by every system, and the
+    root has none, so the hash of the names, sizes, first clusters and write
+    times of the MP3 files stands in for them. Only if it differs from the
+    one in the catalog is the catalog rebuilt:
+    - the entries are read from the directory into runs of
+      LIBRARY_SORT_ENTRIES, sorted in RAM and written to a temporary file
+    - the runs are merged, two at a time, between two temporary files until
+      one is left
+    - the sorted entries and the old catalog are read side by side; an
+      entry whose file has not changed keeps its title, artist and length,
+      only new or changed files are opened and their tags and first frames
+      read
+    - the result is copied to LIBRARY_FILE, whose header is written last so
+      that a build cut short by a power cycle is redone.
+    Every pass reads and writes whole sectors in order, through a few sector
+    buffers, so a catalog of thousands of songs is built in a few KB of RAM.
+
+    Call from one task at a time. Other tasks may use the card meanwhile,
+    e.g. to stream a song: every SD call holds the card (SdCardLock in SD.h)
+    and the catalog keeps nothing of the card between calls.
+
+    2026/10 written for the MP3Player project
+*/
+
+#include "bsp.h"
+#include "mp3Index.h"
+#include "libraryUtil.h"
+#include "SD.h"
+
+#define LIBRARY_SORT_PAGES     4   // sectors of librarySort
+#define LIBRARY_SORT_ENTRIES   (LIBRARY_SORT_PAGES * LIBRARY_PAGE_ENTRIES)
+#define LIBRARY_PROBE_SECTORS  4   // sectors of frames read to time a song without a TOC
+#define LIBRARY_TEXT_READ      64  // bytes of an ID3 text frame read
+#define LIBRARY_PATH_MAX       64  // bytes of the path of a catalog file, with its NUL
+#define LIBRARY_NONE           0xFFFF  // no directory index
+
+// The temporary files of a build go in the root, which is searched quickly
+// for them; LIBRARY_FILE goes in the directory it catalogs
+static char libraryTemp1[] = "/LIBRARY.TM1";
+static char libraryTemp2[] = "/LIBRARY.TM2";
+static char libraryFileName[LIBRARY_PATH_MAX];
+
+// A run being sorted, or the sector buffers of a pass
+static LibraryEntry librarySort[LIBRARY_SORT_ENTRIES];
+
+// The sector of entries LibraryGet() read last, or scratch while building
+static LibraryEntry libraryPage[LIBRARY_PAGE_ENTRIES];
+static INT32U libraryPageSector;      // sector of LIBRARY_FILE in libraryPage, 0 if none
+
+static File libraryFile;              // LIBRARY_FILE, open after LibraryOpen()
+static INT32U libraryCount;
+static BOOLEAN libraryFailed;         // a read or write failed while building
+
+// The first frames of the song being timed
+static Mp3Index libraryIndex;
+static Mp3IndexBuilder libraryBuilder;
+
+// Reads entries in order from a range of a file, a sector at a time
+typedef struct _LibraryReader
+{
+    File *pFile;
+    INT32U base;             // file offset of entry 0, a multiple of 512
+    INT32U next;             // entry read next
+    INT32U end;              // entry to stop at
+    INT32U page;             // 1 + the number of the sector of entries in pPage, 0 if none
+    LibraryEntry *pPage;     // LIBRARY_PAGE_ENTRIES entries
+} LibraryReader;
+
+// Writes entries to a file a sector at a time
+typedef struct _LibraryWriter
+{
+    File *pFile;
+    INT16U count;            // entries in pPage
+    LibraryEntry *pPage;
+} LibraryWriter;
+
+
+static void LibraryReaderInit(LibraryReader *pReader, File *pFile, INT32U base, INT32U first, INT32U end, LibraryEntry *pPage)
+{
+    pReader->pFile = pFile;
+    pReader->base = base;
+    pReader->next = first;
+    pReader->end = end;
+    pReader->page = 0;
+    pReader->pPage = pPage;
+}
+
+// Returns the next entry, or NULL at the end of the range
+static LibraryEntry *LibraryReaderPeek(LibraryReader *pReader)
+{
+    INT32U page = pReader->next / LIBRARY_PAGE_ENTRIES;
+
+    if (pReader->next >= pReader->end) return NULL;
+    if (pReader->page != page + 1)
+    {
+        if (!pReader->pFile->seek(pReader->base + page * 512) || pReader->pFile->readSector(pReader->pPage) <= 0)
+        {
+            libraryFailed = OS_TRUE;
+            pReader->end = pReader->next;
+            return NULL;
+        }
+        pReader->page = page + 1;
+    }
+    return &pReader->pPage[pReader->next % LIBRARY_PAGE_ENTRIES];
+}
+
+// Writes the entries held, a part sector only at the end of the file
+static void LibraryWriterFlush(LibraryWriter *pWriter)
+{
+    size_t length = pWriter->count * sizeof(LibraryEntry);
+
+    if (length != 0 && pWriter->pFile->write((const uint8_t*)pWriter->pPage, length) != length)
+    {
+        libraryFailed = OS_TRUE;
+    }
+    pWriter->count = 0;
+}
+
+static void LibraryWriterPut(LibraryWriter *pWriter, const LibraryEntry *pEntry)
+{
+    pWriter->pPage[pWriter->count++] = *pEntry;
+    if (pWriter->count == LIBRARY_PAGE_ENTRIES) LibraryWriterFlush(pWriter);
+}
+
+
+// Opens the given file for writing, empty
+static File LibraryCreate(char *pName)
+{
+    SD.remove(pName);
+    return SD.open(pName, FILE_WRITE);
+}
+
+// Returns OS_TRUE if the directory entry is an MP3 file
+static BOOLEAN LibraryIsSong(const dir_t *pDir)
+{
+    return (BOOLEAN)(DIR_IS_FILE(pDir) && memcmp(&pDir->name[8], "MP3", 3) == 0);
+}
+
+// FNV-1a hash
+static INT32U LibraryHash(INT32U hash, const INT8U *p, INT16U length)
+{
+    while (length-- > 0)
+    {
+        hash = (hash ^ *p++) * 16777619u;
+    }
+    return hash;
+}
+
+// Hashes the entries of the MP3 files of the directory.
+// *pCount: set to the number of MP3 files
+// *pCatalog: set to the index of the directory's LIBRARY_FILE, LIBRARY_NONE if none
+static INT32U LibraryCheck(File *pDir, INT32U *pCount, INT16U *pCatalog)
+{
+    INT32U hash = 2166136261u;
+    dir_t entry;
+
+    *pCount = 0;
+    *pCatalog = LIBRARY_NONE;
+    pDir->rewindDirectory();
+    while (pDir->readDir(&entry) > 0)
+    {
+        if (DIR_IS_FILE(&entry) && memcmp(entry.name, "LIBRARY DAT", 11) == 0)
+        {
+            *pCatalog = (INT16U)(pDir->position() / sizeof(dir_t) - 1);
+        }
+        if (!LibraryIsSong(&entry)) continue;
+        // the name, then first cluster, write time, write date and size; not
+        // the access date, which reading the file may change
+        hash = LibraryHash(hash, entry.name, sizeof(entry.name));
+        hash = LibraryHash(hash, (const INT8U*)&entry.firstClusterHigh, 12);
+        (*pCount)++;
+    }
+    return hash;
+}
+
+
+// Sorts the first count entries of librarySort by name
+static void LibrarySortRun(INT16U count)
+{
+    LibraryEntry entry;
+    INT16U i, j;
+
+    for (i = 1; i < count; i++)
+    {
+        entry = librarySort[i];
+        for (j = i; j > 0 && memcmp(librarySort[j - 1].name, entry.name, sizeof(entry.name)) > 0; j--)
+        {
+            librarySort[j] = librarySort[j - 1];
+        }
+        librarySort[j] = entry;
+    }
+}
+
+// Writes an entry for each MP3 file of the directory to pDst, in sorted
+// runs of LIBRARY_SORT_ENTRIES. Returns the number of entries.
+static INT32U LibraryRuns(File *pDir, char *pDst)
+{
+    File out = LibraryCreate(pDst);
+    LibraryEntry *pEntry;
+    dir_t entry;
+    INT16U n = 0;
+    INT32U count = 0;
+    size_t length;
+
+    if (!out)
+    {
+        libraryFailed = OS_TRUE;
+        return 0;
+    }
+
+    pDir->rewindDirectory();
+    while (1)
+    {
+        BOOLEAN more = (BOOLEAN)(pDir->readDir(&entry) > 0);
+
+        if (more && LibraryIsSong(&entry))
+        {
+            pEntry = &librarySort[n++];
+            memset(pEntry, 0, sizeof(LibraryEntry));
+            memcpy(pEntry->name, entry.name, sizeof(pEntry->name));
+            pEntry->cluster = ((INT32U)entry.firstClusterHigh << 16) | entry.firstClusterLow;
+            pEntry->size = entry.fileSize;
+            pEntry->modified = ((INT32U)entry.lastWriteDate << 16) | entry.lastWriteTime;
+            pEntry->dirIndex = (INT16U)(pDir->position() / sizeof(dir_t) - 1);
+        }
+        if (n == LIBRARY_SORT_ENTRIES || (!more && n != 0))
+        {
+            LibrarySortRun(n);
+            length = n * sizeof(LibraryEntry);
+            if (out.write((const uint8_t*)librarySort, length) != length) libraryFailed = OS_TRUE;
+            count += n;
+            n = 0;
+        }
+        if (!more) break;
+    }
+    out.close();
+    return count;
+}
+
+// Merges the sorted runs of run entries in pSrc into runs twice as long in pDst
+static void LibraryMergePass(char *pSrc, char *pDst, INT32U count, INT32U run)
+{
+    File a = SD.open(pSrc, O_READ);
+    File b = SD.open(pSrc, O_READ);
+    File out = LibraryCreate(pDst);
+    LibraryReader readerA, readerB;
+    LibraryWriter writer = { &out, 0, &librarySort[2 * LIBRARY_PAGE_ENTRIES] };
+    LibraryEntry *pA, *pB;
+    INT32U start;
+
+    if (!a || !b || !out) libraryFailed = OS_TRUE;
+
+    for (start = 0; start < count && !libraryFailed; start += 2 * run)
+    {
+        LibraryReaderInit(&readerA, &a, 0, start, (start + run < count) ? start + run : count, &librarySort[0]);
+        LibraryReaderInit(&readerB, &b, 0, readerA.end, (start + 2 * run < count) ? start + 2 * run : count, &librarySort[LIBRARY_PAGE_ENTRIES]);
+        while (1)
+        {
+            pA = LibraryReaderPeek(&readerA);
+            pB = LibraryReaderPeek(&readerB);
+            if (pA == NULL && pB == NULL) break;
+            if (pB == NULL || (pA != NULL && memcmp(pA->name, pB->name, sizeof(pA->name)) <= 0))
+            {
+                LibraryWriterPut(&writer, pA);
+                readerA.next++;
+            }
+            else
+            {
+                LibraryWriterPut(&writer, pB);
+                readerB.next++;
+            }
+        }
+    }
+    LibraryWriterFlush(&writer);
+
+    out.close();
+    b.close();
+    a.close();
+}
+
+
+// Copies the text of an ID3 frame to pText, of max bytes, as printable
+// ASCII. encoding: the ID3 text encoding, 0 ISO-8859-1, 1 UTF-16 with a BOM,
+// 2 UTF-16BE, 3 UTF-8
+static void LibraryText(char *pText, INT16U max, const INT8U *p, INT16U length, INT8U encoding)
+{
+    BOOLEAN wide = (BOOLEAN)(encoding == 1 || encoding == 2);
+    BOOLEAN bigEndian = (BOOLEAN)(encoding == 2);
+    INT16U i = 0;
+    INT16U n = 0;
+    INT16U c;
+
+    if (wide && length >= 2 && (p[0] == 0xFE || p[0] == 0xFF) && p[0] + p[1] == 0x1FD)
+    {
+        bigEndian = (BOOLEAN)(p[0] == 0xFE); // byte order mark
+        i = 2;
+    }
+    while (n < max - 1 && i < length)
+    {
+        if (wide)
+        {
+            if (i + 1 >= length) break;
+            c = bigEndian ? (p[i] << 8) | p[i + 1] : (p[i + 1] << 8) | p[i];
+            i += 2;
+        }
+        else
+        {
+            c = p[i++];
+            if (encoding == 3 && (c & 0xC0) == 0x80) continue; // rest of a UTF-8 character
+        }
+        if (c == 0) break;
+        pText[n++] = (c < 0x20 || c > 0x7E) ? '?' : (char)c;
+    }
+    while (n > 0 && pText[n - 1] == ' ') n--;
+    pText[n] = 0;
+}
+
+// Reads the title or artist from the ID3v2 text frame of size bytes at the
+// position of pFile
+static void LibraryTextFrame(File *pFile, INT32U size, char *pText, INT16U max)
+{
+    INT8U *p = (INT8U*)libraryPage;
+    INT16U length = (INT16U)((size < LIBRARY_TEXT_READ) ? size : LIBRARY_TEXT_READ);
+
+    if (length < 2 || pFile->read(p, length) != length) return;
+    LibraryText(pText, max, &p[1], length - 1, p[0]);
+}
+
+static INT32U LibrarySyncsafe(const INT8U *p)
+{
+    return ((INT32U)(p[0] & 0x7F) << 21) | ((INT32U)(p[1] & 0x7F) << 14) | ((p[2] & 0x7F) << 7) | (p[3] & 0x7F);
+}
+
+// Reads the title and artist from the ID3v2 tag whose 10 byte header is in
+// libraryPage
+static void LibraryId3v2(File *pFile, LibraryEntry *pEntry)
+{
+    INT8U *p = (INT8U*)libraryPage;
+    INT8U version = p[3];
+    INT8U flags = p[5];
+    INT16U frameHeader = (version == 2) ? 6 : 10;
+    INT16U idLength = (version == 2) ? 3 : 4;
+    INT32U end, pos, size;
+
+    if (memcmp(p, "ID3", 3) != 0 || version < 2 || version > 4) return;
+    end = 10 + LibrarySyncsafe(&p[6]);
+    pos = 10;
+
+    if ((flags & 0x40) && version > 2)
+    {
+        // skip the extended header
+        if (!pFile->seek(pos) || pFile->read(p, 4) != 4) return;
+        pos += (version == 3) ? 4 + ((INT32U)p[0] << 24 | (INT32U)p[1] << 16 | p[2] << 8 | p[3]) : LibrarySyncsafe(p);
+    }
+
+    while (pos + frameHeader <= end && (pEntry->title[0] == 0 || pEntry->artist[0] == 0))
+    {
+        if (!pFile->seek(pos) || pFile->read(p, frameHeader) != frameHeader || p[0] == 0) break; // padding
+        if (version == 2) size = ((INT32U)p[3] << 16) | (p[4] << 8) | p[5];
+        else if (version == 3) size = ((INT32U)p[4] << 24) | ((INT32U)p[5] << 16) | (p[6] << 8) | p[7];
+        else size = LibrarySyncsafe(&p[4]);
+
+        if (memcmp(p, (version == 2) ? "TT2" : "TIT2", idLength) == 0)
+        {
+            LibraryTextFrame(pFile, size, pEntry->title, LIBRARY_TITLE_MAX);
+        }
+        else if (memcmp(p, (version == 2) ? "TP1" : "TPE1", idLength) == 0)
+        {
+            LibraryTextFrame(pFile, size, pEntry->artist, LIBRARY_ARTIST_MAX);
+        }
+        pos += frameHeader + size;
+    }
+}
+
+// Reads the title and artist from an ID3v1 tag, the last 128 bytes of the file
+static void LibraryId3v1(File *pFile, LibraryEntry *pEntry)
+{
+    INT8U *p = (INT8U*)libraryPage;
+
+    if (pEntry->size < 128 || !pFile->seek(pEntry->size - 128) || pFile->read(p, 128) != 128) return;
+    if (memcmp(p, "TAG", 3) != 0) return;
+    if (pEntry->title[0] == 0) LibraryText(pEntry->title, LIBRARY_TITLE_MAX, &p[3], 30, 0);
+    if (pEntry->artist[0] == 0) LibraryText(pEntry->artist, LIBRARY_ARTIST_MAX, &p[33], 30, 0);
+}
+
+// Fills in the title, artist and length of the song from its file. The
+// length comes from a Xing/VBRI TOC, or else from the bitrate of its first
+// frames.
+static void LibraryScan(File *pDir, LibraryEntry *pEntry)
+{
+    INT8U *p = (INT8U*)libraryPage;
+    File file = pDir->openAt(pEntry->dirIndex, O_READ);
+    INT32U frames = 0;
+    INT32U ms;
+    INT16U i;
+    int count;
+
+    pEntry->flags |= LIBRARY_SCANNED;
+    if (!file) return;
+
+    Mp3IndexBegin(&libraryBuilder, &libraryIndex, pEntry->size);
+    if (file.read(p, 10) == 10)
+    {
+        Mp3IndexFeed(&libraryBuilder, p, 10);
+        LibraryId3v2(&file, pEntry);
+    }
+
+    // the frames after the tag, from where the builder wants them
+    for (i = 0; i < LIBRARY_PROBE_SECTORS && file.seek(Mp3IndexSkip(&libraryBuilder)); i++)
+    {
+        count = file.read(p, 512);
+        if (count <= 0 || Mp3IndexFeed(&libraryBuilder, p, count)) break;
+    }
+    if (Mp3IndexEnd(&libraryBuilder))
+    {
+        frames = libraryIndex.frameCount;
+    }
+    else if (libraryBuilder.frame != 0 && libraryIndex.audioEnd > libraryIndex.audioStart)
+    {
+        frames = (INT32U)((unsigned long long)(pEntry->size - libraryIndex.audioStart) * libraryBuilder.frame
+            / (libraryIndex.audioEnd - libraryIndex.audioStart));
+    }
+    if (frames != 0)
+    {
+        ms = Mp3IndexFrameMs(&libraryIndex, frames);
+        pEntry->seconds = (INT16U)((ms / 1000 < 0xFFFF) ? ms / 1000 : 0xFFFF);
+    }
+
+    if (pEntry->title[0] == 0 || pEntry->artist[0] == 0)
+    {
+        LibraryId3v1(&file, pEntry);
+    }
+    file.close();
+}
+
+// Writes the sorted entries of pSrc to pDst with their titles, artists and
+// lengths: from the old catalog if the file has not changed, else from the file
+static void LibraryScanPass(File *pDir, char *pSrc, char *pDst, INT32U count)
+{
+    File in = SD.open(pSrc, O_READ);
+    File old = SD.open(libraryFileName, O_READ);
+    File out = LibraryCreate(pDst);
+    LibraryReader reader, oldReader;
+    LibraryWriter writer = { &out, 0, &librarySort[2 * LIBRARY_PAGE_ENTRIES] };
+    LibraryHeader header;
+    LibraryEntry entry;
+    LibraryEntry *pOld;
+    INT32U oldCount = 0;
+
+    if (!in || !out) libraryFailed = OS_TRUE;
+    if (old && old.read(&header, sizeof(header)) == sizeof(header) && header.magic == LIBRARY_MAGIC)
+    {
+        oldCount = header.count;
+    }
+
+    LibraryReaderInit(&reader, &in, 0, 0, libraryFailed ? 0 : count, &librarySort[0]);
+    LibraryReaderInit(&oldReader, &old, 512, 0, oldCount, &librarySort[LIBRARY_PAGE_ENTRIES]);
+    while (LibraryReaderPeek(&reader) != NULL)
+    {
+        entry = *LibraryReaderPeek(&reader);
+        reader.next++;
+
+        // the old catalog is sorted too, so it is read once alongside
+        while ((pOld = LibraryReaderPeek(&oldReader)) != NULL && memcmp(pOld->name, entry.name, sizeof(entry.name)) < 0)
+        {
+            oldReader.next++;
+        }
+        if (pOld != NULL && memcmp(pOld->name, entry.name, sizeof(entry.name)) == 0
+            && pOld->cluster == entry.cluster && pOld->size == entry.size && pOld->modified == entry.modified
+            && (pOld->flags & LIBRARY_SCANNED))
+        {
+            entry.flags = pOld->flags;
+            entry.seconds = pOld->seconds;
+            memcpy(entry.title, pOld->title, sizeof(entry.title));
+            memcpy(entry.artist, pOld->artist, sizeof(entry.artist));
+        }
+        else
+        {
+            LibraryScan(pDir, &entry);
+        }
+        LibraryWriterPut(&writer, &entry);
+    }
+    LibraryWriterFlush(&writer);
+
+    out.close();
+    old.close();
+    in.close();
+}
+
+// Copies the entries of pSrc to LIBRARY_FILE after its header
+static void LibraryInstall(char *pSrc, INT32U count, INT32U check)
+{
+    File in = SD.open(pSrc, O_READ);
+    File out = LibraryCreate(libraryFileName);
+    LibraryHeader *pHeader = (LibraryHeader*)libraryPage;
+    int length;
+
+    if (!in || !out) libraryFailed = OS_TRUE;
+
+    // the header is written without its magic until the entries are all there
+    memset(libraryPage, 0, sizeof(libraryPage));
+    pHeader->count = count;
+    pHeader->dirCheck = check;
+    if (out.write((const uint8_t*)libraryPage, 512) != 512) libraryFailed = OS_TRUE;
+
+    while (!libraryFailed && (length = in.readSector(librarySort)) > 0)
+    {
+        if (out.write((const uint8_t*)librarySort, length) != (size_t)length) libraryFailed = OS_TRUE;
+    }
+
+    if (!libraryFailed)
+    {
+        pHeader->magic = LIBRARY_MAGIC;
+        out.seek(0);
+        out.write((const uint8_t*)libraryPage, 512);
+    }
+    out.close();
+    in.close();
+}
+
+// Builds LIBRARY_FILE for the directory, whose hash is check
+static void LibraryBuild(File *pDir, INT32U check)
+{
+    char *pSrc = libraryTemp1;
+    char *pDst = libraryTemp2;
+    char *pSwap;
+    INT32U count;
+    INT32U run;
+
+    libraryFailed = OS_FALSE;
+    count = LibraryRuns(pDir, pSrc);
+    for (run = LIBRARY_SORT_ENTRIES; run < count && !libraryFailed; run *= 2)
+    {
+        LibraryMergePass(pSrc, pDst, count, run);
+        pSwap = pSrc;
+        pSrc = pDst;
+        pDst = pSwap;
+    }
+    if (!libraryFailed) LibraryScanPass(pDir, pSrc, pDst, count);
+    if (!libraryFailed) LibraryInstall(pDst, count, check);
+
+    SD.remove(libraryTemp1);
+    SD.remove(libraryTemp2);
+}
+
+// Reads the header of the given LIBRARY_FILE and keeps it open as the
+// catalog. Returns OS_FALSE unless it is a complete catalog of count entries
+// with the given hash.
+static BOOLEAN LibraryLoad(File file, INT32U check, INT32U count)
+{
+    LibraryHeader header;
+
+    libraryFile = file;
+    if (!libraryFile) return OS_FALSE;
+    if (libraryFile.read(&header, sizeof(header)) == sizeof(header) && header.magic == LIBRARY_MAGIC
+        && header.dirCheck == check && header.count == count)
+    {
+        libraryCount = count;
+        return OS_TRUE;
+    }
+    libraryFile.close();
+    libraryFile = File();
+    return OS_FALSE;
+}
+
+// Makes the path of the file of the given name in directory pDir. Returns
+// OS_FALSE if it does not fit.
+static BOOLEAN LibraryPath(char *pPath, const char *pDir, const char *pName)
+{
+    INT16U length = strlen(pDir);
+
+    if (length > 0 && pDir[length - 1] == '/') length--;
+    if (length + 1 + strlen(pName) + 1 > LIBRARY_PATH_MAX) return OS_FALSE;
+    memcpy(pPath, pDir, length);
+    pPath[length] = '/';
+    strcpy(&pPath[length + 1], pName);
+    return OS_TRUE;
+}
+
+// Opens the catalog of the songs in the given directory, e.g. "/" or
+// "/MUSIC", rebuilding it if the directory has changed since it was made.
+// Each directory keeps its own LIBRARY_FILE, so moving between directories
+// does not rebuild.
+// The directory is read whole, a sector per 16 entries, to tell. Returns
+// OS_FALSE if the directory or the catalog could not be read.
+BOOLEAN LibraryOpen(const char *pDir)
+{
+    File dir = SD.open(pDir, O_READ);
+    INT32U check;
+    INT32U count;
+    INT16U catalog;
+    BOOLEAN ok = OS_FALSE;
+
+    if (libraryFile)
+    {
+        libraryFile.close();
+        libraryFile = File();
+    }
+    libraryCount = 0;
+    libraryPageSector = 0;
+
+    if (dir && dir.isDirectory() && LibraryPath(libraryFileName, pDir, LIBRARY_FILE))
+    {
+        // the catalog is opened by its index, found while hashing, not
+        // by a second search of a directory of perhaps thousands of songs
+        check = LibraryCheck(&dir, &count, &catalog);
+        ok = catalog != LIBRARY_NONE && LibraryLoad(dir.openAt(catalog, O_READ), check, count);
+        if (!ok)
+        {
+            LibraryBuild(&dir, check);
+            libraryPageSector = 0; // libraryPage was scratch
+            ok = LibraryLoad(SD.open(libraryFileName, O_READ), check, count);
+        }
+    }
+    dir.close();
+    return ok;
+}
+
+// Returns the number of songs in the open catalog
+INT32U LibraryCount()
+{
+    return libraryCount;
+}
+
+// Returns the entry of the given song, in order of name, or NULL if there is
+// none. The entry is read with the others of its sector, at most one sector
+// read, and stays valid until an entry of another sector is asked for.
+const LibraryEntry *LibraryGet(INT32U index)
+{
+    INT32U sector = 1 + index / LIBRARY_PAGE_ENTRIES;
+
+    if (index >= libraryCount) return NULL;
+    if (sector != libraryPageSector)
+    {
+        libraryPageSector = 0;
+        if (!libraryFile.seek(sector * 512) || libraryFile.readSector(libraryPage) <= 0) return NULL;
+        libraryPageSector = sector;
+    }
+    return &libraryPage[index % LIBRARY_PAGE_ENTRIES];
+}
+
+// Makes the file name of the entry, e.g. "SONG.MP3". pName must hold 13 bytes.
+void LibraryName(const LibraryEntry *pEntry, char *pName)
+{
+    INT16U i;
+    INT16U n = 0;
+
+    for (i = 0; i < 11; i++)
+    {
+        if (i == 8) pName[n++] = '.';
+        if (pEntry->name[i] != ' ') pName[n++] = pEntry->name[i];
+    }
+    pName[n] = 0;
+}
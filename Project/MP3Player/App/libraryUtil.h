@@ -0,0 +1,50 @@
+/*
+    libraryUtil.h
+    Catalog of the songs in a directory of the SD card, kept in a file of
+    fixed size entries sorted by name so that the UI can page through
+    thousands of tracks a sector at a time.
+
+    2026/10 written for the MP3Player project
+*/
+
+#ifndef __LIBRARYUTIL_H
+#define __LIBRARYUTIL_H
+
+#define LIBRARY_FILE          "LIBRARY.DAT"
+#define LIBRARY_MAGIC         0x3142494Cu  // "LIB1"
+#define LIBRARY_ENTRY_SIZE    64           // bytes
+#define LIBRARY_PAGE_ENTRIES  (512 / LIBRARY_ENTRY_SIZE)  // entries per SD card sector
+#define LIBRARY_TITLE_MAX     20           // bytes of title, with its NUL
+#define LIBRARY_ARTIST_MAX    16           // bytes of artist, with its NUL
+
+// LibraryEntry flags
+#define LIBRARY_SCANNED       0x01         // seconds, title and artist have been read from the file
+
+typedef struct _LibraryEntry
+{
+    char name[11];           // 8.3 name as in the directory entry, space padded, e.g. "SONG    MP3"
+    INT8U flags;             // LIBRARY_xxx
+    INT32U cluster;          // first cluster; with size and modified tells whether the file changed
+    INT32U size;             // bytes
+    INT32U modified;         // FAT last write date << 16 | time
+    INT16U seconds;          // playing time
+    INT16U dirIndex;         // entry number in the directory, opens the file without a name search
+    char title[LIBRARY_TITLE_MAX];    // from the ID3 tag, "" if none
+    char artist[LIBRARY_ARTIST_MAX];
+} LibraryEntry;
+
+// Sector 0 of LIBRARY_FILE. The entries follow from sector 1.
+typedef struct _LibraryHeader
+{
+    INT32U magic;            // LIBRARY_MAGIC, written last
+    INT32U count;            // entries
+    INT32U dirCheck;         // hash of the directory entries of the MP3 files the catalog was made from
+} LibraryHeader;
+
+BOOLEAN LibraryOpen(const char *pDir);
+INT32U LibraryCount(void);
+const LibraryEntry *LibraryGet(INT32U index);
+void LibraryName(const LibraryEntry *pEntry, char *pName);
+
+
+#endif
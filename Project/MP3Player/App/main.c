@@ -56,6 +56,9 @@ INT8U err;
     DEBUGMSG(1, ("main: Running OSInit()...\n"));
     OSInit();
 
+    // Move console output and input through the UART interrupt from OSStart() on
+    BspUartInitInterrupts();
+
     // Initialize driver framework after initializing uCOS since the framework uses uCOS services
     DEBUGMSG(1, ("Initializing PJDF driver framework...\n"));
     InitPjdf();
@@ -0,0 +1,563 @@
+/*
+    mp3Index.c
+    Seek index of the frames of an MP3 file.
+
+    The file is fed to the builder in order, in chunks of any size, e.g. as
+    the SD reader task streams it to the decoder. An ID3v2 tag at the start
+    is skipped. When the first frame carries a Xing/Info or VBRI table of
+    contents the index is taken from it at once; otherwise every frame header
+    is parsed, which only looks at 4 bytes per frame, and the offset of every
+    framesPerEntry'th frame is kept. A tag frame without a TOC is not counted
+    as audio. When the entries run out every other one
+    is dropped and framesPerEntry doubles, so any length of file fits.
+
+    A seek then costs a lookup in the index plus one seek in the file, and
+    lands on a frame whose number, and so whose first sample, is known. From
+    there the frames up to the wanted one are skipped by their headers alone.
+
+    2026/10 written for the MP3Player project
+*/
+
+#include "bsp.h"
+#include "mp3Index.h"
+
+// Builder states
+#define MP3_INDEX_ST_ID3    0  // reading the 10 bytes where an ID3v2 header would be
+#define MP3_INDEX_ST_SYNC   1  // looking for a frame header one byte at a time
+#define MP3_INDEX_ST_FRAME  2  // reading the header of the next frame
+#define MP3_INDEX_ST_HEAD   3  // reading the start of the first frame for a Xing/VBRI tag
+#define MP3_INDEX_ST_DONE   4  // no more frames wanted
+
+// Header bits every frame must share with the first: sync, version, layer
+// and sample rate
+#define MP3_HEADER_MATCH_MASK  0xFFFE0C00u
+
+// Bitrates in kbit/s by [MPEG-1, MPEG-2/2.5][layer I, II, III][bitrate index]
+static const INT16U mp3Bitrates[2][3][16] =
+{
+    {
+        {0, 32, 64, 96, 128, 160, 192, 224, 256, 288, 320, 352, 384, 416, 448, 0},
+        {0, 32, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 384, 0},
+        {0, 32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 0},
+    },
+    {
+        {0, 32, 48, 56, 64, 80, 96, 112, 128, 144, 160, 176, 192, 224, 256, 0},
+        {0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160, 0},
+        {0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160, 0},
+    },
+};
+
+// MPEG-1 sample rates, halved for MPEG-2 and quartered for MPEG-2.5
+static const INT32U mp3SampleRates[3] = {44100, 48000, 32000};
+
+
+static INT32U GetBE32(const INT8U *p)
+{
+    return ((INT32U)p[0] << 24) | ((INT32U)p[1] << 16) | ((INT32U)p[2] << 8) | p[3];
+}
+
+static INT16U GetBE16(const INT8U *p)
+{
+    return (INT16U)((p[0] << 8) | p[1]);
+}
+
+
+// Returns the length in bytes of the frame with the given header, or 0 if it
+// is not a valid header (free format bitrates included).
+// *pSampleRate, *pSamples: set to the frame's sample rate and sample count
+static INT32U Mp3FrameLength(INT32U header, INT32U *pSampleRate, INT16U *pSamples)
+{
+    INT32U version = (header >> 19) & 3;      // 0 = MPEG-2.5, 1 reserved, 2 = MPEG-2, 3 = MPEG-1
+    INT32U layer = (header >> 17) & 3;        // 1 = III, 2 = II, 3 = I, 0 reserved
+    INT32U bitrateIndex = (header >> 12) & 15;
+    INT32U rateIndex = (header >> 10) & 3;
+    INT32U padding = (header >> 9) & 1;
+    INT32U bitrate;
+    INT32U rate;
+
+    if ((header & 0xFFE00000u) != 0xFFE00000u || version == 1 || layer == 0
+        || bitrateIndex == 0 || bitrateIndex == 15 || rateIndex == 3)
+    {
+        return 0;
+    }
+
+    bitrate = mp3Bitrates[version == 3 ? 0 : 1][3 - layer][bitrateIndex] * 1000u;
+    rate = mp3SampleRates[rateIndex] >> (version == 3 ? 0 : (version == 2 ? 1 : 2));
+    *pSampleRate = rate;
+
+    if (layer == 3)
+    {
+        *pSamples = 384;
+        return (12 * bitrate / rate + padding) * 4;
+    }
+    *pSamples = (layer == 1 && version != 3) ? 576 : 1152;
+    return *pSamples / 8 * bitrate / rate + padding;
+}
+
+
+// Records the offset of the current frame if it starts an entry
+static void Mp3IndexAddEntry(Mp3IndexBuilder *pBuilder, INT32U offset)
+{
+    Mp3Index *pIndex = pBuilder->pIndex;
+    INT16U i;
+
+    if (pBuilder->frame % pIndex->framesPerEntry != 0) return;
+
+    if (pIndex->entryCount == MP3_INDEX_ENTRIES)
+    {
+        if (pIndex->framesPerEntry >= 0x8000) return; // keep the entries there are
+        for (i = 0; i < MP3_INDEX_ENTRIES / 2; i++)
+        {
+            pIndex->entries[i] = pIndex->entries[2 * i];
+        }
+        pIndex->entryCount = MP3_INDEX_ENTRIES / 2;
+        pIndex->framesPerEntry *= 2;
+        if (pBuilder->frame % pIndex->framesPerEntry != 0) return;
+    }
+    pIndex->entries[pIndex->entryCount++] = offset;
+}
+
+
+// Returns the offset in the first frame of a Xing/Info tag, after the
+// header and the side information
+static INT32U Mp3XingOffset(INT32U header)
+{
+    BOOLEAN mono = ((header >> 6) & 3) == 3;
+    BOOLEAN mpeg1 = ((header >> 19) & 3) == 3;
+
+    return 4 + (mpeg1 ? (mono ? 17 : 32) : (mono ? 9 : 17));
+}
+
+
+// Returns OS_TRUE if the first frame, held in head, is a Xing/Info or VBRI
+// tag rather than audio, whether or not it has a TOC
+static BOOLEAN Mp3IndexIsTag(const Mp3IndexBuilder *pBuilder)
+{
+    INT32U at = Mp3XingOffset(pBuilder->header);
+
+    if (at + 4 <= pBuilder->held
+        && (memcmp(&pBuilder->head[at], "Xing", 4) == 0 || memcmp(&pBuilder->head[at], "Info", 4) == 0))
+    {
+        return OS_TRUE;
+    }
+    return (BOOLEAN)(4 + 32 + 4 <= pBuilder->held && memcmp(&pBuilder->head[4 + 32], "VBRI", 4) == 0);
+}
+
+
+// Takes the index from a Xing/Info tag with a frame count and TOC in the
+// first frame, of length bytes. The TOC gives the file position of each
+// percent of the playing time in 1/256ths of the stream, so entries are
+// interpolated from it and are not frame starts.
+static BOOLEAN Mp3IndexXing(Mp3IndexBuilder *pBuilder, INT32U length)
+{
+    Mp3Index *pIndex = pBuilder->pIndex;
+    INT32U at = Mp3XingOffset(pBuilder->header);
+    INT32U flags, frames, bytes, frame, percent, fraction, a, b, offset;
+    const INT8U *pToc;
+    INT16U i, step;
+
+    if (at + 8 > pBuilder->held) return OS_FALSE;
+    if (memcmp(&pBuilder->head[at], "Xing", 4) != 0 && memcmp(&pBuilder->head[at], "Info", 4) != 0) return OS_FALSE;
+    flags = GetBE32(&pBuilder->head[at + 4]);
+    if ((flags & 0x05) != 0x05) return OS_FALSE; // needs the frame count and the TOC
+    at += 8;
+    frames = GetBE32(&pBuilder->head[at]);
+    at += 4;
+    bytes = pIndex->fileSize - pBuilder->want;
+    if (flags & 0x02)
+    {
+        bytes = GetBE32(&pBuilder->head[at]);
+        at += 4;
+    }
+    if (at + 100 > pBuilder->held || frames == 0 || bytes == 0) return OS_FALSE;
+    pToc = &pBuilder->head[at];
+
+    pIndex->audioStart = pBuilder->want + length;
+    pIndex->audioEnd = pBuilder->want + bytes;
+    if (pIndex->audioEnd > pIndex->fileSize) pIndex->audioEnd = pIndex->fileSize;
+    pIndex->frameCount = frames;
+    step = (INT16U)((frames + MP3_INDEX_ENTRIES - 1) / MP3_INDEX_ENTRIES);
+    pIndex->framesPerEntry = step;
+
+    for (i = 0, frame = 0; i < MP3_INDEX_ENTRIES && frame < frames; i++, frame += step)
+    {
+        percent = frame * 100 / frames;
+        fraction = (frame * 100 % frames) * 256 / frames;
+        a = pToc[percent];
+        b = (percent < 99) ? pToc[percent + 1] : 256;
+        if (b < a) b = a;
+        offset = pBuilder->want + (INT32U)(((unsigned long long)bytes * (a * 256 + (b - a) * fraction)) >> 16);
+        pIndex->entries[i] = (offset < pIndex->audioStart) ? pIndex->audioStart : offset;
+    }
+    pIndex->entryCount = i;
+    pIndex->source = MP3_INDEX_XING;
+    return OS_TRUE;
+}
+
+
+// Takes the index from a VBRI tag in the first frame, of length bytes. Its
+// TOC holds the size of each run of a fixed number of frames.
+static BOOLEAN Mp3IndexVbri(Mp3IndexBuilder *pBuilder, INT32U length)
+{
+    Mp3Index *pIndex = pBuilder->pIndex;
+    const INT8U *pTag = &pBuilder->head[4 + 32];
+    INT32U bytes, frames, offset, size;
+    INT16U tocEntries, scale, entryBytes, framesPerToc, keep, t, i, k;
+
+    if (4 + 32 + 26 > pBuilder->held || memcmp(pTag, "VBRI", 4) != 0) return OS_FALSE;
+    bytes = GetBE32(&pTag[10]);
+    frames = GetBE32(&pTag[14]);
+    tocEntries = GetBE16(&pTag[18]);
+    scale = GetBE16(&pTag[20]);
+    entryBytes = GetBE16(&pTag[22]);
+    framesPerToc = GetBE16(&pTag[24]);
+    if (frames == 0 || tocEntries == 0 || entryBytes == 0 || entryBytes > 4 || framesPerToc == 0) return OS_FALSE;
+    if (4 + 32 + 26 + (INT32U)tocEntries * entryBytes > pBuilder->held) return OS_FALSE;
+
+    // keep every keep'th of the tocEntries + 1 run boundaries
+    keep = (INT16U)((tocEntries + MP3_INDEX_ENTRIES) / MP3_INDEX_ENTRIES);
+    if ((INT32U)framesPerToc * keep > 0xFFFF) return OS_FALSE;
+
+    pIndex->audioStart = pBuilder->want + length;
+    pIndex->audioEnd = pBuilder->want + bytes;
+    if (pIndex->audioEnd > pIndex->fileSize) pIndex->audioEnd = pIndex->fileSize;
+    pIndex->frameCount = frames;
+    pIndex->framesPerEntry = framesPerToc * keep;
+
+    offset = pIndex->audioStart;
+    for (t = 0, i = 0; t <= tocEntries && i < MP3_INDEX_ENTRIES && (INT32U)t * framesPerToc < frames; t++)
+    {
+        if (t % keep == 0) pIndex->entries[i++] = offset;
+        if (t == tocEntries) break;
+        for (size = 0, k = 0; k < entryBytes; k++)
+        {
+            size = (size << 8) | pTag[26 + t * entryBytes + k];
+        }
+        offset += size * scale;
+    }
+    pIndex->entryCount = i;
+    pIndex->source = MP3_INDEX_VBRI;
+    return OS_TRUE;
+}
+
+
+// Starts looking for a frame header one byte after the current position
+static void Mp3IndexResync(Mp3IndexBuilder *pBuilder)
+{
+    memmove(pBuilder->head, &pBuilder->head[1], pBuilder->held - 1);
+    pBuilder->held--;
+    pBuilder->want++;
+    pBuilder->wantLength = 4;
+    pBuilder->state = MP3_INDEX_ST_SYNC;
+}
+
+
+// Acts on the wanted bytes, which have been collected in head
+static void Mp3IndexStep(Mp3IndexBuilder *pBuilder)
+{
+    Mp3Index *pIndex = pBuilder->pIndex;
+    INT32U header, length, sampleRate;
+    INT16U samples;
+
+    while (pBuilder->state != MP3_INDEX_ST_DONE && pBuilder->held >= pBuilder->wantLength)
+    {
+        if (pBuilder->state == MP3_INDEX_ST_ID3)
+        {
+            pBuilder->state = MP3_INDEX_ST_SYNC;
+            pBuilder->wantLength = 4;
+            if (memcmp(pBuilder->head, "ID3", 3) == 0)
+            {
+                // the size is a 28 bit "syncsafe" integer, plus the header and any footer
+                pBuilder->want = (((INT32U)pBuilder->head[6] & 0x7F) << 21) | (((INT32U)pBuilder->head[7] & 0x7F) << 14)
+                    | (((INT32U)pBuilder->head[8] & 0x7F) << 7) | (pBuilder->head[9] & 0x7F);
+                pBuilder->want += (pBuilder->head[5] & 0x10) ? 20 : 10;
+                pBuilder->held = 0;
+            }
+            continue; // otherwise look for a frame in the bytes held
+        }
+
+        if (pBuilder->state == MP3_INDEX_ST_HEAD)
+        {
+            // the first frame: take the index from its tag, skip a tag
+            // without a usable TOC, or count it as frame 0
+            length = Mp3FrameLength(pBuilder->header, &sampleRate, &samples);
+            if (Mp3IndexXing(pBuilder, length) || Mp3IndexVbri(pBuilder, length))
+            {
+                pBuilder->complete = OS_TRUE;
+                pBuilder->state = MP3_INDEX_ST_DONE;
+                return;
+            }
+            if (Mp3IndexIsTag(pBuilder))
+            {
+                // the tag frame is silent and no part of the audio
+                pIndex->audioStart = pBuilder->want + length;
+                pIndex->audioEnd = pIndex->audioStart;
+            }
+            else
+            {
+                pIndex->audioStart = pBuilder->want;
+                pIndex->audioEnd = pBuilder->want + length;
+                Mp3IndexAddEntry(pBuilder, pBuilder->want);
+                pBuilder->frame = 1;
+            }
+            pBuilder->want += length;
+            pBuilder->held = 0;
+            pBuilder->wantLength = 4;
+            pBuilder->state = MP3_INDEX_ST_FRAME;
+            continue;
+        }
+
+        header = GetBE32(pBuilder->head);
+        length = Mp3FrameLength(header, &sampleRate, &samples);
+        if (length != 0 && pBuilder->header != 0 && (header & MP3_HEADER_MATCH_MASK) != (pBuilder->header & MP3_HEADER_MATCH_MASK))
+        {
+            length = 0; // another stream's header, or a false sync
+        }
+        if (length == 0)
+        {
+            if (pBuilder->state == MP3_INDEX_ST_FRAME && pBuilder->frame == 1)
+            {
+                // the first frame was a false sync: look again from the byte
+                // after its header, which Mp3IndexFeed() goes back to
+                pBuilder->header = 0;
+                pBuilder->frame = 0;
+                pIndex->entryCount = 0;
+                pBuilder->want = pIndex->audioStart + 1;
+                pBuilder->held = 0;
+                pBuilder->wantLength = 4;
+                pBuilder->state = MP3_INDEX_ST_SYNC;
+                continue;
+            }
+            Mp3IndexResync(pBuilder);
+            continue;
+        }
+        if (pBuilder->want + length > pIndex->fileSize)
+        {
+            pBuilder->state = MP3_INDEX_ST_DONE; // a truncated last frame
+            return;
+        }
+
+        if (pBuilder->header == 0)
+        {
+            // keep the start of the first frame to look for a tag
+            pBuilder->header = header;
+            pIndex->sampleRate = sampleRate;
+            pIndex->samplesPerFrame = samples;
+            pBuilder->wantLength = (INT16U)((length < MP3_INDEX_HEAD_SIZE) ? length : MP3_INDEX_HEAD_SIZE);
+            pBuilder->state = MP3_INDEX_ST_HEAD;
+            continue;
+        }
+
+        Mp3IndexAddEntry(pBuilder, pBuilder->want);
+        pBuilder->frame++;
+        pBuilder->want += length;
+        pIndex->audioEnd = pBuilder->want;
+        pBuilder->held = 0;
+        pBuilder->wantLength = 4;
+        pBuilder->state = MP3_INDEX_ST_FRAME;
+    }
+}
+
+
+// Starts building pIndex for a file of fileSize bytes. Feed the whole file
+// from its start to Mp3IndexFeed(), then call Mp3IndexEnd().
+void Mp3IndexBegin(Mp3IndexBuilder *pBuilder, Mp3Index *pIndex, INT32U fileSize)
+{
+    if (sizeof(Mp3Index) != MP3_INDEX_SIZE) while(1);  // the sidecar file holds one sector
+
+    memset(pIndex, 0, sizeof(Mp3Index));
+    pIndex->fileSize = fileSize;
+    pIndex->framesPerEntry = 1;
+    pIndex->source = MP3_INDEX_SCANNED;
+
+    pBuilder->pIndex = pIndex;
+    pBuilder->pos = 0;
+    pBuilder->want = 0;
+    pBuilder->wantLength = 10;
+    pBuilder->held = 0;
+    pBuilder->state = MP3_INDEX_ST_ID3;
+    pBuilder->complete = OS_FALSE;
+    pBuilder->header = 0;
+    pBuilder->frame = 0;
+}
+
+
+// Feeds the next length bytes of the file. While the file is being fed the
+// entries so far are usable with Mp3IndexLocate(). Returns OS_TRUE once the
+// index is complete, having been taken from a TOC, and the rest of the file
+// need not be fed.
+// After a false first frame the builder goes back to the byte after its
+// header. If that was fed in an earlier call the rest of pData is not used:
+// Mp3IndexSkip() then returns an offset before the end of pData, and the
+// file must be fed again from there.
+BOOLEAN Mp3IndexFeed(Mp3IndexBuilder *pBuilder, const INT8U *pData, INT32U length)
+{
+    const INT8U *pStart = pData;
+    INT32U next;
+    INT32U count;
+
+    while (length > 0 && pBuilder->state != MP3_INDEX_ST_DONE)
+    {
+        next = pBuilder->want + pBuilder->held;
+        if (pBuilder->pos > next)
+        {
+            // back to bytes already fed, after a false sync
+            count = pBuilder->pos - next;
+            pBuilder->pos = next;
+            if (count > (INT32U)(pData - pStart)) return OS_FALSE;
+            pData -= count;
+            length += count;
+            continue;
+        }
+
+        // skip to the wanted bytes, frame data is never looked at
+        if (pBuilder->pos < next)
+        {
+            count = next - pBuilder->pos;
+            if (count > length) count = length;
+            pBuilder->pos += count;
+            pData += count;
+            length -= count;
+            continue;
+        }
+
+        count = pBuilder->wantLength - pBuilder->held;
+        if (count > length) count = length;
+        memcpy(&pBuilder->head[pBuilder->held], pData, count);
+        pBuilder->held += count;
+        pBuilder->pos += count;
+        pData += count;
+        length -= count;
+
+        Mp3IndexStep(pBuilder);
+    }
+    pBuilder->pos += length;
+    return pBuilder->complete;
+}
+
+
+// Skips ahead to the next byte the builder looks at, past bytes it would
+// only count, e.g. an ID3v2 tag, and returns its file offset. The caller
+// seeks the file there and feeds on from there. Also returns the offset
+// Mp3IndexFeed() went back to after a false sync, when that was before the
+// bytes it was fed.
+INT32U Mp3IndexSkip(Mp3IndexBuilder *pBuilder)
+{
+    INT32U next = pBuilder->want + pBuilder->held;
+
+    if (pBuilder->pos < next) pBuilder->pos = next;
+    return pBuilder->pos;
+}
+
+
+// Finishes the index. Returns OS_TRUE if it is complete and holds at least
+// one frame, OS_FALSE if the file was not fed to its end or has no frames.
+BOOLEAN Mp3IndexEnd(Mp3IndexBuilder *pBuilder)
+{
+    Mp3Index *pIndex = pBuilder->pIndex;
+
+    if (!pBuilder->complete)
+    {
+        if (pBuilder->pos < pIndex->fileSize || pBuilder->frame == 0) return OS_FALSE;
+        pIndex->frameCount = pBuilder->frame;
+        pBuilder->complete = OS_TRUE;
+    }
+    pBuilder->state = MP3_INDEX_ST_DONE;
+    pIndex->magic = MP3_INDEX_MAGIC;
+    return OS_TRUE;
+}
+
+
+// Returns OS_TRUE if pIndex, e.g. read from a sidecar file, is a complete
+// index of a file of fileSize bytes.
+BOOLEAN Mp3IndexValid(const Mp3Index *pIndex, INT32U fileSize)
+{
+    return (BOOLEAN)(pIndex->magic == MP3_INDEX_MAGIC && pIndex->fileSize == fileSize
+        && pIndex->entryCount != 0 && pIndex->entryCount <= MP3_INDEX_ENTRIES
+        && pIndex->framesPerEntry != 0 && pIndex->sampleRate != 0 && pIndex->samplesPerFrame != 0);
+}
+
+
+// Returns the number of the frame that plays at ms into the audio
+INT32U Mp3IndexMsFrame(const Mp3Index *pIndex, INT32U ms)
+{
+    INT32U samples = ms / 1000 * pIndex->sampleRate + ms % 1000 * pIndex->sampleRate / 1000;
+
+    return samples / pIndex->samplesPerFrame;
+}
+
+
+// Returns the offset of the indexed frame at or before the given frame.
+// From there frames can be skipped with Mp3IndexFrameLength() until the
+// given one is reached, if the index was MP3_INDEX_SCANNED; TOC entries are
+// not frame starts, the decoder finds the next frame itself.
+// *pFrame: set to the number of the indexed frame, which starts at sample
+//     *pFrame * samplesPerFrame
+INT32U Mp3IndexSeek(const Mp3Index *pIndex, INT32U frame, INT32U *pFrame)
+{
+    INT32U entry = frame / pIndex->framesPerEntry;
+
+    if (entry >= pIndex->entryCount) entry = pIndex->entryCount - 1;
+    *pFrame = entry * pIndex->framesPerEntry;
+    return pIndex->entries[entry];
+}
+
+
+// Returns the offset of the indexed frame at or before the given file
+// offset, e.g. the position playback has reached.
+// *pFrame: set to the number of that frame
+INT32U Mp3IndexLocate(const Mp3Index *pIndex, INT32U offset, INT32U *pFrame)
+{
+    INT32U low = 0;
+    INT32U high = pIndex->entryCount;
+    INT32U mid;
+
+    // the last entry at or before offset, entry 0 if there is none
+    while (high - low > 1)
+    {
+        mid = (low + high) / 2;
+        if (pIndex->entries[mid] <= offset) low = mid;
+        else high = mid;
+    }
+    *pFrame = low * pIndex->framesPerEntry;
+    return pIndex->entries[low];
+}
+
+
+// Returns the time in ms at which the given frame starts
+INT32U Mp3IndexFrameMs(const Mp3Index *pIndex, INT32U frame)
+{
+    INT32U samples = frame * pIndex->samplesPerFrame;
+
+    return samples / pIndex->sampleRate * 1000 + samples % pIndex->sampleRate * 1000 / pIndex->sampleRate;
+}
+
+
+// Returns the length of the frame whose 4 byte header is at pHeader, or 0
+// if it is not a frame header
+INT32U Mp3IndexFrameLength(const INT8U *pHeader)
+{
+    INT32U sampleRate;
+    INT16U samples;
+
+    return Mp3FrameLength(GetBE32(pHeader), &sampleRate, &samples);
+}
+
+
+// Makes the name of the sidecar file holding the index of the file pName by
+// replacing its extension with .IDX, e.g. SONG.MP3 -> SONG.IDX.
+// pSidecar must hold strlen(pName) + 5 bytes.
+void Mp3IndexSidecarName(const char *pName, char *pSidecar)
+{
+    const char *pDot = NULL;
+    const char *p;
+
+    for (p = pName; *p; p++)
+    {
+        if (*p == '.') pDot = p;
+        if (*p == '/') pDot = NULL;
+    }
+    if (pDot == NULL) pDot = p;
+    memcpy(pSidecar, pName, pDot - pName);
+    strcpy(&pSidecar[pDot - pName], ".IDX");
+}
@@ -0,0 +1,70 @@
+/*
+    mp3Index.h
+    Seek index of the frames of an MP3 file, built by scanning the MPEG audio
+    frame headers or taken from a Xing/Info or VBRI table of contents. The
+    index fills one SD card sector so it can be cached next to the file.
+
+    2026/10 written for the MP3Player project
+*/
+
+#ifndef __MP3INDEX_H
+#define __MP3INDEX_H
+
+#define MP3_INDEX_MAGIC    0x3158444Du  // "MDX1"
+#define MP3_INDEX_SIZE     512          // bytes, one SD card sector
+#define MP3_INDEX_ENTRIES  120
+
+// Where the entries of an index came from
+#define MP3_INDEX_SCANNED  0  // every frame header was parsed: entries are exact frame starts
+#define MP3_INDEX_XING     1  // interpolated from a Xing/Info TOC, within 1/256 of the audio
+#define MP3_INDEX_VBRI     2  // summed from a VBRI TOC
+
+// Bytes of the first frame kept for its Xing/Info or VBRI tag
+#define MP3_INDEX_HEAD_SIZE  512
+
+typedef struct _Mp3Index
+{
+    INT32U magic;            // MP3_INDEX_MAGIC
+    INT32U fileSize;         // size of the MP3 file, an index of another size is stale
+    INT32U audioStart;       // offset of frame 0, after any ID3v2 tag and Xing/VBRI frame
+    INT32U audioEnd;         // offset just past the last whole frame
+    INT32U frameCount;       // frames from audioStart to audioEnd
+    INT32U sampleRate;       // Hz
+    INT16U samplesPerFrame;  // 384, 1152, or 576 for MPEG-2/2.5 layer III
+    INT16U framesPerEntry;   // entry i is the offset of frame i * framesPerEntry
+    INT16U entryCount;
+    INT8U source;            // MP3_INDEX_xxx
+    INT8U reserved;
+    INT32U entries[MP3_INDEX_ENTRIES];
+} Mp3Index;
+
+// State of an index being built from the bytes of the file, fed in order
+typedef struct _Mp3IndexBuilder
+{
+    Mp3Index *pIndex;
+    INT32U pos;              // file offset of the next byte fed
+    INT32U want;             // file offset of the bytes wanted next
+    INT16U wantLength;       // bytes wanted there, collected in head
+    INT16U held;             // bytes of them collected so far
+    INT8U state;             // MP3_INDEX_ST_xxx in mp3Index.c
+    BOOLEAN complete;        // the index covers the whole file
+    INT32U header;           // first frame header, later frames must match it
+    INT32U frame;            // number of the frame at want
+    INT8U head[MP3_INDEX_HEAD_SIZE];
+} Mp3IndexBuilder;
+
+void Mp3IndexBegin(Mp3IndexBuilder *pBuilder, Mp3Index *pIndex, INT32U fileSize);
+BOOLEAN Mp3IndexFeed(Mp3IndexBuilder *pBuilder, const INT8U *pData, INT32U length);
+INT32U Mp3IndexSkip(Mp3IndexBuilder *pBuilder);
+BOOLEAN Mp3IndexEnd(Mp3IndexBuilder *pBuilder);
+
+BOOLEAN Mp3IndexValid(const Mp3Index *pIndex, INT32U fileSize);
+INT32U Mp3IndexMsFrame(const Mp3Index *pIndex, INT32U ms);
+INT32U Mp3IndexSeek(const Mp3Index *pIndex, INT32U frame, INT32U *pFrame);
+INT32U Mp3IndexLocate(const Mp3Index *pIndex, INT32U offset, INT32U *pFrame);
+INT32U Mp3IndexFrameMs(const Mp3Index *pIndex, INT32U frame);
+INT32U Mp3IndexFrameLength(const INT8U *pHeader);
+void Mp3IndexSidecarName(const char *pName, char *pSidecar);
+
+
+#endif
@@ -9,6 +9,8 @@
 
 #include "bsp.h"
 #include "print.h"
+#include "bufUtil.h"
+#include "mp3Index.h"
 #include "SD.h"
 
 void delay(uint32_t time);
@@ -18,36 +20,301 @@ static File dataFile;
 
 extern BOOLEAN nextSong;
 
+static OS_STK Mp3ReaderTaskStk[APP_CFG_TASK_MP3_STK_SIZE];
+static OS_STK Mp3FeederTaskStk[APP_CFG_TASK_MP3_STK_SIZE];
+static OS_STK Mp3ResumeTaskStk[APP_CFG_TASK_MP3_STK_SIZE];
+
+// Sector buffers are passed from the SD reader task to the decoder feeder
+// task. A buffer with length 0 marks the end of the stream.
+static BUF_POOL_STORAGE(mp3StreamBlocks, MP3_STREAM_BUF_COUNT, MP3_STREAM_BUF_SIZE);
+static BufPool mp3StreamPool;         // sector buffers, the reader waits on it when all are queued
+static void *mp3StreamQPtrs[MP3_STREAM_BUF_COUNT]; // storage for the queue of filled buffers
+static OS_EVENT *mp3StreamQ;          // filled buffers, reader -> feeder
+static OS_EVENT *mp3StreamDoneSem;    // posted by each task when it has finished with the stream
+
+static HANDLE mp3StreamHandle;        // decoder handle used by the feeder task
+static INT32U mp3StreamUnderruns;     // times the feeder found no filled buffer waiting
+static volatile INT32U mp3StreamFed;  // file offset of the next byte the feeder writes to the decoder
+
+#define MP3_PATH_MAX         32            // longest file name with a sidecar index or resume record, with its NUL
+#define MP3_RESUME_FILE      "RESUME.DAT"  // where the song being played and how far it got are kept
+#define MP3_RESUME_MAGIC     0x31535952u   // "RYS1"
+#define MP3_RESUME_INTERVAL  (64 * 1024u)  // bytes fed to the decoder between updates of the resume record
+
+// Contents of MP3_RESUME_FILE
+typedef struct _Mp3Resume
+{
+    INT32U magic;             // MP3_RESUME_MAGIC
+    INT32U ms;                // start of the indexed frame playback had reached
+    char name[MP3_PATH_MAX];
+} Mp3Resume;
+
+static Mp3Index mp3Index;             // index of the file being played
+static Mp3IndexBuilder mp3IndexBuilder;
+static BOOLEAN mp3Indexing;           // the reader feeds the file to mp3IndexBuilder as it plays
+static File resumeFile;               // open while playing if the resume record is kept
+static Mp3Resume mp3Resume;
+static INT32U mp3ResumeSaved;         // mp3StreamFed when the resume record was last asked for
+static OS_EVENT *mp3ResumeSem;        // posted by the reader for an update of the resume record
+static BOOLEAN mp3ResumeStop;         // set with the last post, when the stream has ended
+
 static void Mp3StreamInit(HANDLE hMp3)
 {
-    INT32U length;
-    
-    // Place MP3 driver in command mode (subsequent writes will be sent to the decoder's command interface)
-    Ioctl(hMp3, PJDF_CTRL_MP3_SELECT_COMMAND, 0, 0);
+    // Reset the device, set volume, then to allow streaming data set the
+    // decoder mode to Play Mode, all in one driver transaction
+    PjdfSegment seg[3] = {
+        { (void*)BspMp3SoftReset, BspMp3SoftResetLen, PJDF_SEG_COMMAND },
+        { (void*)BspMp3SetVol1010, BspMp3SetVol1010Len, PJDF_SEG_COMMAND },
+        { (void*)BspMp3PlayMode, BspMp3PlayModeLen, PJDF_SEG_COMMAND },
+    };
     
-    // Reset the device
-    length = BspMp3SoftResetLen;
-    Write(hMp3, (void*)BspMp3SoftReset, &length);
- 
-    // Set volume
-    length = BspMp3SetVol1010Len;
-    Write(hMp3, (void*)BspMp3SetVol1010, &length);
-
-    // To allow streaming data, set the decoder mode to Play Mode
-    length = BspMp3PlayModeLen;
-    Write(hMp3, (void*)BspMp3PlayMode, &length);
+    WriteV(hMp3, seg, 3);
    
     // Set MP3 driver to data mode (subsequent writes will be sent to decoder's data interface)
     Ioctl(hMp3, PJDF_CTRL_MP3_SELECT_DATA, 0, 0);
 }
 
-// Mp3StreamSDFile
-// Streams the given file from the SD card to the given MP3 decoder.
+// Mp3StreamCreate
+// Creates the buffer pool, queue and semaphore shared by the streaming tasks.
+static void Mp3StreamCreate()
+{
+    if (mp3StreamQ != NULL) return; // already created
+
+    BufPoolCreate(&mp3StreamPool, mp3StreamBlocks, MP3_STREAM_BUF_COUNT, MP3_STREAM_BUF_SIZE);
+
+    mp3StreamQ = OSQCreate(mp3StreamQPtrs, MP3_STREAM_BUF_COUNT);
+    if (mp3StreamQ == NULL) while(1);
+
+    mp3StreamDoneSem = OSSemCreate(0);
+    if (mp3StreamDoneSem == NULL) while(1);
+
+    mp3ResumeSem = OSSemCreate(0);
+    if (mp3ResumeSem == NULL) while(1);
+}
+
+// Mp3ResumeSave
+// Records in the resume file the start of the indexed frame at or before
+// the data the feeder has reached, so that a power cycle loses little of the
+// song. Costs one sector write.
+static void Mp3ResumeSave()
+{
+    INT32U fed = mp3StreamFed;
+    INT32U frame = 0;
+
+    if (mp3Index.entryCount != 0)
+    {
+        Mp3IndexLocate(&mp3Index, fed, &frame);
+    }
+    mp3Resume.ms = (frame != 0) ? Mp3IndexFrameMs(&mp3Index, frame) : 0;
+
+    resumeFile.seek(0);
+    resumeFile.write((const uint8_t*)&mp3Resume, sizeof(mp3Resume));
+    resumeFile.flush();
+}
+
+// Mp3ReaderTask
+// Fills sector buffers from dataFile and queues them for Mp3FeederTask,
+// feeding them to the index builder too while the index is being built.
+// Sends an empty buffer at end of file, or when nextSong is set, then deletes itself.
+static void Mp3ReaderTask(void* pdata)
+{
+    INT8U err;
+    Buf *pBuf;
+    BOOLEAN done = OS_FALSE;
+
+    while (!done)
+    {
+        // wait for the feeder to hand back a buffer
+        pBuf = BufGet(&mp3StreamPool, 0, &err);
+        if (err != OS_ERR_NONE) while(1);
+
+        if (!nextSong && dataFile.available())
+        {
+            int count = dataFile.read(pBuf->pData, MP3_STREAM_BUF_SIZE);
+            if (count > 0)
+            {
+                pBuf->length = count;
+                if (mp3Indexing)
+                {
+                    Mp3IndexFeed(&mp3IndexBuilder, pBuf->pData, count);
+                    // gone back to bytes already played after a false sync:
+                    // a seek scans the file instead
+                    if (mp3IndexBuilder.pos < dataFile.position()) mp3Indexing = OS_FALSE;
+                }
+            }
+        }
+        done = (pBuf->length == 0);
+
+        // the write is left to Mp3ResumeTask, so the queue does not run
+        // dry behind it
+        if (resumeFile && mp3StreamFed - mp3ResumeSaved >= MP3_RESUME_INTERVAL)
+        {
+            mp3ResumeSaved = mp3StreamFed;
+            OSSemPost(mp3ResumeSem);
+        }
+
+        err = BufPost(&mp3StreamQ, 1, pBuf);
+        if (err != OS_ERR_NONE) while(1);
+    }
+
+    OSSemPost(mp3StreamDoneSem);
+    OSTaskDel(OS_PRIO_SELF);
+}
+
+// Mp3FeederTask
+// Drains queued sector buffers into the decoder, one Write() per sector.
+// Deletes itself after receiving the empty end-of-stream buffer.
+static void Mp3FeederTask(void* pdata)
+{
+    INT8U err;
+    Buf *pBuf;
+    BOOLEAN done = OS_FALSE;
+
+    while (!done)
+    {
+        pBuf = (Buf*) OSQAccept(mp3StreamQ, &err);
+        if (pBuf == NULL)
+        {
+            // the reader has fallen behind the decoder
+            mp3StreamUnderruns++;
+            pBuf = (Buf*) OSQPend(mp3StreamQ, 0, &err);
+            if (err != OS_ERR_NONE) while(1);
+        }
+
+        done = (pBuf->length == 0);
+
+        // skip whatever is still queued once the user asks for the next song
+        if (!done && !nextSong)
+        {
+            // the driver paces the sector out at the decoder's DREQ
+            INT32U length = pBuf->length;
+            Write(mp3StreamHandle, pBuf->pData, &length);
+            mp3StreamFed += pBuf->length;
+        }
+
+        BufRelease(pBuf);
+    }
+
+    OSSemPost(mp3StreamDoneSem);
+    OSTaskDel(OS_PRIO_SELF);
+}
+
+// Mp3ResumeTask
+// Updates the resume file each time the reader asks, below the priority of
+// the stream tasks and the UI, so the SD card write fits in time the reader
+// would spend waiting for a free buffer. Deletes itself once
+// Mp3StreamSDFileAt() sets mp3ResumeStop.
+static void Mp3ResumeTask(void* pdata)
+{
+    INT8U err;
+
+    while (1)
+    {
+        OSSemPend(mp3ResumeSem, 0, &err);
+        if (err != OS_ERR_NONE) while(1);
+        if (mp3ResumeStop) break;
+        Mp3ResumeSave();
+    }
+
+    OSSemPost(mp3StreamDoneSem);
+    OSTaskDel(OS_PRIO_SELF);
+}
+
+// Mp3IndexLoad
+// Reads the index of a file of fileSize bytes from its sidecar file into
+// mp3Index. Returns OS_FALSE if there is none or it is stale.
+static BOOLEAN Mp3IndexLoad(char *pSidecar, INT32U fileSize)
+{
+    File file = SD.open(pSidecar, O_READ);
+    int count;
+
+    if (!file) return OS_FALSE;
+    count = file.read(&mp3Index, sizeof(mp3Index));
+    file.close();
+    return (BOOLEAN)(count == sizeof(mp3Index) && Mp3IndexValid(&mp3Index, fileSize));
+}
+
+// Mp3IndexSave
+// Writes mp3Index to the sidecar file, one sector.
+static void Mp3IndexSave(char *pSidecar)
+{
+    File file = SD.open(pSidecar, FILE_WRITE);
+
+    if (!file) return;
+    file.seek(0);
+    file.write((const uint8_t*)&mp3Index, sizeof(mp3Index));
+    file.close();
+}
+
+// Mp3IndexSDFile
+// Builds mp3Index by reading dataFile from its start, in a stream buffer,
+// as far as the index needs: to the end, or only the first frame if it has
+// a table of contents. Each read starts where the builder wants the next
+// bytes. Returns OS_FALSE if no frames were found.
+static BOOLEAN Mp3IndexSDFile()
+{
+    INT8U err;
+    Buf *pBuf;
+    int count;
+
+    pBuf = BufGet(&mp3StreamPool, 0, &err);
+    if (err != OS_ERR_NONE) while(1);
+
+    Mp3IndexBegin(&mp3IndexBuilder, &mp3Index, dataFile.size());
+    while (dataFile.seek(Mp3IndexSkip(&mp3IndexBuilder)))
+    {
+        count = dataFile.read(pBuf->pData, MP3_STREAM_BUF_SIZE);
+        if (count <= 0 || Mp3IndexFeed(&mp3IndexBuilder, pBuf->pData, count)) break;
+    }
+
+    BufRelease(pBuf);
+    return Mp3IndexEnd(&mp3IndexBuilder);
+}
+
+// Mp3SkipFrames
+// Skips from the frame of dataFile at offset, numbered *pFrame, to the given
+// frame, or the last one, reading only the frame headers.
+// Returns the offset of the frame reached.
+static INT32U Mp3SkipFrames(INT32U offset, INT32U *pFrame, INT32U frame)
+{
+    INT8U header[4];
+    INT32U length;
+
+    while (*pFrame < frame)
+    {
+        if (!dataFile.seek(offset) || dataFile.read(header, 4) != 4) break;
+        length = Mp3IndexFrameLength(header);
+        if (length == 0 || offset + length >= mp3Index.audioEnd) break;
+        offset += length;
+        (*pFrame)++;
+    }
+    return offset;
+}
+
+// Mp3StreamSDFileAt
+// Streams the given file from the SD card to the given MP3 decoder, starting
+// at the frame that plays at the given time: the index gives the nearest
+// frame before it, the frame headers between are read to reach it.
+// The file is read a sector at a time by Mp3ReaderTask and fed to the decoder
+// by Mp3FeederTask so that SD latency overlaps with the decoder's DREQ waits.
+// The seek index is kept in a sidecar file, e.g. SONG.IDX for SONG.MP3. If
+// there is none it is built as the file plays from the start, or by a scan
+// of the file before a seek. While the file plays MP3_RESUME_FILE records how
+// far it got for Mp3ResumeSDFile(), written by Mp3ResumeTask; it is removed
+// when the song ends or is skipped.
+// Returns when the whole file has been played or nextSong was set.
 // hMP3: an open handle to the MP3 decoder
 // pFilename: The file on the SD card to stream. 
-void Mp3StreamSDFile(HANDLE hMp3, char *pFilename)
+// ms: time into the song to start at
+void Mp3StreamSDFileAt(HANDLE hMp3, char *pFilename, INT32U ms)
 {
     INT32U length;
+    INT32U offset = 0;
+    INT32U frame = 0;
+    INT8U err;
+    BOOLEAN keep = (strlen(pFilename) < MP3_PATH_MAX);
+    BOOLEAN indexed = OS_FALSE;
+    char sidecar[MP3_PATH_MAX + 4];
 
     Mp3StreamInit(hMp3);
     
@@ -60,32 +327,133 @@ void Mp3StreamSDFile(HANDLE hMp3, char *pFilename)
         return;
     }
 
-    INT8U mp3Buf[MP3_DECODER_BUF_SIZE];
-    INT32U iBufPos = 0;
+    Mp3StreamCreate();
+    mp3StreamHandle = hMp3;
+    mp3StreamUnderruns = 0;
     nextSong = OS_FALSE;
-    while (dataFile.available())
+
+    // one sector read finds the frame to start at, unless the index must be built
+    if (keep)
     {
-        iBufPos = 0;
-        while (dataFile.available() && iBufPos < MP3_DECODER_BUF_SIZE)
+        Mp3IndexSidecarName(pFilename, sidecar);
+        indexed = Mp3IndexLoad(sidecar, dataFile.size());
+        if (!indexed && ms != 0)
         {
-            mp3Buf[iBufPos] = dataFile.read();
-            //delay(30);
-            iBufPos++;
+            indexed = Mp3IndexSDFile();
+            if (indexed) Mp3IndexSave(sidecar);
         }
-       
-        Write(hMp3, mp3Buf, &iBufPos);
-        //OSTimeDly(1);
-        if (nextSong)
+    }
+    if (indexed && ms != 0)
+    {
+        offset = Mp3IndexSeek(&mp3Index, Mp3IndexMsFrame(&mp3Index, ms), &frame);
+        if (mp3Index.source == MP3_INDEX_SCANNED)
         {
-            break;
+            offset = Mp3SkipFrames(offset, &frame, Mp3IndexMsFrame(&mp3Index, ms));
         }
+        PrintWithBuf(printBuf, PRINTBUFMAX, "Mp3StreamSDFileAt: %u ms is frame %u at %u\n",
+            Mp3IndexFrameMs(&mp3Index, frame), frame, offset);
+    }
+    dataFile.seek(offset);
+    mp3StreamFed = offset;
+
+    // build the index on the way if it has to be built and playing from the start
+    mp3Indexing = (BOOLEAN)(keep && !indexed && offset == 0);
+    if (mp3Indexing)
+    {
+        Mp3IndexBegin(&mp3IndexBuilder, &mp3Index, dataFile.size());
     }
+    else if (!indexed)
+    {
+        mp3Index.entryCount = 0;
+    }
+
+    if (keep)
+    {
+        resumeFile = SD.open(MP3_RESUME_FILE, FILE_WRITE);
+        if (resumeFile)
+        {
+            mp3Resume.magic = MP3_RESUME_MAGIC;
+            strcpy(mp3Resume.name, pFilename);
+            Mp3ResumeSave();
+        }
+    }
+    mp3ResumeSaved = offset;
+    mp3ResumeStop = OS_FALSE;
+    while (OSSemAccept(mp3ResumeSem) > 0);  // a request the last stream ended before
+
+    // start the reader first so it can fill the buffers before the feeder runs
+    err = OSTaskCreate(Mp3ReaderTask, (void*)0, &Mp3ReaderTaskStk[APP_CFG_TASK_MP3_STK_SIZE-1], APP_TASK_MP3_READ_PRIO);
+    if (err != OS_ERR_NONE) while(1);
+    err = OSTaskCreate(Mp3FeederTask, (void*)0, &Mp3FeederTaskStk[APP_CFG_TASK_MP3_STK_SIZE-1], APP_TASK_MP3_FEED_PRIO);
+    if (err != OS_ERR_NONE) while(1);
+    err = OSTaskCreate(Mp3ResumeTask, (void*)0, &Mp3ResumeTaskStk[APP_CFG_TASK_MP3_STK_SIZE-1], APP_TASK_MP3_RESUME_PRIO);
+    if (err != OS_ERR_NONE) while(1);
+
+    // wait for both the reader and the feeder to finish
+    OSSemPend(mp3StreamDoneSem, 0, &err);
+    if (err != OS_ERR_NONE) while(1);
+    OSSemPend(mp3StreamDoneSem, 0, &err);
+    if (err != OS_ERR_NONE) while(1);
+
+    // then for the resume task, which drops an update still asked for
+    mp3ResumeStop = OS_TRUE;
+    OSSemPost(mp3ResumeSem);
+    OSSemPend(mp3StreamDoneSem, 0, &err);
+    if (err != OS_ERR_NONE) while(1);
     
     dataFile.close();
+
+    // the index is only complete if the whole file went by, or it had a TOC
+    if (mp3Indexing && Mp3IndexEnd(&mp3IndexBuilder))
+    {
+        Mp3IndexSave(sidecar);
+    }
+    mp3Indexing = OS_FALSE;
+
+    if (resumeFile)
+    {
+        resumeFile.close();
+        SD.remove(MP3_RESUME_FILE);
+    }
     
     Ioctl(hMp3, PJDF_CTRL_MP3_SELECT_COMMAND, 0, 0);
     length = BspMp3SoftResetLen;
     Write(hMp3, (void*)BspMp3SoftReset, &length);
+
+    PrintWithBuf(printBuf, PRINTBUFMAX, "Mp3StreamSDFile: decoder underruns=%u\n", mp3StreamUnderruns);
+}
+
+// Mp3StreamSDFile
+// Streams the given file from the SD card to the given MP3 decoder, from the start.
+// hMP3: an open handle to the MP3 decoder
+// pFilename: The file on the SD card to stream. 
+void Mp3StreamSDFile(HANDLE hMp3, char *pFilename)
+{
+    Mp3StreamSDFileAt(hMp3, pFilename, 0);
+}
+
+// Mp3ResumeSDFile
+// Plays the song that was playing when power was lost, or when the board
+// was reset, from about where it had got to.
+// Returns OS_FALSE if no song was playing.
+// hMP3: an open handle to the MP3 decoder
+BOOLEAN Mp3ResumeSDFile(HANDLE hMp3)
+{
+    Mp3Resume resume;
+    File file = SD.open(MP3_RESUME_FILE, O_READ);
+    int count;
+
+    if (!file) return OS_FALSE;
+    count = file.read(&resume, sizeof(resume));
+    file.close();
+    if (count != sizeof(resume) || resume.magic != MP3_RESUME_MAGIC
+        || memchr(resume.name, 0, MP3_PATH_MAX) == NULL)
+    {
+        return OS_FALSE;
+    }
+
+    Mp3StreamSDFileAt(hMp3, resume.name, resume.ms);
+    return OS_TRUE;
 }
 
 // Mp3Stream
@@ -103,12 +471,15 @@ void Mp3Stream(HANDLE hMp3, INT8U *pBuf, INT32U bufLen)
         
     Mp3StreamInit(hMp3);
     
-    chunkLen = MP3_DECODER_BUF_SIZE;
+    // Whole stream buffers, as the feeder task sends: the driver tops up
+    // the decoder FIFO under one SPI lock, so a reserved handle's turn
+    // between LCD fill slices moves more than MP3_DECODER_BUF_SIZE bytes
+    chunkLen = MP3_STREAM_BUF_SIZE;
 
     while (!done)
     {
         // detect last chunk of pBuf
-        if (bufLen - iBufPos < MP3_DECODER_BUF_SIZE)
+        if (bufLen - iBufPos < MP3_STREAM_BUF_SIZE)
         {
             chunkLen = bufLen - iBufPos;
             done = OS_TRUE;
@@ -126,25 +497,58 @@ void Mp3Stream(HANDLE hMp3, INT8U *pBuf, INT32U bufLen)
 }
 
 
+// Mp3StreamAt
+// Streams the given buffer of MP3 data to the given MP3 decoder, starting
+// at the frame that plays at the given time. The buffer is indexed first,
+// which only parses its frame headers.
+// hMp3: an open handle to the MP3 decoder
+// pBuf: MP3 data to stream to the decoder
+// bufLen: number of bytes of MP3 data to stream
+// ms: time into the data to start at
+void Mp3StreamAt(HANDLE hMp3, INT8U *pBuf, INT32U bufLen, INT32U ms)
+{
+    INT32U offset = 0;
+    INT32U frame;
+    INT32U target;
+    INT32U length;
+
+    if (ms != 0)
+    {
+        Mp3IndexBegin(&mp3IndexBuilder, &mp3Index, bufLen);
+        Mp3IndexFeed(&mp3IndexBuilder, pBuf, bufLen);
+        if (Mp3IndexEnd(&mp3IndexBuilder))
+        {
+            target = Mp3IndexMsFrame(&mp3Index, ms);
+            offset = Mp3IndexSeek(&mp3Index, target, &frame);
+            while (frame < target && mp3Index.source == MP3_INDEX_SCANNED)
+            {
+                length = Mp3IndexFrameLength(&pBuf[offset]);
+                if (length == 0 || offset + length >= mp3Index.audioEnd) break;
+                offset += length;
+                frame++;
+            }
+        }
+    }
+    Mp3Stream(hMp3, pBuf + offset, bufLen - offset);
+}
+
+
 // Mp3Init
 // Send commands to the MP3 device to initialize it.
 void Mp3Init(HANDLE hMp3)
 {
-    INT32U length;
+    PjdfSegment seg[3] = {
+        { (void*)BspMp3SetClockF, BspMp3SetClockFLen, PJDF_SEG_COMMAND },
+        { (void*)BspMp3SetVol1010, BspMp3SetVol1010Len, PJDF_SEG_COMMAND },
+        { (void*)BspMp3SoftReset, BspMp3SoftResetLen, PJDF_SEG_COMMAND },
+    };
     
     if (!PJDF_IS_VALID_HANDLE(hMp3)) while (1);
     
     // Place MP3 driver in command mode (subsequent writes will be sent to the decoder's command interface)
     Ioctl(hMp3, PJDF_CTRL_MP3_SELECT_COMMAND, 0, 0);
     
-    length = BspMp3SetClockFLen;
-    Write(hMp3, (void*)BspMp3SetClockF, &length);
-
-    length = BspMp3SetVol1010Len;
-    Write(hMp3, (void*)BspMp3SetVol1010, &length);
-
-    length = BspMp3SoftResetLen;
-    Write(hMp3, (void*)BspMp3SoftReset, &length);
+    WriteV(hMp3, seg, 3);
 }
 
 // Mp3GetRegister
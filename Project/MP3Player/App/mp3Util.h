@@ -15,7 +15,10 @@ PjdfErrCode Mp3GetRegister(HANDLE hMp3, INT8U *cmdInDataOut, INT32U bufLen);
 void Mp3Init(HANDLE hMp3);
 void Mp3Test(HANDLE hMp3);
 void Mp3Stream(HANDLE hMp3, INT8U *pBuf, INT32U bufLen);
+void Mp3StreamAt(HANDLE hMp3, INT8U *pBuf, INT32U bufLen, INT32U ms);
 void Mp3StreamSDFile(HANDLE hMp3, char *pFilename);
+void Mp3StreamSDFileAt(HANDLE hMp3, char *pFilename, INT32U ms);
+BOOLEAN Mp3ResumeSDFile(HANDLE hMp3);
 
 
 #endif
\ No newline at end of file
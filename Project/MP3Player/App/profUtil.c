@@ -0,0 +1,225 @@
+/*
+    profUtil.c
+    Per-task CPU time and context switch profiler.
+
+    Every context switch is timestamped with the port's free running cycle
+    counter (OS_CPU_CYCLES_GET(): DWT CYCCNT on the Cortex-M4, the monotonic
+    clock on the POSIX host port) from the task switch hook, so the time a
+    task ran is charged to it exactly rather than sampled on the tick. ISRs
+    bracket themselves with APP_ISR_ENTER()/APP_ISR_EXIT() and their time is
+    kept apart instead of being charged to the task they interrupted.
+
+    The table has one fixed entry per priority and is rolled over once a
+    second from the tick hook. The hooks run with interrupts
+    disabled and cost a few dozen cycles per switch or ISR, so the profiler
+    can stay enabled in production builds (APP_CFG_PROF_EN in app_cfg.h).
+
+    2026/10 written for the MP3Player project
+*/
+
+#include "bsp.h"
+#include "print.h"
+#include "profUtil.h"
+
+ProfTask profTasks[PROF_TASK_COUNT];   // indexed by task priority
+ProfIsr profIsr;
+
+static INT32U profCyclesPerSec;        // counter rate, 0 until ProfInit()
+static INT32U profWindowStart;         // start of the current window
+static INT32U profWindowLast;          // length of the last complete window, 0 before the first
+static INT32U profRunStart;            // when OSTCBCur was switched in
+static INT32U profRunIsrCycles;        // ISR time since then, not charged to OSTCBCur
+static INT32U profIsrStart;            // entry time of the outermost ISR
+static INT8U profIsrNesting;
+
+
+// Start the cycle counter and the first window.
+// Call once from the startup task after the timer tick is started.
+void ProfInit(void)
+{
+#if APP_CFG_PROF_EN > 0u
+    OS_CPU_SR cpu_sr;
+    INT32U rate;
+
+    rate = OS_CPU_CyclesInit();
+
+    OS_ENTER_CRITICAL();
+    profWindowStart = OS_CPU_CYCLES_GET();
+    profRunStart = profWindowStart;
+    profRunIsrCycles = 0;
+    profCyclesPerSec = rate;
+    OS_EXIT_CRITICAL();
+#endif
+}
+
+
+// Charge the running task for the time since it was switched in.
+// Interrupts must be disabled.
+static void ProfChargeCur(INT32U now)
+{
+    INT32U run;
+
+    run = now - profRunStart - profRunIsrCycles;
+    profTasks[OSTCBCur->OSTCBPrio].cycles += run;
+#if OS_TASK_PROFILE_EN > 0u
+    OSTCBCur->OSTCBCyclesTot += run;
+#endif
+    profRunStart = now;
+    profRunIsrCycles = 0;
+}
+
+
+// Called from the task switch hook with interrupts disabled: OSTCBCur is
+// switched out and OSTCBHighRdy switched in.
+// A task switched out while its ready bit is still set was preempted; the time
+// until it runs again is its preemption latency.
+void ProfTaskSwitch(void)
+{
+    INT32U now;
+    INT32U latency;
+    ProfTask *pIn;
+
+    if (profCyclesPerSec == 0) return;
+
+    now = OS_CPU_CYCLES_GET();
+    ProfChargeCur(now);
+
+    if (OSRdyTbl[OSTCBCur->OSTCBY] & OSTCBCur->OSTCBBitX)
+    {
+        profTasks[OSTCBCur->OSTCBPrio].preemptedAt = now;
+        profTasks[OSTCBCur->OSTCBPrio].preempted = OS_TRUE;
+    }
+
+    pIn = &profTasks[OSTCBHighRdy->OSTCBPrio];
+    pIn->switches++;
+    if (pIn->preempted)
+    {
+        latency = now - pIn->preemptedAt;
+        if (latency > pIn->maxLatency) pIn->maxLatency = latency;
+        pIn->preempted = OS_FALSE;
+    }
+#if OS_TASK_PROFILE_EN > 0u
+    OSTCBHighRdy->OSTCBCyclesStart = now;
+#endif
+}
+
+
+// Called on ISR entry: only the outermost of nested ISRs is timed.
+void ProfIsrEnter(void)
+{
+    OS_CPU_SR cpu_sr;
+
+    OS_ENTER_CRITICAL();
+    if (profIsrNesting++ == 0) profIsrStart = OS_CPU_CYCLES_GET();
+    OS_EXIT_CRITICAL();
+}
+
+
+// Called on ISR exit
+void ProfIsrExit(void)
+{
+    OS_CPU_SR cpu_sr;
+    INT32U cycles;
+
+    OS_ENTER_CRITICAL();
+    if (--profIsrNesting == 0 && profCyclesPerSec != 0)
+    {
+        cycles = OS_CPU_CYCLES_GET() - profIsrStart;
+        profIsr.cycles += cycles;
+        profIsr.count++;
+        if (cycles > profIsr.max) profIsr.max = cycles;
+        profRunIsrCycles += cycles;
+    }
+    OS_EXIT_CRITICAL();
+}
+
+
+// Called from the tick hook. Closes the window once it is at least a second
+// long: the running task is charged up to now and every entry's window time
+// moves to cyclesLast.
+void ProfTick(void)
+{
+    OS_CPU_SR cpu_sr;
+    INT32U now;
+    INT8U prio;
+
+    if (profCyclesPerSec == 0) return;
+
+    OS_ENTER_CRITICAL();
+    now = OS_CPU_CYCLES_GET();
+    if (now - profWindowStart >= profCyclesPerSec)
+    {
+        ProfChargeCur(now);
+        for (prio = 0; prio < PROF_TASK_COUNT; prio++)
+        {
+            profTasks[prio].cyclesLast = profTasks[prio].cycles;
+            profTasks[prio].cycles = 0;
+        }
+        profIsr.cyclesLast = profIsr.cycles;
+        profIsr.cycles = 0;
+        profWindowLast = now - profWindowStart;
+        profWindowStart = now;
+    }
+    OS_EXIT_CRITICAL();
+}
+
+
+// Cycles to microseconds, for counters slower than 1 MHz too
+static INT32U ProfCyclesToUs(INT32U cycles)
+{
+    return (INT32U)((unsigned long long)cycles * 1000000u / profCyclesPerSec);
+}
+
+
+// Print the last complete window: CPU share, switch count and worst
+// preemption latency of every task, then the same for ISRs.
+void ProfDump(void)
+{
+    char buf[PRINTBUFMAX];
+    OS_CPU_SR cpu_sr;
+    ProfTask task;
+    ProfIsr isr;
+    OS_TCB *ptcb;
+    const char *name;
+    INT32U perMilleDiv;
+    INT32U perMille;
+    INT8U prio;
+
+    OS_ENTER_CRITICAL();
+    perMilleDiv = profWindowLast / 1000u;
+    OS_EXIT_CRITICAL();
+
+    if (perMilleDiv == 0)
+    {
+        PrintString("Profiler: no complete window yet\n");
+        return;
+    }
+    PrintString("prio   cpu%  switches  maxlat(us)  name\n");
+    for (prio = 0; prio < PROF_TASK_COUNT; prio++)
+    {
+        OS_ENTER_CRITICAL();
+        task = profTasks[prio];
+        ptcb = OSTCBPrioTbl[prio];
+        name = "";
+#if OS_TASK_NAME_EN > 0u
+        if (ptcb != (OS_TCB *)0 && ptcb != OS_TCB_RESERVED) name = (const char *)ptcb->OSTCBTaskName;
+#endif
+        if (ptcb == OS_TCB_RESERVED) name = "(mutex ceiling)"; // time of tasks raised to it
+        OS_EXIT_CRITICAL();
+
+        if (task.switches == 0 && (ptcb == (OS_TCB *)0 || ptcb == OS_TCB_RESERVED)) continue;
+
+        perMille = task.cyclesLast / perMilleDiv;
+        PrintWithBuf(buf, PRINTBUFMAX, "%4u  %3u.%u  %8u  %10u  %s\n",
+            prio, perMille / 10u, perMille % 10u, task.switches,
+            ProfCyclesToUs(task.maxLatency), name);
+    }
+
+    OS_ENTER_CRITICAL();
+    isr = profIsr;
+    OS_EXIT_CRITICAL();
+
+    perMille = isr.cyclesLast / perMilleDiv;
+    PrintWithBuf(buf, PRINTBUFMAX, " isr  %3u.%u  %8u  %10u  (count, longest)\n",
+        perMille / 10u, perMille % 10u, isr.count, ProfCyclesToUs(isr.max));
+}
@@ -0,0 +1,44 @@
+/*
+    profUtil.h
+    Per-task CPU time and context switch profiler.
+
+    2026/10 written for the MP3Player project
+*/
+
+#ifndef __PROFUTIL_H
+#define __PROFUTIL_H
+
+#define PROF_TASK_COUNT  (OS_LOWEST_PRIO + 1u)  // one entry per task priority
+
+// Profile of the task at one priority. Times are in OS_CPU_CYCLES_GET() counts.
+typedef struct
+{
+    INT32U cycles;       // run time in the current window, ISR time excluded
+    INT32U cyclesLast;   // run time in the last complete window
+    INT32U switches;     // times the task was switched in
+    INT32U maxLatency;   // longest wait from being preempted to running again
+    INT32U preemptedAt;  // when the task was last switched out while still ready
+    BOOLEAN preempted;   // preemptedAt is valid
+} ProfTask;
+
+// Time spent in ISRs that call APP_ISR_ENTER()/APP_ISR_EXIT()
+typedef struct
+{
+    INT32U cycles;       // ISR time in the current window
+    INT32U cyclesLast;   // ISR time in the last complete window
+    INT32U count;        // outermost ISR entries
+    INT32U max;          // longest outermost ISR, nested ISRs included
+} ProfIsr;
+
+void ProfInit(void);
+void ProfTaskSwitch(void);
+void ProfIsrEnter(void);
+void ProfIsrExit(void);
+void ProfTick(void);
+void ProfDump(void);
+
+extern ProfTask profTasks[PROF_TASK_COUNT];
+extern ProfIsr profIsr;
+
+
+#endif
@@ -13,12 +13,21 @@
 
 #include "bsp.h"
 #include "print.h"
+#include "profUtil.h"
+#include "traceUtil.h"
+#include "libraryUtil.h"
+#include "tasks.h"
 
 #define BUFSIZE 256
 #define ARRAYCOUNT(array) (sizeof(array)/sizeof(*array))
 
+static int PJShellReadLine(char *line, int size);
 static void PJShellcd(char *dir);
-static void PJShellls(void);
+static void PJShellls(char *dir);
+static void PJShelllocks(void);
+static void PJShellplay(char *args);
+static void PJShellprof(void);
+static void PJShelltrace(void);
 
 
 // Define command strings here
@@ -26,6 +35,10 @@ static const char *CmdList[] =
 {
 	"cd",
 	"ls",
+	"locks",
+	"play",
+	"prof",
+	"trace",
 };
 
 static int cmdLen[ARRAYCOUNT(CmdList)];
@@ -34,6 +47,10 @@ typedef enum
 {
 	CommandEnumcd,
 	CommandEnumls,
+	CommandEnumlocks,
+	CommandEnumplay,
+	CommandEnumprof,
+	CommandEnumtrace,
 	CommandEnumInvalid
 }CommandEnum_t;
 
@@ -62,6 +79,72 @@ static void PJShellInit(void)
 }
 
 
+/*
+ NAME:
+   PJShellReadLine
+ PURPOSE:
+   Read one line from the console, echoing it. Backspace and delete erase
+   the last character; other control characters are ignored.
+ PARAMETERS:
+   line: receives the null terminated line, without the line ending
+   size: size of line in bytes
+ RETURN:
+   the length of the line
+ EXAMPLE:
+   PJShellReadLine(cmdLine, ARRAYCOUNT(cmdLine))
+ OTHER:
+   Runs in the shell task: the UART interrupt only queues the received
+   bytes and ReadByte() pends until there is one.
+ */
+static int PJShellReadLine(char *line, int size)
+{
+	static char lastCh; // last character read, by the previous call too
+	int iLine = 0;
+	char ch;
+
+	while (1)
+	{
+		ch = ReadByte();
+		if ((ch == '\n') && (lastCh == '\r'))
+		{
+			lastCh = 0; // second half of a "\r\n" line ending
+			continue;
+		}
+		lastCh = ch;
+
+		// Done when 'Enter' is pressed
+		if ((ch == '\r') || (ch == '\n'))
+		{
+			PrintString("\r\n");
+			break;
+		}
+
+		if ((ch == '\b') || (ch == 0x7F))
+		{
+			if (iLine > 0)
+			{
+				iLine -= 1;
+				PrintString("\b \b");
+			}
+			continue;
+		}
+
+		// Ignore control characters, and input beyond the end of the buffer
+		if ((ch < ' ') || (iLine >= size - 1))
+		{
+			continue;
+		}
+
+		PrintByte(ch);
+		line[iLine] = ch;
+		iLine += 1;
+	}
+
+	line[iLine] = 0; // ensure that the line is null terminated
+	return iLine;
+}
+
+
 /*
  NAME:
    PJShellEntry
@@ -84,27 +167,12 @@ void PJShellEntry(void *pArg)
     {
     	PrintString("Shell>");
     	char cmdLine[81];
-    	int iCmdLine = 0;
-    	char ch = 0;
 
-    	while (iCmdLine < ARRAYCOUNT(cmdLine) - 1)
+    	if (PJShellReadLine(cmdLine, ARRAYCOUNT(cmdLine)) == 0)
     	{
-			ch = ReadByte();
-			PrintByte(ch);
-
-			// Break when 'Enter' is pressed
-			if ((ch == '\r') || (ch == '\n'))
-			{
-				PrintString("\r\n");
-				break;
-			}
-
-			cmdLine[iCmdLine] = ch;
-			iCmdLine += 1;
+    		continue; // empty line, prompt again
     	}
 
-    	cmdLine[iCmdLine] = 0; // ensure that command line is null terminated
-
     	CommandEnum_t cmdEnum;
     	for (cmdEnum = CommandEnumcd; cmdEnum < CommandEnumInvalid; cmdEnum  = (CommandEnum_t) ((int)cmdEnum + 1))
     	{
@@ -120,7 +188,20 @@ void PJShellEntry(void *pArg)
 			PJShellcd(&cmdLine[cmdLen[CommandEnumcd]] + 1);
 			break;
 		case CommandEnumls:
-			PJShellls();
+			// an optional directory, the root by default
+			PJShellls((cmdLine[cmdLen[CommandEnumls]] == ' ') ? &cmdLine[cmdLen[CommandEnumls]] + 1 : (char*)"/");
+			break;
+		case CommandEnumlocks:
+			PJShelllocks();
+			break;
+		case CommandEnumplay:
+			PJShellplay((cmdLine[cmdLen[CommandEnumplay]] == ' ') ? &cmdLine[cmdLen[CommandEnumplay]] + 1 : (char*)"");
+			break;
+		case CommandEnumprof:
+			PJShellprof();
+			break;
+		case CommandEnumtrace:
+			PJShelltrace();
 			break;
 		default:
 			PrintString("  invalid command\r\n");
@@ -137,9 +218,66 @@ static void PJShellcd(char *dir)
 }
 
 
-static void PJShellls()
+// List the songs of a directory from its catalog, rebuilt if the directory changed
+static void PJShellls(char *dir)
+{
+    char buf[PRINTBUFMAX];
+    char name[13];
+    const LibraryEntry *pEntry;
+    INT32U i;
+
+    if (!LibraryOpen(dir))
+    {
+        PrintString("  can't read the directory or its catalog\r\n");
+        return;
+    }
+
+    for (i = 0; (pEntry = LibraryGet(i)) != NULL; i++)
+    {
+        LibraryName(pEntry, name);
+        PrintWithBuf(buf, PRINTBUFMAX, "%4u %12s %3u:%02u  %s - %s\r\n", i + 1, name,
+            pEntry->seconds / 60, pEntry->seconds % 60, pEntry->artist, pEntry->title);
+    }
+    PrintWithBuf(buf, PRINTBUFMAX, "  %u songs\r\n", LibraryCount());
+}
+
+
+// Print how often each device lock was taken, how often it blocked a task
+// and for how long at most
+static void PJShelllocks()
+{
+    PjdfLockDump();
+}
+
+
+// Play a song from the SD card, from the start or a number of seconds in:
+// "play SONG.MP3" or "play SONG.MP3 90"
+static void PJShellplay(char *args)
+{
+    char *pSeconds = strchr(args, ' ');
+    INT32U seconds = 0;
+
+    if (pSeconds != NULL)
+    {
+        *pSeconds++ = 0;
+        while (*pSeconds >= '0' && *pSeconds <= '9') seconds = seconds * 10 + (*pSeconds++ - '0');
+    }
+    if (!Mp3DemoPlay(args, seconds * 1000))
+    {
+        PrintString("  usage: play SONG.MP3 [seconds], with an SD card\r\n");
+    }
+}
+
+
+// Print per-task CPU share, switch counts and worst preemption latency
+static void PJShellprof()
 {
-    PrintString("Hello from ls command\n");
+    ProfDump();
 }
 
 
+// Dump the event trace for Tools/traceDecode.py
+static void PJShelltrace()
+{
+    TraceDump();
+}
@@ -18,7 +18,12 @@ Module Description:
 #include "bsp.h"
 #include "print.h"
 #include "mp3Util.h"
+#include "touchUtil.h"
+#include "profUtil.h"
+#include "traceUtil.h"
+#include "tasks.h"
 
+#include "SD.h"
 #include <Adafruit_GFX.h>    // Core graphics library
 #include <Adafruit_ILI9341.h>
 #include <Adafruit_FT6206.h>
@@ -29,6 +34,11 @@ Adafruit_FT6206 touchCtrl = Adafruit_FT6206(); // The touch controller
 
 #define PENRADIUS 3
 
+// Status line at the bottom of the LCD showing the last touch position
+#define TOUCH_TEXT_X     4
+#define TOUCH_TEXT_Y     (ILI9341_TFTHEIGHT - 12)
+#define TOUCH_TEXT_SIZE  16
+
 long MapTouchToScreen(long x, long in_min, long in_max, long out_min, long out_max)
 {
     return (x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
@@ -48,11 +58,13 @@ The maximum number of tasks the application can have is defined by OS_MAX_TASKS
 
 static OS_STK   LcdTouchDemoTaskStk[APP_CFG_TASK_START_STK_SIZE];
 static OS_STK   Mp3DemoTaskStk[APP_CFG_TASK_START_STK_SIZE];
+static OS_STK   ShellTaskStk[APP_CFG_TASK_SHELL_STK_SIZE];
 
 
 // Task prototypes
 void LcdTouchDemoTask(void* pdata);
 void Mp3DemoTask(void* pdata);
+void PJShellEntry(void *pArg);
 
 
 
@@ -62,6 +74,13 @@ void PrintToLcdWithBuf(char *buf, int size, char *format, ...);
 // Globals
 BOOLEAN nextSong = OS_FALSE;
 
+// A song from the SD card for Mp3DemoTask, see Mp3DemoPlay()
+#define PLAY_NAME_MAX 32
+static char playName[PLAY_NAME_MAX];   // empty when there is none
+static INT32U playMs;                  // time into the song to start at
+static OS_EVENT *playSem;              // posted when playName is set
+static BOOLEAN sdReady;                // the FAT volume is mounted
+
 /************************************************************************************
 
 This task is the initial task running, started by main(). It starts
@@ -83,6 +102,10 @@ void StartupTask(void* pdata)
     // Start the system tick
     OS_CPU_SysTickInit(OS_TICKS_PER_SEC);
 
+    // Start timing tasks and ISRs
+    ProfInit();
+    TraceInit();
+
     // Initialize SD card
     PrintWithBuf(buf, PRINTBUFMAX, "Opening handle to SD driver: %s\n", PJDF_DEVICE_ID_SD_ADAFRUIT);
     hSD = Open(PJDF_DEVICE_ID_SD_ADAFRUIT, 0);
@@ -100,12 +123,29 @@ void StartupTask(void* pdata)
     pjdfErr = Ioctl(hSD, PJDF_CTRL_SD_SET_SPI_HANDLE, &hSPI, &length);
     if(PJDF_IS_ERROR(pjdfErr)) while(1);
 
+    // The MP3 stream is read from the SD card, so LCD fills give way to the
+    // SD card as they do to the decoder.
+    BOOLEAN reserved = OS_TRUE;
+    length = sizeof(reserved);
+    pjdfErr = Ioctl(hSPI, PJDF_CTRL_SPI_SET_RESERVED, &reserved, &length);
+    if(PJDF_IS_ERROR(pjdfErr)) while(1);
+
+    // Mount the FAT volume for the songs, their indexes and the resume record
+    sdReady = (BOOLEAN)SD.begin(hSD);
+    if (!sdReady)
+    {
+        PrintWithBuf(buf, BUFSIZE, "StartupTask: no SD card, playing from flash only\n");
+    }
+    playSem = OSSemCreate(0);
+    if (playSem == NULL) while(1);
+
     // Create the test tasks
     PrintWithBuf(buf, BUFSIZE, "StartupTask: Creating the application tasks\n");
 
     // The maximum number of tasks the application can have is defined by OS_MAX_TASKS in os_cfg.h
     OSTaskCreate(Mp3DemoTask, (void*)0, &Mp3DemoTaskStk[APP_CFG_TASK_START_STK_SIZE-1], APP_TASK_TEST1_PRIO);
     OSTaskCreate(LcdTouchDemoTask, (void*)0, &LcdTouchDemoTaskStk[APP_CFG_TASK_START_STK_SIZE-1], APP_TASK_TEST2_PRIO);
+    OSTaskCreate(PJShellEntry, (void*)0, &ShellTaskStk[APP_CFG_TASK_SHELL_STK_SIZE-1], APP_TASK_SHELL_PRIO);
 
     // Delete ourselves, letting the work be done in the new tasks.
     PrintWithBuf(buf, BUFSIZE, "StartupTask: deleting self\n");
@@ -141,7 +181,10 @@ void LcdTouchDemoTask(void* pdata)
 	PrintWithBuf(buf, BUFSIZE, "Opening LCD driver: %s\n", PJDF_DEVICE_ID_LCD_ILI9341);
     // Open handle to the LCD driver
     HANDLE hLcd = Open(PJDF_DEVICE_ID_LCD_ILI9341, 0);
-    if (!PJDF_IS_VALID_HANDLE(hLcd)) while(1);
+    if (!PJDF_IS_VALID_HANDLE(hLcd))
+    {
+        while(1);
+    }
 
 	PrintWithBuf(buf, BUFSIZE, "Opening LCD SPI driver: %s\n", LCD_SPI_DEVICE_ID);
     // We talk to the LCD controller over a SPI interface therefore
@@ -152,7 +195,10 @@ void LcdTouchDemoTask(void* pdata)
 
     length = sizeof(HANDLE);
     pjdfErr = Ioctl(hLcd, PJDF_CTRL_LCD_SET_SPI_HANDLE, &hSPI, &length);
-    if(PJDF_IS_ERROR(pjdfErr)) while(1);
+    if(PJDF_IS_ERROR(pjdfErr))
+    {
+        while(1);
+    }
 
 	PrintWithBuf(buf, BUFSIZE, "Initializing LCD controller\n");
     lcdCtrl.setPjdfHandle(hLcd);
@@ -169,26 +215,22 @@ void LcdTouchDemoTask(void* pdata)
         while (1);
     }
 
+    // Touches now arrive as events posted by the touch task on the INT interrupt
+    TouchEventsStart(&touchCtrl);
+
     int currentcolor = ILI9341_RED;
+    char touchText[TOUCH_TEXT_SIZE];
+    char touchShown[TOUCH_TEXT_SIZE] = "";
 
     while (1) {
-        boolean touched = false;
+        TouchEvent event;
 
-        // TODO: Poll for a touch on the touch panel
-        if(touchCtrl.touched()) {
-            touched = true;
-        }
-        // <hint: Call a function provided by touchCtrl
-
-        if (! touched) {
-            OSTimeDly(5);
+        TouchEventPend(&event, 0);
+        if (event.type == TOUCH_EVENT_UP) {
             continue;
         }
 
-        TS_Point rawPoint;
-
-        // TODO: Retrieve a point
-        rawPoint = touchCtrl.getPoint();
+        TS_Point rawPoint = TS_Point(event.x, event.y, 1);
 
         if (rawPoint.x == 0 && rawPoint.y == 0)
         {
@@ -196,11 +238,21 @@ void LcdTouchDemoTask(void* pdata)
         }
 
         // transform touch orientation to screen orientation.
-        TS_Point p = TS_Point();
-        p.x = MapTouchToScreen(rawPoint.x, 0, ILI9341_TFTWIDTH, ILI9341_TFTWIDTH, 0);
-        p.y = MapTouchToScreen(rawPoint.y, 0, ILI9341_TFTHEIGHT, ILI9341_TFTHEIGHT, 0);
+        // kept on the panel, which the controller can report a little past
+        int x = (int)MapTouchToScreen(rawPoint.x, 0, ILI9341_TFTWIDTH, ILI9341_TFTWIDTH, 0);
+        int y = (int)MapTouchToScreen(rawPoint.y, 0, ILI9341_TFTHEIGHT, ILI9341_TFTHEIGHT, 0);
+        if (x < 0) x = 0;
+        if (x >= ILI9341_TFTWIDTH) x = ILI9341_TFTWIDTH - 1;
+        if (y < 0) y = 0;
+        if (y >= ILI9341_TFTHEIGHT) y = ILI9341_TFTHEIGHT - 1;
+        TS_Point p = TS_Point(x, y, 1);
 
         lcdCtrl.fillCircle(p.x, p.y, PENRADIUS, currentcolor);
+
+        // Only the digits that changed since the last touch are redrawn
+        snprintf(touchText, sizeof(touchText), "x=%3d y=%3d", x, y);
+        lcdCtrl.updateText(TOUCH_TEXT_X, TOUCH_TEXT_Y, touchText, touchShown,
+            sizeof(touchShown), ILI9341_WHITE, ILI9341_BLACK, 1);
     }
 }
 /************************************************************************************
@@ -221,7 +273,10 @@ void Mp3DemoTask(void* pdata)
 	PrintWithBuf(buf, BUFSIZE, "Opening MP3 driver: %s\n", PJDF_DEVICE_ID_MP3_VS1053);
     // Open handle to the MP3 decoder driver
     HANDLE hMp3 = Open(PJDF_DEVICE_ID_MP3_VS1053, 0);
-    if (!PJDF_IS_VALID_HANDLE(hMp3)) while(1);
+    if (!PJDF_IS_VALID_HANDLE(hMp3))
+    {
+        while(1);
+    }
 
 	PrintWithBuf(buf, BUFSIZE, "Opening MP3 SPI driver: %s\n", MP3_SPI_DEVICE_ID);
     // We talk to the MP3 decoder over a SPI interface therefore
@@ -234,21 +289,74 @@ void Mp3DemoTask(void* pdata)
     pjdfErr = Ioctl(hMp3, PJDF_CTRL_MP3_SET_SPI_HANDLE, &hSPI, &length);
     if(PJDF_IS_ERROR(pjdfErr)) while(1);
 
+    // Sleep on the DREQ interrupt instead of polling while the decoder is busy
+    pjdfErr = Ioctl(hMp3, PJDF_CTRL_MP3_DREQ_INTERRUPT, 0, 0);
+    if(PJDF_IS_ERROR(pjdfErr))
+    {
+        while(1);
+    }
+
     // Send initialization data to the MP3 decoder and run a test
 	PrintWithBuf(buf, BUFSIZE, "Starting MP3 device test\n");
     Mp3Init(hMp3);
     int count = 0;
 
+    // Finish the song a power cut or reset interrupted
+    if (sdReady && Mp3ResumeSDFile(hMp3))
+    {
+        PrintWithBuf(buf, BUFSIZE, "Mp3DemoTask: resumed the last song\n");
+    }
+
+    OS_CPU_SR cpu_sr;
+    INT8U err;
+    char name[PLAY_NAME_MAX];
+    INT32U ms;
+
     while (1)
     {
-        OSTimeDly(500);
-        PrintWithBuf(buf, BUFSIZE, "Begin streaming sound file  count=%d\n", ++count);
-        Mp3Stream(hMp3, (INT8U*)Train_Crossing, sizeof(Train_Crossing));
-        PrintWithBuf(buf, BUFSIZE, "Done streaming sound file  count=%d\n", count);
+        // a song the shell's play command asked for, else the one in flash
+        OSSemPend(playSem, 500, &err);
+        OS_ENTER_CRITICAL();
+        strcpy(name, playName);
+        ms = playMs;
+        playName[0] = 0;
+        OS_EXIT_CRITICAL();
+
+        if (name[0] != 0)
+        {
+            PrintWithBuf(buf, BUFSIZE, "Mp3DemoTask: playing %s from %u ms\n", name, ms);
+            if (ms == 0) Mp3StreamSDFile(hMp3, name);
+            else Mp3StreamSDFileAt(hMp3, name, ms);
+        }
+        else if (err == OS_ERR_TIMEOUT)
+        {
+            PrintWithBuf(buf, BUFSIZE, "Begin streaming sound file  count=%d\n", ++count);
+            Mp3Stream(hMp3, (INT8U*)Train_Crossing, sizeof(Train_Crossing));
+            PrintWithBuf(buf, BUFSIZE, "Done streaming sound file  count=%d\n", count);
+        }
     }
 }
 
 
+// Asks Mp3DemoTask to play a song from the SD card, ms into it, in place of
+// a song from the SD card it is playing. The shell's play command calls this.
+// Returns OS_FALSE if there is no SD card or the name is too long.
+BOOLEAN Mp3DemoPlay(const char *pName, INT32U ms)
+{
+    OS_CPU_SR cpu_sr;
+
+    if (!sdReady || pName[0] == 0 || strlen(pName) >= PLAY_NAME_MAX) return OS_FALSE;
+
+    OS_ENTER_CRITICAL();
+    strcpy(playName, pName);
+    playMs = ms;
+    OS_EXIT_CRITICAL();
+    nextSong = OS_TRUE;
+    OSSemPost(playSem);
+    return OS_TRUE;
+}
+
+
 // Renders a character at the current cursor position on the LCD
 static void PrintCharToLcd(char c)
 {
@@ -0,0 +1,14 @@
+/*
+    tasks.h
+    What the tasks of the test application (tasks.c) offer the rest of it.
+
+    2026/10 written for the MP3Player project
+*/
+
+#ifndef __TASKS_H
+#define __TASKS_H
+
+BOOLEAN Mp3DemoPlay(const char *pName, INT32U ms);
+
+
+#endif
@@ -0,0 +1,125 @@
+/*
+    touchUtil.c
+    Interrupt driven touch events from the FT6206 touch controller.
+
+    The FT6206 holds its INT line low while the panel is touched. The falling
+    edge wakes the touch task, which reads the controller once per
+    TOUCH_REPORT_TICKS until INT goes high again and puts a TouchEvent for
+    each report in a ring (Util/ring.c) the UI task pends on. While nothing
+    touches the panel there is no I2C traffic at all.
+
+    2026/10 written for the MP3Player project
+*/
+
+#include "bsp.h"
+#include "touchUtil.h"
+#include "ring.h"
+
+#include <Adafruit_FT6206.h>
+
+static OS_STK TouchTaskStk[APP_CFG_TASK_TOUCH_STK_SIZE];
+
+#define TOUCH_EVENT_RING_SIZE 128          // bytes, a power of 2 with room for TOUCH_EVENT_COUNT events
+
+static INT8U touchEventBuf[TOUCH_EVENT_RING_SIZE];
+static Ring touchEventRing;               // events, touch task -> UI task
+static OS_EVENT *touchIntSem;             // posted by the touch INT interrupt
+
+static Adafruit_FT6206 *touchCtrlPtr;     // controller read by the touch task
+
+INT32U touchEventsDropped = 0;            // events lost because the UI task fell behind
+
+// Queues one event. If the UI task has not consumed the earlier ones the
+// event is dropped rather than blocking the touch task.
+static void TouchPostEvent(INT16S x, INT16S y, INT8U id, INT8U type)
+{
+    TouchEvent event;
+    
+    event.x = x;
+    event.y = y;
+    event.id = id;
+    event.type = type;
+    event.time = OSTimeGet();
+    
+    if (!RingPut(&touchEventRing, &event, sizeof(event)))
+    {
+        touchEventsDropped++;
+    }
+}
+
+// TouchTask
+// Sleeps until the touch INT line goes low, then reads the controller
+// until the touch is released.
+static void TouchTask(void* pdata)
+{
+    INT8U err;
+    TS_Point point;
+    BOOLEAN down;
+    
+    while (1)
+    {
+        // armed before the pin is checked, so a touch between the two is
+        // not missed
+        BspTouchArmInterrupt();
+        if (TOUCH_FT6206_INT_ASSERTED())
+        {
+            BspTouchDisarmInterrupt();
+        }
+        else
+        {
+            OSSemPend(touchIntSem, 0, &err);
+            if (err != OS_ERR_NONE) while(1);
+        }
+        // discard a post left over from an edge that raced the check above,
+        // which would wake the next pend with no touch
+        while (OSSemAccept(touchIntSem) > 0);
+        
+        down = OS_FALSE;
+        while (1)
+        {
+            TS_Point p = touchCtrlPtr->getPoint();
+            if (touchCtrlPtr->getTouches() == 0) break;
+            
+            point = p;
+            TouchPostEvent(point.x, point.y, touchCtrlPtr->getTouchID(), down ? TOUCH_EVENT_MOVE : TOUCH_EVENT_DOWN);
+            down = OS_TRUE;
+            
+            OSTimeDly(TOUCH_REPORT_TICKS);
+            if (!TOUCH_FT6206_INT_ASSERTED()) break;
+        }
+        
+        if (down)
+        {
+            TouchPostEvent(point.x, point.y, touchCtrlPtr->getTouchID(), TOUCH_EVENT_UP);
+        }
+    }
+}
+
+// TouchEventsStart
+// Enables the touch INT interrupt and starts the task that turns touches
+// into events. pTouch must already have been initialized with begin().
+void TouchEventsStart(Adafruit_FT6206 *pTouch)
+{
+    INT8U err;
+    
+    touchCtrlPtr = pTouch;
+    
+    if (TOUCH_EVENT_COUNT * sizeof(TouchEvent) > TOUCH_EVENT_RING_SIZE) while(1);
+    RingInit(&touchEventRing, touchEventBuf, TOUCH_EVENT_RING_SIZE, OS_TRUE);
+    touchIntSem = OSSemCreate(0);
+    if (touchIntSem == 0) while(1);
+    
+    BspTouchInitInterrupt(touchIntSem);
+    
+    err = OSTaskCreate(TouchTask, (void*)0, &TouchTaskStk[APP_CFG_TASK_TOUCH_STK_SIZE-1], APP_TASK_TOUCH_PRIO);
+    if (err != OS_ERR_NONE) while(1);
+}
+
+// TouchEventPend
+// Waits up to timeout ticks (0 waits forever) for the next touch event and
+// copies it to pEvent. Returns OS_FALSE on timeout.
+BOOLEAN TouchEventPend(TouchEvent *pEvent, INT32U timeout)
+{
+    if (!RingPend(&touchEventRing, sizeof(TouchEvent), timeout)) return OS_FALSE;
+    return RingGet(&touchEventRing, pEvent, sizeof(TouchEvent));
+}
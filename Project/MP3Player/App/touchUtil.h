@@ -0,0 +1,37 @@
+/*
+    touchUtil.h
+    Interrupt driven touch events from the FT6206 touch controller.
+
+    2026/10 written for the MP3Player project
+*/
+
+#ifndef __TOUCHUTIL_H
+#define __TOUCHUTIL_H
+
+class Adafruit_FT6206;
+
+#define TOUCH_EVENT_COUNT  8   // events that can wait for the UI task
+#define TOUCH_REPORT_TICKS 5   // interval between controller reads while touched
+
+#define TOUCH_EVENT_DOWN   0   // first report of a touch
+#define TOUCH_EVENT_MOVE   1   // further report while the touch is held
+#define TOUCH_EVENT_UP     2   // touch released, x/y are the last reported position
+
+// A touch report passed from the touch task to the UI task.
+// x/y are raw panel coordinates as returned by Adafruit_FT6206::getPoint()
+typedef struct
+{
+    INT16S x;
+    INT16S y;
+    INT8U id;     // controller touch ID
+    INT8U type;   // TOUCH_EVENT_*
+    INT32U time;  // OSTimeGet() when the report was read
+} TouchEvent;
+
+void TouchEventsStart(Adafruit_FT6206 *pTouch);
+BOOLEAN TouchEventPend(TouchEvent *pEvent, INT32U timeout);
+
+extern INT32U touchEventsDropped;
+
+
+#endif
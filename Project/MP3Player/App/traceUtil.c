@@ -0,0 +1,111 @@
+/*
+    traceUtil.c
+    Binary trace recorder for kernel and driver events.
+
+    Task switches, ISRs, semaphore pends and posts, PJDF calls, DREQ waits and
+    SD commands are recorded as TraceEntry records stamped with the
+    port's cycle counter (OS_CPU_CYCLES_GET()) in a ring that keeps the last
+    TRACE_ENTRY_COUNT events. Recording an event takes a few dozen cycles with
+    interrupts disabled and no printing, so unlike PrintWithBuf() tracing does
+    not disturb the timing it is meant to show.
+
+    TraceDump() (the shell "trace" command) prints the ring as hex text, one
+    entry per line between "TRACE" and "TRACE END" lines; arg is printed with
+    as many hex digits as a pointer has. Tools/traceDecode.py turns a captured
+    dump into a Chrome trace / Perfetto JSON timeline.
+
+    2026/10 written for the MP3Player project
+*/
+
+#include "bsp.h"
+#include "print.h"
+#include "traceUtil.h"
+
+static TraceEntry traceBuf[TRACE_ENTRY_COUNT];
+static INT32U traceHead;          // entries ever recorded, the next one goes to traceBuf[traceHead % TRACE_ENTRY_COUNT]
+static INT32U traceCyclesPerSec;  // counter rate, 0 until TraceInit()
+static BOOLEAN traceOn;           // cleared while the ring is dumped
+
+
+// Start recording. Call once from the startup task.
+void TraceInit(void)
+{
+#if APP_CFG_TRACE_EN > 0u
+    traceCyclesPerSec = OS_CPU_CyclesInit();
+    traceOn = OS_TRUE;
+#endif
+}
+
+
+// Record one event, overwriting the oldest once the ring is full.
+// Safe to call from tasks and ISRs.
+void TraceRecord(INT8U event, INT16U arg16, uintptr_t arg)
+{
+    OS_CPU_SR cpu_sr;
+    TraceEntry *pEntry;
+
+    OS_ENTER_CRITICAL();
+    if (traceOn)
+    {
+        pEntry = &traceBuf[traceHead & (TRACE_ENTRY_COUNT - 1)];
+        traceHead++;
+        pEntry->time = OS_CPU_CYCLES_GET();
+        pEntry->event = event;
+        pEntry->prio = OSTCBCur->OSTCBPrio;
+        pEntry->arg16 = arg16;
+        pEntry->arg = arg;
+    }
+    OS_EXIT_CRITICAL();
+}
+
+
+// Called on ISR entry and exit: the exception number, read through the
+// port's OS_CPU_ISR_NUM(), tells the ISRs apart
+void TraceIsrEnter(void)
+{
+    TraceRecord(TRACE_EV_ISR, (INT16U)OS_CPU_ISR_NUM(), 0);
+}
+
+
+void TraceIsrExit(void)
+{
+    TraceRecord(TRACE_EV_ISR | TRACE_EXIT, (INT16U)OS_CPU_ISR_NUM(), 0);
+}
+
+
+// Print the ring, oldest entry first. Recording stops while the dump is
+// printed so that the entries do not change underneath it; events in the
+// meantime are lost.
+void TraceDump(void)
+{
+    char buf[PRINTBUFMAX];
+    OS_CPU_SR cpu_sr;
+    TraceEntry *pEntry;
+    INT32U head;
+    INT32U count;
+    INT32U i;
+
+    if (traceCyclesPerSec == 0)
+    {
+        PrintString("Trace: not started\n");
+        return;
+    }
+
+    OS_ENTER_CRITICAL();
+    traceOn = OS_FALSE;
+    head = traceHead;
+    OS_EXIT_CRITICAL();
+
+    count = head < TRACE_ENTRY_COUNT ? head : TRACE_ENTRY_COUNT;
+    PrintWithBuf(buf, PRINTBUFMAX, "TRACE %u %u\n", traceCyclesPerSec, count);
+    for (i = head - count; i != head; i++)
+    {
+        pEntry = &traceBuf[i & (TRACE_ENTRY_COUNT - 1)];
+        PrintWithBuf(buf, PRINTBUFMAX, "%08x %02x %02x %04x %0*lx\n",
+            pEntry->time, pEntry->event, pEntry->prio, pEntry->arg16,
+            (int)(2 * sizeof(pEntry->arg)), (unsigned long)pEntry->arg);
+    }
+    PrintString("TRACE END\n");
+
+    traceOn = OS_TRUE;
+}
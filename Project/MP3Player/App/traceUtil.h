@@ -0,0 +1,53 @@
+/*
+    traceUtil.h
+    Binary trace recorder for kernel and driver events.
+
+    2026/10 written for the MP3Player project
+*/
+
+#ifndef __TRACEUTIL_H
+#define __TRACEUTIL_H
+
+#include <stdint.h>
+
+#define TRACE_ENTRY_COUNT  1024  // entries kept, must be a power of 2
+
+// Event codes. An event that spans time records an entry with the plain code
+// when it starts and one with TRACE_EXIT or'ed in when it ends.
+#define TRACE_EXIT            0x80
+#define TRACE_EV_TASK_SWITCH  0x01  // arg16 = priority of the task switched in
+#define TRACE_EV_ISR          0x02  // arg16 = exception number
+#define TRACE_EV_SEM_PEND     0x03  // arg = semaphore or mutex, arg16 = timeout; on exit arg16 = OS_ERR_xxx
+#define TRACE_EV_SEM_POST     0x04  // arg = semaphore or mutex
+#define TRACE_EV_PJDF_OPEN    0x05  // arg = device name; on exit arg16 = handle or error code
+#define TRACE_EV_PJDF_READ    0x06  // arg16 = handle, arg = length; on exit arg = error code
+#define TRACE_EV_PJDF_WRITE   0x07  // arg16 = handle, arg = length; on exit arg = error code
+#define TRACE_EV_PJDF_IOCTL   0x08  // arg16 = handle, arg = request; on exit arg = error code
+#define TRACE_EV_DREQ_WAIT    0x09  // on exit arg16 = number of pends on the DREQ interrupt
+#define TRACE_EV_SD_CMD       0x0A  // arg16 = command, arg = argument; on exit arg16 = R1 status
+#define TRACE_EV_PJDF_WRITEV  0x0B  // arg16 = handle, arg = segment count; on exit arg = error code
+
+// One recorded event, 12 bytes on the target (arg holds a pointer, so 16 on a 64 bit host)
+typedef struct
+{
+    INT32U time;   // OS_CPU_CYCLES_GET() when the event was recorded
+    INT8U event;   // TRACE_EV_xxx, possibly with TRACE_EXIT
+    INT8U prio;    // priority of the running (or interrupted) task
+    INT16U arg16;
+    uintptr_t arg; // an integer or an object pointer
+} TraceEntry;
+
+#if APP_CFG_TRACE_EN > 0u
+#define TRACE(event, arg16, arg) TraceRecord((event), (INT16U)(arg16), (uintptr_t)(arg))
+#else
+#define TRACE(event, arg16, arg)
+#endif
+
+void TraceInit(void);
+void TraceRecord(INT8U event, INT16U arg16, uintptr_t arg);
+void TraceIsrEnter(void);
+void TraceIsrExit(void);
+void TraceDump(void);
+
+
+#endif
@@ -46,6 +46,8 @@
 */
 
 #define  APP_CFG_SERIAL_EN                      DEF_ENABLED
+#define  APP_CFG_PROF_EN                        1u     // per-task CPU / context switch profiler (profUtil.c)
+#define  APP_CFG_TRACE_EN                       1u     // binary kernel and driver event trace (traceUtil.c)
 
 
 /*
@@ -55,12 +57,23 @@
 */
 
 //task priorities
+#define APP_TASK_TOUCH_PRIO                 3   // reads the touch controller while the panel is touched
 #define APP_TASK_START_PRIO                 4
-#define APP_TASK_TEST1_PRIO                 5
-#define APP_TASK_TEST2_PRIO                 6
-#define APP_TASK_TEST3_PRIO                 7
+#define APP_TASK_MP3_FEED_PRIO              5   // drains SD sectors into the MP3 decoder
+#define APP_TASK_MP3_READ_PRIO              6   // fills SD sectors for the feeder task
+#define APP_TASK_TEST1_PRIO                 7
+#define APP_TASK_TEST2_PRIO                 8
+#define APP_TASK_TEST3_PRIO                 9
+#define APP_TASK_SHELL_PRIO                 10  // command line shell on the console UART
+#define APP_TASK_MP3_RESUME_PRIO            11  // writes the resume record while a song plays
 #define  OS_TASK_TMR_PRIO                (OS_LOWEST_PRIO - 2u)
 
+// Ceilings of the PJDF bus locks: PjdfCreateBusLock() hands them out in order,
+// one per bus, so no task may use a priority in this range and every task
+// must be below it.
+#define APP_PJDF_CEILING_PRIO_FIRST         0
+#define APP_PJDF_CEILING_PRIO_LAST          2
+
 
 /*
 *********************************************************************************************************
@@ -72,6 +85,33 @@
 #define  APP_CFG_TASK_START_STK_SIZE            256u
 #define  APP_CFG_TASK_EQ_STK_SIZE               512u
 #define  APP_CFG_TASK_OBJ_STK_SIZE              256u
+#define  APP_CFG_TASK_MP3_STK_SIZE              256u
+#define  APP_CFG_TASK_TOUCH_STK_SIZE            256u
+#define  APP_CFG_TASK_SHELL_STK_SIZE            512u
+
+
+/*
+*********************************************************************************************************
+*                                          ISR ENTRY / EXIT HOOKS
+*          Called by every ISR right after OSIntNesting++ and right before OSIntExit()
+*********************************************************************************************************
+*/
+
+#if (APP_CFG_PROF_EN > 0u) || (APP_CFG_TRACE_EN > 0u)
+#ifdef __cplusplus
+extern "C" {
+#endif
+void App_IsrEnter(void);                                // app_hooks.c
+void App_IsrExit(void);
+#ifdef __cplusplus
+}
+#endif
+#define  APP_ISR_ENTER()                        App_IsrEnter()
+#define  APP_ISR_EXIT()                         App_IsrExit()
+#else
+#define  APP_ISR_ENTER()
+#define  APP_ISR_EXIT()
+#endif
 
 
 
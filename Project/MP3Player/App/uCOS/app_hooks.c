@@ -37,6 +37,8 @@
 */
 
 #include  <ucos_ii.h>
+#include  "profUtil.h"
+#include  "traceUtil.h"
 //#include  <stm32f4xx_hal.h>
 
 
@@ -214,6 +216,10 @@ void  App_TaskSwHook (void)
 #if (APP_CFG_PROBE_OS_PLUGIN_EN > 0) && (OS_PROBE_HOOKS_EN > 0)
     OSProbe_TaskSwHook();
 #endif
+#if APP_CFG_PROF_EN > 0u
+    ProfTaskSwitch();
+#endif
+    TRACE(TRACE_EV_TASK_SWITCH, OSTCBHighRdy->OSTCBPrio, 0);
 }
 #endif
 
@@ -254,8 +260,96 @@ void  App_TimeTickHook (void)
 {
 #if (APP_CFG_PROBE_OS_PLUGIN_EN == DEF_ENABLED) && (OS_PROBE_HOOKS_EN > 0)
     OSProbe_TickHook();
+#endif
+#if APP_CFG_PROF_EN > 0u
+    ProfTick();
 #endif
     //HAL_IncTick();                                              /* STM32CubeF4 library function call.                   */
 }
 #endif
+
+/*
+*********************************************************************************************************
+*                                        KERNEL TRACE HOOK (APPLICATION)
+*
+* Description : This function is called by uC/OS-II on the kernel events listed as OS_TRACE_xxx in ucos_ii.h.
+*
+* Argument(s) : event   is the OS_TRACE_xxx code of the event.
+*
+*               pobj    is a pointer to the kernel object concerned.
+*
+*               arg     is an event specific argument.
+*
+* Note(s)     : (1) This function may be called from an ISR.
+*********************************************************************************************************
+*/
+
+#if OS_TRACE_EN > 0u
+void  App_TraceHook (INT8U event, void *pobj, INT32U arg)
+{
+    switch (event) {
+        case OS_TRACE_SEM_PEND:
+        case OS_TRACE_MUTEX_PEND:
+             TRACE(TRACE_EV_SEM_PEND, arg, pobj);
+             break;
+
+        case OS_TRACE_SEM_PEND_EXIT:
+        case OS_TRACE_MUTEX_PEND_EXIT:
+             TRACE(TRACE_EV_SEM_PEND | TRACE_EXIT, arg, pobj);
+             break;
+
+        case OS_TRACE_SEM_POST:
+        case OS_TRACE_MUTEX_POST:
+             TRACE(TRACE_EV_SEM_POST, arg, pobj);
+             break;
+
+        default:
+             break;
+    }
+}
+#endif
+#endif
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+**                                          ISR ENTRY / EXIT HOOKS
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*                                          ISR ENTRY / EXIT HOOKS
+*
+* Description : App_IsrEnter() is called by every ISR right after it increments OSIntNesting and
+*               App_IsrExit() right before it calls OSIntExit() (see APP_ISR_ENTER() in app_cfg.h).
+*
+* Argument(s) : none.
+*
+* Note(s)     : (1) Interrupts are ENABLED during these calls; higher priority ISRs may nest.
+*********************************************************************************************************
+*/
+
+#if (APP_CFG_PROF_EN > 0u) || (APP_CFG_TRACE_EN > 0u)
+void  App_IsrEnter (void)
+{
+#if APP_CFG_PROF_EN > 0u
+    ProfIsrEnter();
+#endif
+#if APP_CFG_TRACE_EN > 0u
+    TraceIsrEnter();
+#endif
+}
+
+
+void  App_IsrExit (void)
+{
+#if APP_CFG_TRACE_EN > 0u
+    TraceIsrExit();
+#endif
+#if APP_CFG_PROF_EN > 0u
+    ProfIsrExit();
+#endif
+}
 #endif
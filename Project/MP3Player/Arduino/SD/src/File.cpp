@@ -79,6 +79,7 @@ size_t File::write(uint8_t val) {
 }
 
 size_t File::write(const uint8_t *buf, size_t size) {
+  SdCardLock lock;
   size_t t;
   if (!_file) {
     //setWriteError();
@@ -94,15 +95,18 @@ size_t File::write(const uint8_t *buf, size_t size) {
 }
 
 int File::peek() {
+  SdCardLock lock;
   if (! _file) 
     return 0;
 
-  int c = _file->read();
-  if (c != -1) _file->seekCur(-1);
-  return c;
+  uint8_t *p;
+  if (_file->peekBlock(&p) <= 0) 
+    return -1;
+  return *p;
 }
 
 int File::read() {
+  SdCardLock lock;
   if (_file) 
     return _file->read();
   return -1;
@@ -110,11 +114,36 @@ int File::read() {
 
 // buffered read for more efficient, high speed reading
 int File::read(void *buf, uint16_t nbyte) {
+  SdCardLock lock;
   if (_file) 
     return _file->read(buf, nbyte);
   return 0;
 }
 
+// reads up to the next 512 byte sector boundary. When the position is
+// sector aligned the whole sector goes straight into buf, bypassing the
+// volume cache, so buf must hold 512 bytes.
+int File::readSector(void *buf) {
+  SdCardLock lock;
+  if (! _file) 
+    return 0;
+
+  uint16_t n = 512 - (_file->curPosition() & 0X1FF);
+  return _file->read(buf, n);
+}
+
+// zero-copy access to the cached sector at the current position.
+// Sets ptr to the data and returns the number of bytes there, 0 at end of
+// file or -1 on error. The position is not advanced, use seek() for that.
+// ptr is only valid until the next SD call, of any task.
+int File::peekBuffer(uint8_t **ptr) {
+  SdCardLock lock;
+  if (! _file) 
+    return -1;
+
+  return _file->peekBlock(ptr);
+}
+
 int File::available() {
   if (! _file) return 0;
 
@@ -124,11 +153,13 @@ int File::available() {
 }
 
 void File::flush() {
+  SdCardLock lock;
   if (_file)
     _file->sync();
 }
 
 boolean File::seek(uint32_t pos) {
+  SdCardLock lock;
   if (! _file) return false;
 
   return _file->seekSet(pos);
@@ -145,6 +176,7 @@ uint32_t File::size() {
 }
 
 void File::close() {
+    SdCardLock lock;
     INT8U uCOSerr;
   if (_file) {
     _file->close();
@@ -53,6 +53,20 @@
 
 #include "SD.h"
 
+// SdCardLock semaphore, created by SDClass::begin()
+static OS_EVENT *sdCardSem;
+
+SdCardLock::SdCardLock() {
+  INT8U err;
+  if (sdCardSem == NULL) return;  // no card begun, so no file open either
+  OSSemPend(sdCardSem, 0, &err);
+  if (err != OS_ERR_NONE) while(1);
+}
+
+SdCardLock::~SdCardLock() {
+  if (sdCardSem != NULL) OSSemPost(sdCardSem);
+}
+
 // Used by `getNextPathComponent`
 #define MAX_COMPONENT_LEN 12 // What is max length?
 #define PATH_COMPONENT_BUFFER_LEN MAX_COMPONENT_LEN+1
@@ -341,6 +355,11 @@ boolean SDClass::begin(uint8_t csPin) {
     Return true if initialization succeeds, false otherwise.
 
    */
+  if (sdCardSem == NULL) {
+    sdCardSem = OSSemCreate(1);
+    if (sdCardSem == NULL) while(1);  // not enough event blocks
+  }
+  SdCardLock lock;
   return card.init(SPI_HALF_SPEED, csPin) &&
          volume.init(card) &&
          root.openRoot(volume);
@@ -429,6 +448,7 @@ File SDClass::open(const char *filepath, uint8_t mode) {
 
    */
 
+  SdCardLock lock;
   int pathidx;
 
   // do the interative search
@@ -522,6 +542,7 @@ boolean SDClass::exists(char *filepath) {
      Returns true if the supplied file path exists.
 
    */
+  SdCardLock lock;
   return walkPath(filepath, root, callback_pathExists);
 }
 
@@ -545,6 +566,7 @@ boolean SDClass::mkdir(char *filepath) {
     A rough equivalent to `mkdir -p`.
   
    */
+  SdCardLock lock;
   return walkPath(filepath, root, callback_makeDirPath);
 }
 
@@ -556,16 +578,19 @@ boolean SDClass::rmdir(char *filepath) {
     A rough equivalent to `rm -rf`.
   
    */
+  SdCardLock lock;
   return walkPath(filepath, root, callback_rmdir);
 }
 
 boolean SDClass::remove(char *filepath) {
+  SdCardLock lock;
   return walkPath(filepath, root, callback_remove);
 }
 
 
 // allows you to recurse into a directory
 File File::openNextFile(uint8_t mode) {
+  SdCardLock lock;
   dir_t p;
 
   //Serial.print("\t\treading dir...");
@@ -610,8 +635,37 @@ File File::openNextFile(uint8_t mode) {
 }
 
 void File::rewindDirectory(void) {  
+  SdCardLock lock;
   if (isDirectory())
     _file->rewind();
 }
 
+// reads the next directory entry of a file or subdirectory without opening
+// it, which openNextFile() does by searching the directory for its name.
+// The entry's index in the directory is position() / 32 - 1.
+// Returns the entry size, 0 past the last entry or -1 on error.
+int8_t File::readDir(dir_t *dir) {
+  SdCardLock lock;
+  if (!isDirectory())
+    return -1;
+
+  return _file->readDir(dir);
+}
+
+// opens the entry at the given index of this directory, as found with
+// readDir(), without searching for its name. Moves the directory position.
+File File::openAt(uint16_t index, uint8_t mode) {
+  SdCardLock lock;
+  SdFile f;
+  dir_t p;
+  char name[13];
+
+  if (!isDirectory() || !f.open(_file, index, mode))
+    return File();
+
+  f.dirEntry(&p);
+  SdFile::dirName(p, name);
+  return File(f, name);
+}
+
 SDClass SD;
@@ -23,6 +23,19 @@
 #define FILE_READ O_READ
 #define FILE_WRITE (O_READ | O_WRITE | O_CREAT)
 
+// Serializes the SD card between tasks: every SDClass and File call that
+// touches the card holds it for its duration, since the card's command
+// state and the volume's block cache are shared by all the files. It is a
+// semaphore, not a mutex, as the SPI bus lock taken under it is a mutex and
+// mutexes do not nest (see PjdfCreateBusLock()); a low priority task in an
+// SD call can so keep a higher one waiting for the rest of that call.
+// A task must not take it again while it holds it.
+class SdCardLock {
+public:
+  SdCardLock();
+  ~SdCardLock();
+};
+
 class File {
  private:
   char _name[13]; // our name
@@ -38,6 +51,8 @@ public:
   virtual int available();
   virtual void flush();
   int read(void *buf, uint16_t nbyte);
+  int readSector(void *buf);
+  int peekBuffer(uint8_t **ptr);
   boolean seek(uint32_t pos);
   uint32_t position();
   uint32_t size();
@@ -47,6 +62,8 @@ public:
 
   boolean isDirectory(void);
   File openNextFile(uint8_t mode = O_RDONLY);
+  int8_t readDir(dir_t *dir);
+  File openAt(uint16_t index, uint8_t mode = O_RDONLY);
   void rewindDirectory(void);
   
   //using Print::write;
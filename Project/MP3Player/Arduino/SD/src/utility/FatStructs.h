@@ -27,6 +27,11 @@
  * mostly from Microsoft document fatgen103.doc
  * http://www.microsoft.com/whdc/system/platform/firmware/fatgen.mspx
  */
+#ifdef __GNUC__
+// GCC (host build) has no __packed keyword: pack the structures with a pragma
+#define __packed
+#pragma pack(push, 1)
+#endif
 //------------------------------------------------------------------------------
 /** Value for byte 510 of boot block or MBR */
 uint8_t const BOOTSIG0 = 0X55;
@@ -367,6 +372,9 @@ __packed struct directoryEntry {
            /** 32-bit unsigned holding this file's size in bytes. */
   uint32_t fileSize;
 };
+#ifdef __GNUC__
+#pragma pack(pop)
+#endif
 //------------------------------------------------------------------------------
 // Definitions for directory entries
 //
@@ -28,13 +28,22 @@
 #endif
 #include "Sd2Card.h"
 #include "FatStructs.h"
-#include "Print.h"
+#include "print.h"
 //------------------------------------------------------------------------------
 /**
  * Allow use of deprecated functions if non-zero
  */
 #define ALLOW_DEPRECATED_FUNCTIONS 1
 //------------------------------------------------------------------------------
+/**
+ * Number of 512 byte blocks in the SdVolume block cache.  Each block costs
+ * 512 bytes of RAM.  The slot holding the FAT block in use is not evicted
+ * for data or directory blocks, so use at least two.
+ */
+#ifndef SD_CACHE_BLOCK_COUNT
+#define SD_CACHE_BLOCK_COUNT 4
+#endif  // SD_CACHE_BLOCK_COUNT
+//------------------------------------------------------------------------------
 // forward declaration since SdVolume is used in SdFile
 class SdVolume;
 //==============================================================================
@@ -130,6 +139,17 @@ uint16_t const FAT_DEFAULT_DATE = ((2000 - 1980) << 9) | (1 << 5) | 1;
 /** Default time for file timestamp is 1 am */
 uint16_t const FAT_DEFAULT_TIME = (1 << 11);
 //------------------------------------------------------------------------------
+/** Number of cluster runs remembered for each open file */
+uint8_t const SD_FILE_EXTENT_COUNT = 8;
+/**
+ * \struct fat_extent_t
+ * \brief A run of consecutive clusters in a file's cluster chain
+ */
+struct fat_extent_t {
+  uint32_t firstCluster;  // first cluster of the run
+  uint32_t clusterCount;  // number of clusters in the run
+};
+//------------------------------------------------------------------------------
 /**
  * \class SdFile
  * \brief Access FAT16 and FAT32 files on SD and SDHC cards.
@@ -137,7 +157,8 @@ uint16_t const FAT_DEFAULT_TIME = (1 << 11);
 class SdFile {
  public:
   /** Create an instance of SdFile. */
-  SdFile(void) : type_(FAT_FILE_TYPE_CLOSED) {}
+  SdFile(void) : type_(FAT_FILE_TYPE_CLOSED), extentCount_(0), extentClusters_(0),
+    extentOverflow_(0) {}
   /**
    * writeError is set to true if an error occurs during a write().
    * Set writeError to false before calling print() and/or write() and check
@@ -241,6 +262,7 @@ class SdFile {
     return read(&b, 1) == 1 ? b : -1;
   }
   int16_t read(void* buf, uint16_t nbyte);
+  int16_t peekBlock(uint8_t** ptr);
   int8_t readDir(dir_t* dir);
   static uint8_t remove(SdFile* dirFile, const char* fileName);
   uint8_t remove(void);
@@ -394,6 +416,10 @@ class SdFile {
   uint32_t  fileSize_;      // file size in bytes
   uint32_t  firstCluster_;  // first cluster of file
   SdVolume* vol_;           // volume where file is located
+  fat_extent_t extent_[SD_FILE_EXTENT_COUNT];  // cluster runs of the chain in file order
+  uint8_t   extentCount_;   // number of valid entries in extent_
+  uint32_t  extentClusters_;  // number of file clusters covered by extent_
+  uint32_t  extentOverflow_;  // cluster after a full extent_, zero if not found
 
   // private functions
   uint8_t addCluster(void);
@@ -403,6 +429,11 @@ class SdFile {
   static uint8_t make83Name(const char* str, uint8_t* name);
   uint8_t openCachedEntry(uint8_t cacheIndex, uint8_t oflags);
   dir_t* readDirCache(void);
+  uint32_t readRunLength(uint32_t block, uint32_t maxBlocks);
+  uint8_t positionBlock(uint32_t* cluster, uint32_t* block);
+  uint8_t extentLookup(uint32_t index, uint32_t* cluster);
+  uint8_t nextCluster(uint32_t index, uint32_t cluster, uint32_t* next);
+  void extentClear(void) {extentCount_ = 0; extentClusters_ = 0; extentOverflow_ = 0;}
 };
 //==============================================================================
 // SdVolume class
@@ -435,11 +466,13 @@ class SdVolume {
   /** Clear the cache and returns a pointer to the cache.  Used by the WaveRP
    *  recorder to do raw write to the SD card.  Not for normal apps.
    */
-  static uint8_t* cacheClear(void) {
-    cacheFlush();
-    cacheBlockNumber_ = 0XFFFFFFFF;
-    return cacheBuffer_.data;
-  }
+  static uint8_t* cacheClear(void);
+  /** \return The number of block cache lookups found in the cache. */
+  static uint32_t cacheHitCount(void) {return cacheHits_;}
+  /** \return The number of block cache lookups that read the SD card. */
+  static uint32_t cacheMissCount(void) {return cacheMisses_;}
+  /** Reset the block cache hit and miss counters. */
+  static void cacheResetCounts(void) {cacheHits_ = cacheMisses_ = 0;}
   /**
    * Initialize a FAT volume.  Try partition one first then try super
    * floppy format.
@@ -499,11 +532,19 @@ class SdVolume {
   // value for action argument in cacheRawBlock to indicate cache dirty
   static uint8_t const CACHE_FOR_WRITE = 1;
 
-  static cache_t cacheBuffer_;        // 512 byte cache for device blocks
-  static uint32_t cacheBlockNumber_;  // Logical number of block in the cache
+  static cache_t* cacheBuffer_;       // current block, one of cacheSlot_
+  static uint32_t cacheBlockNumber_;  // Logical number of the current block
   static Sd2Card* sdCard_;            // Sd2Card object for cache
-  static uint8_t cacheDirty_;         // cacheFlush() will write block if true
-  static uint32_t cacheMirrorBlock_;  // block number for mirror FAT
+  static uint8_t cacheCurrent_;       // index of the current slot
+  static uint8_t cacheFatSlot_;       // slot holding the FAT block in use
+  static uint32_t cacheUseCount_;     // clock for least recently used order
+  static uint32_t cacheHits_;         // lookups found in the cache
+  static uint32_t cacheMisses_;       // lookups that read the card
+  static cache_t cacheSlot_[SD_CACHE_BLOCK_COUNT];         // block buffers
+  static uint32_t cacheSlotBlock_[SD_CACHE_BLOCK_COUNT];   // block in each slot
+  static uint32_t cacheSlotMirror_[SD_CACHE_BLOCK_COUNT];  // mirror FAT block
+  static uint32_t cacheSlotUse_[SD_CACHE_BLOCK_COUNT];     // time of last use
+  static uint8_t cacheSlotDirty_[SD_CACHE_BLOCK_COUNT];    // slot needs write
 //
   uint32_t allocSearchStart_;   // start cluster for alloc search
   uint8_t blocksPerCluster_;    // cluster size in blocks
@@ -526,8 +567,18 @@ class SdVolume {
            return clusterStartBlock(cluster) + blockOfCluster(position);}
   static uint8_t cacheFlush(void);
   static uint8_t cacheRawBlock(uint32_t blockNumber, uint8_t action);
-  static void cacheSetDirty(void) {cacheDirty_ |= CACHE_FOR_WRITE;}
+  static void cacheSetDirty(void) {
+    cacheSlotDirty_[cacheCurrent_] |= CACHE_FOR_WRITE;
+  }
   static uint8_t cacheZeroBlock(uint32_t blockNumber);
+  static uint8_t cacheNewBlock(uint32_t blockNumber);
+  static uint8_t cacheHolds(uint32_t blockNumber);
+  static void cacheInvalidate(uint32_t blockNumber);
+  static uint32_t cacheCleanRun(uint32_t blockNumber, uint32_t count);
+  static int8_t cacheFind(uint32_t blockNumber);
+  static uint8_t cacheSelect(uint8_t slot);
+  static uint8_t cacheVictim(void);
+  static uint8_t cacheWriteBack(uint8_t slot);
   uint8_t chainSize(uint32_t beginCluster, uint32_t* size) const;
   uint8_t fatGet(uint32_t cluster, uint32_t* value) const;
   uint8_t fatPut(uint32_t cluster, uint32_t value);
@@ -544,6 +595,15 @@ class SdVolume {
     uint16_t count, uint8_t* dst) {
       return sdCard_->readData(block, offset, count, dst);
   }
+  uint8_t readData(uint8_t* dst) {
+    return sdCard_->readData(dst);
+  }
+  uint8_t readStart(uint32_t block) {
+    return sdCard_->readStart(block);
+  }
+  uint8_t readStop(void) {
+    return sdCard_->readStop();
+  }
   uint8_t writeBlock(uint32_t block, const uint8_t* dst) {
     return sdCard_->writeBlock(block, dst);
   }
@@ -34,6 +34,9 @@ void (*SdFile::oldDateTime_)(uint16_t& date, uint16_t& time) = NULL;  // NOLINT
 uint8_t SdFile::addCluster() {
   if (!vol_->allocContiguous(1, &curCluster_)) return false;
 
+  // chain has grown, rebuild the extent map when next needed
+  extentClear();
+
   // if first cluster of file link to directory entry
   if (firstCluster_ == 0) {
     firstCluster_ = curCluster_;
@@ -61,7 +64,7 @@ uint8_t SdFile::addDirCluster(void) {
 // return pointer to cached entry or null for failure
 dir_t* SdFile::cacheDirEntry(uint8_t action) {
   if (!SdVolume::cacheRawBlock(dirBlock_, action)) return NULL;
-  return SdVolume::cacheBuffer_.dir + dirIndex_;
+  return SdVolume::cacheBuffer_->dir + dirIndex_;
 }
 //------------------------------------------------------------------------------
 /**
@@ -75,9 +78,73 @@ dir_t* SdFile::cacheDirEntry(uint8_t action) {
 uint8_t SdFile::close(void) {
   if (!sync())return false;
   type_ = FAT_FILE_TYPE_CLOSED;
+  extentClear();
   return true;
 }
 //------------------------------------------------------------------------------
+/**
+ * Find the cluster holding the file's \a index'th cluster (zero based)
+ * using the extent map.  The map is extended on demand by following the
+ * chain in the FAT from the last mapped cluster.  Once the map is full the
+ * cluster found after it is kept, so the FAT entry that overflowed the map
+ * is only read once.
+ *
+ * \return The value one, true, is returned if \a index is mapped or is
+ * the cluster just after a full map. The value zero, false, is returned if
+ * \a index is past the end of the chain or beyond that cluster, or an I/O
+ * error occurred.
+ */
+uint8_t SdFile::extentLookup(uint32_t index, uint32_t* cluster) {
+  if (firstCluster_ == 0 || type_ == FAT_FILE_TYPE_ROOT16) return false;
+
+  if (extentCount_ == 0) {
+    extent_[0].firstCluster = firstCluster_;
+    extent_[0].clusterCount = 1;
+    extentCount_ = 1;
+    extentClusters_ = 1;
+    extentOverflow_ = 0;
+  }
+  while (index >= extentClusters_) {
+    if (extentOverflow_) {
+      if (index != extentClusters_) return false;
+      *cluster = extentOverflow_;
+      return true;
+    }
+    fat_extent_t* last = &extent_[extentCount_ - 1];
+    uint32_t c = last->firstCluster + last->clusterCount - 1;
+    uint32_t next;
+    if (!vol_->fatGet(c, &next)) return false;
+    if (vol_->isEOC(next)) return false;
+    if (next == c + 1) {
+      last->clusterCount++;
+    } else if (extentCount_ < SD_FILE_EXTENT_COUNT) {
+      extent_[extentCount_].firstCluster = next;
+      extent_[extentCount_].clusterCount = 1;
+      extentCount_++;
+    } else {
+      extentOverflow_ = next;
+      continue;
+    }
+    extentClusters_++;
+  }
+  uint32_t base = 0;
+  for (uint8_t i = 0; i < extentCount_; i++) {
+    if (index < base + extent_[i].clusterCount) {
+      *cluster = extent_[i].firstCluster + (index - base);
+      return true;
+    }
+    base += extent_[i].clusterCount;
+  }
+  return false;
+}
+//------------------------------------------------------------------------------
+// cluster that follows \a cluster, the file's \a index'th cluster.
+// Uses the extent map, falling back to one FAT read past its end.
+uint8_t SdFile::nextCluster(uint32_t index, uint32_t cluster, uint32_t* next) {
+  if (extentLookup(index + 1, next)) return true;
+  return vol_->fatGet(cluster, next);
+}
+//------------------------------------------------------------------------------
 /**
  * Check for contiguous file and return its raw block range.
  *
@@ -321,7 +388,7 @@ uint8_t SdFile::makeDir(SdFile* dir, const char* dirName) {
   if (!SdVolume::cacheRawBlock(block, SdVolume::CACHE_FOR_WRITE)) return false;
 
   // copy '.' to block
-  memcpy(&SdVolume::cacheBuffer_.dir[0], &d, sizeof(d));
+  memcpy(&SdVolume::cacheBuffer_->dir[0], &d, sizeof(d));
 
   // make entry for '..'
   d.name[1] = '.';
@@ -333,7 +400,7 @@ uint8_t SdFile::makeDir(SdFile* dir, const char* dirName) {
     d.firstClusterHigh = dir->firstCluster_ >> 16;
   }
   // copy '..' to block
-  memcpy(&SdVolume::cacheBuffer_.dir[1], &d, sizeof(d));
+  memcpy(&SdVolume::cacheBuffer_->dir[1], &d, sizeof(d));
 
   // set position after '..'
   curPosition_ = 2 * sizeof(d);
@@ -440,7 +507,7 @@ uint8_t SdFile::open(SdFile* dirFile, const char* fileName, uint8_t oflag) {
 
     // use first entry in cluster
     dirIndex_ = 0;
-    p = SdVolume::cacheBuffer_.dir;
+    p = SdVolume::cacheBuffer_->dir;
   }
   // initialize as empty file
   memset(p, 0, sizeof(dir_t));
@@ -508,7 +575,7 @@ uint8_t SdFile::open(SdFile* dirFile, uint16_t index, uint8_t oflag) {
 // open a cached directory entry. Assumes vol_ is initializes
 uint8_t SdFile::openCachedEntry(uint8_t dirIndex, uint8_t oflag) {
   // location of entry in cache
-  dir_t* p = SdVolume::cacheBuffer_.dir + dirIndex;
+  dir_t* p = SdVolume::cacheBuffer_->dir + dirIndex;
 
   // write or truncate is an error for a directory or read-only file
   if (p->attributes & (DIR_ATT_READ_ONLY | DIR_ATT_DIRECTORY)) {
@@ -539,6 +606,14 @@ uint8_t SdFile::openCachedEntry(uint8_t dirIndex, uint8_t oflag) {
   curCluster_ = 0;
   curPosition_ = 0;
 
+  // map the whole chain of a read only file now so that reads and seeks
+  // don't have to load FAT blocks into the cache later
+  extentClear();
+  if (type_ == FAT_FILE_TYPE_NORMAL && !(oflag & O_WRITE) && fileSize_ > 0) {
+    uint32_t lastCluster;
+    extentLookup((fileSize_ - 1) >> (vol_->clusterSizeShift_ + 9), &lastCluster);
+  }
+
   // truncate file to zero length if requested
   if (oflag & O_TRUNC) return truncate(0);
   return true;
@@ -573,6 +648,7 @@ uint8_t SdFile::openRoot(SdVolume* vol) {
   vol_ = vol;
   // read only
   flags_ = O_READ;
+  extentClear();
 
   // set to start of file
   curCluster_ = 0;
@@ -678,36 +754,46 @@ int16_t SdFile::read(void* buf, uint16_t nbyte) {
   while (toRead > 0) {
     uint32_t block;  // raw device block number
     uint16_t offset = curPosition_ & 0X1FF;  // offset in block
-    if (type_ == FAT_FILE_TYPE_ROOT16) {
-      block = vol_->rootDirStart() + (curPosition_ >> 9);
-    } else {
-      uint8_t blockOfCluster = vol_->blockOfCluster(curPosition_);
-      if (offset == 0 && blockOfCluster == 0) {
-        // start of new cluster
-        if (curPosition_ == 0) {
-          // use first cluster in file
-          curCluster_ = firstCluster_;
-        } else {
-          // get next cluster from FAT
-          if (!vol_->fatGet(curCluster_, &curCluster_)) return -1;
+    if (!positionBlock(&curCluster_, &block)) return -1;
+    uint16_t n = toRead;
+
+    // stream whole blocks up to the end of the contiguous cluster run with
+    // one multiple block read instead of a command per block
+    if (offset == 0 && toRead >= 1024 && type_ != FAT_FILE_TYPE_ROOT16) {
+      uint32_t runBlocks = readRunLength(block, toRead >> 9);
+      if (runBlocks > 1) {
+        if (!vol_->readStart(block)) return -1;
+        for (uint32_t i = 0; i < runBlocks; i++) {
+          if (!vol_->readData(dst)) {
+            // end the stream, or the card ignores every later command
+            vol_->readStop();
+            return -1;
+          }
+          dst += 512;
         }
+        if (!vol_->readStop()) return -1;
+
+        // leave curCluster_ at the cluster holding the last block read
+        uint32_t lastBlock = vol_->blockOfCluster(curPosition_) + runBlocks - 1;
+        curCluster_ += lastBlock >> vol_->clusterSizeShift();
+        curPosition_ += runBlocks << 9;
+        toRead -= runBlocks << 9;
+        continue;
       }
-      block = vol_->clusterStartBlock(curCluster_) + blockOfCluster;
     }
-    uint16_t n = toRead;
 
     // amount to be read from current block
     if (n > (512 - offset)) n = 512 - offset;
 
     // no buffering needed if n == 512 or user requests no buffering
     if ((unbufferedRead() || n == 512) &&
-      block != SdVolume::cacheBlockNumber_) {
+      !SdVolume::cacheHolds(block)) {
       if (!vol_->readData(block, offset, n, dst)) return -1;
       dst += n;
     } else {
       // read block to cache and copy data to caller
       if (!SdVolume::cacheRawBlock(block, SdVolume::CACHE_FOR_READ)) return -1;
-      uint8_t* src = SdVolume::cacheBuffer_.data + offset;
+      uint8_t* src = SdVolume::cacheBuffer_->data + offset;
       uint8_t* end = src + n;
       while (src != end) *dst++ = *src++;
     }
@@ -717,6 +803,100 @@ int16_t SdFile::read(void* buf, uint16_t nbyte) {
   return nbyte;
 }
 //------------------------------------------------------------------------------
+/**
+ * Locate the device block holding the current position.
+ *
+ * \param[in,out] cluster On entry the cluster for the current position as
+ * kept in curCluster_.  On exit the cluster holding the current position,
+ * which differs from the entry value when the position is at the start of
+ * a cluster.  Unchanged for a FAT16 root directory.
+ * \param[out] block The raw device block number.
+ *
+ * \return The value one, true, is returned for success and
+ * the value zero, false, is returned for failure.
+ */
+uint8_t SdFile::positionBlock(uint32_t* cluster, uint32_t* block) {
+  if (type_ == FAT_FILE_TYPE_ROOT16) {
+    *block = vol_->rootDirStart() + (curPosition_ >> 9);
+    return true;
+  }
+  uint8_t blockOfCluster = vol_->blockOfCluster(curPosition_);
+  if ((curPosition_ & 0X1FF) == 0 && blockOfCluster == 0) {
+    // start of new cluster
+    if (curPosition_ == 0) {
+      // use first cluster in file
+      *cluster = firstCluster_;
+    } else {
+      // get next cluster from the extent map or FAT
+      uint32_t index = (curPosition_ >> (vol_->clusterSizeShift_ + 9)) - 1;
+      if (!nextCluster(index, *cluster, cluster)) return false;
+    }
+  }
+  *block = vol_->clusterStartBlock(*cluster) + blockOfCluster;
+  return true;
+}
+//------------------------------------------------------------------------------
+/**
+ * Get a pointer to the file data at the current position without copying it.
+ *
+ * The block holding the current position is loaded into the volume cache
+ * and \a ptr is set to the current position inside it.  The file position
+ * is not changed; advance it with seekCur() after using the data.
+ *
+ * \note The pointer is only valid until the next call to the SD library.
+ *
+ * \param[out] ptr Location of the data in the cache.
+ *
+ * \return The number of bytes available at \a ptr, which is never past the
+ * end of the block or of the file, zero at end of file, or -1 if an error
+ * occurs.
+ */
+int16_t SdFile::peekBlock(uint8_t** ptr) {
+  // error if not open or write only
+  if (!isOpen() || !(flags_ & O_READ)) return -1;
+
+  if (curPosition_ >= fileSize_) return 0;
+
+  uint32_t cluster = curCluster_;
+  uint32_t block;
+  if (!positionBlock(&cluster, &block)) return -1;
+  if (!SdVolume::cacheRawBlock(block, SdVolume::CACHE_FOR_READ)) return -1;
+
+  uint16_t offset = curPosition_ & 0X1FF;
+  uint16_t n = 512 - offset;
+  if (n > (fileSize_ - curPosition_)) n = fileSize_ - curPosition_;
+  *ptr = SdVolume::cacheBuffer_->data + offset;
+  return n;
+}
+//------------------------------------------------------------------------------
+/**
+ * Number of blocks, starting with \a block at the current position, that
+ * can be read with one multiple block read.  The run stops at the first
+ * cluster that does not directly follow the previous one in the FAT, at
+ * \a maxBlocks, and before the first block the volume cache holds
+ * a newer, unwritten copy of.
+ *
+ * \return The run length in blocks, zero if an error occurs.
+ */
+uint32_t SdFile::readRunLength(uint32_t block, uint32_t maxBlocks) {
+  uint32_t cluster = curCluster_;
+  uint32_t index = curPosition_ >> (vol_->clusterSizeShift_ + 9);
+  uint32_t runBlocks = vol_->blocksPerCluster() -
+                       vol_->blockOfCluster(curPosition_);
+
+  while (runBlocks < maxBlocks) {
+    uint32_t next;
+    if (!nextCluster(index, cluster, &next)) return 0;
+    if (next != cluster + 1) break;
+    cluster = next;
+    index++;
+    runBlocks += vol_->blocksPerCluster();
+  }
+  if (runBlocks > maxBlocks) runBlocks = maxBlocks;
+
+  return SdVolume::cacheCleanRun(block, runBlocks);
+}
+//------------------------------------------------------------------------------
 /**
  * Read the next directory entry from a directory file.
  *
@@ -761,7 +941,7 @@ dir_t* SdFile::readDirCache(void) {
   curPosition_ += 31;
 
   // return pointer to entry
-  return (SdVolume::cacheBuffer_.dir + i);
+  return (SdVolume::cacheBuffer_->dir + i);
 }
 //------------------------------------------------------------------------------
 /**
@@ -938,6 +1118,12 @@ uint8_t SdFile::seekSet(uint32_t pos) {
   uint32_t nCur = (curPosition_ - 1) >> (vol_->clusterSizeShift_ + 9);
   uint32_t nNew = (pos - 1) >> (vol_->clusterSizeShift_ + 9);
 
+  // the extent map resolves the cluster without walking the FAT
+  if (extentLookup(nNew, &curCluster_)) {
+    curPosition_ = pos;
+    return true;
+  }
+
   if (nNew < nCur || curPosition_ == 0) {
     // must follow chain from first cluster
     curCluster_ = firstCluster_;
@@ -1085,6 +1271,9 @@ uint8_t SdFile::truncate(uint32_t length) {
   // position to last cluster in truncated file
   if (!seekSet(length)) return false;
 
+  // chain is about to shrink
+  extentClear();
+
   if (length == 0) {
     // free all clusters
     if (!vol_->freeChain(firstCluster_)) return false;
@@ -1177,24 +1366,20 @@ size_t SdFile::write(const void* buf, uint16_t nbyte) {
     if (n == 512) {
       // full block - don't need to use cache
       // invalidate cache if block is in cache
-      if (SdVolume::cacheBlockNumber_ == block) {
-        SdVolume::cacheBlockNumber_ = 0XFFFFFFFF;
-      }
+      SdVolume::cacheInvalidate(block);
       if (!vol_->writeBlock(block, src)) goto writeErrorReturn;
       src += 512;
     } else {
       if (blockOffset == 0 && curPosition_ >= fileSize_) {
         // start of new block don't need to read into cache
-        if (!SdVolume::cacheFlush()) goto writeErrorReturn;
-        SdVolume::cacheBlockNumber_ = block;
-        SdVolume::cacheSetDirty();
+        if (!SdVolume::cacheNewBlock(block)) goto writeErrorReturn;
       } else {
         // rewrite part of block
         if (!SdVolume::cacheRawBlock(block, SdVolume::CACHE_FOR_WRITE)) {
           goto writeErrorReturn;
         }
       }
-      uint8_t* dst = SdVolume::cacheBuffer_.data + blockOffset;
+      uint8_t* dst = SdVolume::cacheBuffer_->data + blockOffset;
       uint8_t* end = dst + n;
       while (dst != end) *dst++ = *src++;
     }
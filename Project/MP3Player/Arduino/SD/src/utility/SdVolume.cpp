@@ -22,10 +22,18 @@
 // raw block cache
 // init cacheBlockNumber_to invalid SD block number
 uint32_t SdVolume::cacheBlockNumber_ = 0XFFFFFFFF;
-cache_t  SdVolume::cacheBuffer_;     // 512 byte cache for Sd2Card
+cache_t* SdVolume::cacheBuffer_ = SdVolume::cacheSlot_;  // current cache block
 Sd2Card* SdVolume::sdCard_;          // pointer to SD card object
-uint8_t  SdVolume::cacheDirty_ = 0;  // cacheFlush() will write block if true
-uint32_t SdVolume::cacheMirrorBlock_ = 0;  // mirror  block for second FAT
+uint8_t  SdVolume::cacheCurrent_ = 0;    // slot of cacheBuffer_
+uint8_t  SdVolume::cacheFatSlot_ = 0;    // slot not evicted for non FAT blocks
+uint32_t SdVolume::cacheUseCount_ = 0;   // LRU clock
+uint32_t SdVolume::cacheHits_ = 0;       // lookups found in the cache
+uint32_t SdVolume::cacheMisses_ = 0;     // lookups that read the card
+cache_t  SdVolume::cacheSlot_[SD_CACHE_BLOCK_COUNT];      // 512 byte blocks
+uint32_t SdVolume::cacheSlotBlock_[SD_CACHE_BLOCK_COUNT];   // set by init()
+uint32_t SdVolume::cacheSlotMirror_[SD_CACHE_BLOCK_COUNT];  // mirror FAT block
+uint32_t SdVolume::cacheSlotUse_[SD_CACHE_BLOCK_COUNT];     // last use time
+uint8_t  SdVolume::cacheSlotDirty_[SD_CACHE_BLOCK_COUNT];   // write if true
 //------------------------------------------------------------------------------
 // find a contiguous group of clusters
 uint8_t SdVolume::allocContiguous(uint32_t count, uint32_t* curCluster) {
@@ -96,46 +104,146 @@ uint8_t SdVolume::allocContiguous(uint32_t count, uint32_t* curCluster) {
   return true;
 }
 //------------------------------------------------------------------------------
-uint8_t SdVolume::cacheFlush(void) {
-  if (cacheDirty_) {
-    if (!sdCard_->writeBlock(cacheBlockNumber_, cacheBuffer_.data)) {
+/** Write all dirty cache blocks to the card and return a pointer to a
+ *  cleared cache block.  Used by the WaveRP recorder to do raw write to
+ *  the SD card.  Not for normal apps.
+ */
+uint8_t* SdVolume::cacheClear(void) {
+  cacheFlush();
+  for (uint8_t i = 0; i < SD_CACHE_BLOCK_COUNT; i++) {
+    cacheSlotBlock_[i] = 0XFFFFFFFF;
+  }
+  cacheSelect(0);
+  return cacheBuffer_->data;
+}
+//------------------------------------------------------------------------------
+// index of the slot holding blockNumber or -1 if it is not cached
+int8_t SdVolume::cacheFind(uint32_t blockNumber) {
+  for (uint8_t i = 0; i < SD_CACHE_BLOCK_COUNT; i++) {
+    if (cacheSlotBlock_[i] == blockNumber) return i;
+  }
+  return -1;
+}
+//------------------------------------------------------------------------------
+// make slot the current cache block
+uint8_t SdVolume::cacheSelect(uint8_t slot) {
+  cacheCurrent_ = slot;
+  cacheBuffer_ = &cacheSlot_[slot];
+  cacheBlockNumber_ = cacheSlotBlock_[slot];
+  cacheSlotUse_[slot] = ++cacheUseCount_;
+  return true;
+}
+//------------------------------------------------------------------------------
+// pick a slot to reuse: an empty slot, otherwise the least recently used
+// one that is not holding the FAT block in use
+uint8_t SdVolume::cacheVictim(void) {
+  uint8_t victim = SD_CACHE_BLOCK_COUNT;
+  for (uint8_t i = 0; i < SD_CACHE_BLOCK_COUNT; i++) {
+    if (cacheSlotBlock_[i] == 0XFFFFFFFF) return i;
+    if (i == cacheFatSlot_ && SD_CACHE_BLOCK_COUNT > 1) continue;
+    if (victim == SD_CACHE_BLOCK_COUNT ||
+      (int32_t)(cacheSlotUse_[i] - cacheSlotUse_[victim]) < 0) {
+      victim = i;
+    }
+  }
+  return victim;
+}
+//------------------------------------------------------------------------------
+// write a dirty slot and its FAT mirror to the card
+uint8_t SdVolume::cacheWriteBack(uint8_t slot) {
+  if (cacheSlotDirty_[slot]) {
+    if (!sdCard_->writeBlock(cacheSlotBlock_[slot], cacheSlot_[slot].data)) {
       return false;
     }
     // mirror FAT tables
-    if (cacheMirrorBlock_) {
-      if (!sdCard_->writeBlock(cacheMirrorBlock_, cacheBuffer_.data)) {
+    if (cacheSlotMirror_[slot]) {
+      if (!sdCard_->writeBlock(cacheSlotMirror_[slot], cacheSlot_[slot].data)) {
         return false;
       }
-      cacheMirrorBlock_ = 0;
+      cacheSlotMirror_[slot] = 0;
     }
-    cacheDirty_ = 0;
+    cacheSlotDirty_[slot] = 0;
+  }
+  return true;
+}
+//------------------------------------------------------------------------------
+uint8_t SdVolume::cacheFlush(void) {
+  for (uint8_t i = 0; i < SD_CACHE_BLOCK_COUNT; i++) {
+    if (!cacheWriteBack(i)) return false;
   }
   return true;
 }
 //------------------------------------------------------------------------------
 uint8_t SdVolume::cacheRawBlock(uint32_t blockNumber, uint8_t action) {
-  if (cacheBlockNumber_ != blockNumber) {
-    if (!cacheFlush()) return false;
-    if (!sdCard_->readBlock(blockNumber, cacheBuffer_.data)) return false;
-    cacheBlockNumber_ = blockNumber;
+  int8_t slot = cacheFind(blockNumber);
+  if (slot >= 0) {
+    cacheHits_++;
+  } else {
+    cacheMisses_++;
+    slot = cacheVictim();
+    if (!cacheWriteBack(slot)) return false;
+    cacheSlotBlock_[slot] = 0XFFFFFFFF;
+    if (slot == cacheCurrent_) cacheBlockNumber_ = 0XFFFFFFFF;
+    if (!sdCard_->readBlock(blockNumber, cacheSlot_[slot].data)) return false;
+    cacheSlotBlock_[slot] = blockNumber;
+  }
+  cacheSelect(slot);
+  cacheSlotDirty_[slot] |= action;
+  return true;
+}
+//------------------------------------------------------------------------------
+// make blockNumber the current cache block, without reading the card, for
+// a block that is about to be overwritten.  The block is marked dirty.
+uint8_t SdVolume::cacheNewBlock(uint32_t blockNumber) {
+  int8_t slot = cacheFind(blockNumber);
+  if (slot < 0) {
+    slot = cacheVictim();
+    if (!cacheWriteBack(slot)) return false;
+    cacheSlotBlock_[slot] = blockNumber;
   }
-  cacheDirty_ |= action;
+  cacheSelect(slot);
+  cacheSetDirty();
   return true;
 }
 //------------------------------------------------------------------------------
 // cache a zero block for blockNumber
 uint8_t SdVolume::cacheZeroBlock(uint32_t blockNumber) {
-  if (!cacheFlush()) return false;
+  if (!cacheNewBlock(blockNumber)) return false;
 
-  // loop take less flash than memset(cacheBuffer_.data, 0, 512);
+  // loop take less flash than memset(cacheBuffer_->data, 0, 512);
   for (uint16_t i = 0; i < 512; i++) {
-    cacheBuffer_.data[i] = 0;
+    cacheBuffer_->data[i] = 0;
   }
-  cacheBlockNumber_ = blockNumber;
-  cacheSetDirty();
   return true;
 }
 //------------------------------------------------------------------------------
+// true if blockNumber is in the cache
+uint8_t SdVolume::cacheHolds(uint32_t blockNumber) {
+  return cacheFind(blockNumber) >= 0;
+}
+//------------------------------------------------------------------------------
+// drop blockNumber from the cache without writing it, the caller is
+// replacing the block on the card
+void SdVolume::cacheInvalidate(uint32_t blockNumber) {
+  int8_t slot = cacheFind(blockNumber);
+  if (slot < 0) return;
+  cacheSlotBlock_[slot] = 0XFFFFFFFF;
+  cacheSlotDirty_[slot] = 0;
+  cacheSlotMirror_[slot] = 0;
+  if (slot == cacheCurrent_) cacheBlockNumber_ = 0XFFFFFFFF;
+}
+//------------------------------------------------------------------------------
+// number of blocks starting at blockNumber, up to count, that can be read
+// from the card directly because the cache holds no newer copy of them
+uint32_t SdVolume::cacheCleanRun(uint32_t blockNumber, uint32_t count) {
+  for (uint8_t i = 0; i < SD_CACHE_BLOCK_COUNT; i++) {
+    if (cacheSlotDirty_[i] && (cacheSlotBlock_[i] - blockNumber) < count) {
+      count = cacheSlotBlock_[i] - blockNumber;
+    }
+  }
+  return count;
+}
+//------------------------------------------------------------------------------
 // return the size in bytes of a cluster chain
 uint8_t SdVolume::chainSize(uint32_t cluster, uint32_t* size) const {
   uint32_t s = 0;
@@ -152,13 +260,12 @@ uint8_t SdVolume::fatGet(uint32_t cluster, uint32_t* value) const {
   if (cluster > (clusterCount_ + 1)) return false;
   uint32_t lba = fatStartBlock_;
   lba += fatType_ == 16 ? cluster >> 8 : cluster >> 7;
-  if (lba != cacheBlockNumber_) {
-    if (!cacheRawBlock(lba, CACHE_FOR_READ)) return false;
-  }
+  if (!cacheRawBlock(lba, CACHE_FOR_READ)) return false;
+  cacheFatSlot_ = cacheCurrent_;
   if (fatType_ == 16) {
-    *value = cacheBuffer_.fat16[cluster & 0XFF];
+    *value = cacheBuffer_->fat16[cluster & 0XFF];
   } else {
-    *value = cacheBuffer_.fat32[cluster & 0X7F] & FAT32MASK;
+    *value = cacheBuffer_->fat32[cluster & 0X7F] & FAT32MASK;
   }
   return true;
 }
@@ -175,19 +282,18 @@ uint8_t SdVolume::fatPut(uint32_t cluster, uint32_t value) {
   uint32_t lba = fatStartBlock_;
   lba += fatType_ == 16 ? cluster >> 8 : cluster >> 7;
 
-  if (lba != cacheBlockNumber_) {
-    if (!cacheRawBlock(lba, CACHE_FOR_READ)) return false;
-  }
+  if (!cacheRawBlock(lba, CACHE_FOR_READ)) return false;
+  cacheFatSlot_ = cacheCurrent_;
   // store entry
   if (fatType_ == 16) {
-    cacheBuffer_.fat16[cluster & 0XFF] = value;
+    cacheBuffer_->fat16[cluster & 0XFF] = value;
   } else {
-    cacheBuffer_.fat32[cluster & 0X7F] = value;
+    cacheBuffer_->fat32[cluster & 0X7F] = value;
   }
   cacheSetDirty();
 
-  // mirror second FAT
-  if (fatCount_ > 1) cacheMirrorBlock_ = lba + blocksPerFat_;
+  // mirror second FAT when the block is written back
+  if (fatCount_ > 1) cacheSlotMirror_[cacheCurrent_] = lba + blocksPerFat_;
   return true;
 }
 //------------------------------------------------------------------------------
@@ -227,12 +333,20 @@ uint8_t SdVolume::freeChain(uint32_t cluster) {
 uint8_t SdVolume::init(Sd2Card* dev, uint8_t part) {
   uint32_t volumeStartBlock = 0;
   sdCard_ = dev;
+
+  // start with an empty cache
+  for (uint8_t i = 0; i < SD_CACHE_BLOCK_COUNT; i++) {
+    cacheSlotBlock_[i] = 0XFFFFFFFF;
+    cacheSlotDirty_[i] = 0;
+    cacheSlotMirror_[i] = 0;
+  }
+  cacheSelect(0);
   // if part == 0 assume super floppy with FAT boot sector in block zero
   // if part > 0 assume mbr volume with partition table
   if (part) {
     if (part > 4)return false;
     if (!cacheRawBlock(volumeStartBlock, CACHE_FOR_READ)) return false;
-    part_t* p = &cacheBuffer_.mbr.part[part-1];
+    part_t* p = &cacheBuffer_->mbr.part[part-1];
     if ((p->boot & 0X7F) !=0  ||
       p->totalSectors < 100 ||
       p->firstSector == 0) {
@@ -242,7 +356,7 @@ uint8_t SdVolume::init(Sd2Card* dev, uint8_t part) {
     volumeStartBlock = p->firstSector;
   }
   if (!cacheRawBlock(volumeStartBlock, CACHE_FOR_READ)) return false;
-  bpb_t* bpb = &cacheBuffer_.fbs.bpb;
+  bpb_t* bpb = &cacheBuffer_->fbs.bpb;
   if (bpb->bytesPerSector != 512 ||
     bpb->fatCount == 0 ||
     bpb->reservedSectorCount == 0 ||
@@ -10,7 +10,7 @@
 
 #include "bsp.h"
 
-
+static OS_EVENT *touchIntSem = 0;  // posted when the touch INT line goes low
 
 // Initializes GPIO pins for the ILI9341 LCD device.
 void BspLcdInitILI9341()
@@ -39,4 +39,74 @@ void BspLcdInitILI9341()
     GPIO_InitStruct.GPIO_PuPd = GPIO_PuPd_UP;
      
     GPIO_Init(LCD_ILI9341_DC_GPIO, &GPIO_InitStruct);
-}
\ No newline at end of file
+}
+
+
+// Configures the FT6206 INT pin (PB4) as an input and routes it to EXTI
+// line 4 as a falling edge interrupt that posts the given semaphore. The
+// line stays masked until BspTouchArmInterrupt() is called.
+void BspTouchInitInterrupt(OS_EVENT *sem)
+{
+    GPIO_InitTypeDef GPIO_InitStruct;
+    EXTI_InitTypeDef EXTI_InitStruct;
+    
+    touchIntSem = sem;
+    
+    RCC_AHB1PeriphClockCmd(RCC_AHB1Periph_GPIOB, ENABLE);
+    
+    GPIO_InitStruct.GPIO_Pin = TOUCH_FT6206_INT_GPIO_Pin;
+    GPIO_InitStruct.GPIO_Mode = GPIO_Mode_IN;
+    GPIO_InitStruct.GPIO_Speed = GPIO_Speed_50MHz;
+    GPIO_InitStruct.GPIO_OType = GPIO_OType_PP;
+    GPIO_InitStruct.GPIO_PuPd = GPIO_PuPd_UP;
+    
+    GPIO_Init(TOUCH_FT6206_INT_GPIO, &GPIO_InitStruct);
+    
+    SYSCFG_EXTILineConfig(TOUCH_FT6206_INT_EXTI_PORT, TOUCH_FT6206_INT_EXTI_PIN);
+    
+    EXTI_InitStruct.EXTI_Line = TOUCH_FT6206_INT_EXTI_LINE;
+    EXTI_InitStruct.EXTI_Mode = EXTI_Mode_Interrupt;
+    EXTI_InitStruct.EXTI_Trigger = EXTI_Trigger_Falling;
+    EXTI_InitStruct.EXTI_LineCmd = ENABLE;
+    EXTI_Init(&EXTI_InitStruct);
+    
+    BspTouchDisarmInterrupt();
+    
+    NVIC_EnableIRQ(TOUCH_FT6206_INT_IRQn);
+}
+
+// Clears any stale edge and unmasks the touch interrupt for one shot.
+void BspTouchArmInterrupt()
+{
+    EXTI_ClearITPendingBit(TOUCH_FT6206_INT_EXTI_LINE);
+    EXTI->IMR |= TOUCH_FT6206_INT_EXTI_LINE;
+}
+
+// Masks the touch interrupt.
+void BspTouchDisarmInterrupt()
+{
+    EXTI->IMR &= ~TOUCH_FT6206_INT_EXTI_LINE;
+    EXTI_ClearITPendingBit(TOUCH_FT6206_INT_EXTI_LINE);
+}
+
+// The touch INT line went low: a finger is on the panel.
+// Masks the line again (one shot) and wakes the touch task.
+void EXTI4IrqHandler(void)
+{
+    OS_CPU_SR cpu_sr;
+    
+    OS_ENTER_CRITICAL();
+    OSIntNesting++;
+    OS_EXIT_CRITICAL();
+    APP_ISR_ENTER();
+    
+    if (EXTI_GetITStatus(TOUCH_FT6206_INT_EXTI_LINE) != RESET)
+    {
+        EXTI->IMR &= ~TOUCH_FT6206_INT_EXTI_LINE;
+        EXTI_ClearITPendingBit(TOUCH_FT6206_INT_EXTI_LINE);
+        if (touchIntSem != 0) OSSemPost(touchIntSem);
+    }
+    
+    APP_ISR_EXIT();
+    OSIntExit();
+}
@@ -26,10 +26,32 @@
 #define LCD_ILI9341_DC_LOW()        GPIO_ResetBits(LCD_ILI9341_DC_GPIO, LCD_ILI9341_DC_GPIO_Pin);
 #define LCD_ILI9341_DC_HIGH()       GPIO_SetBits(LCD_ILI9341_DC_GPIO, LCD_ILI9341_DC_GPIO_Pin);
 
+// FT6206 touch controller INT output (active low), jumpered to PB4 (Arduino D5)
+#define TOUCH_FT6206_INT_GPIO             GPIOB
+#define TOUCH_FT6206_INT_GPIO_Pin         GPIO_Pin_4
+#define TOUCH_FT6206_INT_EXTI_PORT        EXTI_PortSourceGPIOB
+#define TOUCH_FT6206_INT_EXTI_PIN         EXTI_PinSource4
+#define TOUCH_FT6206_INT_EXTI_LINE        EXTI_Line4
+#define TOUCH_FT6206_INT_IRQn             EXTI4_IRQn
+
+#define TOUCH_FT6206_INT_ASSERTED()  (GPIO_ReadInputDataBit(TOUCH_FT6206_INT_GPIO, TOUCH_FT6206_INT_GPIO_Pin) == Bit_RESET)
+
 #define LCD_SPI_DEVICE_ID  PJDF_DEVICE_ID_SPI1
 
 #define LCD_SPI_DATARATE  SPI_BaudRatePrescaler_2  // Tune to find optimal value LCD controller will work with
 
 void BspLcdInitILI9341();
+void BspTouchInitInterrupt(OS_EVENT *sem);
+void BspTouchArmInterrupt();
+void BspTouchDisarmInterrupt();
+
+// Touch INT interrupt service routine, overrides the weak symbol in startup.s
+#ifdef __cplusplus
+extern "C" {
+#endif
+void EXTI4IrqHandler(void);
+#ifdef __cplusplus
+}
+#endif
 
 #endif
\ No newline at end of file
@@ -32,6 +32,9 @@ const INT8U BspMp3SetVol1010Len = sizeof(BspMp3SetVol1010);
 const INT8U BspMp3SetVol6060Len = sizeof(BspMp3SetVol6060);
 const INT8U BspMp3ReadVolLen = sizeof(BspMp3ReadVol);
 
+// Semaphore posted by the DREQ interrupt, owned by the MP3 driver
+static OS_EVENT *dreqSem = 0;
+
 
 
 
@@ -73,4 +76,64 @@ void BspMp3InitVS1053()
     GPIO_InitStruct.GPIO_PuPd = GPIO_PuPd_DOWN;
      
     GPIO_Init(MP3_VS1053_DREQ_GPIO, &GPIO_InitStruct);
-}
\ No newline at end of file
+}
+
+
+// Routes DREQ (PB3) to EXTI line 3 as a rising edge interrupt that posts
+// the given semaphore. The line is left masked until BspMp3ArmDreqInterrupt()
+// is called, so that DREQ toggling during normal playback costs nothing
+// unless a task is actually waiting on it.
+void BspMp3InitDreqInterrupt(OS_EVENT *sem)
+{
+    EXTI_InitTypeDef EXTI_InitStruct;
+    
+    dreqSem = sem;
+    
+    SYSCFG_EXTILineConfig(MP3_VS1053_DREQ_EXTI_PORT, MP3_VS1053_DREQ_EXTI_PIN);
+    
+    EXTI_InitStruct.EXTI_Line = MP3_VS1053_DREQ_EXTI_LINE;
+    EXTI_InitStruct.EXTI_Mode = EXTI_Mode_Interrupt;
+    EXTI_InitStruct.EXTI_Trigger = EXTI_Trigger_Rising;
+    EXTI_InitStruct.EXTI_LineCmd = ENABLE;
+    EXTI_Init(&EXTI_InitStruct);
+    
+    BspMp3DisarmDreqInterrupt();
+    
+    NVIC_EnableIRQ(MP3_VS1053_DREQ_IRQn);
+}
+
+// Clears any stale edge and unmasks the DREQ interrupt for one shot.
+void BspMp3ArmDreqInterrupt()
+{
+    EXTI_ClearITPendingBit(MP3_VS1053_DREQ_EXTI_LINE);
+    EXTI->IMR |= MP3_VS1053_DREQ_EXTI_LINE;
+}
+
+// Masks the DREQ interrupt.
+void BspMp3DisarmDreqInterrupt()
+{
+    EXTI->IMR &= ~MP3_VS1053_DREQ_EXTI_LINE;
+    EXTI_ClearITPendingBit(MP3_VS1053_DREQ_EXTI_LINE);
+}
+
+// DREQ went high: the VS1053 can accept another 32 bytes.
+// Masks the line again (one shot) and wakes the waiting driver.
+void EXTI3IrqHandler(void)
+{
+    OS_CPU_SR cpu_sr;
+    
+    OS_ENTER_CRITICAL();
+    OSIntNesting++;
+    OS_EXIT_CRITICAL();
+    APP_ISR_ENTER();
+    
+    if (EXTI_GetITStatus(MP3_VS1053_DREQ_EXTI_LINE) != RESET)
+    {
+        EXTI->IMR &= ~MP3_VS1053_DREQ_EXTI_LINE;
+        EXTI_ClearITPendingBit(MP3_VS1053_DREQ_EXTI_LINE);
+        if (dreqSem != 0) OSSemPost(dreqSem);
+    }
+    
+    APP_ISR_EXIT();
+    OSIntExit();
+}
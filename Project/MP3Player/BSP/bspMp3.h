@@ -22,6 +22,14 @@
 #define MP3_VS1053_DREQ_GPIO               GPIOB
 #define MP3_VS1053_DREQ_GPIO_Pin           GPIO_Pin_3
 
+// DREQ on PB3 is routed to EXTI line 3
+#define MP3_VS1053_DREQ_EXTI_PORT          EXTI_PortSourceGPIOB
+#define MP3_VS1053_DREQ_EXTI_PIN           EXTI_PinSource3
+#define MP3_VS1053_DREQ_EXTI_LINE          EXTI_Line3
+#define MP3_VS1053_DREQ_IRQn               EXTI3_IRQn
+
+#define MP3_DREQ_WAIT_TIMEOUT  2     // ticks to pend on the DREQ semaphore before re-checking the pin
+
 #define MP3_VS1053_MCS_ASSERT()       GPIO_ResetBits(MP3_VS1053_MCS_GPIO, MP3_VS1053_MCS_GPIO_Pin);
 #define MP3_VS1053_MCS_DEASSERT()      GPIO_SetBits(MP3_VS1053_MCS_GPIO, MP3_VS1053_MCS_GPIO_Pin);
 
@@ -31,6 +39,11 @@
 
 #define MP3_DECODER_BUF_SIZE       32    // number of bytes to stream at one time to the decoder
 
+#define MP3_STREAM_SECTOR_SIZE     512   // size of an SD card block
+#define MP3_STREAM_SECTORS_PER_BUF 4     // SD blocks per streaming buffer, read with one multiple block command
+#define MP3_STREAM_BUF_SIZE        (MP3_STREAM_SECTOR_SIZE * MP3_STREAM_SECTORS_PER_BUF)
+#define MP3_STREAM_BUF_COUNT       4     // number of sector buffers between the SD reader and decoder feeder
+
 #define MP3_SPI_DEVICE_ID  PJDF_DEVICE_ID_SPI1
 
 #define MP3_SPI_DATARATE  SPI_BaudRatePrescaler_16  // Tune to find optimal value MP3 decoder will work with
@@ -59,5 +72,17 @@ extern const INT8U BspMp3ReadVolLen;
 
 
 void BspMp3InitVS1053();
+void BspMp3InitDreqInterrupt(OS_EVENT *sem);
+void BspMp3ArmDreqInterrupt();
+void BspMp3DisarmDreqInterrupt();
+
+// DREQ rising edge interrupt service routine, overrides the weak symbol in startup.s
+#ifdef __cplusplus
+extern "C" {
+#endif
+void EXTI3IrqHandler(void);
+#ifdef __cplusplus
+}
+#endif
 
 #endif
\ No newline at end of file
@@ -10,6 +10,12 @@
 
 #include "bsp.h"
 
+static OS_EVENT *spiDmaIdleSem = 0;  // posted whenever a DMA transfer finishes
+static OS_EVENT *spiDmaDoneSem = 0;  // optional per-transfer completion semaphore
+static uint16_t spiDmaDummy;         // sink for received data of a write-only transfer
+
+INT32U SPI_DMAErrors = 0;  // number of DMA transfer errors seen by the ISR
+
 // BspSPI1Init
 // Initializes the SPI1 memory mapped register block and enables it for use
 // as a master SPI device.
@@ -93,3 +99,161 @@ void SPI_SetDataRate(SPI_TypeDef *spi, uint16_t value)
   spi->CR1 = tmpreg;  // write back the register
 }
 
+
+// SPI_SetFrame16
+// Switches the given SPI interface between 8 and 16 bit frames. DFF may only
+// change while the interface is disabled, so wait for the bus to go idle first.
+static void SPI_SetFrame16(SPI_TypeDef *spi, BOOLEAN wide)
+{
+    while (spi->SR & SPI_SR_BSY);
+    spi->CR1 &= ~SPI_CR1_SPE;
+    if (wide)
+        spi->CR1 |= SPI_CR1_DFF;
+    else
+        spi->CR1 &= ~SPI_CR1_DFF;
+    spi->CR1 |= SPI_CR1_SPE;
+}
+
+// SPI_FillBuffer
+// Sends count copies of the 16 bit value, most significant byte first.
+// Runs in 16 bit frames and only waits for TXE, dropping received data, so
+// the bus is kept busy without per-byte bookkeeping.
+void SPI_FillBuffer(SPI_TypeDef *spi, uint16_t value, uint32_t count)
+{
+    SPI_SetFrame16(spi, OS_TRUE);
+    while (count--) {
+        while (!(spi->SR & SPI_SR_TXE));
+        spi->DR = value;
+    }
+    while (!(spi->SR & SPI_SR_TXE));
+    while (spi->SR & SPI_SR_BSY);
+    (void) spi->DR; // clear RXNE and the overrun flag
+    (void) spi->SR;
+    SPI_SetFrame16(spi, OS_FALSE);
+}
+
+// BspSPI1InitDMA
+// Enables the DMA2 streams that serve SPI1 and the transfer complete
+// interrupt. idleSem is posted at the end of every DMA transfer.
+void BspSPI1InitDMA(OS_EVENT *idleSem)
+{
+    spiDmaIdleSem = idleSem;
+    
+    RCC_AHB1PeriphClockCmd(RCC_AHB1Periph_DMA2, ENABLE);
+    
+    SPI1_DMA_RX_STREAM->CR = 0;
+    SPI1_DMA_TX_STREAM->CR = 0;
+    DMA2->LIFCR = SPI1_DMA_RX_FLAGS | SPI1_DMA_TX_FLAGS;
+    
+    NVIC_EnableIRQ(SPI1_DMA_IRQn);
+}
+
+// SPI_StartDMA
+// Starts a full duplex DMA transfer of the given buffer on SPI1 and returns
+// without waiting. Completion is signalled from DMA2Stream0IrqHandler().
+// buffer: the data to send. If receive is true the buffer is OVERWRITTEN
+//    with the data output by the device, otherwise received bytes are dropped.
+//    The buffer must stay valid until the transfer completes.
+// doneSem: semaphore to post on completion, may be NULL
+void SPI_StartDMA(SPI_TypeDef *spi, uint8_t *buffer, uint16_t bufLength, BOOLEAN receive, OS_EVENT *doneSem)
+{
+    if (spi != SPI1) while(1); // only SPI1 has DMA streams assigned
+    
+    spiDmaDoneSem = doneSem;
+    
+    // Streams must be disabled before they can be reprogrammed
+    SPI1_DMA_RX_STREAM->CR &= ~DMA_SxCR_EN;
+    SPI1_DMA_TX_STREAM->CR &= ~DMA_SxCR_EN;
+    while ((SPI1_DMA_RX_STREAM->CR | SPI1_DMA_TX_STREAM->CR) & DMA_SxCR_EN);
+    DMA2->LIFCR = SPI1_DMA_RX_FLAGS | SPI1_DMA_TX_FLAGS;
+    
+    /*-------- Receive stream, peripheral to memory. Finishes last so it raises the interrupt --------*/
+    SPI1_DMA_RX_STREAM->PAR = (uint32_t)(uintptr_t) &spi->DR;
+    SPI1_DMA_RX_STREAM->NDTR = bufLength;
+    if (receive) {
+        SPI1_DMA_RX_STREAM->M0AR = (uint32_t)(uintptr_t) buffer;
+        SPI1_DMA_RX_STREAM->CR = SPI1_DMA_CHANNEL | DMA_SxCR_PL_1 | DMA_SxCR_MINC | DMA_SxCR_TCIE | DMA_SxCR_TEIE;
+    } else {
+        SPI1_DMA_RX_STREAM->M0AR = (uint32_t)(uintptr_t) &spiDmaDummy;
+        SPI1_DMA_RX_STREAM->CR = SPI1_DMA_CHANNEL | DMA_SxCR_PL_1 | DMA_SxCR_TCIE | DMA_SxCR_TEIE;
+    }
+    
+    /*-------- Transmit stream, memory to peripheral --------*/
+    SPI1_DMA_TX_STREAM->PAR = (uint32_t)(uintptr_t) &spi->DR;
+    SPI1_DMA_TX_STREAM->M0AR = (uint32_t)(uintptr_t) buffer;
+    SPI1_DMA_TX_STREAM->NDTR = bufLength;
+    SPI1_DMA_TX_STREAM->CR = SPI1_DMA_CHANNEL | DMA_SxCR_PL_0 | DMA_SxCR_MINC | DMA_SxCR_DIR_0;
+    
+    SPI1_DMA_RX_STREAM->CR |= DMA_SxCR_EN;
+    SPI1_DMA_TX_STREAM->CR |= DMA_SxCR_EN;
+    spi->CR2 |= SPI_CR2_RXDMAEN | SPI_CR2_TXDMAEN;
+}
+
+// SPI_StartDMAFill
+// Starts a DMA transfer on SPI1 that sends count copies of the 16 bit value,
+// most significant byte first, and returns without waiting. The transmit
+// stream reads a fixed (non-incrementing) source address, so one transfer
+// covers up to SPI_DMA_MAX_LENGTH frames. The interface runs in 16 bit frames
+// until DMA2Stream0IrqHandler() switches it back to 8 bits.
+// value: must stay valid until the transfer completes
+// doneSem: semaphore to post on completion, may be NULL
+void SPI_StartDMAFill(SPI_TypeDef *spi, uint16_t *value, uint16_t count, OS_EVENT *doneSem)
+{
+    if (spi != SPI1) while(1); // only SPI1 has DMA streams assigned
+    
+    spiDmaDoneSem = doneSem;
+    
+    SPI1_DMA_RX_STREAM->CR &= ~DMA_SxCR_EN;
+    SPI1_DMA_TX_STREAM->CR &= ~DMA_SxCR_EN;
+    while ((SPI1_DMA_RX_STREAM->CR | SPI1_DMA_TX_STREAM->CR) & DMA_SxCR_EN);
+    DMA2->LIFCR = SPI1_DMA_RX_FLAGS | SPI1_DMA_TX_FLAGS;
+    
+    SPI_SetFrame16(spi, OS_TRUE);
+    
+    /*-------- Receive stream, received frames are dropped --------*/
+    SPI1_DMA_RX_STREAM->PAR = (uint32_t)(uintptr_t) &spi->DR;
+    SPI1_DMA_RX_STREAM->M0AR = (uint32_t)(uintptr_t) &spiDmaDummy;
+    SPI1_DMA_RX_STREAM->NDTR = count;
+    SPI1_DMA_RX_STREAM->CR = SPI1_DMA_CHANNEL | DMA_SxCR_PL_1 | DMA_SxCR_PSIZE_0 | DMA_SxCR_MSIZE_0 | DMA_SxCR_TCIE | DMA_SxCR_TEIE;
+    
+    /*-------- Transmit stream, fixed memory source to peripheral --------*/
+    SPI1_DMA_TX_STREAM->PAR = (uint32_t)(uintptr_t) &spi->DR;
+    SPI1_DMA_TX_STREAM->M0AR = (uint32_t)(uintptr_t) value;
+    SPI1_DMA_TX_STREAM->NDTR = count;
+    SPI1_DMA_TX_STREAM->CR = SPI1_DMA_CHANNEL | DMA_SxCR_PL_0 | DMA_SxCR_PSIZE_0 | DMA_SxCR_MSIZE_0 | DMA_SxCR_DIR_0;
+    
+    SPI1_DMA_RX_STREAM->CR |= DMA_SxCR_EN;
+    SPI1_DMA_TX_STREAM->CR |= DMA_SxCR_EN;
+    spi->CR2 |= SPI_CR2_RXDMAEN | SPI_CR2_TXDMAEN;
+}
+
+// DMA2Stream0IrqHandler
+// The last byte of a SPI1 DMA transfer has been received, so the bus is idle.
+void DMA2Stream0IrqHandler(void)
+{
+    OS_CPU_SR cpu_sr;
+    INT32U status;
+    
+    OS_ENTER_CRITICAL();
+    OSIntNesting++;
+    OS_EXIT_CRITICAL();
+    APP_ISR_ENTER();
+    
+    status = DMA2->LISR;
+    if (status & (DMA_LISR_TCIF0 | DMA_LISR_TEIF0))
+    {
+        if (status & DMA_LISR_TEIF0) SPI_DMAErrors++;
+        
+        SPI1->CR2 &= ~(SPI_CR2_RXDMAEN | SPI_CR2_TXDMAEN);
+        SPI1_DMA_RX_STREAM->CR &= ~DMA_SxCR_EN;
+        SPI1_DMA_TX_STREAM->CR &= ~DMA_SxCR_EN;
+        DMA2->LIFCR = SPI1_DMA_RX_FLAGS | SPI1_DMA_TX_FLAGS;
+        if (SPI1->CR1 & SPI_CR1_DFF) SPI_SetFrame16(SPI1, OS_FALSE); // end of a fill
+        
+        if (spiDmaDoneSem != 0) OSSemPost(spiDmaDoneSem);
+        if (spiDmaIdleSem != 0) OSSemPost(spiDmaIdleSem);
+    }
+    
+    APP_ISR_EXIT();
+    OSIntExit();
+}
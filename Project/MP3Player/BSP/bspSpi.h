@@ -15,11 +15,43 @@
 
 #define PJDF_SPI1 SPI1 // Address of SPI1 memory mapped register block
 
+// SPI1 DMA request mapping (DMA2, channel 3)
+#define SPI1_DMA_RX_STREAM     DMA2_Stream0
+#define SPI1_DMA_TX_STREAM     DMA2_Stream3
+#define SPI1_DMA_CHANNEL       (DMA_SxCR_CHSEL_0 | DMA_SxCR_CHSEL_1)
+#define SPI1_DMA_IRQn          DMA2_Stream0_IRQn
+
+#define SPI1_DMA_RX_FLAGS      (DMA_LIFCR_CTCIF0 | DMA_LIFCR_CHTIF0 | DMA_LIFCR_CTEIF0 | DMA_LIFCR_CDMEIF0 | DMA_LIFCR_CFEIF0)
+#define SPI1_DMA_TX_FLAGS      (DMA_LIFCR_CTCIF3 | DMA_LIFCR_CHTIF3 | DMA_LIFCR_CTEIF3 | DMA_LIFCR_CDMEIF3 | DMA_LIFCR_CFEIF3)
+
+#define SPI_DMA_MIN_LENGTH     16      // transfers shorter than this are cheaper to poll
+#define SPI_DMA_MAX_LENGTH     0xFFFF  // limit of the DMA NDTR register
+#define SPI_FILL_SLICE_LENGTH  4096    // 16 bit values a fill sends before checking for a reserved waiter (about 8 ms at 8 MHz)
+
+#if SPI_FILL_SLICE_LENGTH > SPI_DMA_MAX_LENGTH
+#error "SPI_FILL_SLICE_LENGTH must fit in one DMA transfer"
+#endif
+
 // Application interface to hardware
 
 void BspSPI1Init();
 void SPI_SendBuffer(SPI_TypeDef *spi, uint8_t *buffer, uint16_t bufLength);
 void SPI_GetBuffer(SPI_TypeDef *spi, uint8_t *buffer, uint16_t bufLength);
 void SPI_SetDataRate(SPI_TypeDef *spi, uint16_t value);
+void BspSPI1InitDMA(OS_EVENT *idleSem);
+void SPI_StartDMA(SPI_TypeDef *spi, uint8_t *buffer, uint16_t bufLength, BOOLEAN receive, OS_EVENT *doneSem);
+void SPI_FillBuffer(SPI_TypeDef *spi, uint16_t value, uint32_t count);
+void SPI_StartDMAFill(SPI_TypeDef *spi, uint16_t *value, uint16_t count, OS_EVENT *doneSem);
+
+extern INT32U SPI_DMAErrors;
+
+// SPI1 DMA receive complete interrupt service routine, overrides the weak symbol in startup.s
+#ifdef __cplusplus
+extern "C" {
+#endif
+void DMA2Stream0IrqHandler(void);
+#ifdef __cplusplus
+}
+#endif
 
 #endif /* __SPI_H */
\ No newline at end of file
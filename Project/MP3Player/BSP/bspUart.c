@@ -3,12 +3,61 @@
 
     Board support for controlling UART interfaces on NUCLEO-F401RE MCU
 
+    Output is queued in a ring drained by the USART TXE interrupt so that a
+    task printing a message no longer spins for each character (about 260 us
+    per byte at 38400 baud). Before the OS is running, and so also on the
+    error paths in main(), output is still written synchronously.
+
+    Input is taken by the RXNE interrupt into a lock-free ring (Util/ring.c),
+    and ReadByte() pends on it, so a task waiting for a keystroke no longer
+    keeps lower priority tasks from running.
+
     Developed for University of Washington embedded systems programming certificate
-    
+
     2016/2 Nick Strathy wrote/arranged it
 */
 
 #include "bsp.h"
+#include "ring.h"
+
+static char uartTxBuf[UART_TX_BUF_SIZE];
+static INT16U uartTxHead;          // bytes ever queued, written by PrintByte()
+static INT16U uartTxTail;          // bytes ever sent, written by the TX interrupt
+static OS_EVENT *uartTxSpaceSem;   // posted by the TX interrupt for tasks waiting on a full ring
+static INT8U uartTxWaiters;        // tasks pending on uartTxSpaceSem
+
+static INT8U uartRxBuf[UART_RX_BUF_SIZE];
+static Ring uartRxRing;            // RX interrupt -> ReadByte()
+static BOOLEAN uartRxInit;         // uartRxRing can be pended on
+
+INT32U uartTxDropped;
+INT32U uartRxDropped;
+
+
+// Creates the semaphore and the RX ring, then enables the RX interrupt and
+// the USART interrupt. Call after OSInit().
+void BspUartInitInterrupts()
+{
+    uartTxSpaceSem = OSSemCreate(0);
+    if (uartTxSpaceSem == 0) while (1);  // not enough semaphores available
+    RingInit(&uartRxRing, uartRxBuf, UART_RX_BUF_SIZE, OS_TRUE);
+    uartRxInit = OS_TRUE;
+    USART_ITConfig(COMM, USART_IT_RXNE, ENABLE);
+    NVIC_EnableIRQ(COMM_IRQn);
+}
+
+// Sends the queued bytes, then c, by polling TXE. Interrupts must be disabled.
+static void PrintBytePolled(char c)
+{
+    while (uartTxTail != uartTxHead)
+    {
+        while (USART_GetFlagStatus(COMM, USART_FLAG_TXE) == RESET);
+        USART_SendData(COMM, uartTxBuf[uartTxTail & (UART_TX_BUF_SIZE - 1)]);
+        uartTxTail++;
+    }
+    while (USART_GetFlagStatus(COMM, USART_FLAG_TXE) == RESET);
+    USART_SendData(COMM, c);
+}
 
 /**
   * @brief  Print a character on the HyperTerminal
@@ -17,18 +66,115 @@
   */
 void PrintByte(char c)
 {
-  USART_SendData(COMM, c);
-  while (USART_GetFlagStatus(COMM, USART_FLAG_TXE) == RESET);
+    OS_CPU_SR cpu_sr;
+#if UART_TX_OVERFLOW == UART_TX_BLOCK
+    INT8U err;
+#endif
+
+    OS_ENTER_CRITICAL();
+    if (!OSRunning)
+    {
+        PrintBytePolled(c);
+        OS_EXIT_CRITICAL();
+        return;
+    }
+
+    while ((INT16U)(uartTxHead - uartTxTail) == UART_TX_BUF_SIZE)
+    {
+#if UART_TX_OVERFLOW == UART_TX_OVERWRITE
+        uartTxTail++;
+        uartTxDropped++;
+#else
+#if UART_TX_OVERFLOW == UART_TX_BLOCK
+        if (OSIntNesting == 0 && OSLockNesting == 0 && uartTxSpaceSem != 0)
+        {
+            uartTxWaiters++;
+            OS_EXIT_CRITICAL();
+            OSSemPend(uartTxSpaceSem, 0, &err);
+            OS_ENTER_CRITICAL();
+            continue;
+        }
+#endif
+        uartTxDropped++;
+        OS_EXIT_CRITICAL();
+        return;
+#endif
+    }
+
+    uartTxBuf[uartTxHead & (UART_TX_BUF_SIZE - 1)] = c;
+    uartTxHead++;
+    COMM->CR1 |= USART_CR1_TXEIE;
+    OS_EXIT_CRITICAL();
+}
+
+// USART2IrqHandler
+// A byte was received: queue it for ReadByte(), or count it as dropped when
+// the RX ring is full or the receiver overran.
+// The transmit data register is empty: send the next queued byte, or stop
+// the interrupt when the ring is empty. Wakes the tasks blocked on a full
+// ring once a quarter of it is free again.
+void USART2IrqHandler(void)
+{
+    OS_CPU_SR cpu_sr;
+    INT16U status;
+    char c;
+
+    OS_ENTER_CRITICAL();
+    OSIntNesting++;
+    OS_EXIT_CRITICAL();
+    APP_ISR_ENTER();
+
+    status = COMM->SR;
+    if (status & (USART_SR_RXNE | USART_SR_ORE))
+    {
+        c = (char)USART_ReceiveData(COMM);  // reading SR then DR clears RXNE and ORE
+        if (status & USART_SR_ORE) uartRxDropped++;
+        if (!RingPutByte(&uartRxRing, (INT8U)c)) uartRxDropped++;
+    }
+
+    OS_ENTER_CRITICAL(); // PrintByte() may be called from a higher priority ISR
+    if ((COMM->CR1 & USART_CR1_TXEIE) && USART_GetFlagStatus(COMM, USART_FLAG_TXE) != RESET)
+    {
+        if (uartTxTail != uartTxHead)
+        {
+            USART_SendData(COMM, uartTxBuf[uartTxTail & (UART_TX_BUF_SIZE - 1)]);
+            uartTxTail++;
+        }
+        else
+        {
+            COMM->CR1 &= ~USART_CR1_TXEIE;
+        }
+
+        if (uartTxWaiters != 0 && (INT16U)(uartTxHead - uartTxTail) <= UART_TX_BUF_SIZE * 3 / 4)
+        {
+            for (; uartTxWaiters != 0; uartTxWaiters--) OSSemPost(uartTxSpaceSem);
+        }
+    }
+    OS_EXIT_CRITICAL();
+
+    APP_ISR_EXIT();
+    OSIntExit();
 }
 
 /**
-  * @brief  Busy wait for a character on the HyperTerminal
+  * @brief  Wait for a character on the HyperTerminal. A task pends until
+  *         the RX interrupt has queued one; before the OS is running, or
+  *         from an ISR, the receiver is polled instead.
   * @retval: The character that was read
   */
 char ReadByte()
 {
-    while (USART_GetFlagStatus(COMM, USART_FLAG_RXNE) == RESET);
-    uint16_t c = USART_ReceiveData(COMM);
-    USART_ClearFlag(COMM, USART_FLAG_RXNE);
-    return c;
-}
\ No newline at end of file
+    INT8U c;
+
+    if (!OSRunning || OSIntNesting != 0 || !uartRxInit)
+    {
+        while (USART_GetFlagStatus(COMM, USART_FLAG_RXNE) == RESET);
+        c = (INT8U)USART_ReceiveData(COMM);
+        USART_ClearFlag(COMM, USART_FLAG_RXNE);
+        return (char)c;
+    }
+
+    RingPend(&uartRxRing, 1, 0);
+    RingGetByte(&uartRxRing, &c);
+    return (char)c;
+}
@@ -11,10 +11,32 @@
 #ifndef __BSPUART_H
 #define __BSPUART_H
 
+#define UART_TX_BUF_SIZE     512  // bytes queued for the TX interrupt, must be a power of 2
+#define UART_RX_BUF_SIZE     64   // bytes received but not yet read, must be a power of 2
+
+// What PrintByte() does when the TX ring is full
+#define UART_TX_DROP         0    // discard the new byte
+#define UART_TX_BLOCK        1    // pend until the TX interrupt frees space (drops in an ISR)
+#define UART_TX_OVERWRITE    2    // discard the oldest queued byte
+#define UART_TX_OVERFLOW     UART_TX_BLOCK
+
 // Application interface to hardware
 
+void BspUartInitInterrupts();
 void PrintByte(char c);
 char ReadByte();
 
+extern INT32U uartTxDropped; // bytes lost to UART_TX_DROP / UART_TX_OVERWRITE
+extern INT32U uartRxDropped; // bytes lost to a full RX ring or a receiver overrun
+
+// USART2 interrupt service routine, overrides the weak symbol in startup.s
+#ifdef __cplusplus
+extern "C" {
+#endif
+void USART2IrqHandler(void);
+#ifdef __cplusplus
+}
+#endif
+
 
 #endif /* __BSPUART_H */
\ No newline at end of file
@@ -16,6 +16,8 @@ Copyright	: David Allegre
 #include "stm32f4xx_usart.h"
 #include "stm32f4xx_gpio.h"
 #include "stm32f4xx_spi.h"
+#include "stm32f4xx_syscfg.h"
+#include "stm32f4xx_exti.h"
 
 /* Exported define -----------------------------------------------------------*/
 // Clock speed
@@ -40,5 +42,6 @@ Copyright	: David Allegre
 // USART 
 #define BAUD_RATE               38400
 #define COMM                    USART2
+#define COMM_IRQn               USART2_IRQn
 
 #endif
\ No newline at end of file
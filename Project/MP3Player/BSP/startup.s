@@ -110,9 +110,25 @@ __vector_table
       DCD     UnusedIrqHandler              ; SPI1
       DCD     UnusedIrqHandler              ; SPI2
       DCD     UnusedIrqHandler              ; USART1
-      DCD     UnusedIrqHandler              ; USART2
+      DCD     USART2IrqHandler              ; USART2
       DCD     0
       DCD     EXTI10Thru15IrqHandler        ; EXTI Lines 10 -> 15
+      DCD     UnusedIrqHandler              ; RTC Alarm through the EXTI line
+      DCD     UnusedIrqHandler              ; USB OTG FS Wakeup through the EXTI line
+      DCD     0
+      DCD     0
+      DCD     0
+      DCD     0
+      DCD     UnusedIrqHandler              ; DMA1 Stream 7
+      DCD     0
+      DCD     UnusedIrqHandler              ; SDIO
+      DCD     UnusedIrqHandler              ; TIM5
+      DCD     UnusedIrqHandler              ; SPI3
+      DCD     0
+      DCD     0
+      DCD     0
+      DCD     0
+      DCD     DMA2Stream0IrqHandler         ; DMA2 Stream 0
      
       ; There are more IRQs that are not added here......
       
@@ -136,6 +152,8 @@ __vector_table
       PUBWEAK  EXTI4IrqHandler 
       PUBWEAK  EXTI5Thru9IrqHandler
       PUBWEAK  EXTI10Thru15IrqHandler
+      PUBWEAK  DMA2Stream0IrqHandler
+      PUBWEAK  USART2IrqHandler
       
 NMIIrqHandler 
 MemManageIrqHandler      
@@ -151,6 +169,8 @@ EXTI3IrqHandler
 EXTI4IrqHandler
 EXTI5Thru9IrqHandler
 EXTI10Thru15IrqHandler
+DMA2Stream0IrqHandler
+USART2IrqHandler
 
 UnusedIrqHandler           
       B         UnusedIrqHandler      ; Loop forever
@@ -0,0 +1,423 @@
+/*
+    hostPeriph.c
+    Host build stand-in for the ST Standard Peripheral Library and the
+    vector table of startup.s.
+
+    The register blocks declared in stm32f4xx.h live here. Accesses to the
+    HostReg registers are routed to the device models in Host/Sim by address;
+    registers without side effects just keep the value written. The library
+    functions the BSP calls are implemented on top of those registers, or on
+    the models directly for GPIO and I2C, with the same effect as the ST
+    versions on the bits this project uses.
+
+    Every access runs with the port's interrupts blocked, so a task polling a
+    flag can be preempted between two reads, as on the target.
+
+    2026/10 written for the MP3Player project
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bsp.h"
+#include "sim.h"
+
+SPI_TypeDef HostSPI1;
+DMA_Stream_TypeDef HostDMA2Stream0, HostDMA2Stream3;
+DMA_TypeDef HostDMA2;
+USART_TypeDef HostUSART2;
+EXTI_TypeDef HostEXTI;
+RCC_TypeDef HostRCC;
+SYSCFG_TypeDef HostSYSCFG;
+GPIO_TypeDef HostGPIOA, HostGPIOB, HostGPIOC, HostGPIOD, HostGPIOE, HostGPIOH;
+I2C_TypeDef HostI2C1;
+
+// True if the register is a member of the given register block
+#define REG_IN(pReg, block) \
+    ((const char*)(pReg) >= (const char*)&(block) && (const char*)(pReg) < (const char*)(&(block) + 1))
+
+
+/*--------------------------------- Registers --------------------------------*/
+
+uint32_t HostRegRead(const HostReg *pReg)
+{
+    OS_CPU_SR cpu_sr;
+    uint32_t value;
+
+    OS_ENTER_CRITICAL();
+    if (REG_IN(pReg, HostSPI1))
+        value = SimSpiRead(pReg);
+    else if (REG_IN(pReg, HostDMA2) || REG_IN(pReg, HostDMA2Stream0) || REG_IN(pReg, HostDMA2Stream3))
+        value = SimDmaRead(pReg);
+    else if (REG_IN(pReg, HostUSART2))
+        value = SimUartRead(pReg);
+    else if (REG_IN(pReg, HostEXTI))
+        value = SimExtiRead(pReg);
+    else
+        value = pReg->value;
+    OS_EXIT_CRITICAL();
+    return value;
+}
+
+void HostRegWrite(HostReg *pReg, uint32_t value)
+{
+    OS_CPU_SR cpu_sr;
+
+    OS_ENTER_CRITICAL();
+    if (REG_IN(pReg, HostSPI1))
+        SimSpiWrite(pReg, value);
+    else if (REG_IN(pReg, HostDMA2) || REG_IN(pReg, HostDMA2Stream0) || REG_IN(pReg, HostDMA2Stream3))
+        SimDmaWrite(pReg, value);
+    else if (REG_IN(pReg, HostUSART2))
+        SimUartWrite(pReg, value);
+    else if (REG_IN(pReg, HostEXTI))
+        SimExtiWrite(pReg, value);
+    else
+        pReg->value = value;
+    OS_EXIT_CRITICAL();
+}
+
+
+/*------------------------------------ RCC -----------------------------------*/
+
+void RCC_AHB1PeriphClockCmd(uint32_t RCC_AHB1Periph, FunctionalState NewState)
+{
+    if (NewState != DISABLE) RCC->AHB1ENR |= RCC_AHB1Periph;
+    else RCC->AHB1ENR &= ~RCC_AHB1Periph;
+}
+
+void RCC_APB1PeriphClockCmd(uint32_t RCC_APB1Periph, FunctionalState NewState)
+{
+    if (NewState != DISABLE) RCC->APB1ENR |= RCC_APB1Periph;
+    else RCC->APB1ENR &= ~RCC_APB1Periph;
+}
+
+void RCC_APB2PeriphClockCmd(uint32_t RCC_APB2Periph, FunctionalState NewState)
+{
+    if (NewState != DISABLE) RCC->APB2ENR |= RCC_APB2Periph;
+    else RCC->APB2ENR &= ~RCC_APB2Periph;
+}
+
+
+/*------------------------------------ GPIO ----------------------------------*/
+
+void GPIO_Init(GPIO_TypeDef* GPIOx, GPIO_InitTypeDef* GPIO_InitStruct)
+{
+    OS_CPU_SR cpu_sr;
+    uint32_t pin;
+
+    OS_ENTER_CRITICAL();
+    for (pin = 0; pin < 16; pin++)
+    {
+        if (!(GPIO_InitStruct->GPIO_Pin & (1u << pin))) continue;
+        GPIOx->MODER = (GPIOx->MODER & ~(3u << (pin * 2))) | ((uint32_t)GPIO_InitStruct->GPIO_Mode << (pin * 2));
+        GPIOx->PUPDR = (GPIOx->PUPDR & ~(3u << (pin * 2))) | ((uint32_t)GPIO_InitStruct->GPIO_PuPd << (pin * 2));
+        if (GPIO_InitStruct->GPIO_Mode == GPIO_Mode_OUT || GPIO_InitStruct->GPIO_Mode == GPIO_Mode_AF)
+        {
+            GPIOx->OSPEEDR = (GPIOx->OSPEEDR & ~(3u << (pin * 2))) | ((uint32_t)GPIO_InitStruct->GPIO_Speed << (pin * 2));
+            GPIOx->OTYPER = (GPIOx->OTYPER & ~(1u << pin)) | ((uint32_t)GPIO_InitStruct->GPIO_OType << pin);
+        }
+    }
+    OS_EXIT_CRITICAL();
+}
+
+uint8_t GPIO_ReadInputDataBit(GPIO_TypeDef* GPIOx, uint16_t GPIO_Pin)
+{
+    OS_CPU_SR cpu_sr;
+    uint8_t bit;
+
+    OS_ENTER_CRITICAL();
+    if (GPIOx == MP3_VS1053_DREQ_GPIO && GPIO_Pin == MP3_VS1053_DREQ_GPIO_Pin)
+    {
+        SimMp3Update(); // DREQ follows the FIFO level
+    }
+    bit = (GPIOx->IDR & GPIO_Pin) ? (uint8_t)Bit_SET : (uint8_t)Bit_RESET;
+    OS_EXIT_CRITICAL();
+    return bit;
+}
+
+void GPIO_SetBits(GPIO_TypeDef* GPIOx, uint16_t GPIO_Pin)
+{
+    OS_CPU_SR cpu_sr;
+
+    OS_ENTER_CRITICAL();
+    GPIOx->ODR |= GPIO_Pin;
+    SimPinsChanged();
+    OS_EXIT_CRITICAL();
+}
+
+void GPIO_ResetBits(GPIO_TypeDef* GPIOx, uint16_t GPIO_Pin)
+{
+    OS_CPU_SR cpu_sr;
+
+    OS_ENTER_CRITICAL();
+    GPIOx->ODR &= ~(uint32_t)GPIO_Pin;
+    SimPinsChanged();
+    OS_EXIT_CRITICAL();
+}
+
+void GPIO_PinAFConfig(GPIO_TypeDef* GPIOx, uint16_t GPIO_PinSource, uint8_t GPIO_AF)
+{
+    uint32_t shift = (GPIO_PinSource & 7) * 4;
+    uint32_t *pAfr = &GPIOx->AFR[GPIO_PinSource >> 3];
+
+    *pAfr = (*pAfr & ~(0xFu << shift)) | ((uint32_t)GPIO_AF << shift);
+}
+
+
+/*------------------------------------ SPI -----------------------------------*/
+
+void SPI_Init(SPI_TypeDef* SPIx, SPI_InitTypeDef* SPI_InitStruct)
+{
+    uint32_t cr1 = SPIx->CR1;
+
+    cr1 &= SPI_CR1_SPE; // the library keeps the enable bit only
+    cr1 |= SPI_InitStruct->SPI_Direction | SPI_InitStruct->SPI_Mode |
+        SPI_InitStruct->SPI_DataSize | SPI_InitStruct->SPI_CPOL |
+        SPI_InitStruct->SPI_CPHA | SPI_InitStruct->SPI_NSS |
+        SPI_InitStruct->SPI_BaudRatePrescaler | SPI_InitStruct->SPI_FirstBit;
+    SPIx->CR1 = cr1;
+}
+
+void SPI_Cmd(SPI_TypeDef* SPIx, FunctionalState NewState)
+{
+    if (NewState != DISABLE) SPIx->CR1 |= SPI_CR1_SPE;
+    else SPIx->CR1 &= ~SPI_CR1_SPE;
+}
+
+void SPI_I2S_SendData(SPI_TypeDef* SPIx, uint16_t Data)
+{
+    SPIx->DR = Data;
+}
+
+uint16_t SPI_I2S_ReceiveData(SPI_TypeDef* SPIx)
+{
+    return (uint16_t)SPIx->DR;
+}
+
+FlagStatus SPI_I2S_GetFlagStatus(SPI_TypeDef* SPIx, uint16_t SPI_I2S_FLAG)
+{
+    return (SPIx->SR & SPI_I2S_FLAG) ? SET : RESET;
+}
+
+
+/*----------------------------------- USART ----------------------------------*/
+
+void USART_Init(USART_TypeDef* USARTx, USART_InitTypeDef* USART_InitStruct)
+{
+    USARTx->CR2 = USART_InitStruct->USART_StopBits;
+    USARTx->CR1 = (USARTx->CR1 & USART_CR1_UE) | USART_InitStruct->USART_WordLength |
+        USART_InitStruct->USART_Parity | USART_InitStruct->USART_Mode;
+    USARTx->CR3 = USART_InitStruct->USART_HardwareFlowControl;
+    USARTx->BRR = (HSI_VALUE + USART_InitStruct->USART_BaudRate / 2) / USART_InitStruct->USART_BaudRate;
+}
+
+void USART_Cmd(USART_TypeDef* USARTx, FunctionalState NewState)
+{
+    if (NewState != DISABLE) USARTx->CR1 |= USART_CR1_UE;
+    else USARTx->CR1 &= ~USART_CR1_UE;
+}
+
+// The interrupt code holds the control register (bits 7:5) and the bit
+// position of its enable bit (bits 4:0). Only CR1 interrupts are used here.
+void USART_ITConfig(USART_TypeDef* USARTx, uint16_t USART_IT, FunctionalState NewState)
+{
+    uint32_t mask = 1u << (USART_IT & 0x1F);
+
+    if (((USART_IT & 0xFF) >> 5) != 1) while(1);
+    if (NewState != DISABLE) USARTx->CR1 |= mask;
+    else USARTx->CR1 &= ~mask;
+}
+
+FlagStatus USART_GetFlagStatus(USART_TypeDef* USARTx, uint16_t USART_FLAG)
+{
+    return (USARTx->SR & USART_FLAG) ? SET : RESET;
+}
+
+void USART_ClearFlag(USART_TypeDef* USARTx, uint16_t USART_FLAG)
+{
+    USARTx->SR = (uint16_t)~USART_FLAG;
+}
+
+void USART_SendData(USART_TypeDef* USARTx, uint16_t Data)
+{
+    USARTx->DR = Data & 0x1FF;
+}
+
+uint16_t USART_ReceiveData(USART_TypeDef* USARTx)
+{
+    return (uint16_t)(USARTx->DR & 0x1FF);
+}
+
+
+/*---------------------------------- EXTI/SYSCFG -----------------------------*/
+
+void EXTI_Init(EXTI_InitTypeDef* EXTI_InitStruct)
+{
+    uint32_t line = EXTI_InitStruct->EXTI_Line;
+
+    EXTI->IMR &= ~line;
+    EXTI->EMR &= ~line;
+    EXTI->RTSR &= ~line;
+    EXTI->FTSR &= ~line;
+    if (EXTI_InitStruct->EXTI_LineCmd == DISABLE) return;
+
+    if (EXTI_InitStruct->EXTI_Mode == EXTI_Mode_Interrupt) EXTI->IMR |= line;
+    else EXTI->EMR |= line;
+    if (EXTI_InitStruct->EXTI_Trigger != EXTI_Trigger_Falling) EXTI->RTSR |= line;
+    if (EXTI_InitStruct->EXTI_Trigger != EXTI_Trigger_Rising) EXTI->FTSR |= line;
+}
+
+ITStatus EXTI_GetITStatus(uint32_t EXTI_Line)
+{
+    return ((EXTI->PR & EXTI_Line) && (EXTI->IMR & EXTI_Line)) ? SET : RESET;
+}
+
+void EXTI_ClearITPendingBit(uint32_t EXTI_Line)
+{
+    EXTI->PR = EXTI_Line;
+}
+
+void SYSCFG_EXTILineConfig(uint8_t EXTI_PortSourceGPIOx, uint8_t EXTI_PinSourcex)
+{
+    uint32_t shift = (EXTI_PinSourcex & 3) * 4;
+    HostReg *pCr = &SYSCFG->EXTICR[EXTI_PinSourcex >> 2];
+
+    *pCr = (*pCr & ~(0xFu << shift)) | ((uint32_t)EXTI_PortSourceGPIOx << shift);
+}
+
+
+/*------------------------------------ I2C -----------------------------------*/
+
+void I2C_Init(I2C_TypeDef* I2Cx, I2C_InitTypeDef* I2C_InitStruct)
+{
+    I2Cx->CR1 = I2C_InitStruct->I2C_Mode | I2C_InitStruct->I2C_Ack;
+    I2Cx->OAR1 = I2C_InitStruct->I2C_AcknowledgedAddress | I2C_InitStruct->I2C_OwnAddress1;
+}
+
+void I2C_Cmd(I2C_TypeDef* I2Cx, FunctionalState NewState)
+{
+    if (NewState != DISABLE) I2Cx->CR1 |= I2C_CR1_PE;
+    else I2Cx->CR1 &= ~I2C_CR1_PE;
+}
+
+void I2C_GenerateSTART(I2C_TypeDef* I2Cx, FunctionalState NewState)
+{
+    OS_CPU_SR cpu_sr;
+
+    if (NewState == DISABLE) return;
+    OS_ENTER_CRITICAL();
+    SimI2cStart(cpu_sr != 0);
+    OS_EXIT_CRITICAL();
+}
+
+void I2C_GenerateSTOP(I2C_TypeDef* I2Cx, FunctionalState NewState)
+{
+    OS_CPU_SR cpu_sr;
+
+    if (NewState == DISABLE) return;
+    OS_ENTER_CRITICAL();
+    SimI2cStop();
+    OS_EXIT_CRITICAL();
+}
+
+void I2C_Send7bitAddress(I2C_TypeDef* I2Cx, uint8_t Address, uint8_t I2C_Direction)
+{
+    OS_CPU_SR cpu_sr;
+
+    if (I2C_Direction != I2C_Direction_Transmitter) Address |= 0x01;
+    else Address &= ~0x01;
+    OS_ENTER_CRITICAL();
+    SimI2cAddress(Address);
+    OS_EXIT_CRITICAL();
+}
+
+void I2C_AcknowledgeConfig(I2C_TypeDef* I2Cx, FunctionalState NewState)
+{
+    OS_CPU_SR cpu_sr;
+
+    OS_ENTER_CRITICAL();
+    SimI2cAck(NewState != DISABLE);
+    OS_EXIT_CRITICAL();
+}
+
+void I2C_SendData(I2C_TypeDef* I2Cx, uint8_t Data)
+{
+    OS_CPU_SR cpu_sr;
+
+    OS_ENTER_CRITICAL();
+    SimI2cSend(Data);
+    OS_EXIT_CRITICAL();
+}
+
+uint8_t I2C_ReceiveData(I2C_TypeDef* I2Cx)
+{
+    OS_CPU_SR cpu_sr;
+    uint8_t data;
+
+    OS_ENTER_CRITICAL();
+    data = SimI2cReceive();
+    OS_EXIT_CRITICAL();
+    return data;
+}
+
+// The FT6206 acknowledges every step, so each event the BSP waits for
+// happens once the step before it has finished on the bus.
+ErrorStatus I2C_CheckEvent(I2C_TypeDef* I2Cx, uint32_t I2C_EVENT)
+{
+    OS_CPU_SR cpu_sr;
+    int ready;
+
+    OS_ENTER_CRITICAL();
+    ready = SimI2cReady();
+    OS_EXIT_CRITICAL();
+    return ready ? SUCCESS : ERROR;
+}
+
+FlagStatus I2C_GetFlagStatus(I2C_TypeDef* I2Cx, uint32_t I2C_FLAG)
+{
+    OS_CPU_SR cpu_sr;
+    int busy;
+
+    if (I2C_FLAG != I2C_FLAG_BUSY)
+    {
+        while(1); // the only flag the BSP reads
+    }
+    OS_ENTER_CRITICAL();
+    busy = SimI2cBusy();
+    OS_EXIT_CRITICAL();
+    return busy ? SET : RESET;
+}
+
+
+/*---------------------------------- Vectors ---------------------------------*/
+
+// Defaults for the handlers startup.s declares weak and the BSP does not
+// implement: an unexpected interrupt stops the program, as the target's
+// UnusedIrqHandler loop does.
+#define HOST_UNUSED_HANDLER(name) \
+    extern "C" void __attribute__((weak)) name(void) \
+    { \
+        fprintf(stderr, "host: unexpected interrupt %s\n", #name); \
+        abort(); \
+    }
+
+HOST_UNUSED_HANDLER(EXTI0IrqHandler)
+HOST_UNUSED_HANDLER(EXTI1IrqHandler)
+HOST_UNUSED_HANDLER(EXTI2IrqHandler)
+HOST_UNUSED_HANDLER(EXTI5Thru9IrqHandler)
+HOST_UNUSED_HANDLER(EXTI10Thru15IrqHandler)
+
+// The entries of the startup.s vector table the application uses
+void HostVectorsInit(void)
+{
+    OS_CPU_IntSet(EXTI0_IRQn, EXTI0IrqHandler);
+    OS_CPU_IntSet(EXTI1_IRQn, EXTI1IrqHandler);
+    OS_CPU_IntSet(EXTI2_IRQn, EXTI2IrqHandler);
+    OS_CPU_IntSet(EXTI3_IRQn, EXTI3IrqHandler);
+    OS_CPU_IntSet(EXTI4_IRQn, EXTI4IrqHandler);
+    OS_CPU_IntSet(EXTI9_5_IRQn, EXTI5Thru9IrqHandler);
+    OS_CPU_IntSet(USART2_IRQn, USART2IrqHandler);
+    OS_CPU_IntSet(EXTI15_10_IRQn, EXTI10Thru15IrqHandler);
+    OS_CPU_IntSet(DMA2_Stream0_IRQn, DMA2Stream0IrqHandler);
+}
@@ -0,0 +1,268 @@
+/*
+    stm32f4xx.h
+    Host build stand-in for the CMSIS STM32F4xx device header.
+
+    Declares the peripheral register blocks the BSP uses, with the register
+    and bit names of the CMSIS header, so that the BSP and the ST Standard
+    Peripheral Library headers compile unchanged. The registers that have
+    side effects on the device (SPI1 DR/SR/CR2, the DMA2 streams, USART2
+    and EXTI IMR) are HostReg objects: every access goes through
+    HostRegRead() and HostRegWrite() in hostPeriph.c, which forward it to
+    the device models in Host/Sim.
+
+    Only the parts of the F401 used by this project are declared. The values
+    of the bit definitions are those of the CMSIS header.
+
+    2026/10 written for the MP3Player project
+*/
+
+#ifndef __STM32F4xx_H
+#define __STM32F4xx_H
+
+#include <stdint.h>
+
+#define HSI_VALUE    ((uint32_t)16000000) // the clock the board runs on, see hw_system_clock()
+#define HSE_VALUE    ((uint32_t)8000000)
+
+#define __IO    volatile
+#define __I     volatile const
+#define __O     volatile
+
+typedef enum IRQn
+{
+    NonMaskableInt_IRQn   = -14,
+    MemoryManagement_IRQn = -12,
+    BusFault_IRQn         = -11,
+    UsageFault_IRQn       = -10,
+    SVCall_IRQn           = -5,
+    DebugMonitor_IRQn     = -4,
+    PendSV_IRQn           = -2,
+    SysTick_IRQn          = -1,
+    EXTI0_IRQn            = 6,
+    EXTI1_IRQn            = 7,
+    EXTI2_IRQn            = 8,
+    EXTI3_IRQn            = 9,
+    EXTI4_IRQn            = 10,
+    EXTI9_5_IRQn          = 23,
+    I2C1_EV_IRQn          = 31,
+    SPI1_IRQn             = 35,
+    USART2_IRQn           = 38,
+    EXTI15_10_IRQn        = 40,
+    DMA2_Stream0_IRQn     = 56,
+    DMA2_Stream3_IRQn     = 59,
+} IRQn_Type;
+
+typedef enum {RESET = 0, SET = !RESET} FlagStatus, ITStatus;
+typedef enum {DISABLE = 0, ENABLE = !DISABLE} FunctionalState;
+#define IS_FUNCTIONAL_STATE(STATE) (((STATE) == DISABLE) || ((STATE) == ENABLE))
+typedef enum {ERROR = 0, SUCCESS = !ERROR} ErrorStatus;
+
+typedef int32_t  s32;
+typedef int16_t  s16;
+typedef int8_t   s8;
+typedef uint32_t u32;
+typedef uint16_t u16;
+typedef uint8_t  u8;
+
+
+// A memory mapped register. Reads and writes go to the device models.
+class HostReg;
+uint32_t HostRegRead(const HostReg *pReg);
+void HostRegWrite(HostReg *pReg, uint32_t value);
+
+class HostReg
+{
+public:
+    operator uint32_t() const { return HostRegRead(this); }
+    HostReg &operator=(uint32_t value) { HostRegWrite(this, value); return *this; }
+    HostReg &operator|=(uint32_t value) { HostRegWrite(this, HostRegRead(this) | value); return *this; }
+    HostReg &operator&=(uint32_t value) { HostRegWrite(this, HostRegRead(this) & value); return *this; }
+    uint32_t value; // the stored contents, for registers without side effects
+};
+
+
+typedef struct
+{
+    HostReg CR1, CR2, SR, DR, CRCPR, RXCRCR, TXCRCR, I2SCFGR, I2SPR;
+} SPI_TypeDef;
+
+typedef struct
+{
+    HostReg CR, NDTR, PAR, M0AR, M1AR, FCR;
+} DMA_Stream_TypeDef;
+
+typedef struct
+{
+    HostReg LISR, HISR, LIFCR, HIFCR;
+} DMA_TypeDef;
+
+typedef struct
+{
+    HostReg SR, DR, BRR, CR1, CR2, CR3, GTPR;
+} USART_TypeDef;
+
+typedef struct
+{
+    HostReg IMR, EMR, RTSR, FTSR, SWIER, PR;
+} EXTI_TypeDef;
+
+typedef struct
+{
+    HostReg CR, PLLCFGR, CFGR, CIR, AHB1RSTR, AHB2RSTR, APB1RSTR, APB2RSTR,
+        AHB1ENR, AHB2ENR, APB1ENR, APB2ENR;
+} RCC_TypeDef;
+
+typedef struct
+{
+    HostReg MEMRMP, PMC, EXTICR[4], CMPCR;
+} SYSCFG_TypeDef;
+
+// GPIO and I2C are only reached through the library functions in hostPeriph.c
+typedef struct
+{
+    uint32_t MODER, OTYPER, OSPEEDR, PUPDR, IDR, ODR, LCKR, AFR[2];
+} GPIO_TypeDef;
+
+typedef struct
+{
+    uint32_t CR1, CR2, OAR1, OAR2, DR, SR1, SR2, CCR, TRISE;
+} I2C_TypeDef;
+
+extern SPI_TypeDef HostSPI1;
+extern DMA_Stream_TypeDef HostDMA2Stream0, HostDMA2Stream3;
+extern DMA_TypeDef HostDMA2;
+extern USART_TypeDef HostUSART2;
+extern EXTI_TypeDef HostEXTI;
+extern RCC_TypeDef HostRCC;
+extern SYSCFG_TypeDef HostSYSCFG;
+extern GPIO_TypeDef HostGPIOA, HostGPIOB, HostGPIOC, HostGPIOD, HostGPIOE, HostGPIOH;
+extern I2C_TypeDef HostI2C1;
+
+#define SPI1            (&HostSPI1)
+#define DMA2            (&HostDMA2)
+#define DMA2_Stream0    (&HostDMA2Stream0)
+#define DMA2_Stream3    (&HostDMA2Stream3)
+#define USART2          (&HostUSART2)
+#define EXTI            (&HostEXTI)
+#define RCC             (&HostRCC)
+#define SYSCFG          (&HostSYSCFG)
+#define GPIOA           (&HostGPIOA)
+#define GPIOB           (&HostGPIOB)
+#define GPIOC           (&HostGPIOC)
+#define GPIOD           (&HostGPIOD)
+#define GPIOE           (&HostGPIOE)
+#define GPIOH           (&HostGPIOH)
+#define I2C1            (&HostI2C1)
+
+// Names the library headers compare against in their IS_..._PERIPH() checks
+#define SPI2            ((SPI_TypeDef *)0)
+#define SPI3            ((SPI_TypeDef *)0)
+#define SPI4            ((SPI_TypeDef *)0)
+#define USART1          ((USART_TypeDef *)0)
+#define USART6          ((USART_TypeDef *)0)
+#define I2C2            ((I2C_TypeDef *)0)
+#define I2C3            ((I2C_TypeDef *)0)
+
+
+/*----------------------------- Bit definitions -----------------------------*/
+
+#define DMA_SxCR_CHSEL_0     ((uint32_t)0x02000000)
+#define DMA_SxCR_CHSEL_1     ((uint32_t)0x04000000)
+#define DMA_SxCR_PL_0        ((uint32_t)0x00010000)
+#define DMA_SxCR_PL_1        ((uint32_t)0x00020000)
+#define DMA_SxCR_MSIZE_0     ((uint32_t)0x00002000)
+#define DMA_SxCR_PSIZE_0     ((uint32_t)0x00000800)
+#define DMA_SxCR_MINC        ((uint32_t)0x00000400)
+#define DMA_SxCR_DIR_0       ((uint32_t)0x00000040)
+#define DMA_SxCR_TCIE        ((uint32_t)0x00000010)
+#define DMA_SxCR_TEIE        ((uint32_t)0x00000004)
+#define DMA_SxCR_EN          ((uint32_t)0x00000001)
+
+#define DMA_LISR_TCIF3       ((uint32_t)0x08000000)
+#define DMA_LISR_TEIF3       ((uint32_t)0x02000000)
+#define DMA_LISR_TCIF0       ((uint32_t)0x00000020)
+#define DMA_LISR_TEIF0       ((uint32_t)0x00000008)
+
+#define DMA_LIFCR_CTCIF3     ((uint32_t)0x08000000)
+#define DMA_LIFCR_CHTIF3     ((uint32_t)0x04000000)
+#define DMA_LIFCR_CTEIF3     ((uint32_t)0x02000000)
+#define DMA_LIFCR_CDMEIF3    ((uint32_t)0x01000000)
+#define DMA_LIFCR_CFEIF3     ((uint32_t)0x00400000)
+#define DMA_LIFCR_CTCIF0     ((uint32_t)0x00000020)
+#define DMA_LIFCR_CHTIF0     ((uint32_t)0x00000010)
+#define DMA_LIFCR_CTEIF0     ((uint32_t)0x00000008)
+#define DMA_LIFCR_CDMEIF0    ((uint32_t)0x00000004)
+#define DMA_LIFCR_CFEIF0     ((uint32_t)0x00000001)
+
+#define SPI_CR1_BR           ((uint16_t)0x0038)
+#define SPI_CR1_SPE          ((uint16_t)0x0040)
+#define SPI_CR1_DFF          ((uint16_t)0x0800)
+#define SPI_CR2_RXDMAEN      ((uint8_t)0x01)
+#define SPI_CR2_TXDMAEN      ((uint8_t)0x02)
+#define SPI_SR_RXNE          ((uint8_t)0x01)
+#define SPI_SR_TXE           ((uint8_t)0x02)
+#define SPI_SR_OVR           ((uint8_t)0x40)
+#define SPI_SR_BSY           ((uint8_t)0x80)
+
+#define USART_SR_ORE         ((uint16_t)0x0008)
+#define USART_SR_RXNE        ((uint16_t)0x0020)
+#define USART_SR_TC          ((uint16_t)0x0040)
+#define USART_SR_TXE         ((uint16_t)0x0080)
+#define USART_CR1_RE         ((uint16_t)0x0004)
+#define USART_CR1_TE         ((uint16_t)0x0008)
+#define USART_CR1_RXNEIE     ((uint16_t)0x0020)
+#define USART_CR1_TCIE       ((uint16_t)0x0040)
+#define USART_CR1_TXEIE      ((uint16_t)0x0080)
+#define USART_CR1_UE         ((uint16_t)0x2000)
+
+#define I2C_CR1_PE           ((uint16_t)0x0001)
+#define I2C_CR1_START        ((uint16_t)0x0100)
+#define I2C_CR1_STOP         ((uint16_t)0x0200)
+#define I2C_CR1_ACK          ((uint16_t)0x0400)
+
+#define RCC_AHB1ENR_GPIOAEN  ((uint32_t)0x00000001)
+#define RCC_AHB1ENR_GPIOBEN  ((uint32_t)0x00000002)
+#define RCC_AHB1ENR_GPIOCEN  ((uint32_t)0x00000004)
+#define RCC_AHB1ENR_GPIODEN  ((uint32_t)0x00000008)
+#define RCC_AHB1ENR_GPIOEEN  ((uint32_t)0x00000010)
+#define RCC_AHB1ENR_DMA2EN   ((uint32_t)0x00400000)
+#define RCC_APB1ENR_USART2EN ((uint32_t)0x00020000)
+#define RCC_APB1ENR_I2C1EN   ((uint32_t)0x00200000)
+#define RCC_APB1ENR_PWREN    ((uint32_t)0x10000000)
+#define RCC_APB2ENR_SPI1EN   ((uint32_t)0x00001000)
+#define RCC_APB2ENR_SYSCFGEN ((uint32_t)0x00004000)
+
+
+/*---------------------------------- NVIC -----------------------------------*/
+
+// The interrupt lines of the host port (see OS_CPU_IntSet()) are the IRQ numbers
+#include <os_cpu.h>
+
+static inline void NVIC_EnableIRQ(IRQn_Type IRQn)
+{
+    if (IRQn >= 0) OS_CPU_IntEn((INT8U)IRQn, 1);
+}
+
+static inline void NVIC_DisableIRQ(IRQn_Type IRQn)
+{
+    if (IRQn >= 0) OS_CPU_IntEn((INT8U)IRQn, 0);
+}
+
+static inline void NVIC_SetPendingIRQ(IRQn_Type IRQn)
+{
+    if (IRQn >= 0) OS_CPU_IntPend((INT8U)IRQn);
+}
+
+// Lines are taken lowest number first, there are no priority levels
+static inline void NVIC_SetPriority(IRQn_Type IRQn, uint32_t priority)
+{
+    (void)IRQn;
+    (void)priority;
+}
+
+
+#ifdef USE_STDPERIPH_DRIVER
+#include "stm32f4xx_conf.h"
+#endif
+
+#endif /* __STM32F4xx_H */
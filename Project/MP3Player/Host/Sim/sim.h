@@ -0,0 +1,223 @@
+/*
+    sim.h
+    Device models of the host build: the NUCLEO-F401RE peripherals the BSP
+    drives (GPIO/EXTI, SPI1 with its DMA2 streams, USART2, I2C1) and the
+    devices on the Adafruit shields behind them (SD card, VS1053 MP3 decoder,
+    ILI9341 LCD, FT6206 touch controller).
+
+    The models run on the real monotonic clock and keep the bus timing of the
+    board, so polling loops, DMA completion, DREQ and the UART take as long
+    on the host as they do on the target. The entry points used by
+    hostPeriph.c are called with the port's interrupts blocked
+    (OS_ENTER_CRITICAL()), as are the models' own interrupt lines below. The
+    ones meant for harnesses (SimPinSet(), SimTouchPress(), SimTouchRelease(),
+    SimUartInject(), SimUartCapture()) block them themselves.
+
+    The counters are for the harnesses in Host/Test and may be reset by them
+    at any time.
+
+    2026/10 written for the MP3Player project
+*/
+
+#ifndef __SIM_H
+#define __SIM_H
+
+#include <stdint.h>
+#include "stm32f4xx.h"
+
+// Host interrupt lines of the models, above the IRQn_Type numbers the BSP uses
+#define SIM_IRQ_DMA         90  // SPI1 DMA transfer finished shifting
+#define SIM_IRQ_DREQ        91  // VS1053 FIFO drained to the DREQ threshold or reset done
+#define SIM_IRQ_UART_TX     92  // USART2 transmit data register empty
+#define SIM_IRQ_UART_RX     93  // USART2 next received byte is due
+#define SIM_IRQ_UART_FD     94  // host input readable
+
+#define SIM_LCD_WIDTH       240
+#define SIM_LCD_HEIGHT      320
+
+#define SIM_UART_CAPTURE_SIZE  8192  // last bytes sent by USART2, see SimUartCapture()
+
+
+/*------------------------------- hostPeriph.c -------------------------------*/
+
+// Installs the application's interrupt handlers on their host lines
+void HostVectorsInit(void);
+
+
+/*--------------------------------- simCore.c --------------------------------*/
+
+// Monotonic time in ns, the time base of all the models
+uint64_t SimNow(void);
+
+// Starts the models and installs the application's interrupt handlers.
+// sdImage: FAT image file for the SD card, or 0 for no card
+// uartFd, uartInFd: see SimUartInit()
+void SimInit(const char *sdImage, int uartFd, int uartInFd);
+
+// Drives an input pin, raising the EXTI line on a matching edge
+void SimPinSet(GPIO_TypeDef *port, uint16_t pin, int high);
+
+// Output pins changed: re-routes the SPI bus to the selected device
+void SimPinsChanged(void);
+
+// Exchanges one byte with the device selected on SPI1
+uint8_t SimSpiExchange(uint8_t out);
+
+uint32_t SimExtiRead(const HostReg *pReg);
+void SimExtiWrite(HostReg *pReg, uint32_t value);
+
+typedef struct
+{
+    uint32_t csConflicts;   // bytes sent with more than one chip select asserted
+    uint32_t unselected;    // bytes sent with no chip select asserted
+} SimBusStats;
+
+extern SimBusStats SimBus;
+
+
+/*--------------------------------- simSpi.c ---------------------------------*/
+
+uint32_t SimSpiRead(const HostReg *pReg);
+void SimSpiWrite(HostReg *pReg, uint32_t value);
+uint32_t SimDmaRead(const HostReg *pReg);
+void SimDmaWrite(HostReg *pReg, uint32_t value);
+void SimSpiInit(void);
+
+// True while a frame or a DMA transfer is on the bus
+int SimSpiBusy(void);
+
+// True from the start of a DMA transfer until its completion interrupt
+int SimSpiDmaActive(void);
+
+typedef struct
+{
+    uint32_t bytes;         // bytes exchanged, polled and DMA
+    uint32_t dmaBytes;      // of which moved by DMA
+    uint32_t dmaTransfers;
+    uint32_t dmaCsChanges;  // chip select changes while a DMA transfer was shifting
+    uint64_t busyNs;        // time the bus was shifting
+} SimSpiStats;
+
+extern SimSpiStats SimSpi;
+
+// Optional recorder of the SPI byte stream: called for every byte exchanged
+// with the device it went to ('S' SD card, 'L' LCD command, 'l' LCD data,
+// 'M' VS1053 SCI, 'D' VS1053 SDI, 0 none).
+extern void (*SimSpiRecorder)(char device, uint8_t out, uint8_t in);
+
+
+/*---------------------------------- simSd.c ---------------------------------*/
+
+void SimSdInit(const char *image);
+void SimSdSelect(int selected);
+uint8_t SimSdExchange(uint8_t in);
+
+typedef struct
+{
+    uint32_t cmd[64];       // commands received, by index
+    uint32_t blocksRead;    // blocks sent, with the one a CMD18 has started when CMD12 stops it
+    uint32_t blocksWritten;
+} SimSdStats;
+
+extern SimSdStats SimSd;
+
+
+/*---------------------------------- simMp3.c --------------------------------*/
+
+void SimMp3Init(void);
+void SimMp3SelectCommand(int selected);
+void SimMp3SelectData(int selected);
+uint8_t SimMp3ExchangeCommand(uint8_t in);
+uint8_t SimMp3ExchangeData(uint8_t in);
+void SimMp3Update(void);    // brings the FIFO level and DREQ up to date
+
+typedef struct
+{
+    uint32_t sciReads;
+    uint32_t sciWrites;
+    uint32_t sdiBytes;
+    uint32_t overflows;     // SDI bytes sent while the FIFO was full
+    uint32_t underruns;     // times the FIFO ran dry while a stream was playing
+    uint64_t starvedNs;     // time the decoder waited for data while playing
+    uint32_t bitrate;       // of the last MPEG frame header seen, bits per second
+    uint32_t dreqWaits;     // times data came after DREQ had been low in a stream
+    uint64_t dreqLatencyNs; // from DREQ rising to the next data byte, summed
+    uint64_t dreqLatencyMaxNs;
+} SimMp3Stats;
+
+extern SimMp3Stats SimMp3;
+
+
+/*---------------------------------- simLcd.c --------------------------------*/
+
+void SimLcdInit(void);
+void SimLcdSelect(int selected);
+uint8_t SimLcdExchange(uint8_t in, int data);
+
+typedef struct
+{
+    uint32_t commandBytes;
+    uint32_t dataBytes;
+    uint32_t caset;
+    uint32_t paset;
+    uint32_t ramwr;
+    uint32_t pixels;
+} SimLcdStats;
+
+extern SimLcdStats SimLcd;
+extern uint16_t SimLcdFrame[SIM_LCD_HEIGHT][SIM_LCD_WIDTH];  // RGB565 by row (page), column
+
+
+/*--------------------------------- simTouch.c -------------------------------*/
+
+void SimTouchInit(void);
+void SimTouchPress(uint16_t x, uint16_t y);
+void SimTouchRelease(void);
+
+void SimI2cStart(int interruptsBlocked);  // the caller had the interrupts disabled
+void SimI2cStop(void);
+void SimI2cAddress(uint8_t address);
+void SimI2cSend(uint8_t data);
+uint8_t SimI2cReceive(void);
+void SimI2cAck(int enable);
+int SimI2cReady(void);      // the last START, address or byte has finished
+int SimI2cBusy(void);       // between START and STOP
+
+typedef struct
+{
+    uint32_t reads;         // bytes read from the FT6206
+    uint32_t writes;        // bytes written to it, register pointer included
+    uint32_t blockedTransfers;  // transfers started with the interrupts disabled
+    uint64_t blockedNs;     // their time from START to STOP on the bus
+    uint64_t blockedMaxNs;  // the longest of them
+} SimTouchStats;
+
+extern SimTouchStats SimTouch;
+
+
+/*---------------------------------- simUart.c -------------------------------*/
+
+// fd: where the bytes USART2 sends are written, -1 for nowhere.
+// inFd: host input fed to the receiver, -1 for none.
+void SimUartInit(int fd, int inFd);
+uint32_t SimUartRead(const HostReg *pReg);
+void SimUartWrite(HostReg *pReg, uint32_t value);
+
+// Queues bytes for the receiver, delivered one per byte time
+void SimUartInject(const char *data, uint32_t length);
+
+// Copies the last bytes sent (up to SIM_UART_CAPTURE_SIZE) to buf as a
+// string and returns their number
+uint32_t SimUartCapture(char *buf, uint32_t size);
+void SimUartCaptureClear(void);
+
+typedef struct
+{
+    uint32_t txBytes;
+    uint32_t rxBytes;
+    uint32_t overruns;      // received bytes lost because RXNE was still set
+} SimUartStats;
+
+extern SimUartStats SimUart;
+
+#endif /* __SIM_H */
@@ -0,0 +1,220 @@
+/*
+    simCore.c
+    Time base, input pins and EXTI lines, and the SPI1 chip select routing of
+    the host device models.
+
+    The SPI bus goes to the device whose chip select is asserted, i.e. the
+    pin is a GPIO output driven low:
+        SD card     PB5
+        LCD         PB6, with PC7 choosing command (low) or data (high)
+        VS1053 SCI  PA8
+        VS1053 SDI  PB10
+    A byte sent with none asserted reads 0xFF, with more than one it is
+    counted as a conflict and also reads 0xFF.
+
+    2026/10 written for the MP3Player project
+*/
+
+#include <malloc.h>
+#include <time.h>
+
+#include "bsp.h"
+#include "sim.h"
+
+SimBusStats SimBus;
+
+// The chip selects, in the order of the device bits below
+#define SEL_SD   0x01
+#define SEL_LCD  0x02
+#define SEL_MCS  0x04
+#define SEL_DCS  0x08
+
+static uint32_t selected; // SEL_ bits of the asserted chip selects
+
+
+uint64_t SimNow(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec;
+}
+
+
+/*------------------------------- Pins and EXTI ------------------------------*/
+
+// Index of the port in the SYSCFG EXTICR fields (EXTI_PortSourceGPIOx)
+static uint32_t PortIndex(GPIO_TypeDef *port)
+{
+    if (port == GPIOA) return 0;
+    if (port == GPIOB) return 1;
+    if (port == GPIOC) return 2;
+    if (port == GPIOD) return 3;
+    if (port == GPIOE) return 4;
+    return 7; // GPIOH
+}
+
+// NVIC line of an EXTI line
+static IRQn_Type ExtiIrq(uint32_t line)
+{
+    if (line <= 4) return (IRQn_Type)(EXTI0_IRQn + line);
+    if (line <= 9) return EXTI9_5_IRQn;
+    return EXTI15_10_IRQn;
+}
+
+void SimPinSet(GPIO_TypeDef *port, uint16_t pin, int high)
+{
+    OS_CPU_SR cpu_sr;
+    uint32_t old;
+    uint32_t line;
+    uint32_t lineBit;
+    BOOLEAN edge;
+
+    OS_ENTER_CRITICAL();
+    old = port->IDR & pin;
+    if (high) port->IDR |= pin;
+    else port->IDR &= ~(uint32_t)pin;
+
+    if (old != (port->IDR & pin))
+    {
+        for (line = 0; !(pin & (1u << line)); line++);
+        lineBit = 1u << line;
+        if (((HostSYSCFG.EXTICR[line >> 2].value >> ((line & 3) * 4)) & 0xF) == PortIndex(port))
+        {
+            edge = high ? (HostEXTI.RTSR.value & lineBit) != 0 : (HostEXTI.FTSR.value & lineBit) != 0;
+            if (edge)
+            {
+                HostEXTI.PR.value |= lineBit;
+                if (HostEXTI.IMR.value & lineBit) OS_CPU_IntPend((INT8U)ExtiIrq(line));
+            }
+        }
+    }
+    OS_EXIT_CRITICAL();
+}
+
+uint32_t SimExtiRead(const HostReg *pReg)
+{
+    return pReg->value;
+}
+
+// PR bits are cleared by writing 1. Unmasking a line with an edge pending
+// raises its interrupt.
+void SimExtiWrite(HostReg *pReg, uint32_t value)
+{
+    uint32_t line;
+    uint32_t raised;
+
+    if (pReg == &HostEXTI.PR)
+    {
+        HostEXTI.PR.value &= ~value;
+        return;
+    }
+    if (pReg == &HostEXTI.IMR)
+    {
+        raised = value & ~HostEXTI.IMR.value & HostEXTI.PR.value;
+        HostEXTI.IMR.value = value;
+        for (line = 0; line < 16; line++)
+        {
+            if (raised & (1u << line)) OS_CPU_IntPend((INT8U)ExtiIrq(line));
+        }
+        return;
+    }
+    pReg->value = value;
+}
+
+
+/*------------------------------- Chip selects -------------------------------*/
+
+// True if the pin is configured as an output and driven low
+static BOOLEAN Asserted(GPIO_TypeDef *port, uint16_t pin)
+{
+    uint32_t n;
+
+    for (n = 0; !(pin & (1u << n)); n++);
+    return ((port->MODER >> (n * 2)) & 3) == GPIO_Mode_OUT && !(port->ODR & pin);
+}
+
+void SimPinsChanged(void)
+{
+    uint32_t now = 0;
+    uint32_t changed;
+
+    if (Asserted(SD_ADAFRUIT_CS_GPIO, SD_ADAFRUIT_CS_GPIO_Pin)) now |= SEL_SD;
+    if (Asserted(LCD_ILI9341_CS_GPIO, LCD_ILI9341_CS_GPIO_Pin)) now |= SEL_LCD;
+    if (Asserted(MP3_VS1053_MCS_GPIO, MP3_VS1053_MCS_GPIO_Pin)) now |= SEL_MCS;
+    if (Asserted(MP3_VS1053_DCS_GPIO, MP3_VS1053_DCS_GPIO_Pin)) now |= SEL_DCS;
+
+    changed = now ^ selected;
+    if (changed == 0) return;
+    if (SimSpiDmaActive()) SimSpi.dmaCsChanges++;
+    selected = now;
+
+    if (changed & SEL_SD) SimSdSelect((now & SEL_SD) != 0);
+    if (changed & SEL_LCD) SimLcdSelect((now & SEL_LCD) != 0);
+    if (changed & SEL_MCS) SimMp3SelectCommand((now & SEL_MCS) != 0);
+    if (changed & SEL_DCS) SimMp3SelectData((now & SEL_DCS) != 0);
+}
+
+uint8_t SimSpiExchange(uint8_t out)
+{
+    uint8_t in = 0xFF;
+    char device = 0;
+
+    switch (selected)
+    {
+    case 0:
+        SimBus.unselected++;
+        break;
+    case SEL_SD:
+        in = SimSdExchange(out);
+        device = 'S';
+        break;
+    case SEL_LCD:
+        if (LCD_ILI9341_DC_GPIO->ODR & LCD_ILI9341_DC_GPIO_Pin)
+        {
+            in = SimLcdExchange(out, 1);
+            device = 'l';
+        }
+        else
+        {
+            in = SimLcdExchange(out, 0);
+            device = 'L';
+        }
+        break;
+    case SEL_MCS:
+        in = SimMp3ExchangeCommand(out);
+        device = 'M';
+        break;
+    case SEL_DCS:
+        in = SimMp3ExchangeData(out);
+        device = 'D';
+        break;
+    default:
+        SimBus.csConflicts++;
+        break;
+    }
+    if (SimSpiRecorder != 0) SimSpiRecorder(device, out, in);
+    return in;
+}
+
+
+/*----------------------------------- Start ----------------------------------*/
+
+void SimInit(const char *sdImage, int uartFd, int uartInFd)
+{
+    OS_CPU_SR cpu_sr;
+
+    // Keep the heap, and so the task stacks, in the brk area below 4 GB:
+    // the DMA model takes 32 bit addresses, see simSpi.c
+    mallopt(M_MMAP_MAX, 0);
+
+    OS_ENTER_CRITICAL();
+    SimSpiInit();
+    SimSdInit(sdImage);
+    SimMp3Init();
+    SimLcdInit();
+    SimTouchInit();
+    SimUartInit(uartFd, uartInFd);
+    HostVectorsInit();
+    OS_EXIT_CRITICAL();
+}
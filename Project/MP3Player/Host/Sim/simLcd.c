@@ -0,0 +1,120 @@
+/*
+    simLcd.c
+    ILI9341 LCD controller: the address window commands and the frame memory.
+
+    Bytes sent with DC low are commands, with DC high their parameters or
+    pixel data. CASET and PASET set the column and page range of the window,
+    RAMWR starts writing RGB565 pixels (high byte first) at its top left
+    corner, left to right and wrapping to the next page at the right edge, as
+    the controller does. The other commands are only counted. Pixels outside
+    240 x 320 are dropped, so a rotated screen (MADCTL) is stored in the
+    orientation it is addressed in.
+
+    The counters show how many bytes of each kind a drawing operation costs.
+
+    2026/10 written for the MP3Player project
+*/
+
+#include <string.h>
+
+#include "bsp.h"
+#include "sim.h"
+
+SimLcdStats SimLcd;
+uint16_t SimLcdFrame[SIM_LCD_HEIGHT][SIM_LCD_WIDTH];
+
+#define LCD_CASET   0x2A
+#define LCD_PASET   0x2B
+#define LCD_RAMWR   0x2C
+
+static uint8_t command;         // last command byte
+static uint8_t args[4];
+static uint32_t argLength;
+static uint16_t x0, x1, y0, y1; // window
+static uint16_t x, y;           // write cursor
+static uint8_t pixelHigh;
+static BOOLEAN pixelHalf;       // the high byte of a pixel has been received
+
+
+static void Pixel(uint16_t color)
+{
+    if (x < SIM_LCD_WIDTH && y < SIM_LCD_HEIGHT) SimLcdFrame[y][x] = color;
+    SimLcd.pixels++;
+    if (x < x1)
+    {
+        x++;
+        return;
+    }
+    x = x0;
+    y = (y < y1) ? y + 1 : y0;
+}
+
+// The controller keeps its place across chip select changes: the driver
+// may deselect between the two bytes of a pixel
+void SimLcdSelect(int selected)
+{
+}
+
+uint8_t SimLcdExchange(uint8_t in, int data)
+{
+    if (!data)
+    {
+        SimLcd.commandBytes++;
+        command = in;
+        argLength = 0;
+        pixelHalf = OS_FALSE;
+        if (in == LCD_CASET) SimLcd.caset++;
+        if (in == LCD_PASET) SimLcd.paset++;
+        if (in == LCD_RAMWR)
+        {
+            SimLcd.ramwr++;
+            x = x0;
+            y = y0;
+        }
+        return 0;
+    }
+
+    SimLcd.dataBytes++;
+    switch (command)
+    {
+    case LCD_CASET:
+    case LCD_PASET:
+        if (argLength >= sizeof(args)) break;
+        args[argLength++] = in;
+        if (argLength < sizeof(args)) break;
+        if (command == LCD_CASET)
+        {
+            x0 = (uint16_t)(args[0] << 8 | args[1]);
+            x1 = (uint16_t)(args[2] << 8 | args[3]);
+        }
+        else
+        {
+            y0 = (uint16_t)(args[0] << 8 | args[1]);
+            y1 = (uint16_t)(args[2] << 8 | args[3]);
+        }
+        break;
+    case LCD_RAMWR:
+        if (!pixelHalf)
+        {
+            pixelHigh = in;
+            pixelHalf = OS_TRUE;
+            break;
+        }
+        pixelHalf = OS_FALSE;
+        Pixel((uint16_t)(pixelHigh << 8 | in));
+        break;
+    }
+    return 0;
+}
+
+void SimLcdInit(void)
+{
+    memset(&SimLcd, 0, sizeof(SimLcd));
+    memset(SimLcdFrame, 0, sizeof(SimLcdFrame));
+    command = 0;
+    argLength = 0;
+    x0 = y0 = 0;
+    x1 = SIM_LCD_WIDTH - 1;
+    y1 = SIM_LCD_HEIGHT - 1;
+    pixelHalf = OS_FALSE;
+}
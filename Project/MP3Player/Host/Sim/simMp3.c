@@ -0,0 +1,257 @@
+/*
+    simMp3.c
+    VS1053 MP3 decoder: the SCI registers, the SDI stream FIFO and DREQ.
+
+    SCI transfers are 4 bytes, opcode (2 write, 3 read), register address and
+    the 16 bit value. A write of SCI_MODE ends the stream being played; with
+    SM_RESET set the FIFO is emptied and DREQ stays low for the reset time.
+
+    SDI bytes go into a FIFO of MP3_FIFO_SIZE bytes that the decoder drains
+    at the bitrate of the MPEG frames it has locked onto (128 kbps until the
+    first frame header). DREQ (PB3) is high while at least MP3_DREQ_FREE
+    bytes are free. The FIFO level is computed from the clock whenever the
+    pin is read or a byte arrives, and a host timer raises DREQ when it would
+    have risen, so the EXTI interrupt comes on time.
+
+    The model counts bytes sent into a full FIFO (which the real decoder
+    drops) and the times it ran dry in the middle of a stream, with the time
+    it waited for data: those are the audible glitches. It also times how
+    long the driver takes to send again after DREQ rises.
+
+    2026/10 written for the MP3Player project
+*/
+
+#include <string.h>
+
+#include "bsp.h"
+#include "sim.h"
+
+SimMp3Stats SimMp3;
+
+#define MP3_FIFO_SIZE       2048
+#define MP3_DREQ_FREE       32          // DREQ is high with this much room
+#define MP3_RESET_NS        1000000u    // DREQ low after SM_RESET
+#define MP3_SM_RESET        0x0004
+
+static uint16_t regs[16];
+static uint8_t sci[4];
+static uint32_t sciLength;
+
+static uint32_t fifo;              // bytes in the FIFO
+static uint64_t drainedAt;         // time the FIFO level was last brought up to date
+static uint64_t drainNs;           // time to the next byte leaving, carried over
+static uint64_t emptyAt;           // time the FIFO ran dry
+static uint64_t resetEnd;
+static BOOLEAN playing;            // SDI data arrived since the last SCI_MODE write
+static BOOLEAN dreqHigh;
+static uint64_t dreqRoseAt;        // DREQ rose during a stream and no byte has come since, or 0
+static uint32_t byteRate = 128000 / 8;
+
+// MPEG-1 Layer III frame header parser
+static uint8_t header[4];
+static uint32_t headerLength;
+static uint32_t frameSkip;         // bytes left in the current frame
+
+static const uint16_t bitrates[16] = { 0, 32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 0 };
+static const uint32_t sampleRates[4] = { 44100, 48000, 32000, 0 };
+
+
+// Feeds one stream byte to the parser: after a valid header the rest of the
+// frame is skipped, so the rate follows real frame headers and not data
+// that happens to look like one
+static void Parse(uint8_t byte)
+{
+    uint32_t bitrate;
+    uint32_t sampleRate;
+    uint32_t length;
+
+    if (frameSkip > 0)
+    {
+        frameSkip--;
+        return;
+    }
+    if (headerLength == 0 && byte != 0xFF) return;
+    header[headerLength++] = byte;
+    if (headerLength == 2 && (header[1] & 0xFE) != 0xFA)    // MPEG-1 Layer III
+    {
+        headerLength = (byte == 0xFF) ? 1 : 0;
+        header[0] = byte;
+        return;
+    }
+    if (headerLength < 4) return;
+    headerLength = 0;
+
+    bitrate = bitrates[header[2] >> 4];
+    sampleRate = sampleRates[(header[2] >> 2) & 3];
+    if (bitrate == 0 || sampleRate == 0) return;
+    length = 144 * bitrate * 1000 / sampleRate + ((header[2] >> 1) & 1);
+    frameSkip = length - 4;
+    SimMp3.bitrate = bitrate * 1000;
+    byteRate = bitrate * 1000 / 8;
+}
+
+// Drives DREQ and, while it is low, arms the timer for when it will rise
+static void Dreq(uint64_t now)
+{
+    BOOLEAN resetting = now < resetEnd;
+    BOOLEAN high = !resetting && MP3_FIFO_SIZE - fifo >= MP3_DREQ_FREE;
+    uint64_t wait;
+
+    SimPinSet(MP3_VS1053_DREQ_GPIO, MP3_VS1053_DREQ_GPIO_Pin, high);
+    if (high && !dreqHigh && playing) dreqRoseAt = now;
+    dreqHigh = high;
+    if (high)
+    {
+        OS_CPU_IntTimer(SIM_IRQ_DREQ, 0);
+        return;
+    }
+    if (resetting) wait = resetEnd - now;
+    else wait = (fifo - (MP3_FIFO_SIZE - MP3_DREQ_FREE)) * (1000000000ull / byteRate) - drainNs;
+    OS_CPU_IntTimer(SIM_IRQ_DREQ, (INT32U)wait + 1);
+}
+
+void SimMp3Update(void)
+{
+    uint64_t now = SimNow();
+    uint64_t elapsed;
+    uint64_t byteNs = 1000000000ull / byteRate;
+
+    if (now < resetEnd)
+    {
+        drainedAt = now;
+        drainNs = 0;
+    }
+    else if (fifo > 0)
+    {
+        elapsed = now - drainedAt + drainNs;
+        if (elapsed / byteNs >= fifo)
+        {
+            emptyAt = drainedAt + fifo * byteNs - drainNs;
+            fifo = 0;
+            drainNs = 0;
+        }
+        else
+        {
+            fifo -= (uint32_t)(elapsed / byteNs);
+            drainNs = elapsed % byteNs;
+        }
+    }
+    drainedAt = now;
+    Dreq(now);
+}
+
+static void DreqTimer(void)
+{
+    SimMp3Update();
+}
+
+
+/*------------------------------------ SCI -----------------------------------*/
+
+void SimMp3SelectCommand(int selected)
+{
+    sciLength = 0;
+}
+
+uint8_t SimMp3ExchangeCommand(uint8_t in)
+{
+    uint8_t out = 0xFF;
+    uint8_t address;
+
+    if (sciLength >= sizeof(sci)) return 0xFF;
+    sci[sciLength] = in;
+    address = sci[1] & 0x0F;
+    if (sci[0] == 3 && sciLength == 2) out = (uint8_t)(regs[address] >> 8);
+    if (sci[0] == 3 && sciLength == 3) out = (uint8_t)regs[address];
+    sciLength++;
+    if (sciLength < sizeof(sci)) return out;
+
+    if (sci[0] == 3)
+    {
+        SimMp3.sciReads++;
+    }
+    else if (sci[0] == 2)
+    {
+        SimMp3.sciWrites++;
+        regs[address] = (uint16_t)(sci[2] << 8 | sci[3]);
+        if (address == 0) // SCI_MODE
+        {
+            SimMp3Update();
+            playing = OS_FALSE;
+            dreqRoseAt = 0;
+            if (regs[0] & MP3_SM_RESET)
+            {
+                regs[0] &= ~MP3_SM_RESET;
+                fifo = 0;
+                drainNs = 0;
+                headerLength = 0;
+                frameSkip = 0;
+                byteRate = 128000 / 8;
+                resetEnd = SimNow() + MP3_RESET_NS;
+                Dreq(SimNow());
+            }
+        }
+    }
+    return out;
+}
+
+
+/*------------------------------------ SDI -----------------------------------*/
+
+void SimMp3SelectData(int selected)
+{
+}
+
+uint8_t SimMp3ExchangeData(uint8_t in)
+{
+    uint64_t now;
+
+    SimMp3Update();
+    now = SimNow();
+    SimMp3.sdiBytes++;
+    if (now < resetEnd || fifo == MP3_FIFO_SIZE)
+    {
+        SimMp3.overflows++;
+        return 0xFF;
+    }
+    if (playing && fifo == 0 && emptyAt < now)
+    {
+        SimMp3.underruns++;
+        SimMp3.starvedNs += now - emptyAt;
+    }
+    if (dreqRoseAt != 0)
+    {
+        SimMp3.dreqWaits++;
+        SimMp3.dreqLatencyNs += now - dreqRoseAt;
+        if (now - dreqRoseAt > SimMp3.dreqLatencyMaxNs) SimMp3.dreqLatencyMaxNs = now - dreqRoseAt;
+        dreqRoseAt = 0;
+    }
+    playing = OS_TRUE;
+    if (fifo == 0) drainNs = 0;
+    fifo++;
+    Parse(in);
+    Dreq(now);
+    return 0xFF;
+}
+
+void SimMp3Init(void)
+{
+    memset(&SimMp3, 0, sizeof(SimMp3));
+    memset(regs, 0, sizeof(regs));
+    regs[0] = 0x0800; // SM_SDINEW
+    regs[1] = 0x0040; // SCI_STATUS: VS1053
+    sciLength = 0;
+    fifo = 0;
+    drainedAt = SimNow();
+    drainNs = 0;
+    resetEnd = 0;
+    playing = OS_FALSE;
+    dreqHigh = OS_FALSE;
+    dreqRoseAt = 0;
+    headerLength = 0;
+    frameSkip = 0;
+    byteRate = 128000 / 8;
+    OS_CPU_IntSet(SIM_IRQ_DREQ, DreqTimer);
+    OS_CPU_IntEn(SIM_IRQ_DREQ, OS_TRUE);
+    Dreq(drainedAt);
+}
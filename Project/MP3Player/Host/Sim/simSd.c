@@ -0,0 +1,333 @@
+/*
+    simSd.c
+    SD card in SPI mode, backed by an image file.
+
+    The card answers as an SDHC card (block addressing) to the commands
+    Sd2Card uses: CMD0, CMD8, CMD55/ACMD41, CMD58, CMD9, CMD10, CMD17, CMD18,
+    CMD12, CMD24, ACMD23/CMD25 and CMD13. The bytes it sends are queued and
+    go out one per exchange, each response after one NCR byte of 0xFF, so the
+    driver's polling loops see the order and byte count of a real card.
+    Blocks are read and written with pread() and pwrite() on the image, so
+    the card keeps no state between runs other than the image itself.
+
+    Without an image the card does not answer: every byte reads 0xFF.
+
+    2026/10 written for the MP3Player project
+*/
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "bsp.h"
+#include "sim.h"
+
+SimSdStats SimSd;
+
+#define SD_BLOCK_SIZE       512
+#define SD_QUEUE_SIZE       (SD_BLOCK_SIZE + 8)
+
+typedef enum
+{
+    SD_IDLE,          // waiting for a command
+    SD_COMMAND,       // receiving the 6 command bytes
+    SD_READ_MULTI,    // streaming blocks after CMD18 until CMD12
+    SD_WRITE_WAIT,    // waiting for the data token of a write
+    SD_WRITE_DATA,    // receiving a data block and its CRC
+} SdState;
+
+static int image = -1;
+static uint32_t blocks;          // capacity in blocks
+static SdState state;
+static BOOLEAN idle;             // in the idle state until ACMD41
+static BOOLEAN appCmd;           // the last command was CMD55
+static BOOLEAN multiWrite;       // CMD25 rather than CMD24
+static uint8_t command[6];
+static uint32_t commandLength;
+static uint32_t block;           // next block to stream or write
+static uint8_t data[SD_BLOCK_SIZE + 2];
+static uint32_t dataLength;
+
+static uint8_t queue[SD_QUEUE_SIZE];  // bytes to send
+static uint32_t queueHead;
+static uint32_t queueLength;
+
+
+static void Queue(uint8_t byte)
+{
+    if (queueLength == SD_QUEUE_SIZE) while(1); // responses are never longer
+    queue[(queueHead + queueLength++) % SD_QUEUE_SIZE] = byte;
+}
+
+static void QueueClear(void)
+{
+    queueHead = 0;
+    queueLength = 0;
+}
+
+// Queues the start token, the block and a dummy CRC, or a data error token
+// for a block past the end of the card
+static void QueueBlock(uint32_t n)
+{
+    uint8_t buf[SD_BLOCK_SIZE];
+    uint32_t i;
+
+    if (n >= blocks || pread(image, buf, SD_BLOCK_SIZE, (off_t)n * SD_BLOCK_SIZE) != SD_BLOCK_SIZE)
+    {
+        Queue(0x08); // data error token: out of range
+        return;
+    }
+    Queue(0xFE);
+    for (i = 0; i < SD_BLOCK_SIZE; i++) Queue(buf[i]);
+    Queue(0xFF);
+    Queue(0xFF);
+    SimSd.blocksRead++;
+}
+
+// Queues a register read: start token, 16 bytes and a dummy CRC
+static void QueueRegister(const uint8_t *reg)
+{
+    uint32_t i;
+
+    Queue(0xFE);
+    for (i = 0; i < 16; i++) Queue(reg[i]);
+    Queue(0xFF);
+    Queue(0xFF);
+}
+
+static void Command(void)
+{
+    uint8_t index = command[0] & 0x3F;
+    uint32_t arg = (uint32_t)command[1] << 24 | (uint32_t)command[2] << 16 |
+        (uint32_t)command[3] << 8 | command[4];
+    BOOLEAN app = appCmd;
+    uint8_t csd[16];
+    uint8_t cid[16];
+    uint32_t cSize;
+
+    SimSd.cmd[index]++;
+    appCmd = OS_FALSE;
+    state = SD_IDLE;
+    Queue(0xFF); // NCR
+
+    if (app)
+    {
+        switch (index)
+        {
+        case 41: // ACMD41 SD_SEND_OP_COND
+            idle = OS_FALSE;
+            Queue(0x00);
+            return;
+        case 23: // ACMD23 SET_WR_BLK_ERASE_COUNT
+            Queue(0x00);
+            return;
+        }
+    }
+
+    switch (index)
+    {
+    case 0: // GO_IDLE_STATE
+        idle = OS_TRUE;
+        Queue(0x01);
+        break;
+    case 8: // SEND_IF_COND: voltage accepted, check pattern echoed
+        Queue(idle ? 0x01 : 0x00);
+        Queue(0x00);
+        Queue(0x00);
+        Queue(0x01);
+        Queue(0xAA);
+        break;
+    case 55: // APP_CMD
+        appCmd = OS_TRUE;
+        Queue(idle ? 0x01 : 0x00);
+        break;
+    case 58: // READ_OCR: powered up, high capacity
+        Queue(idle ? 0x01 : 0x00);
+        Queue(0xC0);
+        Queue(0xFF);
+        Queue(0x80);
+        Queue(0x00);
+        break;
+    case 9: // SEND_CSD, version 2.0
+        memset(csd, 0, sizeof(csd));
+        cSize = blocks / 1024 - 1;
+        csd[0] = 0x40;
+        csd[7] = (uint8_t)((cSize >> 16) & 0x3F);
+        csd[8] = (uint8_t)(cSize >> 8);
+        csd[9] = (uint8_t)cSize;
+        Queue(0x00);
+        Queue(0xFF);
+        QueueRegister(csd);
+        break;
+    case 10: // SEND_CID
+        memset(cid, 0, sizeof(cid));
+        memcpy(cid + 1, "SMHOSTSD", 8);
+        Queue(0x00);
+        Queue(0xFF);
+        QueueRegister(cid);
+        break;
+    case 17: // READ_SINGLE_BLOCK
+        if (arg >= blocks)
+        {
+            Queue(0x40); // address error
+            break;
+        }
+        Queue(0x00);
+        Queue(0xFF);
+        QueueBlock(arg);
+        break;
+    case 18: // READ_MULTIPLE_BLOCK
+        if (arg >= blocks)
+        {
+            Queue(0x40);
+            break;
+        }
+        Queue(0x00);
+        block = arg;
+        state = SD_READ_MULTI;
+        break;
+    case 12: // STOP_TRANSMISSION: stuff byte, then R1b
+        Queue(0xFF);
+        Queue(0x00);
+        break;
+    case 24: // WRITE_BLOCK
+    case 25: // WRITE_MULTIPLE_BLOCK
+        if (arg >= blocks)
+        {
+            Queue(0x40);
+            break;
+        }
+        Queue(0x00);
+        block = arg;
+        multiWrite = index == 25;
+        state = SD_WRITE_WAIT;
+        break;
+    case 13: // SEND_STATUS, R2
+        Queue(0x00);
+        Queue(0x00);
+        break;
+    default:
+        Queue(0x04 | (idle ? 0x01 : 0x00)); // illegal command
+        break;
+    }
+}
+
+// A data block has been received: program it and queue the data response
+static void WriteBlock(void)
+{
+    if (block >= blocks ||
+        pwrite(image, data, SD_BLOCK_SIZE, (off_t)block * SD_BLOCK_SIZE) != SD_BLOCK_SIZE)
+    {
+        Queue(0x0D); // write error
+    }
+    else
+    {
+        Queue(0x05); // accepted
+        SimSd.blocksWritten++;
+        block++;
+    }
+    Queue(0x00); // busy while programming
+    Queue(0x00);
+    state = multiWrite ? SD_WRITE_WAIT : SD_IDLE;
+}
+
+uint8_t SimSdExchange(uint8_t in)
+{
+    uint8_t out = 0xFF;
+
+    if (image < 0) return 0xFF;
+
+    if (queueLength > 0)
+    {
+        out = queue[queueHead];
+        queueHead = (queueHead + 1) % SD_QUEUE_SIZE;
+        queueLength--;
+    }
+    else if (state == SD_READ_MULTI)
+    {
+        // Keep the next block coming: the token follows after a gap byte
+        QueueBlock(block++);
+        out = 0xFF;
+    }
+
+    switch (state)
+    {
+    case SD_IDLE:
+    case SD_READ_MULTI:
+        if ((in & 0xC0) == 0x40)
+        {
+            if (state == SD_READ_MULTI) QueueClear();
+            command[0] = in;
+            commandLength = 1;
+            state = SD_COMMAND;
+        }
+        break;
+    case SD_COMMAND:
+        command[commandLength++] = in;
+        if (commandLength == sizeof(command)) Command();
+        break;
+    case SD_WRITE_WAIT:
+        if (in == 0xFE || in == 0xFC)
+        {
+            dataLength = 0;
+            state = SD_WRITE_DATA;
+        }
+        else if (in == 0xFD && multiWrite)
+        {
+            Queue(0x00); // busy after the stop token
+            Queue(0x00);
+            state = SD_IDLE;
+        }
+        else if ((in & 0xC0) == 0x40)
+        {
+            command[0] = in;
+            commandLength = 1;
+            state = SD_COMMAND;
+        }
+        break;
+    case SD_WRITE_DATA:
+        data[dataLength++] = in;
+        if (dataLength == sizeof(data)) WriteBlock();
+        break;
+    }
+    return out;
+}
+
+// Deselecting the card abandons whatever it was sending
+void SimSdSelect(int selected)
+{
+    if (selected) return;
+    QueueClear();
+    if (state != SD_WRITE_WAIT || !multiWrite) state = SD_IDLE;
+}
+
+void SimSdInit(const char *path)
+{
+    off_t size;
+
+    memset(&SimSd, 0, sizeof(SimSd));
+    QueueClear();
+    state = SD_IDLE;
+    idle = OS_TRUE;
+    appCmd = OS_FALSE;
+    if (image >= 0) close(image);
+    image = -1;
+    blocks = 0;
+    if (path == 0) return;
+
+    image = open(path, O_RDWR);
+    if (image < 0)
+    {
+        perror(path);
+        exit(1);
+    }
+    size = lseek(image, 0, SEEK_END);
+    blocks = (uint32_t)(size / SD_BLOCK_SIZE);
+    if (blocks < 1024)
+    {
+        fprintf(stderr, "sim: SD image %s is smaller than 512 KB\n", path);
+        exit(1);
+    }
+}
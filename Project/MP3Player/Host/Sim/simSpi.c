@@ -0,0 +1,246 @@
+/*
+    simSpi.c
+    SPI1 and the DMA2 streams that serve it (stream 0 receive, stream 3
+    transmit).
+
+    A frame takes 8 or 16 bit times at HSI / 2^(BR+1). The byte is exchanged
+    with the selected device as soon as DR is written; the flags then follow
+    the bus time: TXE comes back when the frame starts shifting, RXNE and the
+    end of BSY when it is done, so a second write queues behind the first as
+    in the transmit buffer of the real interface.
+
+    A DMA transfer starts when both streams are enabled and SPI CR2 requests
+    DMA for both directions. All its frames are exchanged at once; the
+    completion (TCIF0/TCIF3 and the stream 0 interrupt) is raised by a host
+    timer when the last frame would have finished shifting. The memory
+    addresses of the streams are 32 bit, so the buffers must live in the
+    program image or the heap below 4 GB (see SimInit()).
+
+    2026/10 written for the MP3Player project
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "bsp.h"
+#include "sim.h"
+
+SimSpiStats SimSpi;
+void (*SimSpiRecorder)(char device, uint8_t out, uint8_t in);
+
+static uint64_t txStart;     // the last frame written starts shifting
+static uint64_t shiftEnd;    // the bus is idle again
+static uint32_t rxData;
+static BOOLEAN rxPending;
+static BOOLEAN dmaActive;
+
+extern "C" char __executable_start;
+
+
+// Time of one frame at the current prescaler and frame size
+static uint64_t FrameNs(void)
+{
+    uint32_t cr1 = HostSPI1.CR1.value;
+    uint64_t bits = (cr1 & SPI_CR1_DFF) ? 16 : 8;
+    uint64_t divider = 2u << ((cr1 & SPI_CR1_BR) >> 3);
+
+    return bits * divider * 1000000000u / HSI_VALUE;
+}
+
+// Exchanges one 8 or 16 bit frame with the selected device, MSB first
+static uint32_t Frame(uint32_t out, BOOLEAN wide)
+{
+    uint32_t in;
+
+    if (!wide) return SimSpiExchange((uint8_t)out);
+    in = (uint32_t)SimSpiExchange((uint8_t)(out >> 8)) << 8;
+    return in | SimSpiExchange((uint8_t)out);
+}
+
+int SimSpiBusy(void)
+{
+    return dmaActive || SimNow() < shiftEnd;
+}
+
+int SimSpiDmaActive(void)
+{
+    return dmaActive;
+}
+
+
+/*---------------------------------- Polled ----------------------------------*/
+
+uint32_t SimSpiRead(const HostReg *pReg)
+{
+    uint64_t now = SimNow();
+    uint32_t sr = 0;
+
+    if (pReg == &HostSPI1.SR)
+    {
+        if (!dmaActive && now >= txStart) sr |= SPI_SR_TXE;
+        if (rxPending && now >= shiftEnd) sr |= SPI_SR_RXNE;
+        if (dmaActive || now < shiftEnd) sr |= SPI_SR_BSY;
+        return sr;
+    }
+    if (pReg == &HostSPI1.DR)
+    {
+        rxPending = OS_FALSE;
+        return rxData;
+    }
+    return pReg->value;
+}
+
+static void DmaStart(void);
+
+void SimSpiWrite(HostReg *pReg, uint32_t value)
+{
+    uint64_t now;
+    uint64_t frameNs;
+    BOOLEAN wide;
+
+    if (pReg == &HostSPI1.DR)
+    {
+        if (!(HostSPI1.CR1.value & SPI_CR1_SPE)) return;
+        now = SimNow();
+        frameNs = FrameNs();
+        wide = (HostSPI1.CR1.value & SPI_CR1_DFF) != 0;
+        txStart = now > shiftEnd ? now : shiftEnd;
+        shiftEnd = txStart + frameNs;
+        rxData = Frame(value, wide);
+        rxPending = OS_TRUE;
+        SimSpi.bytes += wide ? 2 : 1;
+        SimSpi.busyNs += frameNs;
+        return;
+    }
+    pReg->value = value;
+    if (pReg == &HostSPI1.CR2 &&
+        (value & (SPI_CR2_RXDMAEN | SPI_CR2_TXDMAEN)) == (SPI_CR2_RXDMAEN | SPI_CR2_TXDMAEN) &&
+        (HostDMA2Stream0.CR.value & DMA_SxCR_EN) && (HostDMA2Stream3.CR.value & DMA_SxCR_EN) &&
+        !dmaActive)
+    {
+        DmaStart();
+    }
+}
+
+
+/*------------------------------------ DMA -----------------------------------*/
+
+// Stops the program on a stream address a DMA transfer of the target could
+// not reach either: the memory must be in the image or the heap.
+static void DmaCheck(uint32_t address, uint32_t length)
+{
+    uintptr_t start = (uintptr_t)&__executable_start;
+    uintptr_t end = (uintptr_t)sbrk(0);
+
+    if (address < start || (uintptr_t)address + length > end)
+    {
+        fprintf(stderr, "sim: DMA buffer 0x%08x (%u bytes) outside program memory\n",
+            (unsigned)address, (unsigned)length);
+        abort();
+    }
+}
+
+// Completion of the transfer, raised by the host timer
+static void DmaDone(void)
+{
+    if (!dmaActive) return;
+    dmaActive = OS_FALSE;
+    HostDMA2Stream0.CR.value &= ~DMA_SxCR_EN;
+    HostDMA2Stream3.CR.value &= ~DMA_SxCR_EN;
+    HostDMA2Stream0.NDTR.value = 0;
+    HostDMA2Stream3.NDTR.value = 0;
+    HostDMA2.LISR.value |= DMA_LISR_TCIF0 | DMA_LISR_TCIF3;
+    if (HostDMA2Stream0.CR.value & DMA_SxCR_TCIE) OS_CPU_IntPend(DMA2_Stream0_IRQn);
+}
+
+static void DmaStart(void)
+{
+    uint32_t n = HostDMA2Stream3.NDTR.value;
+    uint32_t txCr = HostDMA2Stream3.CR.value;
+    uint32_t rxCr = HostDMA2Stream0.CR.value;
+    BOOLEAN wide = (HostSPI1.CR1.value & SPI_CR1_DFF) != 0;
+    uint32_t size = wide ? 2 : 1;
+    uint32_t txAddress = HostDMA2Stream3.M0AR.value;
+    uint32_t rxAddress = HostDMA2Stream0.M0AR.value;
+    uint64_t start;
+    uint64_t frameNs = FrameNs();
+    uint32_t in;
+    uint32_t out;
+    uint32_t i;
+
+    if (HostDMA2Stream0.PAR.value != (uint32_t)(uintptr_t)&HostSPI1.DR ||
+        HostDMA2Stream3.PAR.value != (uint32_t)(uintptr_t)&HostSPI1.DR)
+    {
+        fprintf(stderr, "sim: DMA stream peripheral address is not SPI1 DR\n");
+        abort();
+    }
+    if ((txCr & DMA_SxCR_PSIZE_0) != (wide ? DMA_SxCR_PSIZE_0 : 0))
+    {
+        fprintf(stderr, "sim: DMA peripheral size does not match the SPI frame size\n");
+        abort();
+    }
+    DmaCheck(txAddress, (txCr & DMA_SxCR_MINC) ? n * size : size);
+    DmaCheck(rxAddress, (rxCr & DMA_SxCR_MINC) ? n * size : size);
+
+    for (i = 0; i < n; i++)
+    {
+        if (wide) out = *(uint16_t *)(uintptr_t)txAddress;
+        else out = *(uint8_t *)(uintptr_t)txAddress;
+        in = Frame(out, wide);
+        if (wide) *(uint16_t *)(uintptr_t)rxAddress = (uint16_t)in;
+        else *(uint8_t *)(uintptr_t)rxAddress = (uint8_t)in;
+        if (txCr & DMA_SxCR_MINC) txAddress += size;
+        if (rxCr & DMA_SxCR_MINC) rxAddress += size;
+    }
+
+    start = SimNow();
+    if (shiftEnd > start) start = shiftEnd;
+    shiftEnd = txStart = start + n * frameNs;
+    dmaActive = OS_TRUE;
+    SimSpi.bytes += n * size;
+    SimSpi.dmaBytes += n * size;
+    SimSpi.dmaTransfers++;
+    SimSpi.busyNs += n * frameNs;
+    OS_CPU_IntTimer(SIM_IRQ_DMA, (INT32U)(shiftEnd - SimNow()) + 1);
+}
+
+uint32_t SimDmaRead(const HostReg *pReg)
+{
+    return pReg->value;
+}
+
+void SimDmaWrite(HostReg *pReg, uint32_t value)
+{
+    if (pReg == &HostDMA2.LIFCR)
+    {
+        HostDMA2.LISR.value &= ~value;
+        return;
+    }
+    if (pReg == &HostDMA2.HIFCR)
+    {
+        HostDMA2.HISR.value &= ~value;
+        return;
+    }
+    if ((pReg == &HostDMA2Stream0.CR || pReg == &HostDMA2Stream3.CR) &&
+        !(value & DMA_SxCR_EN) && dmaActive)
+    {
+        // Disabling a stream aborts the transfer: the data already went
+        // out, only the completion is dropped
+        OS_CPU_IntTimer(SIM_IRQ_DMA, 0);
+        dmaActive = OS_FALSE;
+        HostDMA2Stream0.CR.value &= ~DMA_SxCR_EN;
+        HostDMA2Stream3.CR.value &= ~DMA_SxCR_EN;
+    }
+    pReg->value = value;
+}
+
+void SimSpiInit(void)
+{
+    txStart = 0;
+    shiftEnd = 0;
+    rxPending = OS_FALSE;
+    dmaActive = OS_FALSE;
+    OS_CPU_IntSet(SIM_IRQ_DMA, DmaDone);
+    OS_CPU_IntEn(SIM_IRQ_DMA, OS_TRUE);
+}
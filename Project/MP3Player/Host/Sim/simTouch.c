@@ -0,0 +1,169 @@
+/*
+    simTouch.c
+    FT6206 capacitive touch controller on I2C1, and its INT line (PB4).
+
+    The controller is a 256 byte register file at address 0x38. A write
+    transfer sets the register pointer with its first byte and writes
+    registers with the rest; a read transfer returns registers from the
+    pointer on. SimTouchPress() reports one touch point and pulls INT low,
+    SimTouchRelease() clears it and lets INT go high again, as the FT6206
+    does in its default interrupt (polling) mode.
+
+    The bus runs at 100 kHz: START takes 10 us and every address or data byte
+    with its acknowledge 90 us. I2C_CheckEvent() succeeds once the last step
+    has finished; receiving runs one byte ahead while acknowledging, as the
+    STM32 interface does.
+
+    2026/10 written for the MP3Player project
+*/
+
+#include <string.h>
+
+#include "bsp.h"
+#include "sim.h"
+
+SimTouchStats SimTouch;
+
+#define FT6206_ADDRESS   0x38
+#define I2C_START_NS     10000u
+#define I2C_BYTE_NS      90000u
+
+static uint8_t regs[256];
+static uint8_t pointer;
+static BOOLEAN started;       // between START and STOP
+static BOOLEAN addressed;     // the FT6206 acknowledged the address
+static BOOLEAN receiving;
+static BOOLEAN pointerSet;    // the first byte of a write transfer was received
+static BOOLEAN ack;
+static uint64_t readyAt;      // the last step finishes
+static uint64_t stopAt;       // STOP goes out, 0 if not requested
+static uint64_t startAt;      // START went out
+static BOOLEAN blocked;       // START was given with the interrupts disabled
+
+
+static uint64_t After(uint64_t ns)
+{
+    uint64_t now = SimNow();
+
+    return (readyAt > now ? readyAt : now) + ns;
+}
+
+void SimI2cStart(int interruptsBlocked)
+{
+    started = OS_TRUE;
+    addressed = OS_FALSE;
+    stopAt = 0;
+    startAt = After(0);
+    blocked = interruptsBlocked != 0;
+    readyAt = After(I2C_START_NS);
+}
+
+void SimI2cStop(void)
+{
+    stopAt = readyAt > SimNow() ? readyAt : SimNow();
+    if (blocked)
+    {
+        SimTouch.blockedTransfers++;
+        SimTouch.blockedNs += stopAt - startAt;
+        if (stopAt - startAt > SimTouch.blockedMaxNs) SimTouch.blockedMaxNs = stopAt - startAt;
+        blocked = OS_FALSE;
+    }
+}
+
+void SimI2cAddress(uint8_t address)
+{
+    addressed = (address >> 1) == FT6206_ADDRESS;
+    receiving = (address & 1) != 0;
+    pointerSet = OS_FALSE;
+    // A receiver gets its first byte right after the address
+    readyAt = After(receiving ? 2 * I2C_BYTE_NS : I2C_BYTE_NS);
+}
+
+void SimI2cSend(uint8_t data)
+{
+    readyAt = After(I2C_BYTE_NS);
+    if (!addressed) return;
+    SimTouch.writes++;
+    if (!pointerSet)
+    {
+        pointer = data;
+        pointerSet = OS_TRUE;
+        return;
+    }
+    regs[pointer++] = data;
+}
+
+uint8_t SimI2cReceive(void)
+{
+    uint8_t data = 0xFF;
+
+    if (addressed)
+    {
+        data = regs[pointer++];
+        SimTouch.reads++;
+    }
+    if (ack) readyAt = After(I2C_BYTE_NS); // the next byte is on its way
+    return data;
+}
+
+void SimI2cAck(int enable)
+{
+    ack = enable != 0;
+}
+
+int SimI2cReady(void)
+{
+    return SimNow() >= readyAt;
+}
+
+int SimI2cBusy(void)
+{
+    if (!started) return 0;
+    if (stopAt == 0 || SimNow() < stopAt) return 1;
+    started = OS_FALSE;
+    return 0;
+}
+
+
+/*----------------------------------- Panel ----------------------------------*/
+
+void SimTouchPress(uint16_t x, uint16_t y)
+{
+    OS_CPU_SR cpu_sr;
+
+    OS_ENTER_CRITICAL();
+    regs[0x02] = 1;
+    regs[0x03] = (uint8_t)(0x80 | ((x >> 8) & 0x0F)); // contact event
+    regs[0x04] = (uint8_t)x;
+    regs[0x05] = (uint8_t)((0 << 4) | ((y >> 8) & 0x0F)); // touch ID 0
+    regs[0x06] = (uint8_t)y;
+    OS_EXIT_CRITICAL();
+    SimPinSet(TOUCH_FT6206_INT_GPIO, TOUCH_FT6206_INT_GPIO_Pin, 0);
+}
+
+void SimTouchRelease(void)
+{
+    OS_CPU_SR cpu_sr;
+
+    OS_ENTER_CRITICAL();
+    regs[0x02] = 0;
+    regs[0x03] = 0x40; // lift up event
+    OS_EXIT_CRITICAL();
+    SimPinSet(TOUCH_FT6206_INT_GPIO, TOUCH_FT6206_INT_GPIO_Pin, 1);
+}
+
+void SimTouchInit(void)
+{
+    memset(&SimTouch, 0, sizeof(SimTouch));
+    memset(regs, 0, sizeof(regs));
+    regs[0xA3] = 0x06; // chip ID
+    regs[0xA8] = 0x11; // vendor ID
+    pointer = 0;
+    started = OS_FALSE;
+    addressed = OS_FALSE;
+    ack = OS_FALSE;
+    readyAt = 0;
+    stopAt = 0;
+    blocked = OS_FALSE;
+    SimPinSet(TOUCH_FT6206_INT_GPIO, TOUCH_FT6206_INT_GPIO_Pin, 1);
+}
@@ -0,0 +1,264 @@
+/*
+    simUart.c
+    USART2, the ST-LINK virtual COM port of the board.
+
+    A frame (start, 8 data, stop bit) takes 10 bit times at HSI / BRR. The
+    transmitter is double buffered like the real one: a byte written to DR
+    moves to the shift register at once if it is idle, so TXE comes straight
+    back, and otherwise when the byte ahead of it has gone out. Sent bytes
+    are written to a host file descriptor and kept in a capture buffer for
+    the harnesses.
+
+    Received bytes come from a host file descriptor (a terminal or a pty) or
+    from SimUartInject(), and are delivered one per frame time. A byte that
+    arrives while RXNE is still set is lost and sets ORE.
+
+    The USART interrupt is raised while an enabled condition holds (TXEIE with
+    TXE, RXNEIE with RXNE or ORE), re-evaluated after every register write
+    and data read and whenever the bus moves on.
+
+    2026/10 written for the MP3Player project
+*/
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "bsp.h"
+#include "sim.h"
+
+SimUartStats SimUart;
+
+#define UART_RX_QUEUE_SIZE  4096
+
+static int outFd = -1;
+static int inFd = -1;
+
+static uint64_t txStart;       // the byte in DR moves to the shift register
+static uint64_t shiftEnd;      // the transmitter is idle again
+static uint32_t rxData;
+static uint32_t sr;            // RXNE and ORE, TXE and TC are derived from the clock
+
+static char rxQueue[UART_RX_QUEUE_SIZE];
+static uint32_t rxHead;
+static uint32_t rxLength;
+static BOOLEAN rxArmed;        // the timer will deliver the next queued byte
+
+static char capture[SIM_UART_CAPTURE_SIZE];
+static uint32_t captureCount;  // bytes ever captured
+
+
+static uint64_t ByteNs(void)
+{
+    uint32_t brr = HostUSART2.BRR.value;
+
+    if (brr == 0) brr = 1;
+    return 10ull * 1000000000ull * brr / HSI_VALUE;
+}
+
+static uint32_t Status(uint64_t now)
+{
+    uint32_t status = sr;
+
+    if (now >= txStart) status |= USART_SR_TXE;
+    if (now >= shiftEnd) status |= USART_SR_TC;
+    return status;
+}
+
+// Raises the interrupt for an enabled condition, or arms the timer for the
+// time TXE will come back
+static void Evaluate(void)
+{
+    uint64_t now = SimNow();
+    uint32_t cr1 = HostUSART2.CR1.value;
+    uint32_t status = Status(now);
+
+    if ((cr1 & USART_CR1_RXNEIE) && (status & (USART_SR_RXNE | USART_SR_ORE)))
+    {
+        OS_CPU_IntPend(USART2_IRQn);
+    }
+    if (cr1 & USART_CR1_TXEIE)
+    {
+        if (status & USART_SR_TXE) OS_CPU_IntPend(USART2_IRQn);
+        else OS_CPU_IntTimer(SIM_IRQ_UART_TX, (INT32U)(txStart - now) + 1);
+    }
+}
+
+static void TxTimer(void)
+{
+    Evaluate();
+}
+
+static void Send(char c)
+{
+    ssize_t n;
+
+    SimUart.txBytes++;
+    capture[captureCount++ % SIM_UART_CAPTURE_SIZE] = c;
+    if (outFd < 0) return;
+    do
+    {
+        n = write(outFd, &c, 1);
+    } while (n < 0 && errno == EINTR);
+}
+
+uint32_t SimUartRead(const HostReg *pReg)
+{
+    uint32_t data;
+
+    if (pReg == &HostUSART2.SR) return Status(SimNow());
+    if (pReg == &HostUSART2.DR)
+    {
+        data = rxData;
+        sr &= ~(USART_SR_RXNE | USART_SR_ORE);
+        Evaluate();
+        return data;
+    }
+    return pReg->value;
+}
+
+void SimUartWrite(HostReg *pReg, uint32_t value)
+{
+    uint64_t now;
+
+    if (pReg == &HostUSART2.DR)
+    {
+        if ((HostUSART2.CR1.value & (USART_CR1_UE | USART_CR1_TE)) != (USART_CR1_UE | USART_CR1_TE)) return;
+        now = SimNow();
+        txStart = now > shiftEnd ? now : shiftEnd;
+        shiftEnd = txStart + ByteNs();
+        Send((char)value);
+    }
+    else if (pReg == &HostUSART2.SR)
+    {
+        sr &= value; // rc_w0: writing 0 clears
+    }
+    else
+    {
+        pReg->value = value;
+    }
+    Evaluate();
+}
+
+
+/*---------------------------------- Receive ---------------------------------*/
+
+static void RxArm(void)
+{
+    if (rxArmed || rxLength == 0) return;
+    rxArmed = OS_TRUE;
+    OS_CPU_IntTimer(SIM_IRQ_UART_RX, (INT32U)ByteNs());
+}
+
+static void RxQueue(const char *data, uint32_t length)
+{
+    while (length-- > 0 && rxLength < UART_RX_QUEUE_SIZE)
+    {
+        rxQueue[(rxHead + rxLength++) % UART_RX_QUEUE_SIZE] = *data++;
+    }
+    RxArm();
+}
+
+// The next queued byte has arrived in the receiver
+static void RxTimer(void)
+{
+    rxArmed = OS_FALSE;
+    if (rxLength == 0) return;
+    if ((HostUSART2.CR1.value & (USART_CR1_UE | USART_CR1_RE)) == (USART_CR1_UE | USART_CR1_RE))
+    {
+        if (sr & USART_SR_RXNE)
+        {
+            sr |= USART_SR_ORE;
+            SimUart.overruns++;
+        }
+        else
+        {
+            rxData = (uint8_t)rxQueue[rxHead];
+            sr |= USART_SR_RXNE;
+            SimUart.rxBytes++;
+        }
+    }
+    rxHead = (rxHead + 1) % UART_RX_QUEUE_SIZE;
+    rxLength--;
+    RxArm();
+    Evaluate();
+}
+
+// Host input is readable: queue all of it (SIGIO is edge triggered)
+static void FdIsr(void)
+{
+    char buf[256];
+    ssize_t n;
+
+    for (;;)
+    {
+        n = read(inFd, buf, sizeof(buf));
+        if (n > 0)
+        {
+            RxQueue(buf, (uint32_t)n);
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        break;
+    }
+}
+
+void SimUartInject(const char *data, uint32_t length)
+{
+    OS_CPU_SR cpu_sr;
+
+    OS_ENTER_CRITICAL();
+    RxQueue(data, length);
+    OS_EXIT_CRITICAL();
+}
+
+uint32_t SimUartCapture(char *buf, uint32_t size)
+{
+    OS_CPU_SR cpu_sr;
+    uint32_t count;
+    uint32_t first;
+    uint32_t i;
+
+    if (size == 0) return 0;
+    OS_ENTER_CRITICAL();
+    count = captureCount < SIM_UART_CAPTURE_SIZE ? captureCount : SIM_UART_CAPTURE_SIZE;
+    if (count > size - 1) count = size - 1;
+    first = captureCount - count;
+    for (i = 0; i < count; i++) buf[i] = capture[(first + i) % SIM_UART_CAPTURE_SIZE];
+    buf[count] = 0;
+    OS_EXIT_CRITICAL();
+    return count;
+}
+
+void SimUartCaptureClear(void)
+{
+    OS_CPU_SR cpu_sr;
+
+    OS_ENTER_CRITICAL();
+    captureCount = 0;
+    OS_EXIT_CRITICAL();
+}
+
+void SimUartInit(int fd, int inputFd)
+{
+    memset(&SimUart, 0, sizeof(SimUart));
+    outFd = fd;
+    inFd = inputFd;
+    txStart = 0;
+    shiftEnd = 0;
+    sr = 0;
+    rxHead = 0;
+    rxLength = 0;
+    rxArmed = OS_FALSE;
+    captureCount = 0;
+    OS_CPU_IntSet(SIM_IRQ_UART_TX, TxTimer);
+    OS_CPU_IntEn(SIM_IRQ_UART_TX, OS_TRUE);
+    OS_CPU_IntSet(SIM_IRQ_UART_RX, RxTimer);
+    OS_CPU_IntEn(SIM_IRQ_UART_RX, OS_TRUE);
+    if (inFd >= 0)
+    {
+        OS_CPU_IntSet(SIM_IRQ_UART_FD, FdIsr);
+        OS_CPU_IntEn(SIM_IRQ_UART_FD, OS_TRUE);
+        OS_CPU_IntFd(SIM_IRQ_UART_FD, inFd);
+    }
+}
@@ -0,0 +1,31 @@
+/*
+    os_cfg.h
+    Kernel configuration for benchTick: the application's App/uCOS/os_cfg.h
+    with room for 60 delayed tasks next to the test task, and the delay list
+    switched by BENCH_TICK_LIST_EN (1 the delta list, 0 the TCB scan, which
+    also needs the tickless idle off). Put first on the include path by
+    "make bench-tick", see the Makefile.
+
+    2026/10 written for the MP3Player project
+*/
+
+#ifndef BENCH_OS_CFG_H
+#define BENCH_OS_CFG_H
+
+#include "../../../App/uCOS/os_cfg.h"
+
+#undef  OS_LOWEST_PRIO
+#define OS_LOWEST_PRIO           95u
+#undef  OS_MAX_TASKS
+#define OS_MAX_TASKS             64u
+
+#ifdef BENCH_TICK_LIST_EN
+#undef  OS_TICK_LIST_EN
+#define OS_TICK_LIST_EN          BENCH_TICK_LIST_EN
+#if BENCH_TICK_LIST_EN == 0
+#undef  OS_TICKLESS_EN
+#define OS_TICKLESS_EN           0u
+#endif
+#endif
+
+#endif /* BENCH_OS_CFG_H */
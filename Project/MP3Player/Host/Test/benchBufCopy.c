@@ -0,0 +1,217 @@
+/*
+    benchBufCopy.c
+    Counts the bytes moved by memcpy() and memmove() per second of playback:
+    while Mp3StreamSDFile() plays TRAIN.MP3, and while the same sectors go
+    to the decoder and to a second consumer (a level meter) that gets them
+    either as another reference through BufPost() or, as tasks did before
+    bufUtil, copied into a block of its own partition. Checks that the
+    meter sees every byte either way.
+
+    This file defines memcpy() and memmove(), so the library calls of the
+    program come here. Copies the compiler inlines are not counted, nor is
+    the byte loop of SdFile::read() that copies a partial block from the
+    block cache (the last 464 bytes of the song).
+
+    2026/10 written for the MP3Player project
+*/
+
+#include <stdio.h>
+#include <string.h>
+
+#include "hostTest.h"
+#include "bufUtil.h"
+#include "mp3Util.h"
+#include "SD.h"
+
+#define SONG        "TRAIN.MP3"
+#define SONG_SIZE   39376u
+#define PIPE_BUFS   4
+#define FEED_PRIO   APP_TASK_MP3_FEED_PRIO
+#define METER_PRIO  APP_TASK_TEST3_PRIO
+
+typedef struct
+{
+    INT32U length;
+    INT8U data[MP3_STREAM_BUF_SIZE];
+} MeterBlock;
+
+static volatile uint64_t copied;
+static OS_STK FeedStk[APP_CFG_TASK_START_STK_SIZE];
+static OS_STK MeterStk[APP_CFG_TASK_START_STK_SIZE];
+static BufPool pool;
+static BUF_POOL_STORAGE(poolStorage, PIPE_BUFS, MP3_STREAM_BUF_SIZE);
+static OS_MEM *meterMem;
+static MeterBlock meterStorage[PIPE_BUFS];
+static OS_EVENT *queues[2];     // the feeder's, the meter's
+static void *feedQPtrs[PIPE_BUFS];
+static void *meterQPtrs[PIPE_BUFS];
+static HANDLE hMp3;
+static volatile INT32U fed;
+static volatile INT32U metered;
+static INT32U meterSum;
+
+extern "C" void *memcpy(void *pDst, const void *pSrc, size_t n) noexcept
+{
+    volatile INT8U *pTo = (volatile INT8U *)pDst;
+    const INT8U *pFrom = (const INT8U *)pSrc;
+
+    copied += n;
+    while (n--) *pTo++ = *pFrom++;
+    return pDst;
+}
+
+extern "C" void *memmove(void *pDst, const void *pSrc, size_t n) noexcept
+{
+    volatile INT8U *pTo = (volatile INT8U *)pDst;
+    const INT8U *pFrom = (const INT8U *)pSrc;
+
+    copied += n;
+    if (pTo < pFrom) while (n--) *pTo++ = *pFrom++;
+    else while (n--) pTo[n] = pFrom[n];
+    return pDst;
+}
+
+// Mp3FeederTask without the end of stream
+static void FeedTask(void *pdata)
+{
+    INT32U length;
+    INT8U err;
+    Buf *pBuf;
+
+    while (1)
+    {
+        pBuf = (Buf*) OSQPend(queues[0], 0, &err);
+        if (err != OS_ERR_NONE) while(1);
+        length = pBuf->length;
+        Write(hMp3, pBuf->pData, &length);
+        fed += pBuf->length;
+        BufRelease(pBuf);
+    }
+}
+
+// Adds up the bytes it is given, in a Buf or in one of its own MeterBlocks
+static void MeterTask(void *pdata)
+{
+    MeterBlock *pBlock;
+    Buf *pBuf;
+    INT32U i;
+    INT8U err;
+    void *pMsg;
+
+    while (1)
+    {
+        pMsg = OSQPend(queues[1], 0, &err);
+        if (err != OS_ERR_NONE) while(1);
+        if (pMsg >= (void *)meterStorage && pMsg < (void *)&meterStorage[PIPE_BUFS])
+        {
+            pBlock = (MeterBlock *)pMsg;
+            for (i = 0; i < pBlock->length; i++) meterSum += pBlock->data[i];
+            metered += pBlock->length;
+            OSMemPut(meterMem, pBlock);
+        }
+        else
+        {
+            pBuf = (Buf *)pMsg;
+            for (i = 0; i < pBuf->length; i++) meterSum += pBuf->pData[i];
+            metered += pBuf->length;
+            BufRelease(pBuf);
+        }
+    }
+}
+
+static double Seconds(INT32U bytes)
+{
+    return bytes * 8.0 / SimMp3.bitrate;
+}
+
+static void Report(const char *what, uint64_t bytes, INT32U played)
+{
+    printf("benchBufCopy: %-38s %5.0f bytes copied per second of playback (%u in %.2f s)\n",
+        what, bytes / Seconds(played), (unsigned)bytes, Seconds(played));
+}
+
+// Sends the song to the feeder and the meter, posting each Buf to both or
+// copying it for the meter. Returns the bytes copied.
+static uint64_t Pipe(BOOLEAN copying)
+{
+    MeterBlock *pBlock;
+    uint64_t before;
+    INT32U sum = 0;
+    INT32U i;
+    File file;
+    Buf *pBuf;
+    INT8U err;
+    int count;
+
+    fed = 0;
+    metered = 0;
+    meterSum = 0;
+    file = SD.open(SONG, O_READ);
+    HOST_CHECK(file);
+    before = copied;
+    while (1)
+    {
+        pBuf = BufGet(&pool, 0, &err);
+        if (err != OS_ERR_NONE) while(1);
+        count = file.read(pBuf->pData, MP3_STREAM_BUF_SIZE);
+        if (count <= 0) break;
+        pBuf->length = count;
+        for (i = 0; i < (INT32U)count; i++) sum += pBuf->pData[i];
+        if (copying)
+        {
+            while ((pBlock = (MeterBlock *)OSMemGet(meterMem, &err)) == 0) OSTimeDly(1);
+            memcpy(pBlock->data, pBuf->pData, count);
+            pBlock->length = count;
+            if (OSQPost(queues[1], pBlock) != OS_ERR_NONE) while(1);
+            if (BufPost(queues, 1, pBuf) != OS_ERR_NONE) while(1);
+        }
+        else
+        {
+            if (BufPost(queues, 2, pBuf) != OS_ERR_NONE) while(1);
+        }
+    }
+    BufRelease(pBuf);
+    file.close();
+    while (fed < SONG_SIZE || metered < SONG_SIZE) OSTimeDly(10);
+    HOST_CHECK(fed == SONG_SIZE && metered == SONG_SIZE);
+    HOST_CHECK(meterSum == sum);
+    HOST_CHECK(pool.used == 0);
+    return copied - before;
+}
+
+static void BenchTask(void *pdata)
+{
+    uint64_t before;
+    INT8U err;
+
+    HostTestOpenSd();
+    hMp3 = HostTestOpenMp3(OS_TRUE);
+
+    SimMp3 = SimMp3Stats();
+    before = copied;
+    Mp3StreamSDFile(hMp3, (char *)SONG);
+    Report("Mp3StreamSDFile():", copied - before, SimMp3.sdiBytes);
+    HOST_CHECK(SimMp3.sdiBytes == SONG_SIZE);
+
+    BufPoolCreate(&pool, poolStorage, PIPE_BUFS, MP3_STREAM_BUF_SIZE);
+    meterMem = OSMemCreate(meterStorage, PIPE_BUFS, sizeof(MeterBlock), &err);
+    if (err != OS_ERR_NONE) while(1);
+    queues[0] = OSQCreate(feedQPtrs, PIPE_BUFS);
+    queues[1] = OSQCreate(meterQPtrs, PIPE_BUFS);
+    if (queues[0] == 0 || queues[1] == 0) while(1);
+    err = OSTaskCreate(FeedTask, (void*)0, &FeedStk[APP_CFG_TASK_START_STK_SIZE-1], FEED_PRIO);
+    if (err != OS_ERR_NONE) while(1);
+    err = OSTaskCreate(MeterTask, (void*)0, &MeterStk[APP_CFG_TASK_START_STK_SIZE-1], METER_PRIO);
+    if (err != OS_ERR_NONE) while(1);
+
+    Ioctl(hMp3, PJDF_CTRL_MP3_SELECT_DATA, 0, 0);
+    Report("decoder and meter, meter copies:", Pipe(OS_TRUE), SONG_SIZE);
+    Report("decoder and meter, BufPost() to both:", Pipe(OS_FALSE), SONG_SIZE);
+    HostTestExit("benchBufCopy");
+}
+
+int main()
+{
+    HostTestRun(HOST_TEST_IMAGE, OS_FALSE, BenchTask);
+    return 0;
+}
@@ -0,0 +1,126 @@
+/*
+    benchCache.c
+    Reports the hit ratio of the SdVolume block cache (SD_CACHE_BLOCK_COUNT
+    slots) for three workloads on the SD card model: listing /MUSIC and
+    opening every file in it by name, playing the songs (2 KB reads, as the
+    MP3 reader task does) and appending lines to a log file with a flush
+    after each. Build with e.g. CXXFLAGS="-O2 -DSD_CACHE_BLOCK_COUNT=8" to
+    compare cache sizes.
+
+    2026/10 written for the MP3Player project
+*/
+
+#include <stdio.h>
+#include <string.h>
+
+#include "hostTest.h"
+#include "SD.h"
+
+#define LOG_FILE   "CACHE.LOG"
+#define LOG_LINES  200
+
+static INT8U chunk[2048];
+
+static void Report(const char *what, uint64_t start)
+{
+    INT32U hits = SdVolume::cacheHitCount();
+    INT32U misses = SdVolume::cacheMissCount();
+
+    HOST_CHECK(hits + misses > 0);
+    printf("benchCache: %u slots, %-9s %5u hits %5u misses, hit ratio %5.1f%%, %6.1f ms\n",
+        (unsigned)SD_CACHE_BLOCK_COUNT, what, (unsigned)hits, (unsigned)misses,
+        100.0 * hits / (hits + misses ? hits + misses : 1), HostTestMs(start));
+}
+
+// Lists /MUSIC, then opens each entry by its path as a browser would
+static void Listing(void)
+{
+    char path[24];
+    File dir;
+    File entry;
+    uint64_t start;
+    int pass;
+
+    SdVolume::cacheResetCounts();
+    start = SimNow();
+    for (pass = 0; pass < 2; pass++)
+    {
+        dir = SD.open("/MUSIC", O_READ);
+        HOST_CHECK(dir);
+        while ((entry = dir.openNextFile()))
+        {
+            strcpy(path, "/MUSIC/");
+            strcat(path, entry.name());
+            entry.close();
+            entry = SD.open(path, O_READ);
+            HOST_CHECK(entry);
+            entry.close();
+        }
+        dir.close();
+    }
+    Report("listing:", start);
+}
+
+// Reads every song through as the MP3 reader task does
+static void Playback(void)
+{
+    char path[24];
+    File dir;
+    File entry;
+    File song;
+    uint64_t start;
+
+    dir = SD.open("/MUSIC", O_READ);
+    SdVolume::cacheResetCounts();
+    start = SimNow();
+    while ((entry = dir.openNextFile()))
+    {
+        strcpy(path, "/MUSIC/");
+        strcat(path, entry.name());
+        entry.close();
+        song = SD.open(path, O_READ);
+        while (song.read(chunk, sizeof(chunk)) > 0);
+        song.close();
+    }
+    Report("playback:", start);
+    dir.close();
+}
+
+// Appends short lines to a log, flushing each to the card
+static void Logging(void)
+{
+    char line[48];
+    File log;
+    uint64_t start;
+    int i;
+
+    SD.remove(LOG_FILE);
+    SdVolume::cacheResetCounts();
+    start = SimNow();
+    log = SD.open(LOG_FILE, FILE_WRITE);
+    HOST_CHECK(log);
+    for (i = 0; i < LOG_LINES; i++)
+    {
+        sprintf(line, "%6d: decoder underruns=0 fed=%u\n", i, (unsigned)(i * 2048));
+        log.write((const uint8_t*)line, strlen(line));
+        log.flush();
+    }
+    log.close();
+    Report("logging:", start);
+    SD.remove(LOG_FILE);
+}
+
+static void BenchTask(void *pdata)
+{
+    HostTestOpenSd();
+    Listing();
+    Playback();
+    Logging();
+    HostTestExit("benchCache");
+}
+
+int main()
+{
+    HostTestRun(HOST_TEST_IMAGE, OS_FALSE, BenchTask);
+    return 0;
+}
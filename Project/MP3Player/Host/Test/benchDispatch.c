@@ -0,0 +1,130 @@
+/*
+    benchDispatch.c
+    Cost of the PJDF calls in host CPU cycles (x86 time stamp counter),
+    median of many calls: an Ioctl() whose driver work is one store, a
+    zero-length Write() to SPI, Open() and Close() of a handle, and the
+    lookup of a device name that does not exist, hashed by Open() and
+    scanned with strcmp() as Open() used to. Also checks that every open
+    handle is distinct and that a closed slot comes back with a new
+    generation, and that a device allowing one handle refuses a second.
+
+    Every call records an entry and an exit trace event, and on the host a
+    critical section is a sigprocmask() system call, so most of each number
+    is that; the miss through Open() is best read against the Ioctl().
+
+    2026/10 written for the MP3Player project
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <x86intrin.h>
+
+#include "hostTest.h"
+
+#define CALLS  20000u
+
+static const char *deviceIds[] = { PJDF_DEVICE_IDS };
+static uint32_t cycles[CALLS];
+static volatile int found;
+
+static int CompareCycles(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+
+    return x < y ? -1 : x > y;
+}
+
+static void Report(const char *what)
+{
+    qsort(cycles, CALLS, sizeof(cycles[0]), CompareCycles);
+    printf("benchDispatch: %-34s median %6u cycles, 99%% %6u cycles\n",
+        what, (unsigned)cycles[CALLS / 2], (unsigned)cycles[CALLS * 99 / 100]);
+}
+
+// Open()'s name lookup before the hash table
+static int LinearLookup(const char *pName)
+{
+    for (unsigned i = 0; i < sizeof(deviceIds) / sizeof(deviceIds[0]); i++)
+        if (strcmp(pName, deviceIds[i]) == 0) return i;
+    return -1;
+}
+
+static void BenchTask(void *pdata)
+{
+    HANDLE hI2C;
+    HANDLE hSPI;
+    HANDLE h;
+    HANDLE first;
+    INT32U length;
+    INT8U address = 0x38;
+    INT8U byte = 0;
+    uint64_t start;
+    INT32U i;
+
+    hI2C = Open(PJDF_DEVICE_ID_I2C1, 0);
+    if (!PJDF_IS_VALID_HANDLE(hI2C)) while(1);
+    hSPI = Open(PJDF_DEVICE_ID_SPI1, 0);
+    if (!PJDF_IS_VALID_HANDLE(hSPI)) while(1);
+    HOST_CHECK(hI2C != hSPI);
+
+    for (i = 0; i < CALLS; i++)
+    {
+        length = sizeof(address);
+        start = __rdtsc();
+        Ioctl(hI2C, PJDF_CTRL_I2C_SET_DEVICE_ADDRESS, &address, &length);
+        cycles[i] = (uint32_t)(__rdtsc() - start);
+    }
+    Report("Ioctl(I2C, SET_DEVICE_ADDRESS):");
+
+    for (i = 0; i < CALLS; i++)
+    {
+        length = 0;
+        start = __rdtsc();
+        Write(hSPI, &byte, &length);
+        cycles[i] = (uint32_t)(__rdtsc() - start);
+    }
+    Report("Write(SPI, 0 bytes):");
+
+    HOST_CHECK(Open(PJDF_DEVICE_ID_I2C1, 0) == PJDF_ERR_TOO_MANY_REFS);   // one handle at a time
+    first = Open(PJDF_DEVICE_ID_SPI1, 0);
+    if (!PJDF_IS_VALID_HANDLE(first)) while(1);
+    HOST_CHECK(first != hSPI);
+    Close(first);
+    for (i = 0; i < CALLS; i++)
+    {
+        start = __rdtsc();
+        h = Open(PJDF_DEVICE_ID_SPI1, 0);
+        Close(h);
+        cycles[i] = (uint32_t)(__rdtsc() - start);
+    }
+    Report("Open() + Close() of SPI:");
+    HOST_CHECK((h & (PJDF_MAX_HANDLES - 1)) == (first & (PJDF_MAX_HANDLES - 1)));
+    HOST_CHECK(h != first);     // same slot, later generation
+
+    for (i = 0; i < CALLS; i++)
+    {
+        start = __rdtsc();
+        h = Open((char *)"/dev/none", 0);
+        cycles[i] = (uint32_t)(__rdtsc() - start);
+    }
+    Report("unknown name, hashed (Open()):");
+    HOST_CHECK(h == PJDF_ERR_DEVICE_NOT_FOUND);
+
+    for (i = 0; i < CALLS; i++)
+    {
+        start = __rdtsc();
+        found = LinearLookup("/dev/none");
+        cycles[i] = (uint32_t)(__rdtsc() - start);
+    }
+    Report("unknown name, strcmp() scan:");
+
+    HostTestExit("benchDispatch");
+}
+
+int main()
+{
+    HostTestRun(0, OS_FALSE, BenchTask);
+    return 0;
+}
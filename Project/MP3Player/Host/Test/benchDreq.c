@@ -0,0 +1,56 @@
+/*
+    benchDreq.c
+    Streams the song in flash to the VS1053 model once with DREQ polled
+    (PJDF_CTRL_MP3_DREQ_POLL) and once with the DREQ interrupt
+    (PJDF_CTRL_MP3_DREQ_INTERRUPT), and compares the time from DREQ rising
+    to the next chunk starting, the decoder underruns and the context
+    switches each mode costs.
+
+    2026/10 written for the MP3Player project
+*/
+
+#include <stdio.h>
+
+#include "hostTest.h"
+#include "mp3Util.h"
+#include "train_crossing.h"
+
+static void Run(HANDLE hMp3, INT8U mode, const char *name)
+{
+    INT32U switches;
+    uint64_t start;
+    double ms;
+
+    if (PJDF_IS_ERROR(Ioctl(hMp3, mode, 0, 0))) while(1);
+    OSTimeDly(10);
+    SimMp3 = SimMp3Stats();
+    switches = OSCtxSwCtr;
+    start = SimNow();
+    Mp3Stream(hMp3, (INT8U*)Train_Crossing, sizeof(Train_Crossing));
+    ms = HostTestMs(start);
+    switches = OSCtxSwCtr - switches;
+
+    HOST_CHECK(SimMp3.sdiBytes == sizeof(Train_Crossing));
+    HOST_CHECK(SimMp3.overflows == 0);
+    HOST_CHECK(SimMp3.dreqWaits > 0);
+    printf("benchDreq: %-9s chunk latency after DREQ avg %7.1f us max %7.1f us (%u waits), "
+        "underruns %u, %u context switches in %.0f ms\n",
+        name, SimMp3.dreqLatencyNs / 1e3 / (SimMp3.dreqWaits ? SimMp3.dreqWaits : 1),
+        SimMp3.dreqLatencyMaxNs / 1e3, (unsigned)SimMp3.dreqWaits,
+        (unsigned)SimMp3.underruns, (unsigned)switches, ms);
+}
+
+static void BenchTask(void *pdata)
+{
+    HANDLE hMp3 = HostTestOpenMp3(OS_FALSE);
+
+    Run(hMp3, PJDF_CTRL_MP3_DREQ_POLL, "poll");
+    Run(hMp3, PJDF_CTRL_MP3_DREQ_INTERRUPT, "interrupt");
+    HostTestExit("benchDreq");
+}
+
+int main()
+{
+    HostTestRun(HOST_TEST_IMAGE, OS_FALSE, BenchTask);
+    return 0;
+}
@@ -0,0 +1,90 @@
+/*
+    benchFat.c
+    Seeks and reads in TRAIN.MP3 on a card image where every file is
+    fragmented (mkimg.py --fragment), so that each of its 10 clusters is a
+    separate run and only the first SD_FILE_EXTENT_COUNT are in the file's
+    extent map. Seeks into mapped clusters show the map, seeks past it the
+    FAT walk every seek used to take. Prints the FAT lookups (block cache
+    lookups) and the time per seek, and checks that a sequential read
+    crossing the end of the map reads the FAT once per cluster past it.
+
+    2026/10 written for the MP3Player project
+*/
+
+#include <stdio.h>
+
+#include "hostTest.h"
+#include "SD.h"
+
+#define SONG          "TRAIN.MP3"
+#define CLUSTER_SIZE  4096u
+#define CLUSTERS      10u      // TRAIN.MP3 is 39376 bytes
+#define SEEKS         200u
+
+static INT32U Lookups(void)
+{
+    return SdVolume::cacheHitCount() + SdVolume::cacheMissCount();
+}
+
+// Seeks back and forth between the start of the file and the given
+// cluster, reading 4 bytes after each seek. The two data blocks stay in the
+// block cache, so the lookups beyond one per seek are FAT reads.
+static void Seeks(File *pFile, INT32U cluster, const char *what)
+{
+    INT8U buf[4];
+    INT32U lookups;
+    INT32U i;
+    uint64_t start;
+    double ms;
+
+    SdVolume::cacheResetCounts();
+    start = SimNow();
+    for (i = 0; i < SEEKS; i++)
+    {
+        HOST_CHECK(pFile->seek(4));
+        HOST_CHECK(pFile->read(buf, 4) == 4);
+        HOST_CHECK(pFile->seek(cluster * CLUSTER_SIZE + 100));
+        HOST_CHECK(pFile->read(buf, 4) == 4);
+    }
+    ms = HostTestMs(start);
+    lookups = Lookups();
+    printf("benchFat: %-30s %5.2f block cache lookups and %5.1f us per seek\n",
+        what, lookups / (2.0 * SEEKS), ms * 1000 / (2 * SEEKS));
+}
+
+static void BenchTask(void *pdata)
+{
+    File file;
+    INT8U buf[512];
+    INT32U lookups;
+    INT32U total = 0;
+    int count;
+
+    HostTestOpenSd();
+    file = SD.open(SONG, O_READ);
+    HOST_CHECK(file);
+
+    // Sequential read: whole data blocks are read straight into buf, so the
+    // lookups are the FAT reads of the clusters past the map and the last,
+    // partial block
+    SdVolume::cacheResetCounts();
+    while ((count = file.read(buf, sizeof(buf))) > 0) total += count;
+    lookups = Lookups();
+    HOST_CHECK(total == 39376);
+    HOST_CHECK(lookups == (CLUSTERS - SD_FILE_EXTENT_COUNT - 1) + 1);
+    printf("benchFat: sequential read of %u clusters, %u mapped: %u FAT reads\n",
+        CLUSTERS, (unsigned)SD_FILE_EXTENT_COUNT, (unsigned)(lookups - 1));
+
+    Seeks(&file, SD_FILE_EXTENT_COUNT - 1, "seeks to a mapped cluster:");
+    Seeks(&file, SD_FILE_EXTENT_COUNT, "seeks to the cluster after:");
+    Seeks(&file, CLUSTERS - 1, "seeks to the last cluster:");
+    file.close();
+
+    HostTestExit("benchFat");
+}
+
+int main()
+{
+    HostTestRun(HOST_TEST_FRAGMENTED_IMAGE, OS_FALSE, BenchTask);
+    return 0;
+}
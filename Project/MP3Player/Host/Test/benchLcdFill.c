@@ -0,0 +1,113 @@
+/*
+    benchLcdFill.c
+    Times a full-screen clear on the SPI1/DMA2 and ILI9341 models: once the
+    way fillScreen() used to do it, writedata() twice per pixel through the
+    128-byte spiBuffer, and once with fillScreen() and its single
+    PJDF_CTRL_LCD_FILL. Prints the time and the DMA transfers each takes
+    and the CPU left to a lower priority task, and checks that both paint
+    every pixel.
+
+    2026/10 written for the MP3Player project
+*/
+
+#include <stdio.h>
+
+#include "hostTest.h"
+#include <Adafruit_ILI9341.h>
+
+#define SPINNER_PRIO (HOST_TEST_PRIO + 1)
+#define PIXELS       ((INT32U)SIM_LCD_WIDTH * SIM_LCD_HEIGHT)
+
+static OS_STK SpinnerStk[APP_CFG_TASK_START_STK_SIZE];
+static Adafruit_ILI9341 lcd;
+static volatile INT32U spins;
+
+// Counts the CPU the clears leave to lower priority tasks
+static void SpinnerTask(void *pdata)
+{
+    while (1)
+    {
+        spins++;
+        OSTimeGet(); // lets a pending switch happen, see the port's OSIntCtxSw()
+    }
+}
+
+static void OpenLcd(void)
+{
+    HANDLE hLcd;
+    HANDLE hSPI;
+    INT32U length;
+
+    hLcd = Open(PJDF_DEVICE_ID_LCD_ILI9341, 0);
+    if (!PJDF_IS_VALID_HANDLE(hLcd)) while(1);
+    hSPI = Open(LCD_SPI_DEVICE_ID, 0);
+    if (!PJDF_IS_VALID_HANDLE(hSPI)) while(1);
+    length = sizeof(HANDLE);
+    if (PJDF_IS_ERROR(Ioctl(hLcd, PJDF_CTRL_LCD_SET_SPI_HANDLE, &hSPI, &length))) while(1);
+    lcd.setPjdfHandle(hLcd);
+    lcd.begin();
+}
+
+// The fillScreen() loop before PJDF_CTRL_LCD_FILL
+static void ClearByBytes(uint16_t color)
+{
+    lcd.setAddrWindow(0, 0, SIM_LCD_WIDTH - 1, SIM_LCD_HEIGHT - 1);
+    for (INT32U i = 0; i < PIXELS; i++)
+    {
+        lcd.writedata(color >> 8);
+        lcd.writedata(color);
+    }
+    lcd.spiFlush();
+}
+
+static BOOLEAN ScreenIs(uint16_t color)
+{
+    for (int y = 0; y < SIM_LCD_HEIGHT; y++)
+        for (int x = 0; x < SIM_LCD_WIDTH; x++)
+            if (SimLcdFrame[y][x] != color) return OS_FALSE;
+    return OS_TRUE;
+}
+
+static void Clear(BOOLEAN byBytes, uint16_t color, const char *what)
+{
+    INT32U spun;
+    uint64_t start;
+    double ms;
+
+    SimLcd = SimLcdStats();
+    SimSpi = SimSpiStats();
+    spun = spins;
+    start = SimNow();
+    if (byBytes) ClearByBytes(color);
+    else lcd.fillScreen(color);
+    ms = HostTestMs(start);
+    spun = spins - spun;
+
+    HOST_CHECK(SimLcd.pixels == PIXELS);
+    HOST_CHECK(ScreenIs(color));
+    printf("benchLcdFill: %-22s %7.1f ms, %6u data bytes, %4u DMA transfers, "
+        "%7u spins of a lower priority task\n",
+        what, ms, (unsigned)SimLcd.dataBytes, (unsigned)SimSpi.dmaTransfers, (unsigned)spun);
+}
+
+static void BenchTask(void *pdata)
+{
+    INT8U err;
+
+    OpenLcd();
+    err = OSTaskCreate(SpinnerTask, (void*)0, &SpinnerStk[APP_CFG_TASK_START_STK_SIZE-1], SPINNER_PRIO);
+    if (err != OS_ERR_NONE) while(1);
+
+    Clear(OS_TRUE, ILI9341_BLUE, "writedata per byte:");
+    Clear(OS_FALSE, ILI9341_RED, "fillScreen:");
+    printf("benchLcdFill: the bus alone takes %.1f ms for %u pixels at 8 MHz\n",
+        PIXELS * 16 / 8e3, (unsigned)PIXELS);
+
+    HostTestExit("benchLcdFill");
+}
+
+int main()
+{
+    HostTestRun(0, OS_FALSE, BenchTask);
+    return 0;
+}
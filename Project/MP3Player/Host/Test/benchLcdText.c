@@ -0,0 +1,136 @@
+/*
+    benchLcdText.c
+    Records the SPI stream to the ILI9341 model while a text line is drawn
+    in the ways the driver offers: one window per pixel through the
+    Adafruit_GFX drawChar() the driver used to rely on, one window per
+    character cell (the driver's drawChar(), used by write() and so by
+    PrintToLcdWithBuf), one window for the line (drawText()), and
+    updateText() redrawing a field of which one character changed. Prints
+    the windows, command and data bytes and the time each takes, and checks
+    that all of them leave the same pixels on screen.
+
+    2026/10 written for the MP3Player project
+*/
+
+#include <stdio.h>
+#include <string.h>
+
+#include "hostTest.h"
+#include <Adafruit_ILI9341.h>
+
+#define TEXT        "Train_Crossing 01:23"
+#define TEXT_LEN    (sizeof(TEXT) - 1)
+#define TEXT_SIZE   1
+#define COLOR       ILI9341_WHITE
+#define BG          ILI9341_BLACK
+#define ROW_Y(row)  (20 + (row) * 16)
+
+static Adafruit_ILI9341 lcd;
+static INT32U commandBytes;
+static INT32U dataBytes;
+
+static void Record(char device, uint8_t out, uint8_t in)
+{
+    if (device == 'L') commandBytes++;
+    else if (device == 'l') dataBytes++;
+}
+
+static void OpenLcd(void)
+{
+    HANDLE hLcd;
+    HANDLE hSPI;
+    INT32U length;
+
+    hLcd = Open(PJDF_DEVICE_ID_LCD_ILI9341, 0);
+    if (!PJDF_IS_VALID_HANDLE(hLcd)) while(1);
+    hSPI = Open(LCD_SPI_DEVICE_ID, 0);
+    if (!PJDF_IS_VALID_HANDLE(hSPI)) while(1);
+    length = sizeof(HANDLE);
+    if (PJDF_IS_ERROR(Ioctl(hLcd, PJDF_CTRL_LCD_SET_SPI_HANDLE, &hSPI, &length))) while(1);
+    lcd.setPjdfHandle(hLcd);
+    lcd.begin();
+    lcd.fillScreen(BG);
+}
+
+static void Start(void)
+{
+    commandBytes = 0;
+    dataBytes = 0;
+    SimLcd = SimLcdStats();
+}
+
+static void Report(const char *what, uint64_t start)
+{
+    double ms = HostTestMs(start);
+
+    printf("benchLcdText: %-26s %4u windows, %5u command bytes, %6u data bytes, %6.2f ms\n",
+        what, (unsigned)SimLcd.ramwr, (unsigned)commandBytes, (unsigned)dataBytes, ms);
+}
+
+// Every pixel of the text cells on row equals the one on row 0
+static BOOLEAN SameAsFirstRow(int row)
+{
+    for (int y = 0; y < 8 * TEXT_SIZE; y++)
+        if (memcmp(&SimLcdFrame[ROW_Y(0) + y][0], &SimLcdFrame[ROW_Y(row) + y][0],
+            6 * TEXT_SIZE * TEXT_LEN * sizeof(uint16_t)) != 0) return OS_FALSE;
+    return OS_TRUE;
+}
+
+static void BenchTask(void *pdata)
+{
+    char shown[TEXT_LEN + 1] = "";
+    char changed[] = TEXT;
+    uint64_t start;
+    INT32U i;
+
+    OpenLcd();
+    SimSpiRecorder = Record;
+
+    Start();
+    start = SimNow();
+    for (i = 0; i < TEXT_LEN; i++)
+        lcd.Adafruit_GFX::drawChar(i * 6 * TEXT_SIZE, ROW_Y(0), TEXT[i], COLOR, BG, TEXT_SIZE);
+    Report("per pixel (GFX drawChar):", start);
+
+    Start();
+    start = SimNow();
+    lcd.setCursor(0, ROW_Y(1));
+    lcd.setTextColor(COLOR, BG);
+    lcd.setTextSize(TEXT_SIZE);
+    for (i = 0; i < TEXT_LEN; i++) lcd.write(TEXT[i]);
+    Report("per character (write):", start);
+    HOST_CHECK(SimLcd.ramwr == TEXT_LEN);
+    HOST_CHECK(SameAsFirstRow(1));
+
+    Start();
+    start = SimNow();
+    lcd.drawText(0, ROW_Y(2), TEXT, TEXT_LEN, COLOR, BG, TEXT_SIZE);
+    Report("per line (drawText):", start);
+    HOST_CHECK(SimLcd.ramwr == 1);
+    HOST_CHECK(SameAsFirstRow(2));
+
+    // A field first drawn whole, then with its last digit changed and back
+    lcd.updateText(0, ROW_Y(3), TEXT, shown, sizeof(shown), COLOR, BG, TEXT_SIZE);
+    HOST_CHECK(SameAsFirstRow(3));
+    changed[TEXT_LEN - 1] = '4';
+    lcd.updateText(0, ROW_Y(3), changed, shown, sizeof(shown), COLOR, BG, TEXT_SIZE);
+    Start();
+    start = SimNow();
+    lcd.updateText(0, ROW_Y(3), TEXT, shown, sizeof(shown), COLOR, BG, TEXT_SIZE);
+    Report("one changed (updateText):", start);
+    HOST_CHECK(SimLcd.ramwr == 1);
+    HOST_CHECK(SameAsFirstRow(3));
+
+    Start();
+    lcd.updateText(0, ROW_Y(3), TEXT, shown, sizeof(shown), COLOR, BG, TEXT_SIZE);
+    HOST_CHECK(commandBytes == 0 && dataBytes == 0);
+
+    SimSpiRecorder = 0;
+    HostTestExit("benchLcdText");
+}
+
+int main()
+{
+    HostTestRun(0, OS_FALSE, BenchTask);
+    return 0;
+}
@@ -0,0 +1,247 @@
+/*
+    benchLibrary.c
+    The song catalog (App/libraryUtil.c) of a card with 5000 songs in
+    /MUSIC, made by "mkimg.py --songs 5000 --truth": the sectors read to
+    list the first songs with openNextFile() and from the catalog, to build
+    the catalog, to open it again unchanged, to rebuild it after songs are
+    added, removed and rewritten, and to page through it at random with
+    LibraryGet(). Checks every entry against the songs mkimg.py wrote: the
+    names in order, the titles and artists, and the lengths to within a
+    second.
+
+    The bench changes the card, so "make bench" writes the image again
+    before each run.
+
+    2026/10 written for the MP3Player project
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hostTest.h"
+#include "libraryUtil.h"
+#include "SD.h"
+
+#define IMAGE       "build/sd-library.img"
+#define TRUTH       "build/sd-library.txt"
+#define DIR         "/MUSIC"
+#define SONGS       5000
+#define GETS        10000
+#define LIST_SONGS  250
+#define CHANGES     3       // songs added and removed
+
+typedef struct
+{
+    char name[13];
+    char title[LIBRARY_TITLE_MAX];
+    char artist[LIBRARY_ARTIST_MAX];
+    INT32U seconds;
+} Truth;
+
+static Truth truth[SONGS];
+static INT32U truthCount;
+
+// Reads the "NAME.MP3|title|artist|seconds" lines mkimg.py wrote
+static void ReadTruth(void)
+{
+    char line[128];
+    char *pField[4];
+    FILE *file;
+    Truth *pTruth;
+    int i;
+
+    file = fopen(TRUTH, "r");
+    HOST_CHECK(file != 0);
+    if (file == 0) return;
+    while (truthCount < SONGS && fgets(line, sizeof(line), file))
+    {
+        line[strcspn(line, "\n")] = 0;
+        pField[0] = line;
+        for (i = 1; i < 4; i++)
+        {
+            pField[i] = strchr(pField[i - 1], '|');
+            if (pField[i] == 0) break;
+            *pField[i]++ = 0;
+        }
+        if (i < 4) continue;
+        pTruth = &truth[truthCount++];
+        snprintf(pTruth->name, sizeof(pTruth->name), "%.12s", pField[0]);
+        snprintf(pTruth->title, sizeof(pTruth->title), "%s", pField[1]);
+        snprintf(pTruth->artist, sizeof(pTruth->artist), "%s", pField[2]);
+        pTruth->seconds = atoi(pField[3]);
+    }
+    fclose(file);
+}
+
+static void Report(const char *what, uint64_t start)
+{
+    printf("benchLibrary: %-44s %7u sector reads %5u writes %8.1f ms\n",
+        what, (unsigned)SimSd.blocksRead, (unsigned)SimSd.blocksWritten, HostTestMs(start));
+}
+
+// Lists the first LIST_SONGS of the directory as the shell did before the
+// catalog, every file opened by openNextFile() for its name and size. Each
+// open searches the directory for the name again, so the reads grow with
+// the square of the songs listed.
+static void List(void)
+{
+    INT32U count = 0;
+    uint64_t start;
+    File dir;
+    File file;
+
+    SimSd = SimSdStats();
+    start = SimNow();
+    dir = SD.open(DIR, O_READ);
+    HOST_CHECK(dir);
+    while (count < LIST_SONGS && (file = dir.openNextFile()))
+    {
+        if (strstr(file.name(), ".MP3") && file.size() > 0) count++;
+        file.close();
+    }
+    dir.close();
+    Report("openNextFile(), first 250 names and sizes:", start);
+    HOST_CHECK(count == LIST_SONGS);
+}
+
+// The same from the catalog
+static void ListCatalog(void)
+{
+    const LibraryEntry *pEntry;
+    INT32U count = 0;
+    uint64_t start;
+    INT32U i;
+
+    SimSd = SimSdStats();
+    start = SimNow();
+    for (i = 0; i < LIST_SONGS; i++)
+    {
+        pEntry = LibraryGet(i);
+        if (pEntry != NULL && pEntry->size > 0) count++;
+    }
+    Report("LibraryGet(), first 250 names and sizes:", start);
+    HOST_CHECK(count == LIST_SONGS);
+}
+
+static void Open(const char *what)
+{
+    uint64_t start;
+
+    SimSd = SimSdStats();
+    start = SimNow();
+    HOST_CHECK(LibraryOpen(DIR));
+    Report(what, start);
+}
+
+// Checks the catalog against the truth from first on, which is in the
+// catalog at shift places further on
+static void Check(INT32U first, INT32U shift)
+{
+    const LibraryEntry *pEntry;
+    char name[13];
+    INT32U wrong = 0;
+    INT32U i;
+
+    for (i = first; i < truthCount && i + shift < LibraryCount(); i++)
+    {
+        pEntry = LibraryGet(i + shift);
+        if (pEntry == NULL)
+        {
+            wrong++;
+            continue;
+        }
+        LibraryName(pEntry, name);
+        if (strcmp(name, truth[i].name) != 0 || strcmp(pEntry->title, truth[i].title) != 0
+            || strcmp(pEntry->artist, truth[i].artist) != 0
+            || abs((int)pEntry->seconds - (int)truth[i].seconds) > 1)
+        {
+            if (wrong++ == 0) printf("benchLibrary: entry %u is %s, %s, %s, %u s, not %s, %s, %s, %u s\n",
+                (unsigned)(i + shift), name, pEntry->title, pEntry->artist, (unsigned)pEntry->seconds,
+                truth[i].name, truth[i].title, truth[i].artist, (unsigned)truth[i].seconds);
+        }
+    }
+    HOST_CHECK(wrong == 0);
+}
+
+// Adds CHANGES copies of TRAIN.MP3 named to sort first, removes the last
+// CHANGES songs and appends a byte to the one before them
+static void Change(void)
+{
+    static INT8U buf[512];
+    char path[32];
+    File from;
+    File to;
+    INT32U i;
+    int count;
+
+    for (i = 0; i < CHANGES; i++)
+    {
+        sprintf(path, DIR "/0000ADD%u.MP3", (unsigned)i);
+        from = SD.open("TRAIN.MP3", O_READ);
+        to = SD.open(path, FILE_WRITE);
+        HOST_CHECK(from && to);
+        while ((count = from.read(buf, sizeof(buf))) > 0) to.write(buf, count);
+        to.close();
+        from.close();
+
+        sprintf(path, DIR "/%s", truth[truthCount - 1 - i].name);
+        HOST_CHECK(SD.remove(path));
+    }
+    sprintf(path, DIR "/%s", truth[truthCount - 1 - CHANGES].name);
+    to = SD.open(path, FILE_WRITE);
+    HOST_CHECK(to);
+    to.write((INT8U)0);
+    to.close();
+}
+
+static void BenchTask(void *pdata)
+{
+    const LibraryEntry *pEntry;
+    char name[13];
+    unsigned seed = 1;
+    uint64_t start;
+    INT32U i;
+
+    ReadTruth();
+    HOST_CHECK(truthCount == SONGS);
+    HostTestOpenSd();
+
+    List();
+    Open("LibraryOpen(), cold build:");
+    HOST_CHECK(LibraryCount() == truthCount);
+    ListCatalog();
+    Check(0, 0);
+    Open("LibraryOpen(), unchanged:");
+    HOST_CHECK(SimSd.blocksWritten == 0);
+    HOST_CHECK(LibraryCount() == truthCount);
+
+    Change();
+    Open("LibraryOpen(), 3 added, 3 removed, 1 rewritten:");
+    HOST_CHECK(LibraryCount() == truthCount);
+    for (i = 0; i < CHANGES; i++)
+    {
+        pEntry = LibraryGet(i);
+        HOST_CHECK(pEntry != NULL);
+        if (pEntry == NULL) continue;
+        LibraryName(pEntry, name);
+        HOST_CHECK(strncmp(name, "0000ADD", 7) == 0 && pEntry->seconds > 0);
+    }
+    truthCount -= CHANGES + 1;
+    Check(0, CHANGES);
+    pEntry = LibraryGet(LibraryCount() - 1);
+    HOST_CHECK(pEntry != NULL && pEntry->flags & LIBRARY_SCANNED);
+
+    SimSd = SimSdStats();
+    start = SimNow();
+    for (i = 0; i < GETS; i++) HOST_CHECK(LibraryGet(rand_r(&seed) % LibraryCount()) != NULL);
+    Report("10000 LibraryGet() at random:", start);
+    HOST_CHECK(SimSd.blocksRead <= GETS);
+    HostTestExit("benchLibrary");
+}
+
+int main()
+{
+    HostTestRun(IMAGE, OS_FALSE, BenchTask);
+    return 0;
+}
@@ -0,0 +1,255 @@
+/*
+    benchMp3Index.c
+    Speed of the MP3 frame index builder (App/mp3Index.c) on the songs in
+    MP3data and on a synthetic 5 MB file: an ID3v2 tag, a false frame
+    header before the first frame, and the frames of train_crossing.mp3
+    over and over with junk between some of them. Each file is fed from
+    RAM in 2048 byte reads one after the other, as the reader task does
+    while a song plays, and from where Mp3IndexSkip() says, as
+    Mp3IndexSDFile() does. Checks every index entry against a separate
+    scan of the frames, or against where the synthetic file put them.
+
+    The false header is followed in 64 byte reads too, where the builder
+    has to go back to an earlier read to find the first frame. The song is
+    also indexed with its first frame made a Xing tag without a TOC, as
+    mkimg.py writes them, which must not be counted as audio.
+
+    2026/10 written for the MP3Player project
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hostTest.h"
+#include "mp3Index.h"
+#include "final.h"
+
+#define SONG_PATH       "../MP3data/train_crossing.mp3"
+#define SYNTH_SIZE      (5u << 20)
+#define SYNTH_FRAMES    30000
+#define JUNK_EVERY      97      // frames between runs of junk
+#define READ_SIZE       2048    // MP3_STREAM_BUF_SIZE
+#define RUN_NS          100000000ull
+
+static INT8U song[64 * 1024];
+static INT32U songSize;
+static INT8U synth[SYNTH_SIZE + 4096];
+static INT32U synthSize;
+static INT32U truth[SYNTH_FRAMES];
+static INT32U frames[SYNTH_FRAMES];
+static Mp3IndexBuilder builder;
+static Mp3Index mp3Index;
+
+// Length of an MPEG-1 layer III frame, 0 if p is not its header
+static INT32U RefFrameLength(const INT8U *p)
+{
+    static const INT16U kbps[16] = { 0, 32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 0 };
+    static const INT32U rates[4] = { 44100, 48000, 32000, 0 };
+
+    if (p[0] != 0xFF || (p[1] & 0xFE) != 0xFA || kbps[p[2] >> 4] == 0 || rates[(p[2] >> 2) & 3] == 0) return 0;
+    return 144000u * kbps[p[2] >> 4] / rates[(p[2] >> 2) & 3] + ((p[2] >> 1) & 1);
+}
+
+// The frame starts of an MPEG-1 layer III file: after any ID3v2 tag, the
+// first header followed by a second, then every header of the same
+// sample rate, looking on at the next byte after anything else
+static INT32U RefScan(const INT8U *pData, INT32U size, INT32U *pStarts)
+{
+    INT32U count = 0;
+    INT32U pos = 0;
+    INT32U length;
+    INT8U rate = 0;
+
+    if (size >= 10 && memcmp(pData, "ID3", 3) == 0)
+    {
+        pos = ((pData[6] & 0x7F) << 21 | (pData[7] & 0x7F) << 14 | (pData[8] & 0x7F) << 7 | (pData[9] & 0x7F)) + 10;
+    }
+    for (; pos + 4 <= size; pos++)
+    {
+        length = RefFrameLength(&pData[pos]);
+        if (length == 0 || pos + length + 4 > size || RefFrameLength(&pData[pos + length]) == 0) continue;
+        rate = pData[pos + 2] & 0x0C;
+        break;
+    }
+    while (pos + 4 <= size && count < SYNTH_FRAMES)
+    {
+        length = RefFrameLength(&pData[pos]);
+        if (length == 0 || (pData[pos + 2] & 0x0C) != rate)
+        {
+            pos++;
+            continue;
+        }
+        if (pos + length > size) break;
+        pStarts[count++] = pos;
+        pos += length;
+    }
+    return count;
+}
+
+// Builds the index of pData as the SD code reads a file, readSize bytes at
+// a time: one read after the other, or from where Mp3IndexSkip() says.
+// Returns OS_FALSE if it is not complete, e.g. because the builder went
+// back to a read before the last one, which only a seeking reader can do.
+static BOOLEAN Build(const INT8U *pData, INT32U size, INT32U readSize, BOOLEAN seeking)
+{
+    INT32U pos = 0;
+    INT32U count;
+
+    Mp3IndexBegin(&builder, &mp3Index, size);
+    while (pos < size)
+    {
+        if (seeking)
+        {
+            pos = Mp3IndexSkip(&builder);
+            if (pos >= size) break;
+        }
+        count = (size - pos < readSize) ? size - pos : readSize;
+        if (Mp3IndexFeed(&builder, pData + pos, count)) break;
+        pos += count;
+        if (!seeking && builder.pos != pos) return OS_FALSE;
+    }
+    return Mp3IndexEnd(&builder);
+}
+
+// Returns OS_TRUE if the index holds every framesPerEntry'th of the count
+// frame starts
+static BOOLEAN Exact(const INT32U *pStarts, INT32U count)
+{
+    INT32U i;
+
+    if (mp3Index.source != MP3_INDEX_SCANNED || mp3Index.frameCount != count) return OS_FALSE;
+    if (mp3Index.entryCount != (count + mp3Index.framesPerEntry - 1) / mp3Index.framesPerEntry) return OS_FALSE;
+    for (i = 0; i < mp3Index.entryCount; i++)
+        if (mp3Index.entries[i] != pStarts[i * mp3Index.framesPerEntry]) return OS_FALSE;
+    return (BOOLEAN)(mp3Index.audioStart == pStarts[0]);
+}
+
+static void Bench(const char *what, const INT8U *pData, INT32U size, const INT32U *pStarts, INT32U count)
+{
+    static const char *ways[2] = { "one read after the other", "reads from Mp3IndexSkip()" };
+    uint64_t start;
+    uint64_t ns;
+    INT32U runs;
+    BOOLEAN complete;
+    int seeking;
+
+    for (seeking = 0; seeking < 2; seeking++)
+    {
+        start = SimNow();
+        runs = 0;
+        do
+        {
+            complete = Build(pData, size, READ_SIZE, (BOOLEAN)seeking);
+            runs++;
+            ns = SimNow() - start;
+        } while (ns < RUN_NS);
+        printf("benchMp3Index: %-28s %8u bytes %6u frames, %-26s %7.3f ms %7.2f GB/s %s\n",
+            what, (unsigned)size, (unsigned)count, ways[seeking], ns / 1e6 / runs,
+            (double)size * runs / ns, complete && Exact(pStarts, count) ? "exact" : "WRONG");
+        HOST_CHECK(complete);
+        HOST_CHECK(Exact(pStarts, count));
+    }
+}
+
+static void Append(const void *pData, INT32U length)
+{
+    memcpy(&synth[synthSize], pData, length);
+    synthSize += length;
+}
+
+// Bytes that never hold a frame sync
+static void AppendJunk(INT32U length)
+{
+    while (length--) synth[synthSize++] = (INT8U)(rand() % 0xFF);
+}
+
+// The synthetic file; returns its frame count, their starts in truth
+static INT32U MakeSynth(const INT32U *pSongStarts, INT32U songFrames)
+{
+    static const INT8U falseHeader[4] = { 0xFF, 0xFB, 0x90, 0xC4 };   // 128 kbps, 417 bytes
+    INT8U tag[10] = { 'I', 'D', '3', 3, 0, 0, 0, 0, 0x17, 0x70 };      // 3056 bytes after the header
+    INT32U count = 0;
+    INT32U from;
+    INT32U length;
+
+    srand(1);
+    Append(tag, sizeof(tag));
+    AppendJunk(3056);
+    Append(falseHeader, sizeof(falseHeader));
+    AppendJunk(60);
+    while (count < SYNTH_FRAMES)
+    {
+        from = pSongStarts[count % songFrames];
+        length = (count % songFrames + 1 < songFrames) ? pSongStarts[count % songFrames + 1] - from : songSize - from;
+        if (synthSize + length > SYNTH_SIZE) break;
+        truth[count++] = synthSize;
+        Append(&song[from], length);
+        if (count % JUNK_EVERY == 0) AppendJunk(1 + count % 50);
+    }
+    return count;
+}
+
+// Makes the first frame of the song a Xing tag with the frame and byte
+// counts of the rest but no TOC
+static void MakeXing(const INT32U *pSongStarts, INT32U songFrames)
+{
+    INT32U at = pSongStarts[0];
+    INT32U length = pSongStarts[1] - at;
+    INT32U side = ((song[at + 3] >> 6) == 3) ? 17 : 32;  // mono or not
+    INT32U count = songFrames - 1;
+    INT32U bytes = songSize - pSongStarts[1];
+    INT8U tag[16] = { 'X', 'i', 'n', 'g', 0, 0, 0, 3,
+        (INT8U)(count >> 24), (INT8U)(count >> 16), (INT8U)(count >> 8), (INT8U)count,
+        (INT8U)(bytes >> 24), (INT8U)(bytes >> 16), (INT8U)(bytes >> 8), (INT8U)bytes };
+
+    memset(&song[at + 4], 0, length - 4);
+    memcpy(&song[at + 4 + side], tag, sizeof(tag));
+}
+
+static void BenchTask(void *pdata)
+{
+    FILE *file;
+    INT32U songFrames;
+    INT32U finalFrames;
+    INT32U synthFrames;
+
+    file = fopen(SONG_PATH, "rb");
+    HOST_CHECK(file != 0);
+    if (file == 0) HostTestExit("benchMp3Index");
+    songSize = fread(song, 1, sizeof(song), file);
+    fclose(file);
+
+    songFrames = RefScan(song, songSize, frames);
+    Bench("train_crossing.mp3:", song, songSize, frames, songFrames);
+    finalFrames = RefScan(final, sizeof(final), frames);
+    Bench("final.h:", final, sizeof(final), frames, finalFrames);
+
+    RefScan(song, songSize, frames);
+    synthFrames = MakeSynth(frames, songFrames);
+    HOST_CHECK(RefScan(synth, synthSize, frames) == synthFrames);
+    HOST_CHECK(memcmp(frames, truth, synthFrames * sizeof(truth[0])) == 0);
+    Bench("synthetic (ID3v2, junk):", synth, synthSize, truth, synthFrames);
+
+    // the false header is 417 bytes before the frame after it
+    HOST_CHECK(!Build(synth, synthSize, 64, OS_FALSE));
+    HOST_CHECK(Build(synth, synthSize, 64, OS_TRUE) && Exact(truth, synthFrames));
+    printf("benchMp3Index: false header 3066 bytes in, 64 byte reads: %s from Mp3IndexSkip(), "
+        "%u frames, first at %u\n", Exact(truth, synthFrames) ? "exact" : "WRONG",
+        (unsigned)mp3Index.frameCount, (unsigned)mp3Index.audioStart);
+
+    // the frames after the tag, from the first of them
+    songFrames = RefScan(song, songSize, frames);
+    MakeXing(frames, songFrames);
+    HOST_CHECK(Build(song, songSize, READ_SIZE, OS_FALSE) && Exact(&frames[1], songFrames - 1));
+    printf("benchMp3Index: Xing tag without a TOC: %s, %u frames, first at %u\n",
+        Exact(&frames[1], songFrames - 1) ? "exact" : "WRONG",
+        (unsigned)mp3Index.frameCount, (unsigned)mp3Index.audioStart);
+    HostTestExit("benchMp3Index");
+}
+
+int main()
+{
+    HostTestRun(0, OS_FALSE, BenchTask);
+    return 0;
+}
@@ -0,0 +1,131 @@
+/*
+    benchRead.c
+    Compares the ways File hands out file data, in bytes per host CPU cycle
+    (x86 time stamp counter): read() and available() once per byte, as
+    Mp3StreamSDFile used to, read(buf, n), readSector() and peekBuffer().
+
+    Each is run twice: over the whole of TRAIN.MP3, where the SD bus time
+    of the card model is part of the cost, and over the first blocks of it
+    with those blocks held in the block cache, where only the code path is.
+
+    2026/10 written for the MP3Player project
+*/
+
+#include <stdio.h>
+#include <x86intrin.h>
+
+#include "hostTest.h"
+#include "SD.h"
+
+#define SONG        "TRAIN.MP3"
+#define SONG_SIZE   39376u
+#define WINDOW      ((SD_CACHE_BLOCK_COUNT - 1) * 512u)   // the cache slots not kept for the FAT
+#define PASSES      200u
+
+typedef enum { PER_BYTE, READ_32, READ_512, READ_SECTOR, PEEK_BUFFER } Path;
+
+static const char *pathNames[] = {
+    "read() per byte", "read(buf, 32)", "read(buf, 512)", "readSector()", "peekBuffer()"
+};
+
+static INT8U buf[512];
+
+// Reads limit bytes from the start of the file by the given path and
+// returns their sum, so that the compiler keeps every byte access
+static INT32U ReadAll(File *pFile, Path path, INT32U limit)
+{
+    INT32U sum = 0;
+    INT32U pos = 0;
+    INT8U *p;
+    int count;
+    int i;
+
+    pFile->seek(0);
+    while (pos < limit)
+    {
+        switch (path)
+        {
+        case PER_BYTE:
+            if (!pFile->available()) return sum;
+            sum += pFile->read();
+            pos++;
+            continue;
+        case READ_32:
+            count = pFile->read(buf, 32);
+            p = buf;
+            break;
+        case READ_512:
+            count = pFile->read(buf, 512);
+            p = buf;
+            break;
+        case READ_SECTOR:
+            count = pFile->readSector(buf);
+            p = buf;
+            break;
+        case PEEK_BUFFER:
+            count = pFile->peekBuffer(&p);
+            if (count > 0) pFile->seek(pos + count);
+            break;
+        }
+        if (count <= 0) return sum;
+        for (i = 0; i < count; i++) sum += p[i];
+        pos += count;
+    }
+    return sum;
+}
+
+// Runs a path passes times and prints its best pass
+static void Bench(File *pFile, Path path, INT32U limit, INT32U passes, INT32U expected)
+{
+    uint64_t best = ~(uint64_t)0;
+    uint64_t start;
+    uint64_t cycles;
+    INT32U sum;
+    INT32U i;
+
+    for (i = 0; i < passes; i++)
+    {
+        start = __rdtsc();
+        sum = ReadAll(pFile, path, limit);
+        cycles = __rdtsc() - start;
+        HOST_CHECK(sum == expected);
+        if (cycles < best) best = cycles;
+    }
+    printf("benchRead: %-16s %6u bytes: %8.4f bytes/cycle, %7.2f cycles/byte\n",
+        pathNames[path], (unsigned)limit, (double)limit / best, (double)best / limit);
+}
+
+static void BenchTask(void *pdata)
+{
+    File file;
+    INT32U songSum;
+    INT32U windowSum;
+    int path;
+
+    HostTestOpenSd();
+    file = SD.open(SONG, O_READ);
+    HOST_CHECK(file);
+    HOST_CHECK(file.size() == SONG_SIZE);
+    songSum = ReadAll(&file, READ_512, SONG_SIZE);
+    windowSum = ReadAll(&file, PER_BYTE, WINDOW);
+
+    printf("benchRead: whole file from the card\n");
+    for (path = PER_BYTE; path <= PEEK_BUFFER; path++)
+        Bench(&file, (Path)path, SONG_SIZE, 3, songSum);
+
+    // Whole aligned blocks bypass the cache in read(buf, 512) and
+    // readSector(), so only the paths that go through it are run here
+    printf("benchRead: first %u bytes from the block cache\n", (unsigned)WINDOW);
+    Bench(&file, PER_BYTE, WINDOW, PASSES, windowSum);
+    Bench(&file, READ_32, WINDOW, PASSES, windowSum);
+    Bench(&file, PEEK_BUFFER, WINDOW, PASSES, windowSum);
+    file.close();
+
+    HostTestExit("benchRead");
+}
+
+int main()
+{
+    HostTestRun(HOST_TEST_IMAGE, OS_FALSE, BenchTask);
+    return 0;
+}
@@ -0,0 +1,225 @@
+/*
+    benchSpiLocks.c
+    Counts the SPI bus lock acquisitions (the "locks" column of
+    PjdfLockDump()) of an ILI9341 address window set with the
+    writecommand()/writedata() calls setAddrWindow() used to make and with
+    its WriteV(), and of the frame LcdTouchDemoTask draws for one touch: a
+    pen dot and the updateText() of its position; the frame is only drawn
+    with WriteV(), its count before is worked out from its windows. Then the
+    same for the VS1053 command sequences of Mp3Init() and Mp3StreamInit(),
+    sent as one Write() per command and as one WriteV(). Checks that both
+    ways send the LCD and the decoder the same bytes.
+
+    2026/10 written for the MP3Player project
+*/
+
+#include <stdio.h>
+#include <string.h>
+
+#include "hostTest.h"
+#include "mp3Util.h"
+#include <Adafruit_ILI9341.h>
+
+#define WINDOWS     20
+#define FRAMES      20
+#define PENRADIUS   3       // as in tasks.c
+#define TEXT_X      4
+#define TEXT_Y      (ILI9341_TFTHEIGHT - 12)
+#define TEXT_SIZE   16
+
+static Adafruit_ILI9341 lcd;
+
+// The locks column of the PJDF_DEVICE_ID_SPI1 line of PjdfLockDump()
+static INT32U SpiLocks(void)
+{
+    static char out[SIM_UART_CAPTURE_SIZE + 1];
+    unsigned locks = 0;
+    char *p;
+
+    OSTimeDly(20);  // earlier output is out
+    SimUartCaptureClear();
+    PjdfLockDump();
+    HOST_CHECK(HostTestWaitOutput(PJDF_DEVICE_ID_I2C1 "\n", 500));     // the last line
+    out[SimUartCapture(out, SIM_UART_CAPTURE_SIZE)] = 0;
+    p = strstr(out, PJDF_DEVICE_ID_SPI1 "\n");
+    HOST_CHECK(p != 0);
+    if (p == 0) return 0;
+    while (p > out && p[-1] != '\n' && p[-1] != '\r') p--;
+    HOST_CHECK(sscanf(p, "%u", &locks) == 1);
+    return locks;
+}
+
+static void OpenLcd(void)
+{
+    HANDLE hLcd;
+    HANDLE hSPI;
+    INT32U length;
+
+    hLcd = Open(PJDF_DEVICE_ID_LCD_ILI9341, 0);
+    if (!PJDF_IS_VALID_HANDLE(hLcd)) while(1);
+    hSPI = Open(LCD_SPI_DEVICE_ID, 0);
+    if (!PJDF_IS_VALID_HANDLE(hSPI)) while(1);
+    length = sizeof(HANDLE);
+    if (PJDF_IS_ERROR(Ioctl(hLcd, PJDF_CTRL_LCD_SET_SPI_HANDLE, &hSPI, &length))) while(1);
+    lcd.setPjdfHandle(hLcd);
+    lcd.begin();
+    lcd.fillScreen(ILI9341_BLACK);
+}
+
+// setAddrWindow() before WriteV()
+static void SetAddrWindowPerByte(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1)
+{
+    lcd.writecommand(ILI9341_CASET);
+    lcd.writedata(x0 >> 8);
+    lcd.writedata(x0 & 0xFF);
+    lcd.writedata(x1 >> 8);
+    lcd.writedata(x1 & 0xFF);
+    lcd.writecommand(ILI9341_PASET);
+    lcd.writedata(y0 >> 8);
+    lcd.writedata(y0);
+    lcd.writedata(y1 >> 8);
+    lcd.writedata(y1);
+    lcd.writecommand(ILI9341_RAMWR);
+}
+
+// Returns the lock acquisitions of one window
+static double Windows(BOOLEAN perByte, SimLcdStats *pStats)
+{
+    INT32U locks = SpiLocks();
+    INT32U i;
+
+    SimLcd = SimLcdStats();
+    for (i = 0; i < WINDOWS; i++)
+    {
+        if (perByte) SetAddrWindowPerByte(10 + i, 20 + i, 30 + i, 40 + i);
+        else lcd.setAddrWindow(10 + i, 20 + i, 30 + i, 40 + i);
+    }
+    lcd.spiFlush();
+    *pStats = SimLcd;
+    return (double)(SpiLocks() - locks) / WINDOWS;
+}
+
+static void Lcd(void)
+{
+    char text[TEXT_SIZE];
+    char shown[TEXT_SIZE] = "";
+    SimLcdStats perByte;
+    SimLcdStats writeV;
+    double perByteLocks;
+    double writeVLocks;
+    double frameLocks;
+    double frameWindows;
+    INT32U locks;
+    int x;
+    int y;
+    INT32U i;
+
+    OpenLcd();
+    perByteLocks = Windows(OS_TRUE, &perByte);
+    writeVLocks = Windows(OS_FALSE, &writeV);
+    HOST_CHECK(perByte.commandBytes == writeV.commandBytes);
+    HOST_CHECK(perByte.dataBytes == writeV.dataBytes);
+    HOST_CHECK(writeV.ramwr == WINDOWS);
+    printf("benchSpiLocks: setAddrWindow() per byte: %4.1f locks, as a WriteV(): %4.1f locks\n",
+        perByteLocks, writeVLocks);
+    HOST_CHECK(writeVLocks == 1);
+
+    // The frame of a touch in LcdTouchDemoTask
+    lcd.updateText(TEXT_X, TEXT_Y, "x=  0 y=  0", shown, sizeof(shown), ILI9341_WHITE, ILI9341_BLACK, 1);
+    locks = SpiLocks();
+    SimLcd = SimLcdStats();
+    for (i = 0; i < FRAMES; i++)
+    {
+        x = 20 + 9 * i;
+        y = 30 + 13 * i;
+        lcd.fillCircle(x, y, PENRADIUS, ILI9341_RED);
+        snprintf(text, sizeof(text), "x=%3d y=%3d", x, y);
+        lcd.updateText(TEXT_X, TEXT_Y, text, shown, sizeof(shown), ILI9341_WHITE, ILI9341_BLACK, 1);
+    }
+    frameLocks = (double)(SpiLocks() - locks) / FRAMES;
+    frameWindows = (double)SimLcd.ramwr / FRAMES;
+    printf("benchSpiLocks: touch frame: %4.1f windows, %5.1f locks, %5.1f with setAddrWindow() per byte\n",
+        frameWindows, frameLocks, frameLocks + frameWindows * (perByteLocks - writeVLocks));
+}
+
+// Mp3Init() and Mp3StreamInit() before WriteV()
+static void CommandsPerWrite(HANDLE hMp3, const INT8U **pCommands, const INT32U *pLengths)
+{
+    INT32U length;
+    int i;
+
+    Ioctl(hMp3, PJDF_CTRL_MP3_SELECT_COMMAND, 0, 0);
+    for (i = 0; i < 3; i++)
+    {
+        length = pLengths[i];
+        Write(hMp3, (void*)pCommands[i], &length);
+    }
+}
+
+static void CommandsWriteV(HANDLE hMp3, const INT8U **pCommands, const INT32U *pLengths)
+{
+    PjdfSegment seg[3];
+    int i;
+
+    for (i = 0; i < 3; i++)
+    {
+        seg[i].pBuffer = (void*)pCommands[i];
+        seg[i].length = pLengths[i];
+        seg[i].flags = PJDF_SEG_COMMAND;
+    }
+    Ioctl(hMp3, PJDF_CTRL_MP3_SELECT_COMMAND, 0, 0);
+    WriteV(hMp3, seg, 3);
+}
+
+static void Mp3Sequence(HANDLE hMp3, const char *what, const INT8U **pCommands, const INT32U *pLengths)
+{
+    INT32U locks;
+    INT32U sciWrites;
+    INT32U perWriteSci;
+    INT32U perWrite;
+    INT32U writeV;
+
+    OSTimeDly(100);     // the decoder is idle
+    locks = SpiLocks();
+    sciWrites = SimMp3.sciWrites;
+    CommandsPerWrite(hMp3, pCommands, pLengths);
+    perWrite = SpiLocks() - locks;
+    perWriteSci = SimMp3.sciWrites - sciWrites;
+
+    OSTimeDly(100);
+    locks = SpiLocks();
+    sciWrites = SimMp3.sciWrites;
+    CommandsWriteV(hMp3, pCommands, pLengths);
+    writeV = SpiLocks() - locks;
+    HOST_CHECK(SimMp3.sciWrites - sciWrites == perWriteSci);
+    HOST_CHECK(perWriteSci == 3);
+    printf("benchSpiLocks: %-16s one Write() per command: %u locks, one WriteV(): %u locks\n",
+        what, (unsigned)perWrite, (unsigned)writeV);
+    HOST_CHECK(writeV < perWrite);
+}
+
+static void Mp3(void)
+{
+    static const INT8U *init[3] = { BspMp3SetClockF, BspMp3SetVol1010, BspMp3SoftReset };
+    static const INT8U *streamInit[3] = { BspMp3SoftReset, BspMp3SetVol1010, BspMp3PlayMode };
+    INT32U initLengths[3] = { BspMp3SetClockFLen, BspMp3SetVol1010Len, BspMp3SoftResetLen };
+    INT32U streamInitLengths[3] = { BspMp3SoftResetLen, BspMp3SetVol1010Len, BspMp3PlayModeLen };
+    HANDLE hMp3;
+
+    hMp3 = HostTestOpenMp3(OS_TRUE);
+    Mp3Sequence(hMp3, "Mp3Init():", init, initLengths);
+    Mp3Sequence(hMp3, "Mp3StreamInit():", streamInit, streamInitLengths);
+}
+
+static void BenchTask(void *pdata)
+{
+    Lcd();
+    Mp3();
+    HostTestExit("benchSpiLocks");
+}
+
+int main()
+{
+    HostTestRun(0, OS_FALSE, BenchTask);
+    return 0;
+}
@@ -0,0 +1,197 @@
+/*
+    benchSpiShare.c
+    Plays MP3 data on the VS1053 model while a task at LcdTouchDemoTask's
+    priority redraws the ILI9341 on the same SPI bus: a full-screen fill
+    and 30 rectangles of 60x60 every 150 ticks. Plays TRAIN.MP3 (64 kbps)
+    from the SD card through Mp3StreamSDFile(), and 128 kbps frames from
+    RAM through Mp3Stream() at the feeder's priority, each once with the
+    decoder and SD card handles reserved (fills give way to them after a
+    slice) and once without, as before PJDF_CTRL_SPI_SET_RESERVED. Prints
+    the decoder underruns and starved time, the longest the decoder waited
+    for data after raising DREQ, and the redraws done.
+
+    2026/10 written for the MP3Player project
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "hostTest.h"
+#include "mp3Util.h"
+#include "SD.h"
+#include <Adafruit_ILI9341.h>
+
+#define LCD_PRIO        APP_TASK_TEST2_PRIO     // as LcdTouchDemoTask
+#define REDRAW_TICKS    150
+#define RECTS           30
+#define RECT_SIZE       60
+#define SONG            "TRAIN.MP3"
+#define FAST_FRAME      417                     // 128 kbps at 44.1 kHz, not padded
+#define FAST_FRAMES     192                     // 5 s
+#define FAST_SIZE       (FAST_FRAME * FAST_FRAMES)
+
+static OS_STK LcdStk[APP_CFG_TASK_START_STK_SIZE];
+static Adafruit_ILI9341 lcd;
+static volatile BOOLEAN drawing;
+static volatile INT32U redraws;
+static INT8U fast[FAST_SIZE];
+
+// Redraws the screen while drawing is set
+static void LcdTask(void *pdata)
+{
+    INT32U i;
+
+    while (1)
+    {
+        if (!drawing)
+        {
+            OSTimeDly(10);
+            continue;
+        }
+        lcd.fillScreen(redraws & 1 ? ILI9341_BLUE : ILI9341_BLACK);
+        for (i = 0; i < RECTS; i++)
+            lcd.fillRect(i * 37 % (ILI9341_TFTWIDTH - RECT_SIZE), i * 53 % (ILI9341_TFTHEIGHT - RECT_SIZE),
+                RECT_SIZE, RECT_SIZE, ILI9341_RED + i);
+        redraws++;
+        OSTimeDly(REDRAW_TICKS);
+    }
+}
+
+static void OpenLcd(void)
+{
+    HANDLE hLcd;
+    HANDLE hSPI;
+    INT32U length;
+
+    hLcd = Open(PJDF_DEVICE_ID_LCD_ILI9341, 0);
+    if (!PJDF_IS_VALID_HANDLE(hLcd)) while(1);
+    hSPI = Open(LCD_SPI_DEVICE_ID, 0);
+    if (!PJDF_IS_VALID_HANDLE(hSPI)) while(1);
+    length = sizeof(HANDLE);
+    if (PJDF_IS_ERROR(Ioctl(hLcd, PJDF_CTRL_LCD_SET_SPI_HANDLE, &hSPI, &length))) while(1);
+    lcd.setPjdfHandle(hLcd);
+    lcd.begin();
+}
+
+// HostTestOpenSd(), keeping the SPI handle
+static HANDLE OpenSd(void)
+{
+    HANDLE hSD;
+    HANDLE hSPI;
+    INT32U length;
+
+    hSD = Open(PJDF_DEVICE_ID_SD_ADAFRUIT, 0);
+    if (!PJDF_IS_VALID_HANDLE(hSD)) while(1);
+    hSPI = Open(SD_SPI_DEVICE_ID, 0);
+    if (!PJDF_IS_VALID_HANDLE(hSPI)) while(1);
+    length = sizeof(HANDLE);
+    if (PJDF_IS_ERROR(Ioctl(hSD, PJDF_CTRL_SD_SET_SPI_HANDLE, &hSPI, &length))) while(1);
+    if (!SD.begin(hSD))
+    {
+        printf("benchSpiShare: SD.begin() failed\n");
+        exit(1);
+    }
+    return hSPI;
+}
+
+// HostTestOpenMp3(OS_TRUE), keeping the SPI handle
+static HANDLE OpenMp3(HANDLE *phMp3)
+{
+    HANDLE hSPI;
+    INT32U length;
+
+    *phMp3 = Open(PJDF_DEVICE_ID_MP3_VS1053, 0);
+    if (!PJDF_IS_VALID_HANDLE(*phMp3)) while(1);
+    hSPI = Open(MP3_SPI_DEVICE_ID, 0);
+    if (!PJDF_IS_VALID_HANDLE(hSPI)) while(1);
+    length = sizeof(HANDLE);
+    if (PJDF_IS_ERROR(Ioctl(*phMp3, PJDF_CTRL_MP3_SET_SPI_HANDLE, &hSPI, &length))) while(1);
+    if (PJDF_IS_ERROR(Ioctl(*phMp3, PJDF_CTRL_MP3_DREQ_INTERRUPT, 0, 0))) while(1);
+    Mp3Init(*phMp3);
+    return hSPI;
+}
+
+static void Reserve(HANDLE hSPI, BOOLEAN reserved)
+{
+    INT32U length = sizeof(reserved);
+
+    if (PJDF_IS_ERROR(Ioctl(hSPI, PJDF_CTRL_SPI_SET_RESERVED, &reserved, &length))) while(1);
+}
+
+// MPEG-1 layer III frames of 128 kbps at 44.1 kHz with silent side info
+static void MakeFast(void)
+{
+    INT32U i;
+
+    for (i = 0; i < FAST_FRAMES; i++)
+    {
+        fast[i * FAST_FRAME] = 0xFF;
+        fast[i * FAST_FRAME + 1] = 0xFB;
+        fast[i * FAST_FRAME + 2] = 0x90;    // 128 kbps, 44.1 kHz, no padding
+        fast[i * FAST_FRAME + 3] = 0xC4;    // mono
+    }
+}
+
+static void Play(HANDLE hMp3, BOOLEAN fromSd, BOOLEAN reserved, const char *what)
+{
+    INT32U redrawsBefore;
+    INT8U err;
+
+    OSTimeDly(100);
+    SimMp3 = SimMp3Stats();
+    redrawsBefore = redraws;
+    drawing = OS_TRUE;
+    if (fromSd)
+    {
+        Mp3StreamSDFile(hMp3, (char *)SONG);
+    }
+    else
+    {
+        // the caller feeds the decoder itself
+        err = OSTaskChangePrio(OS_PRIO_SELF, APP_TASK_MP3_FEED_PRIO);
+        if (err != OS_ERR_NONE) while(1);
+        Mp3Stream(hMp3, fast, FAST_SIZE);
+        err = OSTaskChangePrio(OS_PRIO_SELF, HOST_TEST_PRIO);
+        if (err != OS_ERR_NONE) while(1);
+    }
+    drawing = OS_FALSE;
+
+    printf("benchSpiShare: %-28s %-13s %3u decoder underruns, starved %7.1f ms, "
+        "longest wait after DREQ %6.1f ms, %2u redraws\n",
+        what, reserved ? "reserved:" : "not reserved:", (unsigned)SimMp3.underruns,
+        SimMp3.starvedNs / 1e6, SimMp3.dreqLatencyMaxNs / 1e6, (unsigned)(redraws - redrawsBefore));
+    HOST_CHECK(SimMp3.overflows == 0);
+    HOST_CHECK(SimBus.csConflicts == 0);
+    if (reserved) HOST_CHECK(SimMp3.underruns <= 1);    // the decoder may run dry after the last byte
+}
+
+static void BenchTask(void *pdata)
+{
+    HANDLE hSdSpi;
+    HANDLE hMp3Spi;
+    HANDLE hMp3;
+    INT8U err;
+    int i;
+
+    MakeFast();
+    OpenLcd();
+    hSdSpi = OpenSd();
+    hMp3Spi = OpenMp3(&hMp3);
+    err = OSTaskCreate(LcdTask, (void*)0, &LcdStk[APP_CFG_TASK_START_STK_SIZE-1], LCD_PRIO);
+    if (err != OS_ERR_NONE) while(1);
+
+    for (i = 0; i < 2; i++)
+    {
+        Reserve(hSdSpi, i == 1);
+        Reserve(hMp3Spi, i == 1);
+        Play(hMp3, OS_TRUE, i == 1, SONG " from SD, 64 kbps:");
+        Play(hMp3, OS_FALSE, i == 1, "RAM, 128 kbps:");
+    }
+    HostTestExit("benchSpiShare");
+}
+
+int main()
+{
+    HostTestRun(HOST_TEST_IMAGE, OS_FALSE, BenchTask);
+    return 0;
+}
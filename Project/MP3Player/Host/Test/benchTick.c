@@ -0,0 +1,90 @@
+/*
+    benchTick.c
+    Cost of OSTimeTick() in host CPU cycles (x86 time stamp counter) with
+    5, 20 and 60 tasks waiting on long delays, which the TCB scan visits on
+    every tick and the delta list (OS_TICK_LIST_EN) does not.
+
+    The application's os_cfg.h allows only 20 tasks; "make bench-tick"
+    builds this twice with Test/TickCfg/os_cfg.h, once with the delta list
+    and once with the scan, and runs both. Built by "make bench" it measures
+    the task counts the configuration has room for.
+
+    2026/10 written for the MP3Player project
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <x86intrin.h>
+
+#include "hostTest.h"
+
+#define MAX_DELAYED   60
+#define TICKS         20000u
+#define DELAY_TICKS   1000000u   // far longer than the benchmark
+
+static OS_STK DelayedStk[MAX_DELAYED][APP_CFG_TASK_START_STK_SIZE];
+static uint32_t cycles[TICKS];
+
+static void DelayedTask(void *pdata)
+{
+    while (1) OSTimeDly(DELAY_TICKS + (INT32U)(uintptr_t)pdata);
+}
+
+static int CompareCycles(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+
+    return x < y ? -1 : x > y;
+}
+
+// Calls OSTimeTick() TICKS times, as if the tick came that often, and
+// prints the median and 99th percentile of its cycles
+static void Measure(int delayed)
+{
+    uint64_t start;
+    INT32U i;
+
+    for (i = 0; i < TICKS; i++)
+    {
+        start = __rdtsc();
+        OSTimeTick();
+        cycles[i] = (uint32_t)(__rdtsc() - start);
+    }
+    qsort(cycles, TICKS, sizeof(cycles[0]), CompareCycles);
+    printf("benchTick: %s, %2d delayed tasks: OSTimeTick() median %6u cycles, 99%% %6u cycles\n",
+        OS_TICK_LIST_EN > 0u ? "delta list" : "TCB scan  ", delayed,
+        (unsigned)cycles[TICKS / 2], (unsigned)cycles[TICKS * 99 / 100]);
+}
+
+static void BenchTask(void *pdata)
+{
+    static const int counts[] = { 5, 20, 60 };
+    INT8U err;
+    int delayed = 0;
+    unsigned k;
+
+    for (k = 0; k < sizeof(counts) / sizeof(counts[0]); k++)
+    {
+        if (counts[k] + 1 > (int)OS_MAX_TASKS || HOST_TEST_PRIO + counts[k] >= (int)OS_TASK_STAT_PRIO)
+        {
+            printf("benchTick: no room for %d tasks in this os_cfg.h, see \"make bench-tick\"\n", counts[k]);
+            break;
+        }
+        for (; delayed < counts[k]; delayed++)
+        {
+            err = OSTaskCreate(DelayedTask, (void*)(uintptr_t)delayed,
+                &DelayedStk[delayed][APP_CFG_TASK_START_STK_SIZE-1], HOST_TEST_PRIO + 1 + delayed);
+            if (err != OS_ERR_NONE) while(1);
+        }
+        OSTimeDly(1);       // let them all start their delays
+        Measure(delayed);
+    }
+    HostTestExit("benchTick");
+}
+
+int main()
+{
+    HostTestRun(0, OS_FALSE, BenchTask);
+    return 0;
+}
@@ -0,0 +1,103 @@
+/*
+    benchUart.c
+    Times what a task spends in PrintString() for one status message at 38400
+    baud: spinning on TXE for every character as PrintByte() used to, and
+    queuing into the TX ring drained by the USART interrupt (bspUart.c).
+    Prints the min, median and max per message, then the time a burst
+    larger than the ring takes under UART_TX_OVERFLOW, and checks that every
+    byte went out in order.
+
+    2026/10 written for the MP3Player project
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hostTest.h"
+
+#define MESSAGE       "Begin streaming sound file  count=1\n"
+#define SENT          "Begin streaming sound file  count=1\n\r"  // as PrintString() sends it
+#define MESSAGES      21
+#define BURST         (4 * UART_TX_BUF_SIZE)
+
+static double us[MESSAGES];
+
+// The PrintByte() before the TX ring
+static void PrintBytePolled(char c)
+{
+    while (USART_GetFlagStatus(COMM, USART_FLAG_TXE) == RESET);
+    USART_SendData(COMM, c);
+}
+
+static int CompareUs(const void *a, const void *b)
+{
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+
+    return x < y ? -1 : x > y;
+}
+
+static void Messages(BOOLEAN polled, const char *what)
+{
+    char out[SIM_UART_CAPTURE_SIZE];
+    uint64_t start;
+    int i;
+
+    SimUartCaptureClear();
+    for (i = 0; i < MESSAGES; i++)
+    {
+        OSTimeDly(20);  // the last message is out
+        start = SimNow();
+        if (polled) PrintStringToDevice(PrintBytePolled, (char *)MESSAGE);
+        else PrintString((char *)MESSAGE);
+        us[i] = HostTestMs(start) * 1000;
+    }
+    OSTimeDly(20);
+    qsort(us, MESSAGES, sizeof(us[0]), CompareUs);
+    printf("benchUart: %-16s %2u bytes: min %7.1f us, median %7.1f us, max %7.1f us\n",
+        what, (unsigned)strlen(SENT), us[0], us[MESSAGES / 2], us[MESSAGES - 1]);
+
+    HOST_CHECK(SimUartCapture(out, sizeof(out)) == MESSAGES * strlen(SENT));
+    for (i = 0; i < MESSAGES; i++)
+        HOST_CHECK(memcmp(out + i * strlen(SENT), SENT, strlen(SENT)) == 0);
+}
+
+static void Burst(void)
+{
+    static char burst[BURST + 1];
+    char out[SIM_UART_CAPTURE_SIZE];
+    uint64_t start;
+    double ms;
+    int i;
+
+    for (i = 0; i < BURST; i++) burst[i] = 'a' + i % 26;
+    OSTimeDly(20);
+    SimUartCaptureClear();
+    start = SimNow();
+    PrintString(burst);
+    ms = HostTestMs(start);
+    printf("benchUart: %u bytes into a %u byte ring: %.1f ms in PrintString(), %u dropped\n",
+        BURST, UART_TX_BUF_SIZE, ms, (unsigned)uartTxDropped);
+
+    OSTimeDly(BURST / 3);   // about 260 us a byte
+#if UART_TX_OVERFLOW == UART_TX_BLOCK
+    HOST_CHECK(uartTxDropped == 0);
+    HOST_CHECK(SimUartCapture(out, sizeof(out)) == BURST);
+    HOST_CHECK(memcmp(out, burst, BURST) == 0);
+#endif
+}
+
+static void BenchTask(void *pdata)
+{
+    Messages(OS_TRUE, "spinning on TXE:");
+    Messages(OS_FALSE, "TX ring:");
+    Burst();
+    HostTestExit("benchUart");
+}
+
+int main()
+{
+    HostTestRun(0, OS_FALSE, BenchTask);
+    return 0;
+}
@@ -0,0 +1,132 @@
+/*
+    hostTest.c
+    Helpers shared by the host tests and benchmarks, see hostTest.h.
+
+    2026/10 written for the MP3Player project
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hostTest.h"
+#include "mp3Util.h"
+#include "SD.h"
+
+void StartupTask(void* pdata);
+
+static OS_STK StartupStk[APP_CFG_TASK_START_STK_SIZE];
+static OS_STK TestStk[APP_CFG_TASK_START_STK_SIZE];
+static INT32U failures;
+
+int hostTestUartFd = -1;
+
+
+void HostTestRun(const char *sdImage, BOOLEAN app, void (*pTest)(void *pdata))
+{
+    INT8U err;
+
+    setvbuf(stdout, 0, _IONBF, 0);
+    SimInit(sdImage, hostTestUartFd, hostTestUartFd);
+    Hw_init();
+    OSInit();
+    BspUartInitInterrupts();
+    InitPjdf();
+    if (app)
+    {
+        err = OSTaskCreate(StartupTask, (void*)0, &StartupStk[APP_CFG_TASK_START_STK_SIZE-1], APP_TASK_START_PRIO);
+        if (err != OS_ERR_NONE) while(1);
+    }
+    else
+    {
+        // StartupTask starts the tick when the application runs
+        OS_CPU_SysTickInit(OS_TICKS_PER_SEC);
+    }
+    err = OSTaskCreate(pTest, (void*)0, &TestStk[APP_CFG_TASK_START_STK_SIZE-1], HOST_TEST_PRIO);
+    if (err != OS_ERR_NONE) while(1);
+    OSStart();
+    while(1);
+}
+
+HANDLE HostTestOpenSd(void)
+{
+    HANDLE hSD;
+    HANDLE hSPI;
+    INT32U length;
+
+    hSD = Open(PJDF_DEVICE_ID_SD_ADAFRUIT, 0);
+    if (!PJDF_IS_VALID_HANDLE(hSD)) while(1);
+    hSPI = Open(SD_SPI_DEVICE_ID, 0);
+    if (!PJDF_IS_VALID_HANDLE(hSPI)) while(1);
+    length = sizeof(HANDLE);
+    if (PJDF_IS_ERROR(Ioctl(hSD, PJDF_CTRL_SD_SET_SPI_HANDLE, &hSPI, &length))) while(1);
+    if (!SD.begin(hSD))
+    {
+        printf("HostTestOpenSd: SD.begin() failed\n");
+        exit(1);
+    }
+    return hSD;
+}
+
+HANDLE HostTestOpenMp3(BOOLEAN dreqInterrupt)
+{
+    HANDLE hMp3;
+    HANDLE hSPI;
+    INT32U length;
+
+    hMp3 = Open(PJDF_DEVICE_ID_MP3_VS1053, 0);
+    if (!PJDF_IS_VALID_HANDLE(hMp3)) while(1);
+    hSPI = Open(MP3_SPI_DEVICE_ID, 0);
+    if (!PJDF_IS_VALID_HANDLE(hSPI)) while(1);
+    length = sizeof(HANDLE);
+    if (PJDF_IS_ERROR(Ioctl(hMp3, PJDF_CTRL_MP3_SET_SPI_HANDLE, &hSPI, &length))) while(1);
+    if (PJDF_IS_ERROR(Ioctl(hMp3, dreqInterrupt ? PJDF_CTRL_MP3_DREQ_INTERRUPT : PJDF_CTRL_MP3_DREQ_POLL, 0, 0))) while(1);
+    Mp3Init(hMp3);
+    return hMp3;
+}
+
+void HostTestCheck(int ok, const char *what, const char *file, int line)
+{
+    if (ok) return;
+    failures++;
+    printf("%s:%d: check failed: %s\n", file, line, what);
+}
+
+BOOLEAN HostTestWaitOutput(const char *text, INT32U ms)
+{
+    static char buf[SIM_UART_CAPTURE_SIZE + 1];
+    INT32U waited;
+
+    for (waited = 0; waited <= ms; waited += 10)
+    {
+        SimUartCapture(buf, sizeof(buf));
+        if (strstr(buf, text) != 0) return OS_TRUE;
+        OSTimeDly(10);
+    }
+    return OS_FALSE;
+}
+
+BOOLEAN HostTestOutputValue(const char *key, INT32U *pValue)
+{
+    static char buf[SIM_UART_CAPTURE_SIZE + 1];
+    char *p;
+    char *last = 0;
+
+    SimUartCapture(buf, sizeof(buf));
+    for (p = strstr(buf, key); p != 0; p = strstr(p + 1, key)) last = p;
+    if (last == 0) return OS_FALSE;
+    *pValue = (INT32U)strtoul(last + strlen(key), 0, 10);
+    return OS_TRUE;
+}
+
+double HostTestMs(uint64_t since)
+{
+    return (double)(SimNow() - since) / 1e6;
+}
+
+void HostTestExit(const char *name)
+{
+    if (failures == 0) printf("%s: PASS\n", name);
+    else printf("%s: FAIL (%u checks)\n", name, (unsigned)failures);
+    exit(failures == 0 ? 0 : 1);
+}
@@ -0,0 +1,60 @@
+/*
+    hostTest.h
+    Helpers shared by the host tests and benchmarks in this directory.
+
+    A test runs as a uC/OS-II task next to the application: HostTestRun()
+    does what main() does (Hw_init(), OSInit(), the UART interrupts, PJDF),
+    optionally creates the application's StartupTask, creates the test task
+    and starts the kernel. The test task drives the device models through
+    sim.h and ends the program with HostTestExit().
+
+    2026/10 written for the MP3Player project
+*/
+
+#ifndef __HOSTTEST_H
+#define __HOSTTEST_H
+
+#include "bsp.h"
+#include "sim.h"
+
+#define HOST_TEST_PRIO   20     // below all the application tasks
+#define HOST_TEST_IMAGE  "build/sd.img"
+#define HOST_TEST_FRAGMENTED_IMAGE  "build/sd-frag.img"  // every file's clusters interleaved
+
+// Host file descriptor USART2 reads and writes, -1 (the default) for none.
+// Set it before HostTestRun().
+extern int hostTestUartFd;
+
+// Starts the models, the kernel and pTest as a task of HOST_TEST_PRIO.
+// sdImage: image for the SD card, 0 for none
+// app: also start the application (StartupTask and the tasks it creates)
+// Does not return.
+void HostTestRun(const char *sdImage, BOOLEAN app, void (*pTest)(void *pdata));
+
+// Opens the SD card driver on its SPI handle, as StartupTask does, and
+// mounts the FAT volume. Returns the SD handle.
+HANDLE HostTestOpenSd(void);
+
+// Opens the MP3 decoder driver on its SPI handle, as Mp3DemoTask does, with
+// DREQ waits on the interrupt or polled, and initializes the decoder.
+// Returns the MP3 handle.
+HANDLE HostTestOpenMp3(BOOLEAN dreqInterrupt);
+
+// Checks a condition, counting and reporting a failure
+#define HOST_CHECK(cond) HostTestCheck((cond), #cond, __FILE__, __LINE__)
+void HostTestCheck(int ok, const char *what, const char *file, int line);
+
+// Waits up to ms for text to appear in the UART output (SimUartCapture())
+BOOLEAN HostTestWaitOutput(const char *text, INT32U ms);
+
+// Finds the number after the last "key" in the UART output.
+// Returns OS_FALSE if key is not there.
+BOOLEAN HostTestOutputValue(const char *key, INT32U *pValue);
+
+// Milliseconds since an earlier SimNow()
+double HostTestMs(uint64_t since);
+
+// Prints PASS or FAIL with the number of failed checks and exits accordingly
+void HostTestExit(const char *name);
+
+#endif /* __HOSTTEST_H */
@@ -0,0 +1,143 @@
+/*
+    testPlay.c
+    Runs the application with the SD card image and checks the ways it
+    plays songs from the card: Mp3DemoTask resumes the song of a resume
+    record left by a power cut (Mp3ResumeSDFile()), and the shell's play
+    command has it play TRAIN.MP3 from a time (Mp3StreamSDFileAt()) and
+    from the start (Mp3StreamSDFile()). Checks the frame each starts at and
+    the bytes the decoder gets. The shell's ls command then rebuilds the
+    catalog of /MUSIC while a song plays, the shell task and the stream
+    tasks sharing the card, and the song must play whole and the catalog
+    be kept.
+
+    2026/10 written for the MP3Player project
+*/
+
+#include <stdio.h>
+#include <string.h>
+
+#include "hostTest.h"
+#include "SD.h"
+
+#define SONG            "TRAIN.MP3"
+#define SONG_SIZE       39376u
+#define RESUME_FILE     "RESUME.DAT"
+#define RESUME_MAGIC    0x31535952u
+#define FRAME_SAMPLES   1152
+#define SONGS           8       // in /MUSIC of HOST_TEST_IMAGE
+#define SAMPLE_RATE     44100
+
+// Mp3Resume of mp3Util.c
+typedef struct
+{
+    INT32U magic;
+    INT32U ms;
+    char name[32];
+} Resume;
+
+// The record Mp3StreamSDFileAt() leaves when power is cut ms into SONG
+static void WriteResume(INT32U ms)
+{
+    Resume resume;
+    File file;
+
+    memset(&resume, 0, sizeof(resume));
+    resume.magic = RESUME_MAGIC;
+    resume.ms = ms;
+    strcpy(resume.name, SONG);
+    SD.remove((char *)RESUME_FILE);
+    file = SD.open(RESUME_FILE, FILE_WRITE);
+    HOST_CHECK(file);
+    file.write((const uint8_t *)&resume, sizeof(resume));
+    file.close();
+}
+
+// Waits for the song playing from ms to end and checks where it started and
+// what the decoder got
+static void CheckPlayed(INT32U ms)
+{
+    INT32U frame = (INT32U)((unsigned long long)ms * SAMPLE_RATE / 1000 / FRAME_SAMPLES);
+    INT32U started = 0;
+    INT32U offset = 0;
+    INT32U indexed = 0;
+
+    HOST_CHECK(HostTestWaitOutput("Mp3StreamSDFile: decoder underruns", 10000));
+    if (ms != 0)
+    {
+        HOST_CHECK(HostTestOutputValue("Mp3StreamSDFileAt: ", &started));
+        HOST_CHECK(HostTestOutputValue(" is frame ", &indexed));
+        HOST_CHECK(HostTestOutputValue(" at ", &offset));
+        HOST_CHECK(indexed == frame);
+        HOST_CHECK(started == frame * FRAME_SAMPLES * 1000 / SAMPLE_RATE);
+    }
+    printf("testPlay: from %4u ms: frame %3u at %5u, %5u SDI bytes, %u underruns\n", (unsigned)ms,
+        (unsigned)indexed, (unsigned)offset, (unsigned)SimMp3.sdiBytes, (unsigned)SimMp3.underruns);
+    HOST_CHECK(SimMp3.sdiBytes == SONG_SIZE - offset);
+    HOST_CHECK(SimMp3.overflows == 0);
+}
+
+static void Play(const char *line, INT32U ms)
+{
+    SimUartCaptureClear();
+    SimMp3 = SimMp3Stats();
+    SimUartInject(line, strlen(line));
+    CheckPlayed(ms);
+}
+
+// Lists /MUSIC with the shell, rebuilding its catalog, while SONG plays
+static void ListWhilePlaying(void)
+{
+    INT32U songs = 0;
+    INT32U waited;
+
+    SD.remove((char *)"/MUSIC/LIBRARY.DAT");
+    SimUartCaptureClear();
+    SimMp3 = SimMp3Stats();
+    SimUartInject("play " SONG "\r", strlen("play " SONG "\r"));
+    for (waited = 0; SimMp3.sdiBytes == 0 && waited < 2000; waited += 10) OSTimeDly(10);
+    HOST_CHECK(SimMp3.sdiBytes != 0);
+
+    SimUartInject("ls /MUSIC\r", 10);
+    HOST_CHECK(HostTestWaitOutput(" songs", 10000));
+    HOST_CHECK(HostTestOutputValue("  ", &songs) && songs == SONGS);
+    HOST_CHECK(SimMp3.sdiBytes < SONG_SIZE);   // listed while it played
+    CheckPlayed(0);
+    HOST_CHECK(!SD.exists((char *)RESUME_FILE));
+
+    // the catalog built is whole: listing again reads it, writing nothing
+    SimUartCaptureClear();
+    SimSd = SimSdStats();
+    SimUartInject("ls /MUSIC\r", 10);
+    HOST_CHECK(HostTestWaitOutput(" songs", 5000));
+    HOST_CHECK(HostTestOutputValue("  ", &songs) && songs == SONGS);
+    HOST_CHECK(SimSd.blocksWritten == 0);
+}
+
+static void TestTask(void *pdata)
+{
+    HOST_CHECK(HostTestWaitOutput("StartupTask: deleting self", 2000));
+    HOST_CHECK(!HostTestWaitOutput("no SD card", 0));
+
+    // Mp3DemoTask starts after 2 s and finishes the song first
+    WriteResume(2000);
+    SimMp3 = SimMp3Stats();
+    HOST_CHECK(HostTestWaitOutput("Mp3DemoTask: resumed the last song", 10000));
+    CheckPlayed(2000);
+    HOST_CHECK(!SD.exists((char *)RESUME_FILE));
+
+    HOST_CHECK(HostTestWaitOutput("Shell>", 5000));
+    Play("play " SONG " 3\r", 3000);
+    Play("play " SONG "\r", 0);
+    ListWhilePlaying();
+
+    SimUartCaptureClear();
+    SimUartInject("play\r", 5);
+    HOST_CHECK(HostTestWaitOutput("usage: play", 1000));
+    HostTestExit("testPlay");
+}
+
+int main()
+{
+    HostTestRun(HOST_TEST_IMAGE, OS_TRUE, TestTask);
+    return 0;
+}
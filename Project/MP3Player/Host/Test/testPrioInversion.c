@@ -0,0 +1,143 @@
+/*
+    testPrioInversion.c
+    The priority inversion the PJDF bus locks are mutexes for: a low
+    priority task holds the lock for 20 ms, a high priority task then waits
+    for it and a medium priority task starts 100 ms of CPU work. With a
+    semaphore, as the bus locks were, the medium task keeps the holder off
+    the CPU and the high task waits out its work as well; with a lock from
+    PjdfCreateBusLock() the holder runs at the ceiling and the high task
+    only waits for the rest of the hold. Both go through PjdfLock(), and
+    the test checks its wait count and longest wait against its own.
+
+    2026/10 written for the MP3Player project
+*/
+
+#include <stdio.h>
+
+#include "hostTest.h"
+#include "pjdfInternal.h"
+
+#define HIGH_PRIO   5       // as the MP3 feeder
+#define MEDIUM_PRIO 8
+#define LOW_PRIO    12
+#define HOLD_MS     20
+#define WORK_MS     100
+#define ROUNDS      3
+#define SPIN_GAP_NS 100000
+
+static OS_STK HighStk[APP_CFG_TASK_START_STK_SIZE];
+static OS_STK MediumStk[APP_CFG_TASK_START_STK_SIZE];
+static OS_STK LowStk[APP_CFG_TASK_START_STK_SIZE];
+static DriverInternal bus;      // only the lock and its counts are used
+static volatile BOOLEAN held;
+static volatile BOOLEAN waiting;
+static volatile INT32U finished;
+static double highWaitMs;
+
+// Works ms of CPU, letting the tick preempt (see the port's OSIntCtxSw()).
+// Gaps of more than SPIN_GAP_NS are time the task was preempted for and do
+// not count.
+static void Spin(INT32U ms)
+{
+    uint64_t worked = 0;
+    uint64_t last = SimNow();
+    uint64_t now;
+
+    while (worked < ms * 1000000ull)
+    {
+        OSTimeGet();
+        now = SimNow();
+        if (now - last < SPIN_GAP_NS) worked += now - last;
+        last = now;
+    }
+}
+
+static void Finish(void)
+{
+    OS_CPU_SR cpu_sr;
+
+    OS_ENTER_CRITICAL();
+    finished++;
+    OS_EXIT_CRITICAL();
+    OSTaskDel(OS_PRIO_SELF);
+}
+
+static void LowTask(void *pdata)
+{
+    PjdfLock(&bus);
+    held = OS_TRUE;
+    Spin(HOLD_MS);
+    PjdfUnlock(&bus);
+    Finish();
+}
+
+static void HighTask(void *pdata)
+{
+    uint64_t start;
+
+    while (!held) OSTimeDly(1);
+    waiting = OS_TRUE;
+    start = SimNow();
+    PjdfLock(&bus);
+    highWaitMs = HostTestMs(start);
+    PjdfUnlock(&bus);
+    Finish();
+}
+
+static void MediumTask(void *pdata)
+{
+    while (!waiting) OSTimeDly(1);
+    Spin(WORK_MS);
+    Finish();
+}
+
+// Returns the high task's longest wait in ms
+static double Run(OS_EVENT *pLock, const char *what)
+{
+    double waitMax = 0;
+    INT8U err;
+    int i;
+
+    bus.sem = pLock;
+    bus.locks = 0;
+    bus.lockWaits = 0;
+    bus.lockWaitMax = 0;
+    for (i = 0; i < ROUNDS; i++)
+    {
+        held = OS_FALSE;
+        waiting = OS_FALSE;
+        finished = 0;
+        err = OSTaskCreate(HighTask, (void*)0, &HighStk[APP_CFG_TASK_START_STK_SIZE-1], HIGH_PRIO);
+        if (err != OS_ERR_NONE) while(1);
+        err = OSTaskCreate(MediumTask, (void*)0, &MediumStk[APP_CFG_TASK_START_STK_SIZE-1], MEDIUM_PRIO);
+        if (err != OS_ERR_NONE) while(1);
+        err = OSTaskCreate(LowTask, (void*)0, &LowStk[APP_CFG_TASK_START_STK_SIZE-1], LOW_PRIO);
+        if (err != OS_ERR_NONE) while(1);
+        while (finished < 3) OSTimeDly(10);
+        if (highWaitMs > waitMax) waitMax = highWaitMs;
+        printf("testPrioInversion: %-10s high task waited %6.1f ms\n", what, highWaitMs);
+    }
+    HOST_CHECK(bus.locks == 2 * ROUNDS);
+    HOST_CHECK(bus.lockWaits == ROUNDS);
+    HOST_CHECK(bus.lockWaitMax / (OS_CPU_CyclesInit() / 1000.0) > waitMax - 1);
+    HOST_CHECK(bus.lockWaitMax / (OS_CPU_CyclesInit() / 1000.0) < waitMax + 1);
+    return waitMax;
+}
+
+static void TestTask(void *pdata)
+{
+    double semaphore;
+    double mutex;
+
+    semaphore = Run(OSSemCreate(1), "semaphore:");
+    mutex = Run(PjdfCreateBusLock(), "mutex:");
+    HOST_CHECK(semaphore > WORK_MS);
+    HOST_CHECK(mutex < WORK_MS / 2);
+    HostTestExit("testPrioInversion");
+}
+
+int main()
+{
+    HostTestRun(0, OS_FALSE, TestTask);
+    return 0;
+}
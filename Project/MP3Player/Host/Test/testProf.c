@@ -0,0 +1,144 @@
+/*
+    testProf.c
+    Runs three tasks that each spin for 2, 2 and 3 ms of every 10 ticks and
+    time each of their spins, and checks that the profiler (profUtil.c)
+    accounts for them, then prints the table. A spin that began and ended
+    in a window was charged in that window to its task, the ISRs or the
+    tasks that preempted it, whenever the host ran the process late or
+    stopped it meanwhile, so each load's spinning must be covered by its
+    profiled time and the time the others ran, and each spin needs a
+    switch to its task. The host can skip periods, so the shares are
+    printed against 20%, 20% and 30% but not held to them.
+
+    2026/10 written for the MP3Player project
+*/
+
+#include <stdio.h>
+
+#include "hostTest.h"
+#include "profUtil.h"
+
+#define LOADS         3
+#define LOAD_PRIO     (HOST_TEST_PRIO + 1)  // below the test task, which must see the window roll over
+#define PERIOD_TICKS  10
+#define SPINS         256   // spins of a load kept, more than fit in a window
+#define CLOCK_SLACK   20000 // ns, between reading the clock and switching
+
+static OS_STK LoadStk[LOADS][APP_CFG_TASK_START_STK_SIZE];
+static const INT32U loadMs[LOADS] = { 2, 2, 3 };
+static OS_EVENT *loadGo[LOADS];
+static volatile INT32U started[LOADS];          // spins begun
+static volatile INT32U finished[LOADS];         // spins ended, each timed in spinNs
+static volatile uint64_t spinNs[LOADS][SPINS];
+
+// Spins for loadMs of every period. The loads run one after the other,
+// each started by the one before, so none is ever preempted by another,
+// even when the host runs the process late.
+static void LoadTask(void *pdata)
+{
+    uintptr_t i = (uintptr_t)pdata;
+    uint64_t start;
+    uint64_t now;
+    INT8U err;
+
+    while (1)
+    {
+        if (i == 0) OSTimeDly(PERIOD_TICKS - OSTimeGet() % PERIOD_TICKS);
+        OSSemPend(loadGo[i], 0, &err);
+        start = SimNow();
+        started[i]++;
+        while ((now = SimNow()) - start < loadMs[i] * 1000000u)
+        {
+            OSTimeGet(); // lets the tick preempt, see the port's OSIntCtxSw()
+        }
+        spinNs[i][finished[i] % SPINS] = now - start;
+        finished[i]++;
+        OSSemPost(loadGo[(i + 1) % LOADS]);
+    }
+}
+
+// Waits for the profiler to close a window; the test task runs right after
+// the tick that does it, so no load runs between the two
+static void WaitWindow(void)
+{
+    INT32U last = profIsr.cyclesLast;   // ISR time in ns, never the same twice
+
+    while (profIsr.cyclesLast == last) OSTimeDly(1);
+}
+
+// Checks the loads' spins that begin and end in the next window against
+// what the profiler charged; returns OS_TRUE if it covers all of them
+static BOOLEAN CompareWindow(void)
+{
+    INT32U first[LOADS];
+    INT32U switches[LOADS];
+    uint64_t spun;
+    double window;
+    double others;
+    double measured;
+    double profiled;
+    BOOLEAN agrees = OS_TRUE;
+    uintptr_t i;
+    INT32U prio;
+    INT32U n;
+
+    // no load runs while the test task does, so a spin begun after this
+    // begins in the window
+    for (i = 0; i < LOADS; i++)
+    {
+        first[i] = started[i];
+        switches[i] = profTasks[LOAD_PRIO + i].switches;
+    }
+    WaitWindow();
+
+    // Every cycle of the window is charged to a task or to the ISRs
+    window = profIsr.cyclesLast;
+    for (prio = 0; prio < PROF_TASK_COUNT; prio++) window += profTasks[prio].cyclesLast;
+    // what ran but the loads and the idle task, any of which can preempt a spin
+    others = profIsr.cyclesLast;
+    for (prio = 0; prio < PROF_TASK_COUNT; prio++)
+        if (prio != OS_TASK_IDLE_PRIO && (prio < LOAD_PRIO || prio >= LOAD_PRIO + LOADS)) others += profTasks[prio].cyclesLast;
+    for (i = 0; i < LOADS; i++)
+    {
+        spun = 0;
+        for (n = first[i]; n != finished[i]; n++) spun += spinNs[i][n % SPINS];
+        measured = 100.0 * spun / window;
+        profiled = 100.0 * profTasks[LOAD_PRIO + i].cyclesLast / window;
+        printf("testProf: task spinning %u ms per %u ticks spun %5.2f%% of a %.3f s window in %u spins, profiled at %5.2f%% (others %.2f%%)\n",
+            (unsigned)loadMs[i], PERIOD_TICKS, measured, window / OS_CPU_CyclesInit(), (unsigned)(finished[i] - first[i]),
+            profiled, 100.0 * others / window);
+        // a spin's time is the load's own or that of what preempted it
+        if (spun > profTasks[LOAD_PRIO + i].cyclesLast + others + (finished[i] - first[i]) * CLOCK_SLACK) agrees = OS_FALSE;
+        if (finished[i] == first[i] || profTasks[LOAD_PRIO + i].switches - switches[i] < finished[i] - first[i]) agrees = OS_FALSE;
+    }
+    return agrees;
+}
+
+static void TestTask(void *pdata)
+{
+    INT8U err;
+    uintptr_t i;
+
+    ProfInit();
+    for (i = 0; i < LOADS; i++)
+    {
+        loadGo[i] = OSSemCreate(i == 0);
+        if (loadGo[i] == 0) while(1);
+        err = OSTaskCreate(LoadTask, (void*)i, &LoadStk[i][APP_CFG_TASK_START_STK_SIZE-1], LOAD_PRIO + i);
+        if (err != OS_ERR_NONE) while(1);
+    }
+    WaitWindow();
+
+    HOST_CHECK(CompareWindow());
+    HOST_CHECK(profIsr.count > 0);
+
+    ProfDump();
+    HOST_CHECK(HostTestWaitOutput(" isr ", 1000));  // the table takes about 100 ms at 38400 baud
+    HostTestExit("testProf");
+}
+
+int main()
+{
+    HostTestRun(0, OS_FALSE, TestTask);
+    return 0;
+}
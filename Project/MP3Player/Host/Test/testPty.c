@@ -0,0 +1,195 @@
+/*
+    testPty.c
+    Connects USART2 to a pseudo terminal and types shell commands into its
+    slave side, as a script would: first to a line reader that polls RXNE
+    as ReadByte() used to, then to the shell (PJShellEntry) reading through
+    the RX interrupt. A task below the shell works 5 ms of every 5 ticks.
+    Reports the CPU share of the shell and the idle task from the profiler
+    and the worker's rounds in a one second window, and checks that every
+    line is answered on the terminal.
+
+    OSCPUUsage is not used: the statistics task is off with the tickless
+    idle (OS_TASK_STAT_EN), as the idle task sleeps instead of counting.
+
+    2026/10 written for the MP3Player project
+*/
+
+// The register names of the target (CR1, ...) are macros in termios.h,
+// so the target headers come first
+#include "hostTest.h"
+#include "profUtil.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+
+#define DRIVER_PRIO   (APP_TASK_SHELL_PRIO - 1)  // this test, above either shell
+#define WORKER_PRIO   (APP_TASK_SHELL_PRIO + 2)
+#define WORK_MS       5
+#define WORK_TICKS    5
+#define LINES         20
+#define LINE          "cd /\r"
+#define ANSWER        "Hello from cd command"
+
+void PJShellEntry(void *pArg);
+
+static OS_STK ShellStk[APP_CFG_TASK_SHELL_STK_SIZE];
+static OS_STK WorkerStk[APP_CFG_TASK_START_STK_SIZE];
+static int slaveFd;
+static volatile INT32U workerRounds;
+static volatile INT32U polledLines;
+
+static void WorkerTask(void *pdata)
+{
+    uint64_t start;
+
+    while (1)
+    {
+        start = SimNow();
+        while (SimNow() - start < WORK_MS * 1000000u) OSTimeGet(); // lets the tick preempt, see the port's OSIntCtxSw()
+        workerRounds++;
+        OSTimeDly(WORK_TICKS);
+    }
+}
+
+// Reads lines the way the shell did before the RX interrupt: ReadByte()
+// spinning on RXNE
+static void PollingShellTask(void *pdata)
+{
+    char c;
+
+    while (1)
+    {
+        while (USART_GetFlagStatus(COMM, USART_FLAG_RXNE) == RESET) OSTimeGet();
+        c = (char)USART_ReceiveData(COMM);
+        if (c == '\r')
+        {
+            polledLines++;
+            PrintString((char *)ANSWER "\n");
+        }
+    }
+}
+
+// Waits for the profiler to close a window; this task runs right after the
+// tick that does it
+static void WaitWindow(void)
+{
+    INT32U last = profIsr.cyclesLast;   // ISR time in ns, never the same twice
+
+    while (profIsr.cyclesLast == last) OSTimeDly(1);
+}
+
+// Everything the terminal has received so far, appended to out
+static void ReadTerminal(char *out, size_t size)
+{
+    size_t length = strlen(out);
+    ssize_t n;
+
+    while (length < size - 1 && (n = read(slaveFd, out + length, size - 1 - length)) > 0) length += n;
+    out[length] = 0;
+}
+
+static int Count(const char *text, const char *what)
+{
+    int count = 0;
+
+    for (text = strstr(text, what); text != 0; text = strstr(text + 1, what)) count++;
+    return count;
+}
+
+static void Run(BOOLEAN pending, const char *what)
+{
+    static char out[8192];
+    double window;
+    INT32U rounds;
+    INT32U prio;
+    INT8U err;
+    int i;
+
+    if (pending)
+    {
+        USART_ITConfig(COMM, USART_IT_RXNE, ENABLE);
+        err = OSTaskCreate(PJShellEntry, (void*)0, &ShellStk[APP_CFG_TASK_SHELL_STK_SIZE-1], APP_TASK_SHELL_PRIO);
+        if (err != OS_ERR_NONE) while(1);
+        OSTimeDly(2100);    // the shell waits 2 s for the application to start
+    }
+    else
+    {
+        USART_ITConfig(COMM, USART_IT_RXNE, DISABLE);
+        err = OSTaskCreate(PollingShellTask, (void*)0, &ShellStk[APP_CFG_TASK_SHELL_STK_SIZE-1], APP_TASK_SHELL_PRIO);
+        if (err != OS_ERR_NONE) while(1);
+    }
+    out[0] = 0;
+    ReadTerminal(out, sizeof(out));     // drop the prompt and the answers of the last run
+    out[0] = 0;
+
+    WaitWindow();
+    rounds = workerRounds;
+    for (i = 0; i < LINES; i++)
+    {
+        HOST_CHECK(write(slaveFd, LINE, strlen(LINE)) == (ssize_t)strlen(LINE));
+        OSTimeDly(40);
+    }
+    WaitWindow();
+    rounds = workerRounds - rounds;
+
+    window = profIsr.cyclesLast;
+    for (prio = 0; prio < PROF_TASK_COUNT; prio++) window += profTasks[prio].cyclesLast;
+    printf("testPty: %-15s shell %5.1f%%, idle %5.1f%%, worker %3u rounds in %.3f s\n", what,
+        100.0 * profTasks[APP_TASK_SHELL_PRIO].cyclesLast / window,
+        100.0 * profTasks[OS_TASK_IDLE_PRIO].cyclesLast / window, (unsigned)rounds,
+        window / OS_CPU_CyclesInit());
+
+    OSTimeDly(100);
+    ReadTerminal(out, sizeof(out));
+    HOST_CHECK(Count(out, ANSWER) == LINES);
+    if (pending)
+    {
+        HOST_CHECK(profTasks[OS_TASK_IDLE_PRIO].cyclesLast > window / 4);
+        HOST_CHECK(rounds > 0);
+    }
+    else
+    {
+        HOST_CHECK(polledLines == LINES);
+        HOST_CHECK(rounds == 0);
+    }
+    err = OSTaskDel(APP_TASK_SHELL_PRIO);
+    if (err != OS_ERR_NONE) while(1);
+}
+
+static void TestTask(void *pdata)
+{
+    INT8U err;
+
+    err = OSTaskChangePrio(OS_PRIO_SELF, DRIVER_PRIO);
+    if (err != OS_ERR_NONE) while(1);
+    ProfInit();
+    err = OSTaskCreate(WorkerTask, (void*)0, &WorkerStk[APP_CFG_TASK_START_STK_SIZE-1], WORKER_PRIO);
+    if (err != OS_ERR_NONE) while(1);
+
+    Run(OS_FALSE, "polling RXNE:");
+    Run(OS_TRUE, "RX interrupt:");
+    HostTestExit("testPty");
+}
+
+int main()
+{
+    struct termios raw;
+    int fd;
+
+    // The application gets the master side, this test types on the slave
+    fd = posix_openpt(O_RDWR | O_NOCTTY);
+    if (fd < 0 || grantpt(fd) != 0 || unlockpt(fd) != 0) exit(1);
+    slaveFd = open(ptsname(fd), O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if (slaveFd < 0) exit(1);
+    tcgetattr(slaveFd, &raw);
+    cfmakeraw(&raw);
+    tcsetattr(slaveFd, TCSANOW, &raw);
+
+    hostTestUartFd = fd;
+    HostTestRun(0, OS_FALSE, TestTask);
+    return 0;
+}
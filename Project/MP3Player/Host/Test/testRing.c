@@ -0,0 +1,224 @@
+/*
+    testRing.c
+    Stress test and throughput of the lock-free ring (Util/ring.c) with a
+    producer and a consumer on two host threads, which the host preempts
+    anywhere and runs in parallel when it has the CPUs: one byte at a time,
+    records of 1 to 64 bytes of random length, and 64 byte blocks. Then a
+    consumer task waiting in RingPend() for records an ISR puts, as the UART
+    does. The consumer checks every byte it takes against the sequence put.
+
+    The threads block the port's signals, so the tick and the interrupts
+    stay on the kernel's thread. Prints MB/s of each way and the times
+    RingPend() had to wait.
+
+    2026/10 written for the MP3Player project
+*/
+
+#include <pthread.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "hostTest.h"
+#include "ring.h"
+
+#define TEST_IRQ        89      // a host line no model uses
+#define RING_SIZE       1024
+#define RECORD_MAX      64
+#define THREAD_BYTES    (8u << 20)
+#define PEND_BYTES      (1u << 20)
+#define ISR_NS          20000   // the producer ISR comes back after this
+#define PEND_TICKS      1000    // far longer than any wait on the host
+
+typedef enum { RING_BYTES, RING_RECORDS, RING_BLOCKS } RingMode;
+
+static Ring ring;
+static INT8U ringBuf[RING_SIZE];
+static volatile INT32U badBytes;
+static volatile BOOLEAN consumed;
+static uint64_t consumeNs;
+static unsigned isrSeed;
+static INT32U isrPut;
+static INT16U isrLength;
+
+static INT8U Expected(INT32U i)
+{
+    return (INT8U)(i ^ (i >> 8) ^ (i >> 16));
+}
+
+// Length of the record at n of total; producer and consumer draw the same
+// lengths from their own copy of the seed
+static INT16U NextLength(RingMode mode, unsigned *pSeed, INT32U n, INT32U total)
+{
+    INT32U length;
+
+    if (mode == RING_BYTES) length = 1;
+    else if (mode == RING_BLOCKS) length = RECORD_MAX;
+    else length = 1 + rand_r(pSeed) % RECORD_MAX;
+    if (length > total - n) length = total - n;
+    return (INT16U)length;
+}
+
+static void Fill(INT8U *pRecord, INT32U n, INT16U length)
+{
+    INT16U i;
+
+    for (i = 0; i < length; i++) pRecord[i] = Expected(n + i);
+}
+
+static void Check(const INT8U *pRecord, INT32U n, INT16U length)
+{
+    INT16U i;
+
+    for (i = 0; i < length; i++)
+        if (pRecord[i] != Expected(n + i)) badBytes++;
+}
+
+static void *ProducerThread(void *pArg)
+{
+    RingMode mode = (RingMode)(intptr_t)pArg;
+    INT8U record[RECORD_MAX];
+    unsigned seed = 1;
+    INT16U length;
+    INT32U n;
+
+    for (n = 0; n < THREAD_BYTES; n += length)
+    {
+        length = NextLength(mode, &seed, n, THREAD_BYTES);
+        Fill(record, n, length);
+        if (mode == RING_BYTES) while (!RingPutByte(&ring, record[0])) sched_yield();
+        else while (!RingPut(&ring, record, length)) sched_yield();
+    }
+    return 0;
+}
+
+static void *ConsumerThread(void *pArg)
+{
+    RingMode mode = (RingMode)(intptr_t)pArg;
+    INT8U record[RECORD_MAX];
+    unsigned seed = 1;
+    uint64_t start;
+    INT16U length;
+    INT32U n;
+
+    start = SimNow();
+    for (n = 0; n < THREAD_BYTES; n += length)
+    {
+        length = NextLength(mode, &seed, n, THREAD_BYTES);
+        if (mode == RING_BYTES) while (!RingGetByte(&ring, record)) sched_yield();
+        else while (!RingGet(&ring, record, length)) sched_yield();
+        Check(record, n, length);
+    }
+    consumeNs = SimNow() - start;
+    consumed = OS_TRUE;
+    return 0;
+}
+
+// Starts a thread with the port's signals blocked
+static pthread_t StartThread(void *(*pEntry)(void *), RingMode mode)
+{
+    sigset_t block;
+    sigset_t old;
+    pthread_t thread;
+
+    sigemptyset(&block);
+    sigaddset(&block, SIGALRM);
+    sigaddset(&block, SIGUSR1);
+    sigaddset(&block, SIGIO);
+    pthread_sigmask(SIG_BLOCK, &block, &old);
+    if (pthread_create(&thread, 0, pEntry, (void *)(intptr_t)mode) != 0) while(1);
+    pthread_sigmask(SIG_SETMASK, &old, 0);
+    return thread;
+}
+
+static void Threads(RingMode mode, const char *what)
+{
+    pthread_t producer;
+    pthread_t consumer;
+
+    RingInit(&ring, ringBuf, RING_SIZE, OS_FALSE);
+    badBytes = 0;
+    consumed = OS_FALSE;
+    consumer = StartThread(ConsumerThread, mode);
+    producer = StartThread(ProducerThread, mode);
+    while (!consumed) OSTimeDly(1);     // the threads get the CPU while the kernel sleeps
+    pthread_join(producer, 0);
+    pthread_join(consumer, 0);
+
+    printf("testRing: %-30s %6.1f MB/s\n", what, THREAD_BYTES / 1e6 / (consumeNs / 1e9));
+    HOST_CHECK(badBytes == 0);
+    HOST_CHECK(RingCount(&ring) == 0);
+}
+
+// Puts the records that fit and comes back until all are put
+static void ProducerIsr(void)
+{
+    OS_CPU_SR cpu_sr;
+    INT8U record[RECORD_MAX];
+
+    OS_ENTER_CRITICAL();
+    OSIntNesting++;
+    OS_EXIT_CRITICAL();
+    while (isrPut < PEND_BYTES)
+    {
+        if (isrLength == 0) isrLength = NextLength(RING_RECORDS, &isrSeed, isrPut, PEND_BYTES);
+        Fill(record, isrPut, isrLength);
+        if (!RingPut(&ring, record, isrLength)) break;
+        isrPut += isrLength;
+        isrLength = 0;
+    }
+    if (isrPut < PEND_BYTES) OS_CPU_IntTimer(TEST_IRQ, ISR_NS);
+    OSIntExit();
+}
+
+static void Pend(void)
+{
+    INT8U record[RECORD_MAX];
+    unsigned seed = 1;
+    INT32U waits = 0;
+    uint64_t start;
+    INT16U length;
+    INT32U n;
+
+    RingInit(&ring, ringBuf, RING_SIZE, OS_TRUE);
+    badBytes = 0;
+    isrSeed = 1;
+    isrPut = 0;
+    isrLength = 0;
+    OS_CPU_IntSet(TEST_IRQ, ProducerIsr);
+    OS_CPU_IntEn(TEST_IRQ, OS_TRUE);
+
+    start = SimNow();
+    OS_CPU_IntPend(TEST_IRQ);
+    for (n = 0; n < PEND_BYTES; n += length)
+    {
+        length = NextLength(RING_RECORDS, &seed, n, PEND_BYTES);
+        if (RingCount(&ring) < length) waits++;
+        if (!RingPend(&ring, length, PEND_TICKS)) break;
+        HOST_CHECK(RingGet(&ring, record, length));
+        Check(record, n, length);
+    }
+    printf("testRing: %-30s %6.1f MB/s, %u waits\n", "ISR to RingPend(), records:",
+        PEND_BYTES / 1e6 / (HostTestMs(start) / 1e3), (unsigned)waits);
+    HOST_CHECK(n == PEND_BYTES);
+    HOST_CHECK(badBytes == 0);
+    HOST_CHECK(waits > 0);
+    HOST_CHECK(!RingPend(&ring, 1, 5));     // times out on an empty ring
+    OS_CPU_IntEn(TEST_IRQ, OS_FALSE);
+}
+
+static void TestTask(void *pdata)
+{
+    Threads(RING_BYTES, "threads, a byte at a time:");
+    Threads(RING_RECORDS, "threads, 1 to 64 byte records:");
+    Threads(RING_BLOCKS, "threads, 64 byte blocks:");
+    Pend();
+    HostTestExit("testRing");
+}
+
+int main()
+{
+    HostTestRun(0, OS_FALSE, TestTask);
+    return 0;
+}
@@ -0,0 +1,82 @@
+/*
+    testSdRead.c
+    Reads TRAIN.MP3 from the SD card model a sector at a time, which takes
+    a CMD17 per block, and in 2 KB reads, which stream the contiguous blocks
+    with CMD18. Checks the data against MP3data/train_crossing.mp3 and
+    prints the commands and time each way took.
+
+    2026/10 written for the MP3Player project
+*/
+
+#include <stdio.h>
+#include <string.h>
+
+#include "hostTest.h"
+#include "SD.h"
+
+#define SONG       "TRAIN.MP3"
+#define SONG_HOST  "../MP3data/train_crossing.mp3"
+#define SONG_SIZE  39376
+
+static INT8U expected[SONG_SIZE];
+static INT8U data[SONG_SIZE];
+static INT8U chunk[2048];
+
+// Reads the whole song in reads of the given size, returns the time in ms
+static double ReadSong(uint16_t size)
+{
+    File file;
+    uint64_t start;
+    INT32U total = 0;
+    int count;
+
+    memset(data, 0, sizeof(data));
+    memset(SimSd.cmd, 0, sizeof(SimSd.cmd));
+    SimSd.blocksRead = 0;
+    start = SimNow();
+    file = SD.open(SONG, O_READ);
+    HOST_CHECK(file);
+    while ((count = file.read(chunk, size)) > 0)
+    {
+        if (total + count <= SONG_SIZE) memcpy(&data[total], chunk, count);
+        total += count;
+    }
+    file.close();
+    HOST_CHECK(total == SONG_SIZE);
+    HOST_CHECK(memcmp(data, expected, SONG_SIZE) == 0);
+    return HostTestMs(start);
+}
+
+static void TestTask(void *pdata)
+{
+    FILE *f = fopen(SONG_HOST, "rb");
+    double ms;
+    INT32U singleCommands;
+
+    HOST_CHECK(f != 0 && fread(expected, 1, SONG_SIZE, f) == SONG_SIZE);
+    if (f) fclose(f);
+    HostTestOpenSd();
+
+    ms = ReadSong(512);
+    singleCommands = SimSd.cmd[17] + SimSd.cmd[18];
+    HOST_CHECK(SimSd.cmd[18] == 0);
+    printf("testSdRead: 512 byte reads:  %3u CMD17, %2u CMD18, %2u CMD12, %u blocks sent, %.2f ms\n",
+        (unsigned)SimSd.cmd[17], (unsigned)SimSd.cmd[18], (unsigned)SimSd.cmd[12],
+        (unsigned)SimSd.blocksRead, ms);
+
+    ms = ReadSong(sizeof(chunk));
+    HOST_CHECK(SimSd.cmd[18] > 0);
+    HOST_CHECK(SimSd.cmd[12] == SimSd.cmd[18]);
+    HOST_CHECK(SimSd.cmd[17] + SimSd.cmd[18] < singleCommands / 3);
+    printf("testSdRead: 2048 byte reads: %3u CMD17, %2u CMD18, %2u CMD12, %u blocks sent, %.2f ms\n",
+        (unsigned)SimSd.cmd[17], (unsigned)SimSd.cmd[18], (unsigned)SimSd.cmd[12],
+        (unsigned)SimSd.blocksRead, ms);
+
+    HostTestExit("testSdRead");
+}
+
+int main()
+{
+    HostTestRun(HOST_TEST_IMAGE, OS_FALSE, TestTask);
+    return 0;
+}
@@ -0,0 +1,70 @@
+/*
+    testSmoke.c
+    Runs the whole application on the device models: it must start up over
+    the UART, draw on the LCD, stream the MP3 to the decoder and answer the
+    touch panel, with a dot and the touch position in the status line, and
+    its shell must answer a command.
+
+    2026/10 written for the MP3Player project
+*/
+
+#include <stdio.h>
+
+#include "hostTest.h"
+#include <Adafruit_ILI9341.h>
+
+static void TestTask(void *pdata)
+{
+    uint32_t pixels;
+
+    HOST_CHECK(HostTestWaitOutput("StartupTask: deleting self", 2000));
+    HOST_CHECK(HostTestWaitOutput("Initializing FT6206", 5000));
+    HOST_CHECK(SimLcd.ramwr > 0);
+    HOST_CHECK(SimLcdFrame[SIM_LCD_HEIGHT / 2][SIM_LCD_WIDTH / 2] == ILI9341_BLACK);
+
+    // "Hello World!" in white at (40, 60), size 2
+    pixels = 0;
+    for (int y = 60; y < 76; y++)
+        for (int x = 40; x < 40 + 12 * 12; x++)
+            if (SimLcdFrame[y][x] == ILI9341_WHITE) pixels++;
+    HOST_CHECK(pixels > 100);
+
+    // A touch draws a red dot where the mapping puts it
+    OSTimeDly(200);
+    SimTouchPress(100, 100);
+    OSTimeDly(100);
+    SimTouchRelease();
+    OSTimeDly(50);
+    HOST_CHECK(SimTouch.reads > 0);
+    HOST_CHECK(SimLcdFrame[SIM_LCD_HEIGHT - 100][SIM_LCD_WIDTH - 100] == ILI9341_RED);
+
+    // and shows its position in the status line at the bottom
+    pixels = 0;
+    for (int y = SIM_LCD_HEIGHT - 12; y < SIM_LCD_HEIGHT - 4; y++)
+        for (int x = 4; x < 4 + 11 * 6; x++)
+            if (SimLcdFrame[y][x] == ILI9341_WHITE) pixels++;
+    HOST_CHECK(pixels > 50);
+
+    // The demo streams the song after 2.5 s
+    HOST_CHECK(HostTestWaitOutput("Done streaming sound file  count=1", 8000));
+    HOST_CHECK(SimMp3.sdiBytes > 30000);
+    HOST_CHECK(SimMp3.bitrate == 64000);
+    HOST_CHECK(SimMp3.overflows == 0);
+    HOST_CHECK(SimBus.csConflicts == 0);
+    printf("testSmoke: %u SDI bytes, %u underruns, %u SPI bytes, %u by DMA\n",
+        (unsigned)SimMp3.sdiBytes, (unsigned)SimMp3.underruns,
+        (unsigned)SimSpi.bytes, (unsigned)SimSpi.dmaBytes);
+
+    // The shell prompts once the other tasks had time to start
+    HOST_CHECK(HostTestWaitOutput("Shell>", 2000));
+    SimUartInject("prof\r", 5);
+    HOST_CHECK(HostTestWaitOutput("prio   cpu%", 1000));
+
+    HostTestExit("testSmoke");
+}
+
+int main()
+{
+    HostTestRun(HOST_TEST_IMAGE, OS_TRUE, TestTask);
+    return 0;
+}
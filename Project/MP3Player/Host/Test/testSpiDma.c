@@ -0,0 +1,162 @@
+/*
+    testSpiDma.c
+    Checks the DMA path of the SPI driver on the SPI1/DMA2 model: blocking
+    and async transfers move every byte, an async Write() returns at once and
+    posts its semaphore on completion, the chip select held until then sees
+    no change under the DMA, and the bus lock is only handed to the next task
+    once the transfer has finished. Then times polled and DMA
+    transfers and how much CPU a lower priority task gets meanwhile.
+
+    2026/10 written for the MP3Player project
+*/
+
+#include <stdio.h>
+#include <string.h>
+
+#include "hostTest.h"
+
+#define LENGTH      4096
+#define WAITER_PRIO (HOST_TEST_PRIO - 1)
+#define SPINNER_PRIO (HOST_TEST_PRIO + 1)
+
+static OS_STK WaiterStk[APP_CFG_TASK_START_STK_SIZE];
+static OS_STK SpinnerStk[APP_CFG_TASK_START_STK_SIZE];
+static HANDLE hSpi;
+static HANDLE hSpi2;
+static INT8U txBuf[LENGTH];
+static INT8U recorded[LENGTH];
+static INT32U recordedCount;
+static volatile INT32U spins;
+static BOOLEAN waiterBusBusy;
+static BOOLEAN waiterLocked;
+
+static void Record(char device, uint8_t out, uint8_t in)
+{
+    if (recordedCount < LENGTH) recorded[recordedCount] = out;
+    recordedCount++;
+}
+
+// Waits for the bus lock while the test task holds it with a transfer in flight
+static void WaiterTask(void *pdata)
+{
+    if (Ioctl(hSpi2, PJDF_CTRL_SPI_WAIT_FOR_LOCK, 0, 0) != PJDF_ERR_NONE) while(1);
+    waiterBusBusy = (BOOLEAN)(SimSpiBusy() || SimSpiDmaActive());
+    waiterLocked = OS_TRUE;
+    if (Ioctl(hSpi2, PJDF_CTRL_SPI_RELEASE_LOCK, 0, 0) != PJDF_ERR_NONE) while(1);
+    OSTaskDel(OS_PRIO_SELF);
+}
+
+// Counts the CPU the SPI transfers leave to lower priority tasks
+static void SpinnerTask(void *pdata)
+{
+    while (1)
+    {
+        spins++;
+        OSTimeGet(); // lets a pending switch happen, see the port's OSIntCtxSw()
+    }
+}
+
+// Sends LENGTH bytes with the test pattern, returns the time Write() took in ms
+static double Send(INT32U length)
+{
+    uint64_t start;
+
+    recordedCount = 0;
+    start = SimNow();
+    if (Write(hSpi, txBuf, &length) != PJDF_ERR_NONE) while(1);
+    return HostTestMs(start);
+}
+
+static void TestTask(void *pdata)
+{
+    OS_EVENT *doneSem = OSSemCreate(0);
+    OS_EVENT *noSem = NULL;
+    INT32U size = sizeof(OS_EVENT*);
+    INT16U rate = SD_SPI_DATARATE;
+    INT32U rateSize = sizeof(rate);
+    INT32U dmaBefore;
+    INT32U spinsBefore;
+    double blockingMs;
+    double asyncMs;
+    double pollMs;
+    double totalMs;
+    uint64_t start;
+    INT8U err;
+    INT32U i;
+    INT32U length;
+
+    for (i = 0; i < LENGTH; i++) txBuf[i] = (INT8U)(i * 7 + i / 256);
+    hSpi = Open(PJDF_DEVICE_ID_SPI1, 0);
+    hSpi2 = Open(PJDF_DEVICE_ID_SPI1, 0);
+    HOST_CHECK(PJDF_IS_VALID_HANDLE(hSpi) && PJDF_IS_VALID_HANDLE(hSpi2));
+    SimSpiRecorder = Record;
+    if (OSTaskCreate(SpinnerTask, 0, &SpinnerStk[APP_CFG_TASK_START_STK_SIZE-1], SPINNER_PRIO) != OS_ERR_NONE) while(1);
+
+    if (Ioctl(hSpi, PJDF_CTRL_SPI_WAIT_FOR_LOCK, 0, 0) != PJDF_ERR_NONE) while(1);
+    Ioctl(hSpi, PJDF_CTRL_SPI_SET_DATARATE, &rate, &rateSize);
+
+    // Blocking DMA: all the bytes, in order, and the CPU free meanwhile
+    dmaBefore = SimSpi.dmaTransfers;
+    spinsBefore = spins;
+    blockingMs = Send(LENGTH);
+    HOST_CHECK(SimSpi.dmaTransfers == dmaBefore + 1);
+    HOST_CHECK(recordedCount == LENGTH && memcmp(recorded, txBuf, LENGTH) == 0);
+    HOST_CHECK(spins > spinsBefore);
+    printf("testSpiDma: blocking DMA write of %u bytes took %.2f ms, lower priority task ran %u loops\n",
+        LENGTH, blockingMs, (unsigned)(spins - spinsBefore));
+
+    // Polled: the same bytes, with the CPU busy throughout
+    spinsBefore = spins;
+    totalMs = 0;
+    for (i = 0; i < LENGTH; i += SPI_DMA_MIN_LENGTH - 1)
+    {
+        length = (LENGTH - i < SPI_DMA_MIN_LENGTH - 1) ? LENGTH - i : SPI_DMA_MIN_LENGTH - 1;
+        start = SimNow();
+        if (Write(hSpi, &txBuf[i], &length) != PJDF_ERR_NONE) while(1);
+        totalMs += HostTestMs(start);
+    }
+    pollMs = totalMs;
+    printf("testSpiDma: polled writes of %u bytes took %.2f ms, lower priority task ran %u loops\n",
+        LENGTH, pollMs, (unsigned)(spins - spinsBefore));
+
+    // Async: Write() returns at once, the semaphore is posted when the last
+    // byte is out, and only then is the chip select deasserted
+    Ioctl(hSpi, PJDF_CTRL_SPI_SET_ASYNC, &doneSem, &size);
+    dmaBefore = SimSpi.dmaTransfers;
+    SD_ADAFRUIT_CS_ASSERT();
+    asyncMs = Send(LENGTH);
+    HOST_CHECK(SimSpiDmaActive());
+    HOST_CHECK(OSSemAccept(doneSem) == 0);
+    HOST_CHECK(asyncMs < blockingMs / 4);
+    OSSemPend(doneSem, 100, &err);
+    HOST_CHECK(err == OS_ERR_NONE);
+    HOST_CHECK(!SimSpiDmaActive());
+    SD_ADAFRUIT_CS_DEASSERT();
+    HOST_CHECK(OSSemAccept(doneSem) == 0);
+    HOST_CHECK(SimSpi.dmaTransfers == dmaBefore + 1);
+    HOST_CHECK(recordedCount == LENGTH && memcmp(recorded, txBuf, LENGTH) == 0);
+    HOST_CHECK(SimSpi.dmaCsChanges == 0);
+    printf("testSpiDma: async DMA write of %u bytes returned after %.3f ms\n", LENGTH, asyncMs);
+
+    // A task waiting for the lock only gets it once a transfer is done, even
+    // when it is released with one in flight
+    Send(LENGTH);
+    HOST_CHECK(SimSpiDmaActive());
+    if (OSTaskCreate(WaiterTask, 0, &WaiterStk[APP_CFG_TASK_START_STK_SIZE-1], WAITER_PRIO) != OS_ERR_NONE) while(1);
+    HOST_CHECK(!waiterLocked);
+    if (Ioctl(hSpi, PJDF_CTRL_SPI_RELEASE_LOCK, 0, 0) != PJDF_ERR_NONE) while(1);
+    HOST_CHECK(waiterLocked);
+    HOST_CHECK(!waiterBusBusy);
+    OSSemPend(doneSem, 100, &err);
+    HOST_CHECK(err == OS_ERR_NONE);
+    HOST_CHECK(SimSpi.dmaTransfers == dmaBefore + 2);
+    Ioctl(hSpi, PJDF_CTRL_SPI_SET_ASYNC, &noSem, &size);
+
+    HostTestExit("testSpiDma");
+}
+
+int main()
+{
+    HostTestRun(0, OS_FALSE, TestTask);
+    return 0;
+}
@@ -0,0 +1,53 @@
+/*
+    testStream.c
+    Streams TRAIN.MP3 from the SD card model to the VS1053 model through
+    Mp3StreamSDFile()'s reader and feeder tasks, and reports the underruns
+    of both and the sustained rate.
+
+    2026/10 written for the MP3Player project
+*/
+
+#include <stdio.h>
+
+#include "hostTest.h"
+#include "mp3Util.h"
+
+#define SONG       "TRAIN.MP3"
+#define SONG_SIZE  39376u
+
+static void TestTask(void *pdata)
+{
+    HANDLE hMp3;
+    uint64_t start;
+    double ms;
+    INT32U feederUnderruns = 0;
+
+    HostTestOpenSd();
+    hMp3 = HostTestOpenMp3(OS_TRUE);
+
+    SimMp3 = SimMp3Stats();
+    start = SimNow();
+    Mp3StreamSDFile(hMp3, SONG);
+    ms = HostTestMs(start);
+
+    HOST_CHECK(HostTestWaitOutput("decoder underruns=", 100));
+    HOST_CHECK(HostTestOutputValue("decoder underruns=", &feederUnderruns));
+    HOST_CHECK(SimMp3.sdiBytes == SONG_SIZE);
+    HOST_CHECK(SimMp3.overflows == 0);
+    // The decoder may only run dry once, after the last byte
+    HOST_CHECK(SimMp3.underruns <= 1);
+    HOST_CHECK(SimBus.csConflicts == 0);
+
+    printf("testStream: %u bytes in %.0f ms, %.0f bytes/s sustained (%u bit/s stream)\n",
+        (unsigned)SimMp3.sdiBytes, ms, SimMp3.sdiBytes * 1000.0 / ms, (unsigned)SimMp3.bitrate);
+    printf("testStream: feeder underruns %u, decoder underruns %u, decoder starved %.1f ms\n",
+        (unsigned)feederUnderruns, (unsigned)SimMp3.underruns, SimMp3.starvedNs / 1e6);
+
+    HostTestExit("testStream");
+}
+
+int main()
+{
+    HostTestRun(HOST_TEST_IMAGE, OS_FALSE, TestTask);
+    return 0;
+}
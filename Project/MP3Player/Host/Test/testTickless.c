@@ -0,0 +1,133 @@
+/*
+    testTickless.c
+    Checks the tickless idle of the POSIX port (OS_TICKLESS_EN): delays
+    last their number of ticks, OSTime keeps up with the clock while the
+    tick is stopped, an interrupt in the middle of a long sleep wakes the
+    task it readies at the right tick count, and the idle task wakes only
+    when a delay expires. Prints the delay errors, the clock drift and the
+    wakeups per second.
+
+    2026/10 written for the MP3Player project
+*/
+
+#include <stdio.h>
+
+#include "hostTest.h"
+
+#define TEST_IRQ        89      // a host line no model uses
+#define TICKER_PRIO     (HOST_TEST_PRIO - 1)
+#define TICKER_TICKS    100
+#define IDLE_MS         2000
+#define LATE_TICKS      100     // a 1 ms nanosleep() has been seen to wake 44 ms late on a one-CPU host
+
+static OS_STK TickerStk[APP_CFG_TASK_START_STK_SIZE];
+static OS_EVENT *wakeSem;
+
+static void TestIsr(void)
+{
+    OS_CPU_SR cpu_sr;
+
+    OS_ENTER_CRITICAL();
+    OSIntNesting++;
+    OS_EXIT_CRITICAL();
+    OSSemPost(wakeSem);
+    OSIntExit();
+}
+
+// Wakes ten times a second
+static void TickerTask(void *pdata)
+{
+    while (1) OSTimeDly(TICKER_TICKS);
+}
+
+static void Delays(void)
+{
+    static const INT32U ticks[] = { 1, 7, 100, 1500 };
+    INT32U start;
+    uint64_t startNs;
+    double ms;
+    unsigned i;
+
+    for (i = 0; i < sizeof(ticks) / sizeof(ticks[0]); i++)
+    {
+        OSTimeDly(1);           // start on a tick
+        start = OSTimeGet();
+        startNs = SimNow();
+        OSTimeDly(ticks[i]);
+        ms = HostTestMs(startNs);
+        HOST_CHECK(OSTimeGet() - start - ticks[i] <= LATE_TICKS);
+        HOST_CHECK(ms > ticks[i] - 1 && ms < ticks[i] + LATE_TICKS);
+        HOST_CHECK(OSTimeGet() - start > ms - 1 && OSTimeGet() - start < ms + 1);
+        printf("testTickless: OSTimeDly(%4u) took %7.2f ms\n", (unsigned)ticks[i], ms);
+    }
+}
+
+// An interrupt 250.5 ms into a 1000 tick pend
+static void EarlyWake(void)
+{
+    INT32U start;
+    INT32U elapsed;
+    INT8U err;
+
+    wakeSem = OSSemCreate(0);
+    if (wakeSem == 0) while(1);
+    OS_CPU_IntSet(TEST_IRQ, TestIsr);
+    OS_CPU_IntEn(TEST_IRQ, OS_TRUE);
+
+    OSTimeDly(1);
+    start = OSTimeGet();
+    OS_CPU_IntTimer(TEST_IRQ, 250500000u);
+    OSSemPend(wakeSem, 1000, &err);
+    elapsed = OSTimeGet() - start;
+    HOST_CHECK(err == OS_ERR_NONE);
+    HOST_CHECK(elapsed >= 250 && elapsed <= 250 + LATE_TICKS);
+    printf("testTickless: interrupt after 250.5 ms woke the pend at tick %u\n", (unsigned)elapsed);
+
+    // The tick runs on from there
+    start = OSTimeGet();
+    OSTimeDly(100);
+    HOST_CHECK(OSTimeGet() - start - 100 <= LATE_TICKS);
+}
+
+static void Idle(void)
+{
+    INT32U wakes;
+    INT32U start;
+    uint64_t startNs;
+    double ms;
+    double drift;
+    INT8U err;
+
+    err = OSTaskCreate(TickerTask, (void*)0, &TickerStk[APP_CFG_TASK_START_STK_SIZE-1], TICKER_PRIO);
+    if (err != OS_ERR_NONE) while(1);
+
+    OSTimeDly(1);
+    wakes = OS_CPU_IdleWakeCtr;
+    start = OSTimeGet();
+    startNs = SimNow();
+    OSTimeDly(IDLE_MS);
+    ms = HostTestMs(startNs);
+    wakes = OS_CPU_IdleWakeCtr - wakes;
+    drift = (OSTimeGet() - start) - ms;
+
+    // The ticker and this task's own wakeup, and little else
+    HOST_CHECK(wakes <= 2 * (IDLE_MS / TICKER_TICKS) + 4);
+    HOST_CHECK(drift > -2 && drift < 2);
+    printf("testTickless: %u idle wakeups in %.0f ms (%.1f per second) with a task waking every %u ticks, "
+        "OSTime off the clock by %.2f ticks\n",
+        (unsigned)wakes, ms, wakes * 1000 / ms, TICKER_TICKS, drift);
+}
+
+static void TestTask(void *pdata)
+{
+    Delays();
+    EarlyWake();
+    Idle();
+    HostTestExit("testTickless");
+}
+
+int main()
+{
+    HostTestRun(0, OS_FALSE, TestTask);
+    return 0;
+}
@@ -0,0 +1,150 @@
+/*
+    testTouch.c
+    Touches the FT6206 model and compares the two ways the application has
+    had of noticing: polling touched() every 5 ticks with the interrupts
+    disabled around the I2C read, as LcdTouchDemoTask and
+    Adafruit_FT6206::readRegister8() used to, and the touch task woken by
+    the INT line (touchUtil.c). Reports the time from touch to detection
+    and the I2C bus time spent with the interrupts disabled, and checks
+    that the events carry the position and type and that an idle panel is
+    not read.
+
+    2026/10 written for the MP3Player project
+*/
+
+#include <stdio.h>
+
+#include "hostTest.h"
+#include "touchUtil.h"
+#include <Adafruit_FT6206.h>
+
+#define POLLER_PRIO  (HOST_TEST_PRIO - 1)
+#define POLL_TICKS   5
+#define TOUCHES      20
+#define TOUCH_X      120
+#define TOUCH_Y      200
+
+static OS_STK PollerStk[APP_CFG_TASK_START_STK_SIZE];
+static Adafruit_FT6206 touch;
+static volatile uint64_t pressedAt;     // 0 while the panel is not touched
+static volatile uint64_t detectedAt;    // 0 until the poller sees the touch
+static volatile BOOLEAN polling;
+
+// The old touch loop: reads the controller every POLL_TICKS with the
+// interrupts disabled for the whole I2C transfer
+static void PollerTask(void *pdata)
+{
+    OS_CPU_SR cpu_sr;
+    boolean touched;
+
+    while (polling)
+    {
+        OS_ENTER_CRITICAL();
+        touched = touch.touched();
+        OS_EXIT_CRITICAL();
+        if (touched && pressedAt != 0 && detectedAt == 0) detectedAt = SimNow();
+        OSTimeDly(POLL_TICKS);
+    }
+    OSTaskDel(OS_PRIO_SELF);
+}
+
+static void Report(const char *what, uint64_t totalNs, uint64_t maxNs, uint64_t elapsedNs)
+{
+    printf("testTouch: %-21s touch to detection avg %6.0f us max %6.0f us; "
+        "interrupts disabled for %5u I2C transfers, longest %6.0f us, %4.1f%% of the time\n",
+        what, totalNs / 1e3 / TOUCHES, maxNs / 1e3, (unsigned)SimTouch.blockedTransfers,
+        SimTouch.blockedMaxNs / 1e3, 100.0 * SimTouch.blockedNs / elapsedNs);
+}
+
+static void Poll(void)
+{
+    uint64_t totalNs = 0;
+    uint64_t maxNs = 0;
+    uint64_t start;
+    INT8U err;
+    int i;
+
+    SimTouch = SimTouchStats();
+    start = SimNow();
+    polling = OS_TRUE;
+    err = OSTaskCreate(PollerTask, (void*)0, &PollerStk[APP_CFG_TASK_START_STK_SIZE-1], POLLER_PRIO);
+    if (err != OS_ERR_NONE) while(1);
+
+    for (i = 0; i < TOUCHES; i++)
+    {
+        OSTimeDly(7 + i % POLL_TICKS);      // touch at every phase of the poll
+        detectedAt = 0;
+        pressedAt = SimNow();
+        SimTouchPress(TOUCH_X, TOUCH_Y);
+        while (detectedAt == 0) OSTimeDly(1);
+        totalNs += detectedAt - pressedAt;
+        if (detectedAt - pressedAt > maxNs) maxNs = detectedAt - pressedAt;
+        SimTouchRelease();
+        pressedAt = 0;
+    }
+    polling = OS_FALSE;
+    OSTimeDly(2 * POLL_TICKS);
+
+    HOST_CHECK(SimTouch.blockedTransfers > 0);
+    Report("polled with ints off:", totalNs, maxNs, SimNow() - start);
+}
+
+static void Events(void)
+{
+    TouchEvent event;
+    uint64_t totalNs = 0;
+    uint64_t maxNs = 0;
+    uint64_t latency;
+    uint64_t start;
+    INT32U reads;
+    int i;
+
+    TouchEventsStart(&touch);
+    SimTouch = SimTouchStats();
+    start = SimNow();
+
+    for (i = 0; i < TOUCHES; i++)
+    {
+        OSTimeDly(7 + i % POLL_TICKS);
+        pressedAt = SimNow();
+        SimTouchPress(TOUCH_X + i, TOUCH_Y);
+        HOST_CHECK(TouchEventPend(&event, 100));
+        latency = SimNow() - pressedAt;
+        totalNs += latency;
+        if (latency > maxNs) maxNs = latency;
+        HOST_CHECK(event.type == TOUCH_EVENT_DOWN);
+        HOST_CHECK(event.x == TOUCH_X + i && event.y == TOUCH_Y);
+
+        SimTouchRelease();
+        HOST_CHECK(TouchEventPend(&event, 100));
+        HOST_CHECK(event.type == TOUCH_EVENT_UP);
+    }
+    HOST_CHECK(SimTouch.blockedTransfers == 0);
+    HOST_CHECK(touchEventsDropped == 0);
+    Report("INT line and events:", totalNs, maxNs, SimNow() - start);
+
+    // No touch, no I2C traffic
+    reads = SimTouch.reads;
+    OSTimeDly(500);
+    HOST_CHECK(SimTouch.reads == reads);
+}
+
+static void TestTask(void *pdata)
+{
+    HANDLE hI2C1;
+
+    hI2C1 = Open(PJDF_DEVICE_ID_I2C1, 0);
+    if (!PJDF_IS_VALID_HANDLE(hI2C1)) while(1);
+    touch.setPjdfHandle(hI2C1);
+    HOST_CHECK(touch.begin(40));
+
+    Poll();
+    Events();
+    HostTestExit("testTouch");
+}
+
+int main()
+{
+    HostTestRun(0, OS_FALSE, TestTask);
+    return 0;
+}
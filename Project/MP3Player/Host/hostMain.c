@@ -0,0 +1,115 @@
+/*
+    hostMain.c
+    Entry point of the host build: starts the device models and runs the
+    application's main() (App/main.c, built as AppMain()) on the POSIX port.
+
+    Usage: mp3player [--sd image] [--pty] [--quiet]
+        --sd image  FAT image file to use as the SD card (see mkimg.py)
+        --pty       connect USART2 to a new pseudo terminal instead of the
+                    terminal, and print its name; attach with e.g.
+                    "screen /dev/pts/N"
+        --quiet     drop the USART2 output
+
+    Without --pty the console is USART2: output goes to stdout and keys typed
+    are received one at a time (the terminal is put in raw mode, with Ctrl-C
+    still ending the program).
+
+    2026/10 written for the MP3Player project
+*/
+
+// The register names of the target (CR1, ...) are macros in termios.h,
+// so the target headers come first
+#include "bsp.h"
+#include "sim.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+
+void AppMain(void);
+
+static struct termios savedTermios;
+static BOOLEAN termiosSaved;
+
+
+static void RestoreTerminal(void)
+{
+    if (termiosSaved) tcsetattr(STDIN_FILENO, TCSANOW, &savedTermios);
+}
+
+// Passes keys through one at a time, keeping Ctrl-C and the output newline
+// translation of the terminal
+static void RawTerminal(int fd)
+{
+    struct termios raw;
+
+    if (tcgetattr(fd, &raw) != 0) return;
+    if (fd == STDIN_FILENO)
+    {
+        savedTermios = raw;
+        termiosSaved = OS_TRUE;
+        atexit(RestoreTerminal);
+    }
+    raw.c_iflag &= ~(IGNBRK | BRKINT | PARMRK | ISTRIP | INLCR | IGNCR | ICRNL | IXON);
+    raw.c_lflag &= ~(ECHO | ECHONL | ICANON | IEXTEN);
+    raw.c_cc[VMIN] = 1;
+    raw.c_cc[VTIME] = 0;
+    tcsetattr(fd, TCSANOW, &raw);
+}
+
+static int OpenPty(void)
+{
+    int fd = posix_openpt(O_RDWR | O_NOCTTY);
+
+    if (fd < 0 || grantpt(fd) != 0 || unlockpt(fd) != 0)
+    {
+        perror("posix_openpt");
+        exit(1);
+    }
+    RawTerminal(fd);
+    fprintf(stderr, "mp3player: console on %s\n", ptsname(fd));
+    return fd;
+}
+
+static void Usage(void)
+{
+    fprintf(stderr, "usage: mp3player [--sd image] [--pty] [--quiet]\n");
+    exit(2);
+}
+
+int main(int argc, char **argv)
+{
+    const char *sdImage = 0;
+    BOOLEAN pty = OS_FALSE;
+    BOOLEAN quiet = OS_FALSE;
+    int outFd = STDOUT_FILENO;
+    int inFd = -1;
+    int i;
+
+    for (i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--sd") == 0 && i + 1 < argc) sdImage = argv[++i];
+        else if (strcmp(argv[i], "--pty") == 0) pty = OS_TRUE;
+        else if (strcmp(argv[i], "--quiet") == 0) quiet = OS_TRUE;
+        else Usage();
+    }
+
+    if (pty)
+    {
+        outFd = inFd = OpenPty();
+    }
+    else if (isatty(STDIN_FILENO))
+    {
+        inFd = STDIN_FILENO;
+        RawTerminal(inFd);
+    }
+    if (quiet) outFd = -1;
+    setvbuf(stdout, 0, _IONBF, 0);
+
+    SimInit(sdImage, outFd, inFd);
+    AppMain();
+    return 0;
+}
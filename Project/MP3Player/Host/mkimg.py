@@ -0,0 +1,248 @@
+#!/usr/bin/env python3
+"""
+    mkimg.py
+    Writes a FAT32 SD card image for the host build (Sim/simSd.c).
+
+    Usage: mkimg.py image [--songs N] [--fragment] [--truth file]
+        image       output file, a sparse 320 MB volume behind an MBR
+        --songs N   songs to put in /MUSIC, default 8
+        --fragment  interleave the clusters of all files, one at a time, with
+                    a free cluster after each, so that every cluster of every
+                    file is a run of its own
+        --truth     also write the catalog the library scan should find:
+                    one "NAME.MP3|title|artist|seconds" line per song
+
+    The root holds TRAIN.MP3 (MP3data/train_crossing.mp3). The songs in
+    /MUSIC are made of its MPEG frames, 20 to 119 each, and are tagged in the
+    four ways libraryUtil.c reads: ID3v2.3, ID3v2.4 with UTF-16 text behind a
+    large frame, ID3v1 only, and ID3v2.3 with a Xing header. The contents
+    depend only on the arguments.
+
+    2026/10 written for the MP3Player project
+"""
+
+import os
+import random
+import struct
+import sys
+
+MP3 = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'MP3data', 'train_crossing.mp3')
+
+SECTORS_PER_CLUSTER = 8
+RESERVED = 32
+PARTITION = 2048                       # first sector of the volume
+VOLUME = 320 * 1024 * 1024 // 512      # sectors
+BITRATES = [0, 32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320]
+WORDS = ('red blue night train river song little long road home cold fire rain '
+         'dream summer heart').split()
+
+
+def frames_of(data):
+    """The MPEG-1 Layer III 44.1 kHz frames after the ID3v2 tag."""
+    i = 0
+    if data[:3] == b'ID3':
+        i = 10 + ((data[6] << 21) | (data[7] << 14) | (data[8] << 7) | data[9])
+    frames = []
+    while i + 4 <= len(data):
+        h = struct.unpack('>I', data[i:i + 4])[0]
+        if (h >> 21) != 0x7FF or (h >> 12) & 15 in (0, 15) or (h >> 10) & 3 != 0:
+            break
+        length = 144 * BITRATES[(h >> 12) & 15] * 1000 // 44100 + ((h >> 9) & 1)
+        if i + length > len(data):
+            break
+        frames.append(data[i:i + length])
+        i += length
+    return frames
+
+
+def syncsafe(n):
+    return bytes([(n >> 21) & 127, (n >> 14) & 127, (n >> 7) & 127, n & 127])
+
+
+def frame23(fid, data):
+    return fid + struct.pack('>I', len(data)) + b'\0\0' + data
+
+
+def frame24(fid, data):
+    return fid + syncsafe(len(data)) + b'\0\0' + data
+
+
+def tag(version, frames, pad=0):
+    body = b''.join(frames) + b'\0' * pad
+    return b'ID3' + bytes([version, 0, 0]) + syncsafe(len(body)) + body
+
+
+def utf16(s):
+    return b'\1\xff\xfe' + s.encode('utf-16-le')
+
+
+def xing(first, count, size):
+    x = bytearray(len(first))
+    x[:4] = first[:4]
+    x[21:25] = b'Xing'
+    x[25:29] = struct.pack('>I', 3)
+    x[29:37] = struct.pack('>II', count, size)
+    return bytes(x)
+
+
+def songs(n, frames):
+    """(8.3 base name, file data, title, artist, seconds) of n songs."""
+    rand = random.Random(5)
+    names = set()
+    result = []
+    while len(result) < n:
+        base = ''.join(rand.choice('ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789')
+                       for _ in range(rand.randint(3, 8)))
+        if base in names:
+            continue
+        names.add(base)
+        k = len(result)
+        count = 20 + (k * 7) % 100
+        audio = b''.join(frames[j % len(frames)] for j in range(count))
+        title = ' '.join(rand.choice(WORDS).capitalize() for _ in range(rand.randint(1, 4)))
+        artist = 'The ' + rand.choice(WORDS).capitalize() + 's'
+        kind = k % 4
+        if kind == 0:
+            data = tag(3, [frame23(b'TIT2', b'\0' + title.encode()),
+                           frame23(b'TPE1', b'\0' + artist.encode())], 256) + audio
+        elif kind == 1:
+            data = tag(4, [frame24(b'PRIV', bytes(2000)), frame24(b'TPE1', utf16(artist)),
+                           frame24(b'TIT2', utf16(title))]) + audio
+        elif kind == 2:
+            v1 = (b'TAG' + title.encode().ljust(30, b'\0') + artist.encode().ljust(30, b'\0') +
+                  bytes(65))
+            data = audio + v1
+        else:
+            data = (tag(3, [frame23(b'TIT2', b'\3' + title.encode())]) +
+                    xing(frames[0], count, len(audio) + len(frames[0])) + audio)
+            artist = ''
+        result.append((base, data, title[:19].rstrip(), artist[:15].rstrip(),
+                       count * 1152 // 44100))
+    return result
+
+
+class Volume:
+    def __init__(self, path):
+        self.clusters = (VOLUME - RESERVED) // SECTORS_PER_CLUSTER
+        self.fat_sectors = (self.clusters * 4 + 511) // 512 + 1
+        self.data_start = RESERVED + 2 * self.fat_sectors
+        self.fat = [0x0FFFFFF8, 0x0FFFFFFF]
+        self.image = open(path, 'wb')
+        self.image.truncate((PARTITION + VOLUME) * 512)
+
+    def allocate(self, sizes, interleave):
+        """First clusters of chains for files of the given sizes."""
+        counts = [max(1, (n + SECTORS_PER_CLUSTER * 512 - 1) // (SECTORS_PER_CLUSTER * 512))
+                  for n in sizes]
+        chains = [[] for _ in sizes]
+        if interleave:
+            left = list(counts)
+            while any(left):
+                for i in range(len(left)):
+                    if left[i]:
+                        chains[i].append(len(self.fat))
+                        self.fat += [0, 0]          # the cluster and a free one
+                        left[i] -= 1
+        else:
+            for i, count in enumerate(counts):
+                for _ in range(count):
+                    chains[i].append(len(self.fat))
+                    self.fat.append(0)
+        for chain in chains:
+            for a, b in zip(chain, chain[1:]):
+                self.fat[a] = b
+            self.fat[chain[-1]] = 0x0FFFFFFF
+        return chains
+
+    def write(self, chain, data):
+        size = SECTORS_PER_CLUSTER * 512
+        for i, cluster in enumerate(chain):
+            piece = data[i * size:(i + 1) * size]
+            if not piece:
+                break
+            self.image.seek((PARTITION + self.data_start + (cluster - 2) * SECTORS_PER_CLUSTER) * 512)
+            self.image.write(piece)
+
+    def close(self, root):
+        fat = b''.join(struct.pack('<I', x) for x in self.fat)
+        for copy in range(2):
+            self.image.seek((PARTITION + RESERVED + copy * self.fat_sectors) * 512)
+            self.image.write(fat)
+        boot = bytearray(512)
+        boot[0:3] = b'\xEB\x58\x90'
+        boot[3:11] = b'MSWIN4.1'
+        struct.pack_into('<HBHBHHBHHHII', boot, 11, 512, SECTORS_PER_CLUSTER, RESERVED, 2, 0, 0,
+                         0xF8, 0, 63, 255, PARTITION, VOLUME)
+        struct.pack_into('<IHHIHH', boot, 36, self.fat_sectors, 0, 0, root, 1, 6)
+        boot[66] = 0x29
+        boot[82:90] = b'FAT32   '
+        boot[510:512] = b'\x55\xAA'
+        self.image.seek(PARTITION * 512)
+        self.image.write(boot)
+        info = bytearray(512)
+        struct.pack_into('<I', info, 0, 0x41615252)
+        struct.pack_into('<III', info, 484, 0x61417272, 0xFFFFFFFF, 0xFFFFFFFF)
+        struct.pack_into('<I', info, 508, 0xAA550000)
+        self.image.seek((PARTITION + 1) * 512)
+        self.image.write(info)
+        mbr = bytearray(512)
+        mbr[446:462] = struct.pack('<BBBBBBBBII', 0, 0, 0, 0, 0x0C, 0, 0, 0, PARTITION, VOLUME)
+        mbr[510:512] = b'\x55\xAA'
+        self.image.seek(0)
+        self.image.write(mbr)
+        self.image.close()
+
+
+def dirent(name11, attr, cluster, size):
+    return name11 + bytes([attr, 0, 0]) + struct.pack('<HHHHHHHI', 0, 0, 0, cluster >> 16,
+                                                      0x6000, 0x5A21, cluster & 0xFFFF, size)
+
+
+def main(argv):
+    args = list(argv)
+    count = 8
+    fragment = False
+    truth = None
+    path = None
+    while args:
+        a = args.pop(0)
+        if a == '--songs' and args:
+            count = int(args.pop(0))
+        elif a == '--fragment':
+            fragment = True
+        elif a == '--truth' and args:
+            truth = args.pop(0)
+        elif path is None and not a.startswith('--'):
+            path = a
+        else:
+            sys.exit(__doc__)
+    if path is None:
+        sys.exit(__doc__)
+
+    train = open(MP3, 'rb').read()
+    music = songs(count, frames_of(train))
+    music_dir_size = (len(music) + 3) * 32
+
+    volume = Volume(path)
+    # Directories stay contiguous, only the file data is interleaved
+    root, music_dir = volume.allocate([512, music_dir_size], False)
+    chains = volume.allocate([len(train)] + [len(s[1]) for s in music], fragment)
+
+    volume.write(chains[0], train)
+    entries = [dirent(b'.          ', 0x10, music_dir[0], 0), dirent(b'..         ', 0x10, 0, 0)]
+    for (base, data, _, _, _), chain in zip(music, chains[1:]):
+        volume.write(chain, data)
+        entries.append(dirent(base.ljust(8).encode() + b'MP3', 0x20, chain[0], len(data)))
+    volume.write(music_dir, b''.join(entries) + bytes(32))
+    volume.write(root, dirent(b'TRAIN   MP3', 0x20, chains[0][0], len(train)) +
+                 dirent(b'MUSIC      ', 0x10, music_dir[0], 0) + bytes(32))
+    volume.close(root[0])
+
+    if truth:
+        with open(truth, 'w') as f:
+            f.write(''.join(sorted('%s.MP3|%s|%s|%d\n' % (s[0], s[2], s[3], s[4])
+                                   for s in music)))
+
+
+if __name__ == '__main__':
+    main(sys.argv[1:])
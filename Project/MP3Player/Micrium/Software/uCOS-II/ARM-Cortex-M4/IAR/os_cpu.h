@@ -154,6 +154,10 @@ typedef unsigned int   OS_CPU_SR;                /* Define size of CPU status re
 
 #define  OS_TASK_SW()         OSCtxSw()
 
+#define  OS_CPU_CYCLES_GET()  (*(volatile INT32U *)0xE0001004u)  /* DWT->CYCCNT, see OS_CPU_CyclesInit()   */
+
+#define  OS_CPU_ISR_NUM()     (*(volatile INT32U *)0xE000ED04u & 0x1FFu)  /* ICSR.VECTACTIVE: exception number  */
+
 
 /*
 *********************************************************************************************************
@@ -164,6 +168,8 @@ typedef unsigned int   OS_CPU_SR;                /* Define size of CPU status re
 OS_CPU_EXT  OS_STK   OS_CPU_ExceptStk[OS_CPU_EXCEPT_STK_SIZE];
 OS_CPU_EXT  OS_STK  *OS_CPU_ExceptStkBase;
 
+OS_CPU_EXT  INT32U   OS_CPU_IdleWakeCtr;          /* Times the idle task woke from a tickless sleep    */
+
 
 /*
 *********************************************************************************************************
@@ -184,6 +190,7 @@ void  OSStartHighRdy         (void);
                                                   /* See OS_CPU_C.C                                    */
 void  OS_CPU_SysTickHandler  (void);
 void  OS_CPU_SysTickInit     (INT32U ticksPerSec);
+INT32U  OS_CPU_CyclesInit    (void);
 
 #if (OS_CPU_ARM_FP_EN > 0u)
 void  OS_CPU_FP_Reg_Push     (OS_STK   *stkPtr);
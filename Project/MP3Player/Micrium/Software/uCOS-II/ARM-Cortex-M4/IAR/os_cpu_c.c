@@ -49,6 +49,18 @@
 #include  <ucos_ii.h>
 #include  <stm32f4xx.h>
 
+/*
+*********************************************************************************************************
+*                                          LOCAL CONFIGURATION
+*********************************************************************************************************
+*/
+
+#ifndef  APP_ISR_ENTER                                          /* ISR entry/exit hooks, defined in app_cfg.h           */
+#define  APP_ISR_ENTER()
+#define  APP_ISR_EXIT()
+#endif
+
+
 /*
 *********************************************************************************************************
 *                                          LOCAL VARIABLES
@@ -59,6 +71,22 @@
 static  INT16U  OSTmrCtr;
 #endif
 
+#if OS_TICKLESS_EN > 0u
+static  INT32U  OS_CPU_TickCycles;                              /* SysTick counts per OS tick, 0 until the tick starts  */
+static  INT32U  OS_CPU_TickMax;                                 /* Most ticks one 24-bit SysTick reload can span        */
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                       LOCAL FUNCTION PROTOTYPES
+*********************************************************************************************************
+*/
+
+#if OS_TICKLESS_EN > 0u
+static  void  OS_CPU_TicklessSleep (void);
+#endif
+
 
 
 /*
@@ -174,6 +202,7 @@ void  OSTaskDelHook (OS_TCB *ptcb)
 * Arguments  : none
 *
 * Note(s)    : 1) Interrupts are enabled during this call.
+*              2) With OS_TICKLESS_EN the CPU sleeps here, with the tick stopped until the next delay expires.
 *********************************************************************************************************
 */
 #if OS_CPU_HOOKS_EN > 0u
@@ -182,6 +211,10 @@ void  OSTaskIdleHook (void)
 #if OS_APP_HOOKS_EN > 0u
     App_TaskIdleHook();
 #endif
+
+#if OS_TICKLESS_EN > 0u
+    OS_CPU_TicklessSleep();
+#endif
 }
 #endif
 
@@ -524,9 +557,11 @@ void  OS_CPU_SysTickHandler (void)
     OS_ENTER_CRITICAL();                                        /* Tell uC/OS-II that we are starting an ISR            */
     OSIntNesting++;
     OS_EXIT_CRITICAL();
+    APP_ISR_ENTER();
 
     OSTimeTick();                                               /* Call uC/OS-II's OSTimeTick()                         */
 
+    APP_ISR_EXIT();
     OSIntExit();                                                /* Tell uC/OS-II that we are leaving the ISR            */
 }
 
@@ -549,5 +584,130 @@ void OS_CPU_SysTickInit(INT32U ticksPerSec)
     RCC_GetClocksFreq(&RCC_ClocksStatus);
     
     SysTick_Config(RCC_ClocksStatus.HCLK_Frequency / OS_TICKS_PER_SEC);
+
+#if OS_TICKLESS_EN > 0u
+    OS_CPU_TickCycles = RCC_ClocksStatus.HCLK_Frequency / OS_TICKS_PER_SEC;
+    OS_CPU_TickMax    = SysTick_LOAD_RELOAD_Msk / OS_CPU_TickCycles;
+#endif
+}
+
+
+/*
+*********************************************************************************************************
+*                                          CYCLE COUNTER INIT
+*
+* Description: Starts the DWT cycle counter read by OS_CPU_CYCLES_GET().
+*
+* Arguments  : none
+*
+* Returns    : the counter rate in Hz (the core clock, HCLK).
+*
+* Note(s)    : 1) The counter wraps every 2^32 cycles (about 268 seconds at 16 MHz), so only differences
+*                 between two readings taken less than a wrap apart are meaningful.
+*              2) The counter is not reset, so every user of it may call this function.
+*********************************************************************************************************
+*/
+INT32U  OS_CPU_CyclesInit (void)
+{
+    RCC_ClocksTypeDef RCC_ClocksStatus;
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL        |= DWT_CTRL_CYCCNTENA_Msk;
+
+    RCC_GetClocksFreq(&RCC_ClocksStatus);
+    return (RCC_ClocksStatus.HCLK_Frequency);
+}
+
+
+/*
+*********************************************************************************************************
+*                                          TICKLESS IDLE SLEEP
+*
+* Description: Called by the idle task to sleep with WFI until the next task delay expires (or any other
+*              interrupt occurs) instead of taking a tick interrupt every OS tick.  SysTick is reloaded to
+*              span all the ticks up to the next expiry; on wake-up the whole ticks that passed are handed
+*              to OSTimeTickN() and SysTick goes back to its periodic reload, aligned to the tick phase.
+*
+* Arguments  : none
+*
+* Note(s)    : 1) WFI is executed with PRIMASK set: a pending interrupt wakes the core without being taken,
+*                 so the timer can be read before the interrupt handler runs on OS_EXIT_CRITICAL().
+*              2) If the sleep ran to the end, the pending SysTick interrupt still counts the last tick.
+*              3) OS_TASK_STAT_EN must be 0: OSIdleCtr does not advance while the CPU sleeps, so OSCPUUsage
+*                 would count sleep as busy time, and the statistics task would wake the CPU to compute it.
+*********************************************************************************************************
+*/
+
+#if OS_TICKLESS_EN > 0u
+static  void  OS_CPU_TicklessSleep (void)
+{
+    OS_CPU_SR  cpu_sr;
+    INT32U     ticks;
+    INT32U     reload;
+    INT32U     remain;
+    INT32U     ctrl;
+    INT32U     pending;
+    INT32U     elapsed;
+    INT32U     next;
+
+
+    if (OS_CPU_TickCycles == 0u) {                              /* OS_CPU_SysTickInit() not called yet                  */
+        return;
+    }
+
+    OS_ENTER_CRITICAL();
+    ticks = OSTimeTickNext();
+    if ((ticks == 0u) || (ticks > OS_CPU_TickMax)) {            /* Nothing waiting, or more than one reload can span    */
+        ticks = OS_CPU_TickMax;
+    }
+    if (ticks <= 1u) {                                          /* Next tick is needed anyway: sleep until it           */
+        __DSB();
+        __WFI();
+        OS_CPU_IdleWakeCtr++;
+        OS_EXIT_CRITICAL();
+        return;
+    }
+
+    SysTick->CTRL &= ~SysTick_CTRL_ENABLE_Msk;
+    if ((SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) != 0u) {           /* A tick is already pending, let it run                */
+        SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+        OS_EXIT_CRITICAL();
+        return;
+    }
+    reload        = SysTick->VAL + ((ticks - 1u) * OS_CPU_TickCycles);
+    SysTick->LOAD = reload;
+    SysTick->VAL  = 0u;
+    SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+
+    __DSB();
+    __WFI();
+    OS_CPU_IdleWakeCtr++;
+
+    ctrl          = SysTick->CTRL;                              /* Reading CTRL clears COUNTFLAG                        */
+    SysTick->CTRL = ctrl & ~SysTick_CTRL_ENABLE_Msk;
+    remain        = SysTick->VAL;
+    if ((ctrl & SysTick_CTRL_COUNTFLAG_Msk) != 0u) {            /* Slept to the end, see Note #2                        */
+        elapsed = ticks - 1u;
+        next    = OS_CPU_TickCycles - (reload - remain);
+    } else {                                                    /* Woken early by another interrupt                     */
+        pending = (remain + OS_CPU_TickCycles - 1u) / OS_CPU_TickCycles;
+        if (pending > ticks) {
+            pending = ticks;
+        }
+        elapsed = ticks - pending;
+        next    = remain - ((pending - 1u) * OS_CPU_TickCycles);
+    }
+    if ((next == 0u) || (next > OS_CPU_TickCycles)) {
+        next = OS_CPU_TickCycles;
+    }
+    SysTick->LOAD = next - 1u;                                  /* Finish the current tick ...                          */
+    SysTick->VAL  = 0u;
+    SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+    SysTick->LOAD = OS_CPU_TickCycles - 1u;                     /* ... then back to the periodic reload                 */
+
+    OSTimeTickN(elapsed);
+    OS_EXIT_CRITICAL();                                         /* The interrupt that woke the CPU runs here            */
+    OS_Sched();                                                 /* Run tasks readied by OSTimeTickN()                   */
 }
+#endif
 
@@ -0,0 +1,164 @@
+/*
+*********************************************************************************************************
+*                                                uC/OS-II
+*                                          The Real-Time Kernel
+*
+*                                           POSIX Host Port
+*
+* File      : OS_CPU.H
+* Kernel    : V2.91
+*
+* For       : Linux (or other POSIX) host process
+* Mode      : ucontext tasks, signals as interrupts
+* Toolchain : GNU C/C++
+*
+* Written 2026 for the MP3Player project, so that the kernel, PJDF and the application run as one host
+* process against the device models in Host/.  This port is not a Micrium release.  Its hooks and layout
+* follow the ARM-Cortex-M4/IAR port next to it, which is (c) Copyright 2009-2013 Micrium, Inc. and
+* is used under the licensing terms below.
+*
+* LICENSING TERMS:
+* ---------------
+*           uC/OS-II is provided in source form for FREE short-term evaluation, for educational use or
+*           for peaceful research.  If you plan or intend to use uC/OS-II in a commercial application/
+*           product then, you need to contact Micrium to properly license uC/OS-II for its use in your
+*           application/product.   We provide ALL the source code for your convenience and to help you
+*           experience uC/OS-II.  The fact that the source is provided does NOT mean that you can use
+*           it commercially without paying a licensing fee.
+*
+*           Knowledge of the source code may NOT be used to develop a similar product.
+*
+*           Please help us continue to provide the embedded community with the finest software available.
+*           Your honesty is greatly appreciated.
+*
+*           You can contact us at www.micrium.com, or by phone at +1 (954) 217-2036.
+*********************************************************************************************************
+*/
+
+#ifndef  OS_CPU_H
+#define  OS_CPU_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+
+#ifdef   OS_CPU_GLOBALS
+#define  OS_CPU_EXT
+#else
+#define  OS_CPU_EXT  extern
+#endif
+
+#ifndef  OS_CPU_HOST_STK_SIZE
+#define  OS_CPU_HOST_STK_SIZE      (64u * 1024u) /* Host stack bytes per task, see OSTaskStkInit()     */
+#endif
+
+#ifndef  OS_CPU_HOST_IRQ_MAX
+#define  OS_CPU_HOST_IRQ_MAX              96u    /* Host interrupt lines, numbered like the IRQn_Type  */
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                              DATA TYPES
+*                                         (Compiler Specific)
+*********************************************************************************************************
+*/
+
+typedef unsigned char  BOOLEAN;
+typedef unsigned char  INT8U;                    /* Unsigned  8 bit quantity                           */
+typedef signed   char  INT8S;                    /* Signed    8 bit quantity                           */
+typedef unsigned short INT16U;                   /* Unsigned 16 bit quantity                           */
+typedef signed   short INT16S;                   /* Signed   16 bit quantity                           */
+typedef unsigned int   INT32U;                   /* Unsigned 32 bit quantity                           */
+typedef signed   int   INT32S;                   /* Signed   32 bit quantity                           */
+typedef float          FP32;                     /* Single precision floating point                    */
+typedef double         FP64;                     /* Double precision floating point                    */
+
+typedef unsigned int   OS_STK;                   /* Each stack entry is 32-bit wide                    */
+typedef unsigned int   OS_CPU_SR;                /* 1 if the tick signal was blocked, 0 otherwise      */
+
+
+/*
+*********************************************************************************************************
+*                                             POSIX Host
+*                                      Critical Section Management
+*
+* Method #3:  The "interrupts" of this port are signals: SIGALRM for the tick, SIGUSR1 for the lines of the
+*             host interrupt controller and SIGIO for its file descriptor lines.  OS_CPU_SR_Save() blocks
+*             all three and returns whether they were already blocked; OS_CPU_SR_Restore() unblocks them
+*             only if they were not.
+*
+*             A context switch requested by an ISR (OSIntCtxSw()) is deferred to the next
+*             OS_CPU_SR_Restore() that re-enables the interrupts, the way PendSV defers it on Cortex-M.  Tasks
+*             are therefore never switched out in the middle of a host library call, so host code that
+*             takes locks (stdio, malloc) stays safe.  A task that spins without calling the kernel is
+*             not preempted.
+*********************************************************************************************************
+*/
+
+#define  OS_CRITICAL_METHOD   3u
+
+#if OS_CRITICAL_METHOD == 3u
+#define  OS_ENTER_CRITICAL()  {cpu_sr = OS_CPU_SR_Save();}
+#define  OS_EXIT_CRITICAL()   {OS_CPU_SR_Restore(cpu_sr);}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                          POSIX Host Miscellaneous
+*********************************************************************************************************
+*/
+
+#define  OS_STK_GROWTH        1u                  /* Stack grows from HIGH to LOW memory on x86/ARM    */
+
+#define  OS_TASK_SW()         OSCtxSw()
+
+#define  OS_CPU_CYCLES_GET()  OS_CPU_CyclesGet()  /* Monotonic clock in ns, see OS_CPU_CyclesInit()        */
+
+#define  OS_CPU_ISR_NUM()     OS_CPU_IntNum       /* Exception number, 0 in a task, see OS_CPU_IntNum  */
+
+
+/*
+*********************************************************************************************************
+*                                          GLOBAL VARIABLES
+*********************************************************************************************************
+*/
+
+OS_CPU_EXT  INT32U            OS_CPU_IdleWakeCtr; /* Times the idle task woke from sleep             */
+OS_CPU_EXT  volatile  INT32U  OS_CPU_IntNum;      /* Exception being serviced, as in the Cortex-M IPSR:
+                                                     0 in a task, 15 the tick, 16 + IRQn a host line   */
+
+
+/*
+*********************************************************************************************************
+*                                         FUNCTION PROTOTYPES
+*********************************************************************************************************
+*/
+
+#if OS_CRITICAL_METHOD == 3u                      /* See OS_CPU_C.C                                    */
+OS_CPU_SR  OS_CPU_SR_Save    (void);
+void       OS_CPU_SR_Restore (OS_CPU_SR cpu_sr);
+#endif
+
+void  OSCtxSw                (void);
+void  OSIntCtxSw             (void);
+void  OSStartHighRdy         (void);
+
+void  OS_CPU_SysTickHandler  (void);
+void  OS_CPU_SysTickInit     (INT32U ticksPerSec);
+INT32U  OS_CPU_CyclesInit    (void);
+INT32U  OS_CPU_CyclesGet     (void);
+
+void    OS_CPU_IntSet        (INT8U irq, void (*isr)(void));
+void    OS_CPU_IntEn         (INT8U irq, BOOLEAN en);
+void    OS_CPU_IntPend       (INT8U irq);
+void    OS_CPU_IntTimer      (INT8U irq, INT32U ns);
+void    OS_CPU_IntFd         (INT8U irq, int fd);
+
+#ifdef __cplusplus
+ }
+#endif
+
+#endif
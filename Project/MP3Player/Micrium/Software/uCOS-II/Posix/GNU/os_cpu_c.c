@@ -0,0 +1,1073 @@
+/*
+*********************************************************************************************************
+*                                                uC/OS-II
+*                                          The Real-Time Kernel
+*
+*                                           POSIX Host Port
+*
+* File      : OS_CPU_C.C
+* Kernel    : V2.91
+*
+* For       : Linux (or other POSIX) host process
+* Mode      : ucontext tasks, signals as interrupts
+* Toolchain : GNU C/C++
+*
+* Written 2026 for the MP3Player project, so that the kernel, PJDF and the application run as one host
+* process against the device models in Host/.  This port is not a Micrium release.  Its hooks and layout
+* follow the ARM-Cortex-M4/IAR port next to it, which is (c) Copyright 2009-2013 Micrium, Inc. and
+* is used under the licensing terms below.
+*
+* LICENSING TERMS:
+* ---------------
+*           uC/OS-II is provided in source form for FREE short-term evaluation, for educational use or
+*           for peaceful research.  If you plan or intend to use uC/OS-II in a commercial application/
+*           product then, you need to contact Micrium to properly license uC/OS-II for its use in your
+*           application/product.   We provide ALL the source code for your convenience and to help you
+*           experience uC/OS-II.  The fact that the source is provided does NOT mean that you can use
+*           it commercially without paying a licensing fee.
+*
+*           Knowledge of the source code may NOT be used to develop a similar product.
+*
+*           Please help us continue to provide the embedded community with the finest software available.
+*           Your honesty is greatly appreciated.
+*
+*           You can contact us at www.micrium.com, or by phone at +1 (954) 217-2036.
+*
+* Each task runs on a ucontext with its own host stack of OS_CPU_HOST_STK_SIZE bytes, because host
+* library code needs far more stack than the target task stacks provide.  The OS_STK array passed to
+* OSTaskCreate() is not used for execution; OSTCBStkPtr points to the task's OS_CPU_TASK_CTX instead.
+* Build the kernel, this file, os_cfg.h/app_cfg.h and the application as one host process; the first
+* OS_CPU_SysTickInit() call starts the SIGALRM tick.  The peripherals are modelled by host code that
+* raises the application's ISRs through the interrupt controller at the end of this file.
+*********************************************************************************************************
+*/
+
+#define   OS_CPU_GLOBALS
+
+#ifndef   _XOPEN_SOURCE
+#define   _XOPEN_SOURCE  700                                    /* timer_create(), SA_RESTART, ...                      */
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                             INCLUDE FILES
+*********************************************************************************************************
+*/
+
+#include  <ucos_ii.h>
+#include  <fcntl.h>
+#include  <signal.h>
+#include  <stdint.h>
+#include  <stdlib.h>
+#include  <string.h>
+#include  <sys/time.h>
+#include  <time.h>
+#include  <ucontext.h>
+#include  <unistd.h>
+
+
+/*
+*********************************************************************************************************
+*                                          LOCAL CONFIGURATION
+*********************************************************************************************************
+*/
+
+#ifndef  APP_ISR_ENTER                                          /* ISR entry/exit hooks, defined in app_cfg.h           */
+#define  APP_ISR_ENTER()
+#define  APP_ISR_EXIT()
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                            LOCAL DATA TYPES
+*********************************************************************************************************
+*/
+
+typedef  struct  os_cpu_task_ctx {
+    ucontext_t               Context;                           /* Saved host context of the task                       */
+    void                   (*Task)(void *p_arg);                /* Task entry point and its argument                    */
+    void                    *Arg;
+    struct  os_cpu_task_ctx *Next;                              /* Link in the free list once the task is deleted       */
+} OS_CPU_TASK_CTX;                                              /* Followed by OS_CPU_HOST_STK_SIZE bytes of host stack */
+
+
+/*
+*********************************************************************************************************
+*                                          LOCAL VARIABLES
+*********************************************************************************************************
+*/
+
+#if OS_TMR_EN > 0u
+static  INT16U                  OSTmrCtr;
+#endif
+
+static  OS_CPU_TASK_CTX        *OS_CPU_CtxFreeList;             /* Contexts of deleted tasks, reused by OSTaskStkInit() */
+static  volatile  sig_atomic_t  OS_CPU_CtxSwPending;            /* Set by OSIntCtxSw(), serviced by OS_CPU_SR_Restore() */
+
+static  void                  (*OS_CPU_IntVect[OS_CPU_HOST_IRQ_MAX])(void);     /* ISR of each host line        */
+static  volatile  sig_atomic_t  OS_CPU_IntPending[OS_CPU_HOST_IRQ_MAX];
+static  BOOLEAN                 OS_CPU_IntEnabled[OS_CPU_HOST_IRQ_MAX];
+static  uint64_t                OS_CPU_IntDue[OS_CPU_HOST_IRQ_MAX];   /* OS_CPU_IntTimer() expiry in ns, 0 if none    */
+static  BOOLEAN                 OS_CPU_IntFdLine[OS_CPU_HOST_IRQ_MAX];/* Line raised by SIGIO, see OS_CPU_IntFd()      */
+static  timer_t                 OS_CPU_IntTimerId;
+static  BOOLEAN                 OS_CPU_IntTimerMade;
+
+static  uint64_t                OS_CPU_TickNs;                  /* Tick period, 0 until OS_CPU_SysTickInit()            */
+static  uint64_t                OS_CPU_TickDue;                 /* Clock time the next uncounted tick is due, in ns     */
+
+
+/*
+*********************************************************************************************************
+*                                       LOCAL FUNCTION PROTOTYPES
+*********************************************************************************************************
+*/
+
+static  INT32U    OS_CPU_TicksDue      (uint64_t  slack);
+static  void      OS_CPU_TickTimerSet  (uint64_t  ns);
+
+#if OS_TICKLESS_EN > 0u
+static  void      OS_CPU_TicklessSleep (void);
+#endif
+
+static  uint64_t  OS_CPU_IntNow        (void);
+
+static  void  OS_CPU_IntSigSet     (sigset_t *p_set);
+static  void  OS_CPU_IntDispatch   (void);
+
+
+/*
+*********************************************************************************************************
+*                                       CRITICAL SECTION MANAGEMENT
+*
+* Description: Blocks the "interrupts" of this port, the SIGALRM tick and the SIGUSR1 and SIGIO lines of the
+*              interrupt controller, and restores the previous state.
+*
+* Note(s)    : 1) OS_CPU_SR_Restore() performs any context switch an ISR deferred through OSIntCtxSw()
+*                 before re-enabling the interrupts, so that nested critical sections never switch.  An
+*                 interrupt that was pending meanwhile is taken when the signals are unblocked; if its ISR
+*                 readied a task, the signals are blocked again and that switch is made too.
+*              2) The signals are always blocked together, also while any handler runs, so SIGALRM alone
+*                 tells whether an outer section or a handler had them blocked.
+*              3) Host threads other than the one running the kernel must block these signals.
+*********************************************************************************************************
+*/
+
+static  void  OS_CPU_IntSigSet (sigset_t *p_set)
+{
+    sigemptyset(p_set);
+    sigaddset(p_set, SIGALRM);
+    sigaddset(p_set, SIGIO);
+    sigaddset(p_set, SIGUSR1);
+}
+
+
+OS_CPU_SR  OS_CPU_SR_Save (void)
+{
+    sigset_t  ints;
+    sigset_t  prev;
+
+
+    OS_CPU_IntSigSet(&ints);
+    sigprocmask(SIG_BLOCK, &ints, &prev);
+
+    return ((sigismember(&prev, SIGALRM) == 1) ? 1u : 0u);
+}
+
+
+void  OS_CPU_SR_Restore (OS_CPU_SR cpu_sr)
+{
+    sigset_t  ints;
+
+
+    if (cpu_sr != 0u) {                                         /* Already blocked by an outer section or a handler     */
+        return;
+    }
+
+    OS_CPU_IntSigSet(&ints);
+    while (1) {
+        while (OS_CPU_CtxSwPending != 0) {                      /* Run the switch an ISR asked for                      */
+            OS_CPU_CtxSwPending = 0;
+            OS_Sched();
+        }
+        sigprocmask(SIG_UNBLOCK, &ints, (sigset_t *)0);         /* Pending interrupts are taken here                    */
+        if (OS_CPU_CtxSwPending == 0) {
+            break;
+        }
+        sigprocmask(SIG_BLOCK, &ints, (sigset_t *)0);           /* ... and one readied a task, see Note #1              */
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*                                       OS INITIALIZATION HOOK
+*                                            (BEGINNING)
+*
+* Description: This function is called by OSInit() at the beginning of OSInit().
+*
+* Arguments  : none
+*
+* Note(s)    : 1) Interrupts should be disabled during this call.
+*********************************************************************************************************
+*/
+#if OS_CPU_HOOKS_EN > 0u
+void  OSInitHookBegin (void)
+{
+    OS_CPU_CtxFreeList  = (OS_CPU_TASK_CTX *)0;
+    OS_CPU_CtxSwPending = 0;
+
+#if OS_TMR_EN > 0u
+    OSTmrCtr = 0u;
+#endif
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                       OS INITIALIZATION HOOK
+*                                               (END)
+*
+* Description: This function is called by OSInit() at the end of OSInit().
+*
+* Arguments  : none
+*
+* Note(s)    : 1) Interrupts should be disabled during this call.
+*********************************************************************************************************
+*/
+#if OS_CPU_HOOKS_EN > 0u
+void  OSInitHookEnd (void)
+{
+
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                          TASK CREATION HOOK
+*
+* Description: This function is called when a task is created.
+*
+* Arguments  : ptcb   is a pointer to the task control block of the task being created.
+*
+* Note(s)    : 1) Interrupts are disabled during this call.
+*********************************************************************************************************
+*/
+#if OS_CPU_HOOKS_EN > 0u
+void  OSTaskCreateHook (OS_TCB *ptcb)
+{
+#if OS_APP_HOOKS_EN > 0u
+    App_TaskCreateHook(ptcb);
+#else
+    (void)ptcb;                                                 /* Prevent compiler warning                             */
+#endif
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                           TASK DELETION HOOK
+*
+* Description: This function is called when a task is deleted.
+*
+* Arguments  : ptcb   is a pointer to the task control block of the task being deleted.
+*
+* Note(s)    : 1) Interrupts are disabled during this call.
+*              2) The task's host context goes on the free list.  A task deleting itself keeps running on
+*                 it until its final switch, which is safe because only another (running) task can take
+*                 the context off the list again.
+*********************************************************************************************************
+*/
+#if OS_CPU_HOOKS_EN > 0u
+void  OSTaskDelHook (OS_TCB *ptcb)
+{
+    OS_CPU_TASK_CTX  *p_ctx;
+
+
+    p_ctx               = (OS_CPU_TASK_CTX *)ptcb->OSTCBStkPtr;
+    p_ctx->Next         = OS_CPU_CtxFreeList;
+    OS_CPU_CtxFreeList  = p_ctx;
+
+#if OS_APP_HOOKS_EN > 0u
+    App_TaskDelHook(ptcb);
+#endif
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                             IDLE TASK HOOK
+*
+* Description: This function is called by the idle task.  This hook has been added to allow you to do
+*              such things as STOP the CPU to conserve power.
+*
+* Arguments  : none
+*
+* Note(s)    : 1) Interrupts are enabled during this call.
+*              2) The host process sleeps until the next signal instead of spinning.  With OS_TICKLESS_EN the
+*                 interval timer is also stopped until the next delay expires.
+*********************************************************************************************************
+*/
+#if OS_CPU_HOOKS_EN > 0u
+void  OSTaskIdleHook (void)
+{
+#if OS_APP_HOOKS_EN > 0u
+    App_TaskIdleHook();
+#endif
+
+#if OS_TICKLESS_EN > 0u
+    OS_CPU_TicklessSleep();
+#else
+    pause();
+    OS_CPU_IdleWakeCtr++;
+#endif
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                            TASK RETURN HOOK
+*
+* Description: This function is called if a task accidentally returns.  In other words, a task should
+*              either be an infinite loop or delete itself when done.
+*
+* Arguments  : ptcb      is a pointer to the task control block of the task that is returning.
+*
+* Note(s)    : none
+*********************************************************************************************************
+*/
+
+#if OS_CPU_HOOKS_EN > 0u
+void  OSTaskReturnHook (OS_TCB  *ptcb)
+{
+#if OS_APP_HOOKS_EN > 0u
+    App_TaskReturnHook(ptcb);
+#else
+    (void)ptcb;
+#endif
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                           STATISTIC TASK HOOK
+*
+* Description: This function is called every second by uC/OS-II's statistics task.  This allows your
+*              application to add functionality to the statistics task.
+*
+* Arguments  : none
+*********************************************************************************************************
+*/
+
+#if OS_CPU_HOOKS_EN > 0u
+void  OSTaskStatHook (void)
+{
+#if OS_APP_HOOKS_EN > 0u
+    App_TaskStatHook();
+#endif
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                              TASK ENTRY
+*
+* Description: First code run on a new task's host stack.  Tasks start with the tick enabled, like a
+*              Cortex-M task starts with interrupts enabled.
+*********************************************************************************************************
+*/
+
+static  void  OS_CPU_TaskEntry (void)
+{
+    OS_CPU_TASK_CTX  *p_ctx;
+
+
+    p_ctx = (OS_CPU_TASK_CTX *)OSTCBCur->OSTCBStkPtr;
+    OS_CPU_SR_Restore(0u);
+
+    p_ctx->Task(p_ctx->Arg);
+
+    OS_TaskReturn();                                            /* Task returned: delete it, as the LR trap does on ARM */
+}
+
+
+/*
+*********************************************************************************************************
+*                                        INITIALIZE A TASK'S STACK
+*
+* Description: This function is called by either OSTaskCreate() or OSTaskCreateExt() to initialize the
+*              context of the task being created.
+*
+* Note(s)    : 1) 'ptos' is not used: the task runs on a host stack allocated (or recycled from a deleted
+*                 task) here, and the returned pointer is the task's OS_CPU_TASK_CTX.  OSTaskStkChk()
+*                 therefore reports the target stack as unused.
+*********************************************************************************************************
+*/
+
+OS_STK *OSTaskStkInit (void (*task)(void *p_arg), void *p_arg, OS_STK *ptos, INT16U opt)
+{
+    OS_CPU_SR         cpu_sr;
+    OS_CPU_TASK_CTX  *p_ctx;
+
+
+    (void)ptos;
+    (void)opt;
+
+    OS_ENTER_CRITICAL();
+    p_ctx = OS_CPU_CtxFreeList;
+    if (p_ctx != (OS_CPU_TASK_CTX *)0) {
+        OS_CPU_CtxFreeList = p_ctx->Next;
+    }
+    OS_EXIT_CRITICAL();
+
+    if (p_ctx == (OS_CPU_TASK_CTX *)0) {                        /* The tick ISR never allocates, so malloc() is safe    */
+        p_ctx = (OS_CPU_TASK_CTX *)malloc(sizeof(OS_CPU_TASK_CTX) + OS_CPU_HOST_STK_SIZE);
+        if (p_ctx == (OS_CPU_TASK_CTX *)0) {
+            abort();
+        }
+    }
+
+    getcontext(&p_ctx->Context);
+    p_ctx->Context.uc_stack.ss_sp   = (void *)(p_ctx + 1);
+    p_ctx->Context.uc_stack.ss_size = OS_CPU_HOST_STK_SIZE;
+    p_ctx->Context.uc_link          = (ucontext_t *)0;
+    p_ctx->Task                     = task;
+    p_ctx->Arg                      = p_arg;
+    p_ctx->Next                     = (OS_CPU_TASK_CTX *)0;
+    makecontext(&p_ctx->Context, OS_CPU_TaskEntry, 0);
+
+    return ((OS_STK *)p_ctx);
+}
+
+
+/*
+*********************************************************************************************************
+*                                           TASK SWITCH HOOK
+*
+* Description: This function is called when a task switch is performed.  This allows you to perform other
+*              operations during a context switch.
+*
+* Arguments  : none
+*
+* Note(s)    : 1) Interrupts are disabled during this call.
+*              2) It is assumed that the global pointer 'OSTCBHighRdy' points to the TCB of the task that
+*                 will be 'switched in' (i.e. the highest priority task) and, 'OSTCBCur' points to the
+*                 task being switched out (i.e. the preempted task).
+*********************************************************************************************************
+*/
+#if (OS_CPU_HOOKS_EN > 0u) && (OS_TASK_SW_HOOK_EN > 0u)
+void  OSTaskSwHook (void)
+{
+#if OS_APP_HOOKS_EN > 0u
+    App_TaskSwHook();
+#endif
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                           OS_TCBInit() HOOK
+*
+* Description: This function is called by OS_TCBInit() after setting up most of the TCB.
+*
+* Arguments  : ptcb    is a pointer to the TCB of the task being created.
+*
+* Note(s)    : 1) Interrupts may or may not be ENABLED during this call.
+*********************************************************************************************************
+*/
+#if OS_CPU_HOOKS_EN > 0u
+void  OSTCBInitHook (OS_TCB *ptcb)
+{
+#if OS_APP_HOOKS_EN > 0u
+    App_TCBInitHook(ptcb);
+#else
+    (void)ptcb;                                                 /* Prevent compiler warning                             */
+#endif
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                               TICK HOOK
+*
+* Description: This function is called every tick.
+*
+* Arguments  : none
+*
+* Note(s)    : 1) Interrupts may or may not be ENABLED during this call.
+*********************************************************************************************************
+*/
+#if (OS_CPU_HOOKS_EN > 0u) && (OS_TIME_TICK_HOOK_EN > 0u)
+void  OSTimeTickHook (void)
+{
+#if OS_APP_HOOKS_EN > 0u
+    App_TimeTickHook();
+#endif
+
+#if OS_TMR_EN > 0u
+    OSTmrCtr++;
+    if (OSTmrCtr >= (OS_TICKS_PER_SEC / OS_TMR_CFG_TICKS_PER_SEC)) {
+        OSTmrCtr = 0;
+        OSTmrSignal();
+    }
+#endif
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                         START HIGHEST PRIORITY TASK
+*
+* Description: Called by OSStart() to run the highest priority task ready to run.  The host context of
+*              main() is abandoned.
+*********************************************************************************************************
+*/
+
+void  OSStartHighRdy (void)
+{
+    OS_CPU_TASK_CTX  *p_to;
+
+
+    OSTaskSwHook();
+    OSRunning = OS_TRUE;
+
+    p_to = (OS_CPU_TASK_CTX *)OSTCBHighRdy->OSTCBStkPtr;
+    setcontext(&p_to->Context);
+
+    abort();                                                    /* setcontext() only returns on error                   */
+}
+
+
+/*
+*********************************************************************************************************
+*                                      TASK LEVEL CONTEXT SWITCH
+*
+* Description: Called by OS_Sched() with the tick blocked to switch from OSTCBCur to OSTCBHighRdy.  The
+*              saved context includes the blocked tick, which the resumed task re-enables when it leaves
+*              its critical section.
+*********************************************************************************************************
+*/
+
+void  OSCtxSw (void)
+{
+    OS_CPU_TASK_CTX  *p_from;
+    OS_CPU_TASK_CTX  *p_to;
+
+
+    OSTaskSwHook();
+
+    p_from    = (OS_CPU_TASK_CTX *)OSTCBCur->OSTCBStkPtr;
+    p_to      = (OS_CPU_TASK_CTX *)OSTCBHighRdy->OSTCBStkPtr;
+    OSTCBCur  = OSTCBHighRdy;
+    OSPrioCur = OSPrioHighRdy;
+
+    swapcontext(&p_from->Context, &p_to->Context);
+}
+
+
+/*
+*********************************************************************************************************
+*                                    INTERRUPT LEVEL CONTEXT SWITCH
+*
+* Description: Called by OSIntExit() from a signal handler.  Switching stacks inside a signal
+*              handler could suspend a task in the middle of a host library call, so the switch is only
+*              recorded here and performed by OS_CPU_SR_Restore() through OS_Sched().
+*
+* Note(s)    : 1) OS_Sched() counts the switch when it happens, so the count OSIntExit() just made is
+*                 taken back.
+*********************************************************************************************************
+*/
+
+void  OSIntCtxSw (void)
+{
+#if OS_TASK_PROFILE_EN > 0u
+    OSTCBHighRdy->OSTCBCtxSwCtr--;
+#endif
+    OSCtxSwCtr--;
+    OS_CPU_CtxSwPending = 1;
+}
+
+
+/*
+*********************************************************************************************************
+*                                          SYS TICK HANDLER
+*
+* Description: Handle the system tick, delivered to the host process as SIGALRM.
+*
+* Arguments  : None.
+*
+* Note(s)    : 1) All the interrupt signals are blocked while the handler runs, so the OS_ENTER_CRITICAL() calls
+*                 made by the kernel from here never switch.
+*********************************************************************************************************
+*/
+
+void  OS_CPU_SysTickHandler (void)
+{
+    OS_CPU_SR  cpu_sr;
+
+
+    OS_ENTER_CRITICAL();                                        /* Tell uC/OS-II that we are starting an ISR            */
+    OSIntNesting++;
+    OS_EXIT_CRITICAL();
+    APP_ISR_ENTER();
+
+    OSTimeTick();                                               /* Call uC/OS-II's OSTimeTick()                         */
+
+    APP_ISR_EXIT();
+    OSIntExit();                                                /* Tell uC/OS-II that we are leaving the ISR            */
+}
+
+
+static  void  OS_CPU_TickSignal (int sig)
+{
+    INT32U  ticks;
+
+
+    (void)sig;
+
+    ticks = OS_CPU_TicksDue(OS_CPU_TickNs / 16u);               /* See OS_CPU_SysTickInit() Note #3                     */
+    if (ticks == 0u) {
+        return;
+    }
+    OS_CPU_IntNum = 15u;                                        /* SysTick exception number                             */
+#if OS_TICKLESS_EN > 0u
+    if (ticks > 1u) {                                           /* The end of a tickless sleep, or a late signal        */
+        OSTimeTickN(ticks - 1u);
+    }
+#else
+    while (ticks > 1u) {                                        /* A late signal                                        */
+        OSTimeTick();
+        ticks--;
+    }
+#endif
+    OS_CPU_SysTickHandler();
+    OS_CPU_IntNum = 0u;
+}
+
+
+/*
+*********************************************************************************************************
+*                                            TICKS DUE
+*
+* Description: Counts the ticks that fell due by the monotonic clock since the last call, and moves
+*              OS_CPU_TickDue past them.
+*
+* Arguments  : slack    counts a tick due up to this many ns from now as due already.
+*
+* Returns    : the number of ticks, 0 if none is due or the tick has not been started.
+*
+* Note(s)    : 1) Interrupts MUST be disabled when calling this function.
+*********************************************************************************************************
+*/
+
+static  INT32U  OS_CPU_TicksDue (uint64_t  slack)
+{
+    uint64_t  now;
+    INT32U    ticks;
+
+
+    now = OS_CPU_IntNow() + slack;
+    if ((OS_CPU_TickNs == 0u) || (now < OS_CPU_TickDue)) {
+        return (0u);
+    }
+    ticks           = (INT32U)((now - OS_CPU_TickDue) / OS_CPU_TickNs) + 1u;
+    OS_CPU_TickDue += (uint64_t)ticks * OS_CPU_TickNs;
+    return (ticks);
+}
+
+
+/*
+*********************************************************************************************************
+*                                          TICK TIMER SET
+*
+* Description: Arms the interval timer to signal 'ns' nanoseconds from now, rounded up to whole
+*              microseconds, and once per tick after that.
+*
+* Arguments  : ns       is the time to the next tick signal.
+*********************************************************************************************************
+*/
+
+static  void  OS_CPU_TickTimerSet (uint64_t  ns)
+{
+    struct  itimerval  timer;
+    uint64_t           usec;
+
+
+    usec = (ns + 999u) / 1000u;
+    if (usec == 0u) {                                           /* 0 would stop the timer                               */
+        usec = 1u;
+    }
+    timer.it_value.tv_sec     = (time_t)(usec / 1000000u);
+    timer.it_value.tv_usec    = (suseconds_t)(usec % 1000000u);
+    usec                      = OS_CPU_TickNs / 1000u;
+    timer.it_interval.tv_sec  = (time_t)(usec / 1000000u);
+    timer.it_interval.tv_usec = (suseconds_t)(usec % 1000000u);
+    setitimer(ITIMER_REAL, &timer, (struct itimerval *)0);
+}
+
+
+/*
+*********************************************************************************************************
+*                                          SYS TICK INIT
+*
+* Description: Starts a periodic SIGALRM interval timer as the timer tick used by uCOS
+*
+* Arguments  : ticksPerSec is the number of ticks per second
+*
+* Note(s)    : 1) Call this function from the startup task to initialize the timer tick.
+*              2) Blocking host calls made by tasks are restarted after each tick (SA_RESTART).
+*              3) The ticks are counted from the monotonic clock, not from the signals: each tick signal counts
+*                 every tick that fell due since the last one (OS_CPU_TicksDue()).  A signal the host delivers
+*                 late, for which Linux drops the periods the timer overran, and a tickless sleep thus lose no
+*                 ticks.  The timer is only ever armed onto the tick grid, so a signal that comes a little
+*                 early by the clock (the timer counts in microseconds) counts the tick it stands for.
+*********************************************************************************************************
+*/
+void OS_CPU_SysTickInit(INT32U ticksPerSec)
+{
+    struct  sigaction  act;
+
+
+    memset(&act, 0, sizeof(act));
+    act.sa_handler = OS_CPU_TickSignal;
+    act.sa_flags   = SA_RESTART;
+    OS_CPU_IntSigSet(&act.sa_mask);
+    sigaction(SIGALRM, &act, (struct sigaction *)0);
+
+    OS_CPU_TickNs  = (uint64_t)(1000000u / ticksPerSec) * 1000u;
+    OS_CPU_TickDue = OS_CPU_IntNow() + OS_CPU_TickNs;
+    OS_CPU_TickTimerSet(OS_CPU_TickNs);                         /* Fires at or just after OS_CPU_TickDue, see Note #3   */
+}
+
+
+/*
+*********************************************************************************************************
+*                                          CYCLE COUNTER
+*
+* Description: Host stand-in for the Cortex-M4 DWT cycle counter: the monotonic clock in nanoseconds,
+*              truncated to 32 bits.
+*
+* Arguments  : none
+*
+* Returns    : OS_CPU_CyclesInit() returns the counter rate in Hz; OS_CPU_CyclesGet() the current count.
+*
+* Note(s)    : 1) The counter wraps about every 4.3 seconds, so only differences between two readings taken
+*                 less than a wrap apart are meaningful.
+*********************************************************************************************************
+*/
+INT32U  OS_CPU_CyclesInit (void)
+{
+    return (1000000000u);
+}
+
+
+INT32U  OS_CPU_CyclesGet (void)
+{
+    struct  timespec  now;
+
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((INT32U)now.tv_sec * 1000000000u + (INT32U)now.tv_nsec);
+}
+
+
+/*
+*********************************************************************************************************
+*                                          TICKLESS IDLE SLEEP
+*
+* Description: Host model of the Cortex-M4 tickless idle: the interval timer is re-armed to signal once at the
+*              last tick before the next delay expiry, and the process sleeps in sigsuspend().  That signal,
+*              or whichever one wakes the process first, counts the ticks that passed from the clock and
+*              hands them to OSTimeTickN() (see OS_CPU_SysTickInit() Note #3).  OS_CPU_IdleWakeCtr counts the
+*              wake-ups, so tick accuracy and wake-up rate can be checked on the host.
+*
+* Arguments  : none
+*
+* Note(s)    : 1) A tick already due when the sleep starts has its signal pending or about to come, since the
+*                 timer is always on the tick grid; it is taken first, with the timer left alone.
+*              2) The timer keeps its periodic interval, so the tick runs on after the sleep.  After an early
+*                 wake it is put back on the tick grid.
+*              3) A sleep never spans more than one second of ticks.
+*********************************************************************************************************
+*/
+
+#if OS_TICKLESS_EN > 0u
+static  void  OS_CPU_TicklessSleep (void)
+{
+    OS_CPU_SR  cpu_sr;
+    sigset_t   wait;
+    uint64_t   now;
+    INT32U     ticks;
+    INT32U     elapsed;
+
+
+    OS_ENTER_CRITICAL();                                        /* Block the tick while the timer is reprogrammed       */
+    if (OS_CPU_CtxSwPending != 0) {                             /* A tick readied a task since the last critical section*/
+        OS_EXIT_CRITICAL();                                     /* ... run it instead of sleeping                       */
+        return;
+    }
+    ticks = OSTimeTickNext();
+    if ((ticks == 0u) || (ticks > OS_TICKS_PER_SEC)) {
+        ticks = OS_TICKS_PER_SEC;
+    }
+    if (OS_CPU_TickNs == 0u) {                                  /* Tick not started: plain sleep                        */
+        ticks = 1u;
+    }
+    if (ticks > 1u) {
+        now = OS_CPU_IntNow();
+        if (now >= OS_CPU_TickDue) {                            /* Tick already due: take it first, see Note #1         */
+            ticks = 1u;
+        } else {
+            OS_CPU_TickTimerSet(OS_CPU_TickDue + (ticks - 1u) * OS_CPU_TickNs - now);
+        }
+    }
+
+    sigprocmask(SIG_SETMASK, (sigset_t *)0, &wait);
+    sigdelset(&wait, SIGALRM);
+    sigdelset(&wait, SIGIO);
+    sigdelset(&wait, SIGUSR1);
+    sigsuspend(&wait);                                          /* Signal handlers run here                             */
+    OS_CPU_IdleWakeCtr++;
+
+    if (ticks > 1u) {
+        elapsed = OS_CPU_TicksDue(0u);                          /* Woken early by another signal                        */
+        if (elapsed > 0u) {
+            OSTimeTickN(elapsed);
+        }
+        now = OS_CPU_IntNow();                                  /* Back on the tick grid, see Note #2                   */
+        OS_CPU_TickTimerSet((OS_CPU_TickDue > now) ? (OS_CPU_TickDue - now) : 0u);
+    }
+    OS_Sched();                                                 /* Run tasks readied by OSTimeTickN() before the tick   */
+    OS_EXIT_CRITICAL();                                         /* ... is unblocked, as OS_CPU_SR_Restore() does        */
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                       HOST INTERRUPT CONTROLLER
+*
+* Description: Host stand-in for the NVIC, for the models of the target's peripherals.  Each line has an
+*              ISR, an enable and a pending flag; an enabled line that is pending runs its ISR from a signal
+*              handler, with all the port's signals blocked.
+*
+*              OS_CPU_IntSet()    installs the ISR of a line.
+*              OS_CPU_IntEn()     enables or disables a line; a line enabled while pending is taken at once.
+*              OS_CPU_IntPend()   sets a line pending, like NVIC_SetPendingIRQ().
+*              OS_CPU_IntTimer()  sets a line pending 'ns' nanoseconds from now, once; 0 cancels.
+*              OS_CPU_IntFd()     sets a line pending whenever the file descriptor 'fd' becomes readable.
+*
+* Arguments  : irq     is the line, 0 to OS_CPU_HOST_IRQ_MAX - 1, numbered as the target's IRQn_Type.
+*
+* Note(s)    : 1) Application ISRs do their own OSIntNesting++ and OSIntExit(), as on the target.  Device
+*                 model ISRs may instead just update the model and pend other lines.
+*              2) Pending lines run lowest number first, all at one priority: an ISR is never preempted by
+*                 another.  OS_CPU_IntNum is 16 + irq while it runs.
+*              3) Lines pended from a task are taken when the task leaves its critical section, or at once.
+*              4) OS_CPU_IntTimer() shares one POSIX timer, armed at the earliest expiry and raising SIGUSR1.
+*              5) SIGIO is edge triggered: the ISR of an OS_CPU_IntFd() line must read until EAGAIN.
+*********************************************************************************************************
+*/
+
+static  uint64_t  OS_CPU_IntNow (void)
+{
+    struct  timespec  now;
+
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec);
+}
+
+
+static  void  OS_CPU_IntDispatch (void)
+{
+    INT8U  irq;
+
+
+    irq = 0u;
+    while (irq < OS_CPU_HOST_IRQ_MAX) {
+        if ((OS_CPU_IntPending[irq] != 0) &&
+            (OS_CPU_IntEnabled[irq] == OS_TRUE) &&
+            (OS_CPU_IntVect[irq]    != (void (*)(void))0)) {
+            OS_CPU_IntPending[irq] = 0;
+            OS_CPU_IntNum          = 16u + irq;
+            OS_CPU_IntVect[irq]();
+            OS_CPU_IntNum          = 0u;
+            irq                    = 0u;                        /* Rescan: the ISR may have pended a lower line         */
+        } else {
+            irq++;
+        }
+    }
+}
+
+
+static  void  OS_CPU_IntTimerArm (void)
+{
+    struct  itimerspec  when;
+    uint64_t            due;
+    INT8U               irq;
+
+
+    due = 0u;
+    for (irq = 0u; irq < OS_CPU_HOST_IRQ_MAX; irq++) {
+        if ((OS_CPU_IntDue[irq] != 0u) && ((due == 0u) || (OS_CPU_IntDue[irq] < due))) {
+            due = OS_CPU_IntDue[irq];
+        }
+    }
+    memset(&when, 0, sizeof(when));                             /* 0 disarms the timer                                  */
+    when.it_value.tv_sec  = (time_t)(due / 1000000000u);
+    when.it_value.tv_nsec = (long)(due % 1000000000u);
+    timer_settime(OS_CPU_IntTimerId, TIMER_ABSTIME, &when, (struct itimerspec *)0);
+}
+
+
+static  void  OS_CPU_IntSignal (int sig)
+{
+    uint64_t  now;
+    BOOLEAN   fired;
+    INT8U     irq;
+
+
+    if (sig == SIGIO) {
+        for (irq = 0u; irq < OS_CPU_HOST_IRQ_MAX; irq++) {
+            if (OS_CPU_IntFdLine[irq] == OS_TRUE) {
+                OS_CPU_IntPending[irq] = 1;
+            }
+        }
+    } else if (OS_CPU_IntTimerMade == OS_TRUE) {                /* SIGUSR1: the timer or OS_CPU_IntPend()               */
+        now   = OS_CPU_IntNow();
+        fired = OS_FALSE;
+        for (irq = 0u; irq < OS_CPU_HOST_IRQ_MAX; irq++) {
+            if ((OS_CPU_IntDue[irq] != 0u) && (OS_CPU_IntDue[irq] <= now)) {
+                OS_CPU_IntDue[irq]     = 0u;
+                OS_CPU_IntPending[irq] = 1;
+                fired                  = OS_TRUE;
+            }
+        }
+        if (fired == OS_TRUE) {
+            OS_CPU_IntTimerArm();
+        }
+    }
+    OS_CPU_IntDispatch();
+}
+
+
+static  void  OS_CPU_IntInit (void)
+{
+    struct  sigaction  act;
+    struct  sigevent   ev;
+
+
+    if (OS_CPU_IntTimerMade == OS_TRUE) {
+        return;
+    }
+    memset(&act, 0, sizeof(act));
+    act.sa_handler = OS_CPU_IntSignal;
+    act.sa_flags   = SA_RESTART;
+    OS_CPU_IntSigSet(&act.sa_mask);
+    sigaction(SIGUSR1, &act, (struct sigaction *)0);
+    sigaction(SIGIO,   &act, (struct sigaction *)0);
+
+    memset(&ev, 0, sizeof(ev));
+    ev.sigev_notify = SIGEV_SIGNAL;
+    ev.sigev_signo  = SIGUSR1;
+    if (timer_create(CLOCK_MONOTONIC, &ev, &OS_CPU_IntTimerId) != 0) {
+        abort();
+    }
+    OS_CPU_IntTimerMade = OS_TRUE;
+}
+
+
+void  OS_CPU_IntSet (INT8U irq, void (*isr)(void))
+{
+    OS_CPU_SR  cpu_sr;
+
+
+    if (irq >= OS_CPU_HOST_IRQ_MAX) {
+        return;
+    }
+    OS_ENTER_CRITICAL();
+    OS_CPU_IntInit();
+    OS_CPU_IntVect[irq] = isr;
+    OS_EXIT_CRITICAL();
+}
+
+
+void  OS_CPU_IntEn (INT8U irq, BOOLEAN en)
+{
+    OS_CPU_SR  cpu_sr;
+
+
+    if (irq >= OS_CPU_HOST_IRQ_MAX) {
+        return;
+    }
+    OS_ENTER_CRITICAL();
+    OS_CPU_IntEnabled[irq] = en;
+    if ((en == OS_TRUE) && (OS_CPU_IntPending[irq] != 0)) {
+        OS_CPU_IntInit();
+        raise(SIGUSR1);                                         /* Taken when the section ends, see Note #3             */
+    }
+    OS_EXIT_CRITICAL();
+}
+
+
+void  OS_CPU_IntPend (INT8U irq)
+{
+    OS_CPU_SR  cpu_sr;
+
+
+    if (irq >= OS_CPU_HOST_IRQ_MAX) {
+        return;
+    }
+    OS_ENTER_CRITICAL();
+    OS_CPU_IntInit();
+    OS_CPU_IntPending[irq] = 1;
+    raise(SIGUSR1);
+    OS_EXIT_CRITICAL();
+}
+
+
+void  OS_CPU_IntTimer (INT8U irq, INT32U ns)
+{
+    OS_CPU_SR  cpu_sr;
+
+
+    if (irq >= OS_CPU_HOST_IRQ_MAX) {
+        return;
+    }
+    OS_ENTER_CRITICAL();
+    OS_CPU_IntInit();
+    OS_CPU_IntDue[irq] = (ns == 0u) ? 0u : (OS_CPU_IntNow() + ns);
+    OS_CPU_IntTimerArm();
+    OS_EXIT_CRITICAL();
+}
+
+
+void  OS_CPU_IntFd (INT8U irq, int fd)
+{
+    OS_CPU_SR  cpu_sr;
+
+
+    if (irq >= OS_CPU_HOST_IRQ_MAX) {
+        return;
+    }
+    OS_ENTER_CRITICAL();
+    OS_CPU_IntInit();
+    OS_CPU_IntFdLine[irq] = OS_TRUE;
+    fcntl(fd, F_SETOWN, getpid());
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_ASYNC | O_NONBLOCK);
+    OS_CPU_IntPending[irq] = 1;                                 /* Input may already be waiting, see Note #5            */
+    raise(SIGUSR1);
+    OS_EXIT_CRITICAL();
+}
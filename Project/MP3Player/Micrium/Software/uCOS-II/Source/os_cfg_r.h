@@ -48,7 +48,10 @@
 #define OS_SCHED_LOCK_EN          1u   /* Include code for OSSchedLock() and OSSchedUnlock()           */
 
 #define OS_TICK_STEP_EN           1u   /* Enable tick stepping feature for uC/OS-View                  */
+#define OS_TICK_LIST_EN           0u   /* Keep delayed tasks in a delta list instead of scanning TCBs  */
+#define OS_TICKLESS_EN            0u   /* Stop the tick while idle until the next delay expires        */
 #define OS_TICKS_PER_SEC        100u   /* Set the number of ticks in one second                        */
+#define OS_TRACE_EN               0u   /* Call App_TraceHook() on semaphore and mutex pend and post    */
 
 
                                        /* --------------------- TASK STACK SIZE ---------------------- */
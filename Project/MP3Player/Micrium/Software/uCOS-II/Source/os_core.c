@@ -77,6 +77,10 @@ static  void  OS_InitTCBList(void);
 
 static  void  OS_SchedNew(void);
 
+#if OS_TICK_LIST_EN > 0u
+static  void  OS_TickListAdvance(INT32U ticks);
+#endif
+
 /*$PAGE*/
 /*
 *********************************************************************************************************
@@ -471,7 +475,7 @@ INT16U  OSEventPendMulti (OS_EVENT  **pevents_pend,
     OSTCBCur->OSTCBStat     |= events_stat  |           /* Resource not available, ...                 */
                                OS_STAT_MULTI;           /* ... pend on multiple events                 */
     OSTCBCur->OSTCBStatPend  = OS_STAT_PEND_OK;
-    OSTCBCur->OSTCBDly       = timeout;                 /* Store pend timeout in TCB                   */
+    OS_TickListInsert(OSTCBCur, timeout);               /* Store pend timeout in TCB                   */
     OS_EventTaskWaitMulti(pevents_pend);                /* Suspend task until events or timeout occurs */
 
     OS_EXIT_CRITICAL();
@@ -871,6 +875,68 @@ void  OSStatInit (void)
     OS_EXIT_CRITICAL();
 }
 #endif
+/*$PAGE*/
+/*
+*********************************************************************************************************
+*                                        ADVANCE THE TICK LIST
+*
+* Description: This function counts 'ticks' clock ticks off the head of the delta list of delayed tasks
+*              and readies every task whose delay or timeout expires.
+*
+* Arguments  : ticks    is the number of clock ticks that elapsed.
+*
+* Returns    : none
+*
+* Note(s)    : 1) This function is INTERNAL to uC/OS-II and your application should not call it.
+*              2) Interrupts are re-enabled between expired tasks to bound interrupt latency.
+*********************************************************************************************************
+*/
+
+#if OS_TICK_LIST_EN > 0u
+static  void  OS_TickListAdvance (INT32U  ticks)
+{
+    OS_TCB    *ptcb;
+#if OS_CRITICAL_METHOD == 3u                               /* Allocate storage for CPU status register     */
+    OS_CPU_SR  cpu_sr = 0u;
+#endif
+
+
+
+    OS_ENTER_CRITICAL();
+    ptcb = OSTickList;
+    while (ptcb != (OS_TCB *)0) {
+        if (ptcb->OSTCBTickDelta > ticks) {                /* Head has not expired yet                     */
+            ptcb->OSTCBTickDelta -= ticks;
+            break;
+        }
+        ticks               -= ptcb->OSTCBTickDelta;       /* Expired, carry the rest to the next task     */
+        OSTickList           = ptcb->OSTCBTickNext;
+        if (OSTickList != (OS_TCB *)0) {
+            OSTickList->OSTCBTickPrev = (OS_TCB *)0;
+        }
+        ptcb->OSTCBTickNext  = (OS_TCB *)0;
+        ptcb->OSTCBTickDelta = 0u;
+        ptcb->OSTCBDly       = 0u;
+
+        if ((ptcb->OSTCBStat & OS_STAT_PEND_ANY) != OS_STAT_RDY) {
+            ptcb->OSTCBStat  &= (INT8U)~(INT8U)OS_STAT_PEND_ANY;          /* Yes, Clear status flag           */
+            ptcb->OSTCBStatPend = OS_STAT_PEND_TO;                 /* Indicate PEND timeout            */
+        } else {
+            ptcb->OSTCBStatPend = OS_STAT_PEND_OK;
+        }
+
+        if ((ptcb->OSTCBStat & OS_STAT_SUSPEND) == OS_STAT_RDY) {  /* Is task suspended?               */
+            OSRdyGrp               |= ptcb->OSTCBBitY;             /* No,  Make ready                  */
+            OSRdyTbl[ptcb->OSTCBY] |= ptcb->OSTCBBitX;
+        }
+        OS_EXIT_CRITICAL();
+        OS_ENTER_CRITICAL();
+        ptcb = OSTickList;
+    }
+    OS_EXIT_CRITICAL();
+}
+#endif
+
 /*$PAGE*/
 /*
 *********************************************************************************************************
@@ -888,7 +954,9 @@ void  OSStatInit (void)
 
 void  OSTimeTick (void)
 {
+#if OS_TICK_LIST_EN == 0u
     OS_TCB    *ptcb;
+#endif
 #if OS_TICK_STEP_EN > 0u
     BOOLEAN    step;
 #endif
@@ -931,6 +999,9 @@ void  OSTimeTick (void)
             return;
         }
 #endif
+#if OS_TICK_LIST_EN > 0u
+        OS_TickListAdvance(1u);                            /* Only the head of the delta list counts down  */
+#else
         ptcb = OSTCBList;                                  /* Point at first TCB in TCB list               */
         while (ptcb->OSTCBPrio != OS_TASK_IDLE_PRIO) {     /* Go through all TCBs in TCB list              */
             OS_ENTER_CRITICAL();
@@ -954,8 +1025,82 @@ void  OSTimeTick (void)
             ptcb = ptcb->OSTCBNext;                        /* Point at next TCB in TCB list                */
             OS_EXIT_CRITICAL();
         }
+#endif
+    }
+}
+
+/*$PAGE*/
+/*
+*********************************************************************************************************
+*                                      TICKS TO NEXT DELAY EXPIRY
+*
+* Description: This function is called by the port before it stops the tick to sleep in the idle task.  It
+*              returns how many ticks may elapse before a delayed or timed-out task must be made ready.
+*
+* Arguments  : none
+*
+* Returns    : the number of ticks until the next task delay or pend timeout expires, or 0 if no task is
+*              waiting on the tick.
+*
+* Note(s)    : 1) Interrupts MUST be disabled when calling this function, and stay disabled until the port
+*                 has programmed its timer, so that no new delay can start in between.
+*********************************************************************************************************
+*/
+
+#if OS_TICKLESS_EN > 0u
+INT32U  OSTimeTickNext (void)
+{
+    if (OSTickList == (OS_TCB *)0) {                       /* No task is waiting on the tick               */
+        return (0u);
+    }
+    return (OSTickList->OSTCBTickDelta);                   /* Ticks until the head of the list expires     */
+}
+#endif
+
+/*$PAGE*/
+/*
+*********************************************************************************************************
+*                                      PROCESS SUPPRESSED TICKS
+*
+* Description: This function is called by the port after the idle task slept with the tick stopped, to
+*              account for the 'ticks' clock ticks that elapsed without a tick interrupt.  OSTime and the
+*              delay list are brought up to date in one step.
+*
+* Arguments  : ticks    is the number of whole ticks that elapsed while the tick was stopped.
+*
+* Returns    : none
+*
+* Note(s)    : 1) OSTimeTickHook() is called once for the whole catch-up, not once per tick.
+*              2) Tasks made ready here only run at the next scheduling point, so the caller should call
+*                 OS_Sched() once interrupts are enabled again.
+*********************************************************************************************************
+*/
+
+#if OS_TICKLESS_EN > 0u
+void  OSTimeTickN (INT32U  ticks)
+{
+#if (OS_CRITICAL_METHOD == 3u) && (OS_TIME_GET_SET_EN > 0u)
+    OS_CPU_SR  cpu_sr = 0u;
+#endif
+
+
+
+    if (ticks == 0u) {
+        return;
+    }
+#if OS_TIME_TICK_HOOK_EN > 0u
+    OSTimeTickHook();                                      /* Call user definable hook                     */
+#endif
+#if OS_TIME_GET_SET_EN > 0u
+    OS_ENTER_CRITICAL();                                   /* Update the 32-bit tick counter               */
+    OSTime += ticks;
+    OS_EXIT_CRITICAL();
+#endif
+    if (OSRunning == OS_TRUE) {
+        OS_TickListAdvance(ticks);
     }
 }
+#endif
 
 /*$PAGE*/
 /*
@@ -1059,7 +1204,7 @@ INT8U  OS_EventTaskRdy (OS_EVENT  *pevent,
 #endif
 
     ptcb                  =  OSTCBPrioTbl[prio];        /* Point to this task's OS_TCB                 */
-    ptcb->OSTCBDly        =  0u;                        /* Prevent OSTimeTick() from readying task     */
+    OS_TickListRemove(ptcb);                            /* Prevent OSTimeTick() from readying task     */
 #if ((OS_Q_EN > 0u) && (OS_MAX_QS > 0u)) || (OS_MBOX_EN > 0u)
     ptcb->OSTCBMsg        =  pmsg;                      /* Send message directly to waiting task       */
 #else
@@ -1545,6 +1690,9 @@ static  void  OS_InitTCBList (void)
 #endif
     OSTCBList               = (OS_TCB *)0;                       /* TCB lists initializations          */
     OSTCBFreeList           = &OSTCBTbl[0];
+#if OS_TICK_LIST_EN > 0u
+    OSTickList              = (OS_TCB *)0;                       /* No task is delayed                 */
+#endif
 }
 /*$PAGE*/
 /*
@@ -1727,6 +1875,104 @@ INT8U  OS_StrLen (INT8U *psrc)
     return (len);
 }
 #endif
+/*$PAGE*/
+/*
+*********************************************************************************************************
+*                                       INSERT TASK IN TICK LIST
+*
+* Description: This function places a task in the list of tasks waiting for the tick to expire.  The list
+*              is kept sorted by expiry and each entry only holds the number of ticks between it and the
+*              entry ahead of it, so OSTimeTick() only has to count down the head of the list.
+*
+* Arguments  : ptcb     is a pointer to the task's TCB.
+*
+*              ticks    is the number of clock ticks before the task must be made ready.  0 means the task
+*                       is not to be woken up by the tick (i.e. wait forever).
+*
+* Returns    : none
+*
+* Note(s)    : 1) This function is INTERNAL to uC/OS-II and your application should not call it.
+*              2) Interrupts MUST be disabled when calling this function.
+*              3) OSTCBDly is not counted down; it only indicates whether the task is in the list.
+*********************************************************************************************************
+*/
+
+#if OS_TICK_LIST_EN > 0u
+void  OS_TickListInsert (OS_TCB  *ptcb,
+                         INT32U   ticks)
+{
+    OS_TCB  *pprev;
+    OS_TCB  *pnext;
+
+
+    if (ptcb->OSTCBDly != 0u) {                            /* Already waiting on the tick?                 */
+        OS_TickListRemove(ptcb);
+    }
+    if (ticks == 0u) {                                     /* Not woken up by the tick                     */
+        return;
+    }
+    pprev = (OS_TCB *)0;
+    pnext = OSTickList;
+    while ((pnext != (OS_TCB *)0) && (pnext->OSTCBTickDelta <= ticks)) {
+        ticks -= pnext->OSTCBTickDelta;                    /* Skip tasks expiring no later than this one   */
+        pprev  = pnext;
+        pnext  = pnext->OSTCBTickNext;
+    }
+    ptcb->OSTCBTickDelta = ticks;
+    ptcb->OSTCBTickPrev  = pprev;
+    ptcb->OSTCBTickNext  = pnext;
+    if (pnext != (OS_TCB *)0) {
+        pnext->OSTCBTickDelta -= ticks;                    /* Next task now expires relative to this one   */
+        pnext->OSTCBTickPrev   = ptcb;
+    }
+    if (pprev != (OS_TCB *)0) {
+        pprev->OSTCBTickNext   = ptcb;
+    } else {
+        OSTickList             = ptcb;
+    }
+    ptcb->OSTCBDly = 1u;                                   /* Flag task as waiting on the tick             */
+}
+#endif
+
+/*$PAGE*/
+/*
+*********************************************************************************************************
+*                                      REMOVE TASK FROM TICK LIST
+*
+* Description: This function removes a task from the list of tasks waiting for the tick to expire, e.g.
+*              when the event it was waiting for occurred before the timeout.
+*
+* Arguments  : ptcb     is a pointer to the task's TCB.
+*
+* Returns    : none
+*
+* Note(s)    : 1) This function is INTERNAL to uC/OS-II and your application should not call it.
+*              2) Interrupts MUST be disabled when calling this function.
+*********************************************************************************************************
+*/
+
+#if OS_TICK_LIST_EN > 0u
+void  OS_TickListRemove (OS_TCB  *ptcb)
+{
+    if (ptcb->OSTCBDly == 0u) {                            /* Not in the list                              */
+        return;
+    }
+    if (ptcb->OSTCBTickNext != (OS_TCB *)0) {
+        ptcb->OSTCBTickNext->OSTCBTickDelta += ptcb->OSTCBTickDelta;  /* Hand remaining ticks to next  */
+        ptcb->OSTCBTickNext->OSTCBTickPrev   = ptcb->OSTCBTickPrev;
+    }
+    if (ptcb->OSTCBTickPrev != (OS_TCB *)0) {
+        ptcb->OSTCBTickPrev->OSTCBTickNext   = ptcb->OSTCBTickNext;
+    } else {
+        OSTickList                           = ptcb->OSTCBTickNext;
+    }
+    ptcb->OSTCBTickNext  = (OS_TCB *)0;
+    ptcb->OSTCBTickPrev  = (OS_TCB *)0;
+    ptcb->OSTCBTickDelta = 0u;
+    ptcb->OSTCBDly       = 0u;
+}
+#endif
+
 /*$PAGE*/
 /*
 *********************************************************************************************************
@@ -1941,6 +2187,11 @@ INT8U  OS_TCBInit (INT8U    prio,
         ptcb->OSTCBStat          = OS_STAT_RDY;            /* Task is ready to run                     */
         ptcb->OSTCBStatPend      = OS_STAT_PEND_OK;        /* Clear pend status                        */
         ptcb->OSTCBDly           = 0u;                     /* Task is not delayed                      */
+#if OS_TICK_LIST_EN > 0u
+        ptcb->OSTCBTickNext      = (OS_TCB *)0;
+        ptcb->OSTCBTickPrev      = (OS_TCB *)0;
+        ptcb->OSTCBTickDelta     = 0u;
+#endif
 
 #if OS_TASK_CREATE_EXT_EN > 0u
         ptcb->OSTCBExtPtr        = pext;                   /* Store pointer to TCB extension           */
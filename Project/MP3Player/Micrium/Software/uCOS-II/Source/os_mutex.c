@@ -452,6 +452,7 @@ void  OSMutexPend (OS_EVENT  *pevent,
         return;
     }
 /*$PAGE*/
+    OS_TRACE(OS_TRACE_MUTEX_PEND, pevent, timeout);
     OS_ENTER_CRITICAL();
     pip = (INT8U)(pevent->OSEventCnt >> 8u);               /* Get PIP from mutex                       */
                                                            /* Is Mutex available?                      */
@@ -466,6 +467,7 @@ void  OSMutexPend (OS_EVENT  *pevent,
             OS_EXIT_CRITICAL();
             *perr = OS_ERR_NONE;
         }
+        OS_TRACE(OS_TRACE_MUTEX_PEND_EXIT, pevent, *perr);
         return;
     }
     mprio = (INT8U)(pevent->OSEventCnt & OS_MUTEX_KEEP_LOWER_8);  /* No, Get priority of mutex owner   */
@@ -516,7 +518,7 @@ void  OSMutexPend (OS_EVENT  *pevent,
     }
     OSTCBCur->OSTCBStat     |= OS_STAT_MUTEX;         /* Mutex not available, pend current task        */
     OSTCBCur->OSTCBStatPend  = OS_STAT_PEND_OK;
-    OSTCBCur->OSTCBDly       = timeout;               /* Store timeout in current task's TCB           */
+    OS_TickListInsert(OSTCBCur, timeout);              /* Store timeout in current task's TCB           */
     OS_EventTaskWait(pevent);                         /* Suspend task until event or timeout occurs    */
     OS_EXIT_CRITICAL();
     OS_Sched();                                       /* Find next highest priority task ready         */
@@ -543,6 +545,7 @@ void  OSMutexPend (OS_EVENT  *pevent,
     OSTCBCur->OSTCBEventMultiPtr = (OS_EVENT **)0;
 #endif
     OS_EXIT_CRITICAL();
+    OS_TRACE(OS_TRACE_MUTEX_PEND_EXIT, pevent, *perr);
 }
 /*$PAGE*/
 /*
@@ -590,6 +593,7 @@ INT8U  OSMutexPost (OS_EVENT *pevent)
     if (pevent->OSEventType != OS_EVENT_TYPE_MUTEX) { /* Validate event block type                     */
         return (OS_ERR_EVENT_TYPE);
     }
+    OS_TRACE(OS_TRACE_MUTEX_POST, pevent, 0u);
     OS_ENTER_CRITICAL();
     pip  = (INT8U)(pevent->OSEventCnt >> 8u);         /* Get priority inheritance priority of mutex    */
     prio = (INT8U)(pevent->OSEventCnt & OS_MUTEX_KEEP_LOWER_8);  /* Get owner's original priority      */
@@ -320,17 +320,19 @@ void  OSSemPend (OS_EVENT  *pevent,
         *perr = OS_ERR_PEND_LOCKED;                   /* ... can't PEND when locked                    */
         return;
     }
+    OS_TRACE(OS_TRACE_SEM_PEND, pevent, timeout);
     OS_ENTER_CRITICAL();
     if (pevent->OSEventCnt > 0u) {                    /* If sem. is positive, resource available ...   */
         pevent->OSEventCnt--;                         /* ... decrement semaphore only if positive.     */
         OS_EXIT_CRITICAL();
         *perr = OS_ERR_NONE;
+        OS_TRACE(OS_TRACE_SEM_PEND_EXIT, pevent, OS_ERR_NONE);
         return;
     }
                                                       /* Otherwise, must wait until event occurs       */
     OSTCBCur->OSTCBStat     |= OS_STAT_SEM;           /* Resource not available, pend on semaphore     */
     OSTCBCur->OSTCBStatPend  = OS_STAT_PEND_OK;
-    OSTCBCur->OSTCBDly       = timeout;               /* Store pend timeout in TCB                     */
+    OS_TickListInsert(OSTCBCur, timeout);              /* Store pend timeout in TCB                     */
     OS_EventTaskWait(pevent);                         /* Suspend task until event or timeout occurs    */
     OS_EXIT_CRITICAL();
     OS_Sched();                                       /* Find next highest priority task ready         */
@@ -357,6 +359,7 @@ void  OSSemPend (OS_EVENT  *pevent,
     OSTCBCur->OSTCBEventMultiPtr = (OS_EVENT **)0;
 #endif
     OS_EXIT_CRITICAL();
+    OS_TRACE(OS_TRACE_SEM_PEND_EXIT, pevent, *perr);
 }
 
 /*$PAGE*/
@@ -484,6 +487,7 @@ INT8U  OSSemPost (OS_EVENT *pevent)
     if (pevent->OSEventType != OS_EVENT_TYPE_SEM) {   /* Validate event block type                     */
         return (OS_ERR_EVENT_TYPE);
     }
+    OS_TRACE(OS_TRACE_SEM_POST, pevent, 0u);
     OS_ENTER_CRITICAL();
     if (pevent->OSEventGrp != 0u) {                   /* See if any task waiting for semaphore         */
                                                       /* Ready HPT waiting on event                    */
@@ -65,6 +65,18 @@ extern "C" {
 #define  OS_TRUE                        1u
 #endif
 
+#ifndef  OS_TICK_LIST_EN
+#define  OS_TICK_LIST_EN                0u              /* Older OS_CFG.H: scan all TCBs every tick    */
+#endif
+
+#ifndef  OS_TICKLESS_EN
+#define  OS_TICKLESS_EN                 0u              /* Older OS_CFG.H: tick runs while idle        */
+#endif
+
+#ifndef  OS_TRACE_EN
+#define  OS_TRACE_EN                    0u              /* Older OS_CFG.H: no kernel trace hook        */
+#endif
+
 #define  OS_ASCII_NUL            (INT8U)0
 
 #define  OS_PRIO_SELF                0xFFu              /* Indicate SELF priority                      */
@@ -94,6 +106,25 @@ extern "C" {
 
 #define  OS_TCB_RESERVED        ((OS_TCB *)1)
 
+/*$PAGE*/
+/*
+*********************************************************************************************************
+*                               KERNEL TRACE EVENTS (Passed to App_TraceHook())
+*********************************************************************************************************
+*/
+#define  OS_TRACE_SEM_PEND              1u  /* Entering OSSemPend(),   'arg' is the timeout            */
+#define  OS_TRACE_SEM_PEND_EXIT         2u  /* Leaving  OSSemPend(),   'arg' is the error code         */
+#define  OS_TRACE_SEM_POST              3u  /* Entering OSSemPost(),   'arg' is 0                      */
+#define  OS_TRACE_MUTEX_PEND            4u  /* Entering OSMutexPend(), 'arg' is the timeout            */
+#define  OS_TRACE_MUTEX_PEND_EXIT       5u  /* Leaving  OSMutexPend(), 'arg' is the error code         */
+#define  OS_TRACE_MUTEX_POST            6u  /* Entering OSMutexPost(), 'arg' is 0                      */
+
+#if OS_TRACE_EN > 0u
+#define  OS_TRACE(event, pobj, arg)     App_TraceHook((INT8U)(event), (void *)(pobj), (INT32U)(arg))
+#else
+#define  OS_TRACE(event, pobj, arg)
+#endif
+
 /*$PAGE*/
 /*
 *********************************************************************************************************
@@ -565,6 +596,11 @@ typedef struct os_tcb {
 #endif
 
     INT32U           OSTCBDly;              /* Nbr ticks to delay task or, timeout waiting for event   */
+#if OS_TICK_LIST_EN > 0u                    /* ... not counted down: non-zero while in OSTickList      */
+    struct os_tcb   *OSTCBTickNext;         /* Next TCB in the delta list of delayed tasks             */
+    struct os_tcb   *OSTCBTickPrev;         /* Previous TCB in the delta list of delayed tasks         */
+    INT32U           OSTCBTickDelta;        /* Ticks to expiry after the previous TCB in the list      */
+#endif
     INT8U            OSTCBStat;             /* Task      status                                        */
     INT8U            OSTCBStatPend;         /* Task PEND status                                        */
     INT8U            OSTCBPrio;             /* Task priority (0 == highest)                            */
@@ -695,6 +731,10 @@ OS_EXT  OS_TCB            OSTCBTbl[OS_MAX_TASKS + OS_N_SYS_TASKS];   /* Table of
 OS_EXT  INT8U             OSTickStepState;          /* Indicates the state of the tick step feature    */
 #endif
 
+#if OS_TICK_LIST_EN > 0u
+OS_EXT  OS_TCB           *OSTickList;               /* Delayed tasks, sorted by expiry, delta encoded  */
+#endif
+
 #if (OS_MEM_EN > 0u) && (OS_MAX_MEM_PART > 0u)
 OS_EXT  OS_MEM           *OSMemFreeList;            /* Pointer to free list of memory partitions       */
 OS_EXT  OS_MEM            OSMemTbl[OS_MAX_MEM_PART];/* Storage for memory partition manager            */
@@ -1135,6 +1175,12 @@ void          OSTimeSet               (INT32U           ticks);
 
 void          OSTimeTick              (void);
 
+#if OS_TICKLESS_EN > 0u
+INT32U        OSTimeTickNext          (void);
+
+void          OSTimeTickN             (INT32U           ticks);
+#endif
+
 /*
 *********************************************************************************************************
 *                                            TIMER MANAGEMENT
@@ -1262,6 +1308,16 @@ INT8U         OS_StrLen               (INT8U           *psrc);
 
 void          OS_TaskIdle             (void            *p_arg);
 
+#if OS_TICK_LIST_EN > 0u
+void          OS_TickListInsert       (OS_TCB          *ptcb,
+                                       INT32U           ticks);
+
+void          OS_TickListRemove       (OS_TCB          *ptcb);
+#else                                                   /* Without the list only OSTCBDly is kept      */
+#define       OS_TickListInsert(ptcb, ticks)          ((ptcb)->OSTCBDly = (ticks))
+#define       OS_TickListRemove(ptcb)                 ((ptcb)->OSTCBDly = 0u)
+#endif
+
 void          OS_TaskReturn           (void);
 
 #if OS_TASK_STAT_EN > 0u
@@ -1356,6 +1412,12 @@ void          App_TimeTickHook        (void);
 #endif
 #endif
 
+#if OS_TRACE_EN > 0u
+void          App_TraceHook           (INT8U            event,
+                                       void            *pobj,
+                                       INT32U           arg);
+#endif
+
 /*
 *********************************************************************************************************
 *                                          FUNCTION PROTOTYPES
@@ -1801,6 +1863,19 @@ void          OSCtxSw                 (void);
 #endif
 
 
+#if    (OS_TICKLESS_EN > 0u) && (OS_TICK_LIST_EN == 0u)
+#error  "OS_CFG.H, OS_TICKLESS_EN needs OS_TICK_LIST_EN to find the next expiring delay"
+#endif
+
+#if    (OS_TICKLESS_EN > 0u) && (OS_TMR_EN > 0u)
+#error  "OS_CFG.H, OS_TICKLESS_EN does not support OS_TMR_EN: timers are signaled from every tick"
+#endif
+
+#if    (OS_TICKLESS_EN > 0u) && (OS_TASK_STAT_EN > 0u)
+#error  "OS_CFG.H, OS_TICKLESS_EN does not support OS_TASK_STAT_EN: OSIdleCtr does not count while the CPU sleeps"
+#endif
+
+
 #ifndef OS_TIME_TICK_HOOK_EN
 #error  "OS_CFG.H, Missing OS_TIME_TICK_HOOK_EN: Allows you to include the code for OSTimeTickHook() or not"
 #endif
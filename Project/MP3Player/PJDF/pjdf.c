@@ -11,6 +11,7 @@
 #include "bsp.h"
 #include "pjdf.h"
 #include "pjdfInternal.h"
+#include "traceUtil.h"
 
 static char *DeviceDriverIDs [] =
 {
@@ -32,59 +33,272 @@ static DriverInternal driversInternal[MAXDEVICES] =
 };
 
 
+#define HANDLE_SLOT_BITS  4 // log2(PJDF_MAX_HANDLES)
+#define HANDLE_MAX_GENERATION  (0x7FFF >> HANDLE_SLOT_BITS)
+#if (1 << HANDLE_SLOT_BITS) != PJDF_MAX_HANDLES
+#error "HANDLE_SLOT_BITS does not match PJDF_MAX_HANDLES"
+#endif
+
+// One entry of the handle table. A handle value is the entry's generation
+// shifted left by HANDLE_SLOT_BITS, or'ed with the entry's index. Generations
+// run from 1 to HANDLE_MAX_GENERATION, so handles are always positive.
+typedef struct _HandleInternal
+{
+    DriverInternal *pDriver; // NULL while the entry is free
+    void *pOpen;             // the driver's per-handle context, see DriverInternal
+    INT16U generation;       // changes each time the entry is freed
+    INT8U openIndex;         // index of pOpen in pDriver->openContexts
+} HandleInternal;
+
+static HandleInternal handles[PJDF_MAX_HANDLES];
+
+// Open-addressed hash table of the device names, filled by InitPjdf().
+// Each bucket holds the index of a driver in driversInternal plus 1, 0 if empty.
+#define NAME_HASH_SIZE  16 // must be a power of 2 and at least twice MAXDEVICES
+static INT8U nameHash[NAME_HASH_SIZE];
+
+
+// FNV-1a hash of a device name
+static INT32U HashName(const char *pName)
+{
+    INT32U hash = 2166136261u;
+    while (*pName)
+    {
+        hash ^= (INT8U)*pName++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Returns the driver for the given device name, or NULL if there is none.
+// Usually costs one hash and one strcmp() however many devices there are.
+static DriverInternal *FindDriver(const char *pName)
+{
+    INT32U bucket = HashName(pName);
+    DriverInternal *pDriver;
+
+    while (nameHash[bucket & (NAME_HASH_SIZE - 1)] != 0)
+    {
+        pDriver = &driversInternal[nameHash[bucket & (NAME_HASH_SIZE - 1)] - 1];
+        if (strcmp(pName, pDriver->pName) == 0)
+        {
+            return pDriver;
+        }
+        bucket++;
+    }
+    return NULL;
+}
+
+// Returns the table entry of the given handle, or NULL if the handle was not
+// returned by Open() or has been closed since.
+static HandleInternal *LookupHandle(HANDLE handle)
+{
+    HandleInternal *pHandle;
+
+    if (handle <= 0)
+    {
+        return NULL;
+    }
+    pHandle = &handles[handle & (PJDF_MAX_HANDLES - 1)];
+    if (pHandle->pDriver == NULL || pHandle->generation != (handle >> HANDLE_SLOT_BITS))
+    {
+        return NULL;
+    }
+    return pHandle;
+}
+
+// Returns the entry to the free pool. Its handle becomes stale.
+static void FreeHandle(HandleInternal *pHandle)
+{
+    OS_CPU_SR cpu_sr;
+
+    OS_ENTER_CRITICAL();
+    pHandle->generation = (pHandle->generation == HANDLE_MAX_GENERATION) ? 1 : pHandle->generation + 1;
+    pHandle->pDriver = NULL;
+    OS_EXIT_CRITICAL();
+}
+
+
+// Next priority PjdfCreateBusLock() hands out as a ceiling
+static INT8U nextCeilingPrio = APP_PJDF_CEILING_PRIO_FIRST;
+
+// Counter rate of OS_CPU_CYCLES_GET(), for PjdfLockDump()
+static INT32U lockCyclesPerSec;
+
+
+// Creates the lock of a bus driver: a mutex whose ceiling is the next free
+// priority of APP_PJDF_CEILING_PRIO_FIRST..LAST. A task holding the bus runs
+// at the ceiling while a higher priority task waits for it, so tasks of the
+// priorities in between cannot keep the waiter off the bus.
+// Mutexes do not nest (a task holding one must not take another), so only
+// the bus drivers use them; the other devices keep a semaphore that guards
+// their Open() and Close().
+OS_EVENT *PjdfCreateBusLock(void)
+{
+    OS_EVENT *pLock;
+    INT8U osErr;
+
+    if (nextCeilingPrio > APP_PJDF_CEILING_PRIO_LAST) while (1); // more buses than ceilings in app_cfg.h
+    pLock = OSMutexCreate(nextCeilingPrio, &osErr);
+    if (osErr != OS_ERR_NONE) while (1); // a task has the ceiling priority, or not enough event blocks
+    nextCeilingPrio++;
+    return pLock;
+}
+
+// Takes the device lock, pDriver->sem, and counts it for PjdfLockDump().
+// When it is taken already the wait is also counted and timed. The lock
+// itself serializes the count.
+void PjdfLock(DriverInternal *pDriver)
+{
+    OS_CPU_SR cpu_sr;
+    OS_EVENT *pLock = pDriver->sem;
+    INT32U start;
+    INT32U wait;
+    INT8U osErr;
+
+    if (pLock->OSEventType == OS_EVENT_TYPE_MUTEX)
+    {
+        if (OSMutexAccept(pLock, &osErr))
+        {
+            if (osErr != OS_ERR_NONE) while (1); // the task is above the ceiling
+            pDriver->locks++;
+            return;
+        }
+        start = OS_CPU_CYCLES_GET();
+        OSMutexPend(pLock, 0, &osErr);
+    }
+    else
+    {
+        if (OSSemAccept(pLock) != 0)
+        {
+            pDriver->locks++;
+            return;
+        }
+        start = OS_CPU_CYCLES_GET();
+        OSSemPend(pLock, 0, &osErr);
+    }
+    wait = OS_CPU_CYCLES_GET() - start;
+    if (osErr != OS_ERR_NONE) while (1);
+
+    pDriver->locks++;
+    OS_ENTER_CRITICAL();
+    pDriver->lockWaits++;
+    if (wait > pDriver->lockWaitMax) pDriver->lockWaitMax = wait;
+    OS_EXIT_CRITICAL();
+}
+
+// Releases the device lock taken by PjdfLock() in the same task
+void PjdfUnlock(DriverInternal *pDriver)
+{
+    INT8U osErr;
+
+    if (pDriver->sem->OSEventType == OS_EVENT_TYPE_MUTEX)
+    {
+        osErr = OSMutexPost(pDriver->sem);
+    }
+    else
+    {
+        osErr = OSSemPost(pDriver->sem);
+    }
+    if (osErr != OS_ERR_NONE) while (1); // the task does not hold the lock
+}
+
+
+// Claims a handle table entry and a per-handle context of the driver and calls
+// its Open(). The caller holds the device lock and has checked refCount.
+static HANDLE OpenHandle(DriverInternal *pDriver, INT8U flags)
+{
+    HANDLE retval;
+    int i;
+    OS_CPU_SR cpu_sr;
+    HandleInternal *pHandle;
+    INT8U openIndex;
+
+    // The table is shared by all devices
+    OS_ENTER_CRITICAL();
+    for (i = 0; i < PJDF_MAX_HANDLES && handles[i].pDriver != NULL; i++);
+    if (i < PJDF_MAX_HANDLES)
+    {
+        // with the claim, so no forged handle of generation 0 ever matches
+        if (handles[i].generation == 0)
+        {
+            handles[i].generation = 1; // first use of the entry
+        }
+        handles[i].pDriver = pDriver;
+    }
+    OS_EXIT_CRITICAL();
+    if (i >= PJDF_MAX_HANDLES)
+    {
+        return PJDF_ERR_TOO_MANY_HANDLES;
+    }
+    pHandle = &handles[i];
+
+    // refCount < maxRefCount so there is an unused per-handle context
+    for (openIndex = 0; pDriver->openContextsUsed & (1u << openIndex); openIndex++);
+    pHandle->openIndex = openIndex;
+    pHandle->pOpen = NULL;
+    if (pDriver->openContexts != NULL)
+    {
+        pHandle->pOpen = (INT8U*)pDriver->openContexts + openIndex * pDriver->openContextSize;
+        memset(pHandle->pOpen, 0, pDriver->openContextSize);
+    }
+
+    // Call the Open() function of the device
+    retval = pDriver->Open(pDriver, pHandle->pOpen, flags);
+    if (PJDF_IS_ERROR(retval))
+    {
+        // Failed to open so release the entry, its handle was never seen
+        OS_ENTER_CRITICAL();
+        pHandle->pDriver = NULL;
+        OS_EXIT_CRITICAL();
+        return retval;
+    }
+
+    pDriver->refCount += 1;
+    pDriver->openContextsUsed |= 1u << openIndex;
+    return (pHandle->generation << HANDLE_SLOT_BITS) | i;
+}
+
+
 // Opens a handle to the specified device.
 // pName: the identifier of the device chosen from PJDF_DEVICE_IDS.
 // flags: a device-defined bit string used to configure options of the device
 // Returns: if no error occured, a valid handle is returned which may be used to
 //    operate on the device. If an error occurs, an error code is returned.
 //    Valid handles are positive numbers; error codes are negative numbers.
+//    Each handle has its own device state, e.g. the chip select or async mode
+//    chosen through Ioctl().
 HANDLE Open(char *pName, INT8U flags)
 {
     HANDLE retval;
-    int i;
     DriverInternal *pDriver;
-    INT8U osErr;
 
-    for (i = 0, pDriver = &driversInternal[0]; i < MAXDEVICES; i++, pDriver++)
-    {
-        if (strcmp(pName, pDriver->pName) == 0)
-        {
-            // We found the device.
-
-            // Enter a critical section to increment the device reference count and call device specific Open()
-            OSSemPend(pDriver->sem, 0, &osErr);
-            if (osErr != OS_ERR_NONE) while (1);
-            if (pDriver->refCount < pDriver->maxRefCount)
-            {
-                pDriver->refCount += 1;
-            }
-            else
-            {
-                retval = PJDF_ERR_TOO_MANY_REFS;
-                OSSemPost(pDriver->sem);
-                break;
-            }
-
-            // Call the Open() function of the device
-            retval = pDriver->Open(pDriver, flags);
-            if (PJDF_IS_ERROR(retval))
-            {
-                // Failed to open so decrement ref count
-                pDriver->refCount -= 1;
-            }
-            else
-            {
-                retval = i + 1; // add 1 to ensure handle is positive
-            }
-            OSSemPost(pDriver->sem);
-            break;
-        }
-    }
-    if (i >= MAXDEVICES)
+    TRACE(TRACE_EV_PJDF_OPEN, 0, pName);
+    pDriver = FindDriver(pName);
+    if (pDriver == NULL)
     {
         // we failed to find the device
         retval = PJDF_ERR_DEVICE_NOT_FOUND;
     }
+    else if (!pDriver->initialized)
+    {
+        retval = PJDF_ERR_DEVICE_NOT_INIT;
+    }
+    else
+    {
+        // Lock the device to increment the device reference count and call device specific Open()
+        PjdfLock(pDriver);
+        if (pDriver->refCount < pDriver->maxRefCount)
+        {
+            retval = OpenHandle(pDriver, flags);
+        }
+        else
+        {
+            retval = PJDF_ERR_TOO_MANY_REFS;
+        }
+        PjdfUnlock(pDriver);
+    }
+    TRACE(TRACE_EV_PJDF_OPEN | TRACE_EXIT, retval, pName);
     return retval;
 }
 
@@ -92,107 +306,110 @@ PjdfErrCode Close(HANDLE handle)
 {
     PjdfErrCode retval;
     DriverInternal *pDriver;
-    INT8U osErr;
+    HandleInternal *pHandle;
 
-    if (handle <= 0 || handle > MAXDEVICES)
+    pHandle = LookupHandle(handle);
+    if (pHandle == NULL)
     {
         retval = PJDF_ERR_INVALID_HANDLE;
         while (1);
     }
+    pDriver = pHandle->pDriver;
 
-    pDriver = &driversInternal[handle-1];
-    if (!pDriver->initialized)
-    {
-        retval = PJDF_ERR_DEVICE_NOT_INIT;
-        while (1);
-    }
+    // Lock the device to call device specific Close() and release the handle
+    PjdfLock(pDriver);
 
-    // Enter a critical section to call device specific Close() and decrement the device reference count
-    OSSemPend(pDriver->sem, 0, &osErr);
-    if (osErr != OS_ERR_NONE) while (1);
-
-    if (pDriver->refCount == 0)
-    {
-        retval = PJDF_ERR_DEVICE_NOT_OPEN;
-    }
-    else
-    {
-        retval = pDriver->Close(pDriver);
-    }
+    retval = pDriver->Close(pDriver, pHandle->pOpen);
 
     if (!PJDF_IS_ERROR(retval))
     {
         pDriver->refCount -= 1;
+        pDriver->openContextsUsed &= ~(1u << pHandle->openIndex);
+        FreeHandle(pHandle);
     }
 
-    OSSemPost(pDriver->sem);
+    PjdfUnlock(pDriver);
     return retval;
 }
 
 PjdfErrCode Read(HANDLE handle, void* pBuffer, INT32U* pLength)
 {
     PjdfErrCode retval;
-    DriverInternal *pDriver;
-    if (handle <= 0 || handle > MAXDEVICES)
+    HandleInternal *pHandle = LookupHandle(handle);
+    if (pHandle == NULL)
     {
         retval = PJDF_ERR_INVALID_HANDLE;
         while (1);
     }
 
-    pDriver = &driversInternal[handle-1];
-    if (!pDriver->initialized)
-    {
-        retval = PJDF_ERR_DEVICE_NOT_INIT;
-        while (1);
-    }
-    retval = pDriver->Read(pDriver, pBuffer, pLength);
+    TRACE(TRACE_EV_PJDF_READ, handle, *pLength);
+    retval = pHandle->pDriver->Read(pHandle->pDriver, pHandle->pOpen, pBuffer, pLength);
+    TRACE(TRACE_EV_PJDF_READ | TRACE_EXIT, handle, retval);
     return retval;
 }
 
 PjdfErrCode Write(HANDLE handle, void* pBuffer, INT32U* pLength)
 {
     PjdfErrCode retval;
-    DriverInternal *pDriver;
-    if (handle <= 0 || handle > MAXDEVICES)
+    HandleInternal *pHandle = LookupHandle(handle);
+    if (pHandle == NULL)
     {
         retval = PJDF_ERR_INVALID_HANDLE;
         while (1);
     }
 
-    pDriver = &driversInternal[handle-1];
-    if (!pDriver->initialized)
+    TRACE(TRACE_EV_PJDF_WRITE, handle, *pLength);
+    retval = pHandle->pDriver->Write(pHandle->pDriver, pHandle->pOpen, pBuffer, pLength);
+    TRACE(TRACE_EV_PJDF_WRITE | TRACE_EXIT, handle, retval);
+    return retval;
+}
+
+// Writes the segments in order as one transaction: the device is locked and
+// selected once for all of them, and switches between its command and data
+// interfaces as each segment's flags say. Use it to replace a series of
+// Ioctl() selections and short Write() calls.
+// Returns: PJDF_ERR_NOT_SUPPORTED if the device has no WriteV() method.
+PjdfErrCode WriteV(HANDLE handle, PjdfSegment *pSegments, INT8U count)
+{
+    PjdfErrCode retval;
+    HandleInternal *pHandle = LookupHandle(handle);
+    if (pHandle == NULL)
     {
-        retval = PJDF_ERR_DEVICE_NOT_INIT;
+        retval = PJDF_ERR_INVALID_HANDLE;
         while (1);
     }
-    retval = pDriver->Write(pDriver, pBuffer, pLength);
+    if (pHandle->pDriver->WriteV == NULL)
+    {
+        return PJDF_ERR_NOT_SUPPORTED;
+    }
+
+    TRACE(TRACE_EV_PJDF_WRITEV, handle, count);
+    retval = pHandle->pDriver->WriteV(pHandle->pDriver, pHandle->pOpen, pSegments, count);
+    TRACE(TRACE_EV_PJDF_WRITEV | TRACE_EXIT, handle, retval);
     return retval;
 }
 
 PjdfErrCode Ioctl(HANDLE handle, INT8U request, void* pArgs, INT32U* pSize)
 {
     PjdfErrCode retval;
-    DriverInternal *pDriver;
-    if (handle <= 0 || handle > MAXDEVICES)
+    HandleInternal *pHandle = LookupHandle(handle);
+    if (pHandle == NULL)
     {
         retval = PJDF_ERR_INVALID_HANDLE;
         while (1);
     }
 
-    pDriver = &driversInternal[handle-1];
-    if (!pDriver->initialized)
-    {
-        retval = PJDF_ERR_DEVICE_NOT_INIT;
-        while (1);
-    }
-    retval = pDriver->Ioctl(pDriver, request, pArgs, pSize);
+    TRACE(TRACE_EV_PJDF_IOCTL, handle, request);
+    retval = pHandle->pDriver->Ioctl(pHandle->pDriver, pHandle->pOpen, request, pArgs, pSize);
+    TRACE(TRACE_EV_PJDF_IOCTL | TRACE_EXIT, handle, retval);
     return retval;
 }
 
 
 // InitPjdf
 // Initialize the device driver framework.
-// Calls the Init function of each driver in driversInternal.
+// Calls the Init function of each driver in driversInternal and fills the
+// hash table of the device names.
 //
 // The purpose of this function is to put the driver framework in a valid initial
 // state before applications start to use it.
@@ -205,14 +422,54 @@ PjdfErrCode Ioctl(HANDLE handle, INT8U request, void* pArgs, INT32U* pSize)
 PjdfErrCode InitPjdf()
 {
     PjdfErrCode retval = PJDF_ERR_NONE;
-    for (int i = 0; i < MAXDEVICES; i++)
+    INT32U bucket;
+
+    if (NAME_HASH_SIZE < 2 * MAXDEVICES) while (1); // increase NAME_HASH_SIZE
+    lockCyclesPerSec = OS_CPU_CyclesInit();
+    for (INT32U i = 0; i < MAXDEVICES; i++)
     {
         retval = driversInternal[i].Init(&driversInternal[i], DeviceDriverIDs[i]);
         if (PJDF_IS_ERROR(retval))
         {
             while (1); // a driver Init() function failed
         }
+        if (driversInternal[i].maxRefCount > 16) while (1); // too many handles for openContextsUsed
+
+        for (bucket = HashName(DeviceDriverIDs[i]); nameHash[bucket & (NAME_HASH_SIZE - 1)] != 0; bucket++);
+        nameHash[bucket & (NAME_HASH_SIZE - 1)] = i + 1;
     }
 
     return retval;
 }
+
+
+// PjdfLockDump
+// Prints, for the lock of every device, how often it was taken, how often a
+// task had to wait for it and the longest of those waits. The shell "locks"
+// command calls this.
+void PjdfLockDump(void)
+{
+    char buf[PRINTBUFMAX];
+    OS_CPU_SR cpu_sr;
+    DriverInternal *pDriver;
+    INT32U locks;
+    INT32U waits;
+    INT32U waitMax;
+
+    PrintString("    locks      waits  maxwait(us)  lock   device\n");
+    for (INT32U i = 0; i < MAXDEVICES; i++)
+    {
+        pDriver = &driversInternal[i];
+        if (!pDriver->initialized) continue;
+
+        OS_ENTER_CRITICAL();
+        locks = pDriver->locks;
+        waits = pDriver->lockWaits;
+        waitMax = pDriver->lockWaitMax;
+        OS_EXIT_CRITICAL();
+
+        PrintWithBuf(buf, PRINTBUFMAX, "%9u  %9u  %11u  %-5s  %s\n", locks, waits,
+            (INT32U)((unsigned long long)waitMax * 1000000u / lockCyclesPerSec),
+            pDriver->sem->OSEventType == OS_EVENT_TYPE_MUTEX ? "mutex" : "sem", pDriver->pName);
+    }
+}
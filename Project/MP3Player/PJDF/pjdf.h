@@ -18,14 +18,19 @@
 #include "pjdfCtrlSDAdafruit.h"
 #include "pjdfCtrlI2C.h"
 
-typedef INT8S HANDLE;
+// A handle is an index into the framework's handle table combined with the
+// generation of that table entry, so a handle that was closed is rejected
+// rather than reaching whichever device reopened the entry.
+typedef INT16S HANDLE;
 #define PJDF_IS_VALID_HANDLE(x)  (x > 0) // A valid device driver handle is a positive number
+#define PJDF_MAX_HANDLES  16 // handles open at the same time over all devices, must be a power of 2
 
 
 // PJDF DEVELOPER TODO LIST FOR ADDING A NEW DRIVER:
 //    - define a new PJDF_DEVICE_ID_<MYDEVICE> below
 //    - reference it under PJDF_DEVICE_IDS below
 //    - add a new pjdfInternal<mydevice>.c module to implement the pjdfInternal.h interface
+//    - keep state that belongs to one open handle in the driver's openContexts, not its deviceContext
 //    - reference the Init() function of your driver in the driversInternal array in pjdf.c
 //    - add a new pjdfCtrl<mydevice>.h interface to define the Ioctl() functionality of your device
 //    - #include your pjdfCtrl<mydevice>.h in the present header file above
@@ -60,15 +65,33 @@ typedef INT8S PjdfErrCode;
 #define PJDF_ERR_UNKNOWN_CTRL_REQUEST -6 // A given Ctrl request was not defined for the driver
 #define PJDF_ERR_CHIP_SELECT -7 // Incorrect chip selection or no chip selected
 #define PJDF_ERR_DEVICE_NOT_OPEN -8 // Attempted operation on device that is not open
+#define PJDF_ERR_TOO_MANY_HANDLES -9 // All PJDF_MAX_HANDLES handles are open
+#define PJDF_ERR_NOT_SUPPORTED -10 // The device does not implement the method
+
+// One segment of a WriteV() transaction
+typedef struct _PjdfSegment
+{
+    void *pBuffer;  // the data to write
+    INT32U length;  // number of bytes in pBuffer
+    INT8U flags;    // PJDF_SEG_xxx
+} PjdfSegment;
+
+#define PJDF_SEG_DATA     0x00 // segment goes to the data interface of the device
+#define PJDF_SEG_COMMAND  0x01 // segment goes to the command interface of the device
 
 // Generic API methods exposed to applications for operating on devices
 HANDLE Open(char *pName, INT8U flags);
 PjdfErrCode Close(HANDLE handle);
 PjdfErrCode Read(HANDLE handle, void* pBuffer, INT32U* pLength);
 PjdfErrCode Write(HANDLE handle, void* pBuffer, INT32U* pLength);
+PjdfErrCode WriteV(HANDLE handle, PjdfSegment *pSegments, INT8U count);
 PjdfErrCode Ioctl(HANDLE handle, INT8U request, void* pArgs, INT32U* pSize);
 
 // Method called by the OS to initialize the driver framework
 PjdfErrCode InitPjdf();
 
+// Prints how often each device lock was taken, how often it was found
+// taken and the longest wait
+void PjdfLockDump(void);
+
 #endif
\ No newline at end of file
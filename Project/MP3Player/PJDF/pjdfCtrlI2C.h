@@ -14,5 +14,7 @@
 // Control definitions for I2C
 
 #define PJDF_CTRL_I2C_SET_DEVICE_ADDRESS  0x01   // Set the I2C device address for subsequent IO
+#define PJDF_CTRL_I2C_WAIT_FOR_LOCK       0x02   // Wait for exclusive access to I2C, then lock it
+#define PJDF_CTRL_I2C_RELEASE_LOCK        0x03   // Release exclusive I2C lock
 
 #endif
\ No newline at end of file
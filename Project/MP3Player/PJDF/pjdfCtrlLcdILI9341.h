@@ -19,4 +19,6 @@
 
 #define PJDF_CTRL_LCD_SET_SPI_HANDLE 0x3  // Passes the required SPI handle to the LCD driver to enable it to talk to the ILI9341
 
+#define PJDF_CTRL_LCD_FILL 0x04  // Write one color to count pixels in a single SPI lock hold, pArgs points to a PjdfSpiFill. Selects data.
+
 #endif
\ No newline at end of file
@@ -19,4 +19,8 @@
 
 #define PJDF_CTRL_MP3_SET_SPI_HANDLE 0x3  // Passes the required SPI handle to the MP3 driver to enable it to talk to the VS1053
 
+// Selecting one of the following two deselects the other one (polling is the default):
+#define PJDF_CTRL_MP3_DREQ_INTERRUPT  0x04   // Pend on the DREQ EXTI interrupt while the VS1053 is busy
+#define PJDF_CTRL_MP3_DREQ_POLL  0x05   // Poll DREQ, sleeping between polls while the VS1053 is busy
+
 #endif
\ No newline at end of file
@@ -16,5 +16,32 @@
 #define PJDF_CTRL_SPI_WAIT_FOR_LOCK  0x01   // Wait for exclusive access to SPI, then lock it
 #define PJDF_CTRL_SPI_RELEASE_LOCK   0x02   // Release exclusive SPI lock
 #define PJDF_CTRL_SPI_SET_DATARATE   0x03   // Set transmission rate of the SPI interface
+#define PJDF_CTRL_SPI_SET_ASYNC      0x04   // Pass an OS_EVENT* semaphore to make Read/Write on this handle return immediately and post it on completion, or NULL to go back to blocking transfers
+#define PJDF_CTRL_SPI_WAIT_FOR_DMA   0x05   // Wait until any DMA transfer in flight has completed
+#define PJDF_CTRL_SPI_FILL           0x06   // Send a 16 bit value repeatedly, pArgs points to a PjdfSpiFill. May stop early for a reserved handle, see below
+#define PJDF_CTRL_SPI_SET_RESERVED   0x07   // pArgs points to a BOOLEAN, when OS_TRUE the handle is reserved bus time (e.g. for an audio decoder)
+
+// Async transfers (PJDF_CTRL_SPI_SET_ASYNC)
+//
+// Write() and Read() return while the DMA is still shifting the bytes. The
+// caller keeps its chip select asserted, and the lock held, until the async
+// semaphore is posted or PJDF_CTRL_SPI_WAIT_FOR_DMA returns, and only then
+// deasserts it. PJDF_CTRL_SPI_RELEASE_LOCK also waits for the transfer, but
+// only to hand the next holder an idle bus: a chip select deasserted before
+// it has already cut the transfer short.
+
+// Arguments of PJDF_CTRL_SPI_FILL (and PJDF_CTRL_LCD_FILL)
+//
+// A DMA fill is sent in slices of SPI_FILL_SLICE_LENGTH values. When a 
+// reserved handle is waiting for the lock at the end of a slice, the fill 
+// stops and count is left holding the values not yet sent: the caller
+// deasserts its chip select, releases the lock, waits for it again, restores
+// its data rate and chip select, then repeats the request to send the rest.
+// This bounds how long a bulk transfer keeps a reserved handle off the bus.
+typedef struct _PjdfSpiFill
+{
+    INT16U value; // sent most significant byte first
+    INT32U count; // in: number of 16 bit values to send, out: number not sent
+} PjdfSpiFill;
 
 #endif
\ No newline at end of file
@@ -25,20 +25,39 @@ struct _DriverInternal
     PjdfErrCode (*Init)(DriverInternal *pDriver, char *pName);
 
     BOOLEAN initialized; // true if Init() ran successfully otherwise false.
-    OS_EVENT *sem;  // semaphore to serialize operations on the device
+    OS_EVENT *sem;  // serializes operations on the device: a semaphore, or for a bus the mutex from PjdfCreateBusLock()
+    INT32U locks;       // times PjdfLock() took sem
+    INT32U lockWaits;   // times PjdfLock() found sem taken
+    INT32U lockWaitMax; // longest of those waits in OS_CPU_CYCLES_GET() counts
     INT8U refCount; // current number of Open handles to the device
-    INT8U maxRefCount; // Maximum Open handles allowed for the device
-    void *deviceContext; // device dependent data
+    INT8U maxRefCount; // Maximum Open handles allowed for the device, at most 16
+    void *deviceContext; // device dependent data shared by all handles
+
+    // Per-handle data: an array of maxRefCount contexts of openContextSize bytes
+    // each, or NULL if the device keeps no per-handle state. Open() hands a
+    // zeroed unused entry to the device's Open() method and the same entry is
+    // passed as pOpen to every method called through that handle.
+    void *openContexts;
+    INT16U openContextSize;
+    INT16U openContextsUsed; // bit i is set while entry i belongs to an open handle
 
     // Device-specific methods for operating on the device
-    PjdfErrCode (*Open)(DriverInternal *pDriver, INT8U flags);
-    PjdfErrCode (*Close)(DriverInternal *pDriver);
-    PjdfErrCode (*Read)(DriverInternal *pDriver, void* pBuffer, INT32U* pCount);
-    PjdfErrCode (*Write)(DriverInternal *pDriver, void* pBuffer, INT32U* pCount);
-    PjdfErrCode (*Ioctl)(DriverInternal *pDriver, INT8U request, void* pArgs, INT32U* pSize);
+    PjdfErrCode (*Open)(DriverInternal *pDriver, void *pOpen, INT8U flags);
+    PjdfErrCode (*Close)(DriverInternal *pDriver, void *pOpen);
+    PjdfErrCode (*Read)(DriverInternal *pDriver, void *pOpen, void* pBuffer, INT32U* pCount);
+    PjdfErrCode (*Write)(DriverInternal *pDriver, void *pOpen, void* pBuffer, INT32U* pCount);
+    PjdfErrCode (*Ioctl)(DriverInternal *pDriver, void *pOpen, INT8U request, void* pArgs, INT32U* pSize);
+
+    // Optional: writes all segments as one transaction, NULL if not supported
+    PjdfErrCode (*WriteV)(DriverInternal *pDriver, void *pOpen, PjdfSegment *pSegments, INT8U count);
 };
 
 
+// Locking for driver methods, see pjdf.c
+OS_EVENT *PjdfCreateBusLock(void);
+void PjdfLock(DriverInternal *pDriver);
+void PjdfUnlock(DriverInternal *pDriver);
+
 // PJDF DEVELOPER TODO: add the prototype of your driver's Init() implementation here:
 PjdfErrCode InitSPI(DriverInternal *pDriver, char *pName);
 PjdfErrCode InitMp3VS1053(DriverInternal *pDriver, char *pName);
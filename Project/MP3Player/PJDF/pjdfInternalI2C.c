@@ -16,16 +16,24 @@ Developed for University of Washington embedded systems programming certificate
 typedef struct _PjdfContextI2C
 {
     I2C_TypeDef *i2cMemMap; // Memory mapped register block for an I2C interface
-    uint32_t i2CDevAddr;
 } PjdfContextI2c;
 
-static PjdfContextI2c i2c1Context = { I2C1, 0 };
+// State of one open handle to an I2C interface
+typedef struct _PjdfOpenI2C
+{
+    uint32_t i2CDevAddr;
+} PjdfOpenI2c;
+
+#define I2C1_MAX_REFS 1 // Maximum refcount allowed for I2C1
+
+static PjdfContextI2c i2c1Context = { I2C1 };
+static PjdfOpenI2c i2c1Opens[I2C1_MAX_REFS];
 
 
 
 // OpenI2C
 // No special action required to open I2C device
-static PjdfErrCode OpenI2C(DriverInternal *pDriver, INT8U flags)
+static PjdfErrCode OpenI2C(DriverInternal *pDriver, void *pOpen, INT8U flags)
 {
     // Nothing to do
     return PJDF_ERR_NONE;
@@ -33,7 +41,7 @@ static PjdfErrCode OpenI2C(DriverInternal *pDriver, INT8U flags)
 
 // CloseI2C
 // No special action required to close I2C device
-static PjdfErrCode CloseI2C(DriverInternal *pDriver)
+static PjdfErrCode CloseI2C(DriverInternal *pDriver, void *pOpen)
 {
     // Nothing to do
     return PJDF_ERR_NONE;
@@ -47,7 +55,7 @@ static PjdfErrCode CloseI2C(DriverInternal *pDriver)
 //     peripheral to read from. After reading, contains the bytes that were read.
 // pCount: the number of bytes to read.
 // Returns: PJDF_ERR_NONE if there was no error, otherwise an error code.
-static PjdfErrCode ReadI2C(DriverInternal *pDriver, void* pBuffer, INT32U* pCount)
+static PjdfErrCode ReadI2C(DriverInternal *pDriver, void *pOpen, void* pBuffer, INT32U* pCount)
 {
     PjdfContextI2c *pContext = (PjdfContextI2c*) pDriver->deviceContext;
     if(NULL == pContext) while(1);
@@ -75,7 +83,7 @@ static PjdfErrCode ReadI2C(DriverInternal *pDriver, void* pBuffer, INT32U* pCoun
 //     the data to write.
 // pCount: the number of bytes to write NOT including the address in the first byte.
 // Returns: PJDF_ERR_NONE if there was no error, otherwise an error code.
-static PjdfErrCode WriteI2C(DriverInternal *pDriver, void* pBuffer, INT32U* pCount)
+static PjdfErrCode WriteI2C(DriverInternal *pDriver, void *pOpen, void* pBuffer, INT32U* pCount)
 {
     PjdfContextI2c* pContext = (PjdfContextI2c*)pDriver->deviceContext;
     if(NULL == pContext) while(1);
@@ -96,14 +104,19 @@ static PjdfErrCode WriteI2C(DriverInternal *pDriver, void* pBuffer, INT32U* pCou
 
 // IoctlI2C
 // Handles the request codes defined in pjdfCtrlI2c.h
-static PjdfErrCode IoctlI2C(DriverInternal *pDriver, INT8U request, void* pArgs, INT32U* pSize)
+static PjdfErrCode IoctlI2C(DriverInternal *pDriver, void *pOpen, INT8U request, void* pArgs, INT32U* pSize)
 {
-    PjdfContextI2c *pContext = (PjdfContextI2c*) pDriver->deviceContext;
-    if (pContext == NULL) while(1);
+    PjdfOpenI2c *pOpenI2c = (PjdfOpenI2c*) pOpen;
     switch (request)
     {
     case PJDF_CTRL_I2C_SET_DEVICE_ADDRESS: // Set the I2C device address for subsequent IO
-        pContext->i2CDevAddr = ((uint8_t*)pArgs)[0];
+        pOpenI2c->i2CDevAddr = ((uint8_t*)pArgs)[0];
+        break;
+    case PJDF_CTRL_I2C_WAIT_FOR_LOCK: // Hold the bus across a register address write and the following read
+        PjdfLock(pDriver);
+        break;
+    case PJDF_CTRL_I2C_RELEASE_LOCK:
+        PjdfUnlock(pDriver);
         break;
     default:
         while(1);
@@ -118,9 +131,8 @@ PjdfErrCode InitI2C(DriverInternal *pDriver, char *pName)
 {
     if (strcmp (pName, pDriver->pName) != 0) while(1); // pName should have been initialized in driversInternal[] declaration
 
-    // Initialize semaphore for serializing operations on the device
-    pDriver->sem = OSSemCreate(1);
-    if (pDriver->sem == NULL) while (1);  // not enough semaphores available
+    // Initialize the bus lock for serializing operations on the device
+    pDriver->sem = PjdfCreateBusLock();
     pDriver->refCount = 0; // initial number of Open handles to the device
 
     // We may choose to handle multiple hardware instances of the I2C interface
@@ -128,8 +140,10 @@ PjdfErrCode InitI2C(DriverInternal *pDriver, char *pName)
     // the context of the I2C hardware instance specified by pName.
     if (strcmp(pName, PJDF_DEVICE_ID_I2C1) == 0)
     {
-        pDriver->maxRefCount = 1; // Maximum refcount allowed for the device
+        pDriver->maxRefCount = I2C1_MAX_REFS; // Maximum refcount allowed for the device
         pDriver->deviceContext = (void*) &i2c1Context;
+        pDriver->openContexts = (void*) i2c1Opens;
+        pDriver->openContextSize = sizeof(PjdfOpenI2c);
         BspI2C1_init(); // init I2C1 hardware
     }
 
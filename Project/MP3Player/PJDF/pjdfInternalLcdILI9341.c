@@ -13,13 +13,15 @@
 #include "pjdfInternal.h"
 
 
-// SPI link, etc for ILI8341 LCD controller
-typedef struct _PjdfContextLcdILI9341
+// SPI link, etc of one open handle to the ILI9341 LCD controller
+typedef struct _PjdfOpenLcdILI9341
 {
     HANDLE spiHandle; // SPI communication link to ILI9341
-} PjdfContextLcdILI9341;
+} PjdfOpenLcdILI9341;
 
-static PjdfContextLcdILI9341 ili9341Context = { 0 };
+#define LCD_ILI9341_MAX_REFS 1 // only one open handle allowed
+
+static PjdfOpenLcdILI9341 ili9341Opens[LCD_ILI9341_MAX_REFS];
 
 static const INT16U LcdSpiDataRate = LCD_SPI_DATARATE;
 static const INT32U SizeofLcdSpiDataRate = sizeof(LcdSpiDataRate);
@@ -27,16 +29,16 @@ static const INT32U SizeofLcdSpiDataRate = sizeof(LcdSpiDataRate);
 
 // OpenLCD
 // Nothing to do.
-static PjdfErrCode OpenLCD(DriverInternal *pDriver, INT8U flags)
+static PjdfErrCode OpenLCD(DriverInternal *pDriver, void *pOpen, INT8U flags)
 {
     return PJDF_ERR_NONE; 
 }
 
 // CloseLCD
 // Ensure that the dependent SPI handle is closed.
-static PjdfErrCode CloseLCD(DriverInternal *pDriver)
+static PjdfErrCode CloseLCD(DriverInternal *pDriver, void *pOpen)
 {
-    PjdfContextLcdILI9341 *pContext = (PjdfContextLcdILI9341*) pDriver->deviceContext;
+    PjdfOpenLcdILI9341 *pContext = (PjdfOpenLcdILI9341*) pOpen;
     return Close(pContext->spiHandle);
 }
 
@@ -54,10 +56,10 @@ static PjdfErrCode CloseLCD(DriverInternal *pDriver)
 //     the resulting data from the device
 // pCount: the number of bytes to write/read
 // Returns: PJDF_ERR_NONE if there was no error, otherwise an error code.
-static PjdfErrCode ReadLCD(DriverInternal *pDriver, void* pBuffer, INT32U* pCount)
+static PjdfErrCode ReadLCD(DriverInternal *pDriver, void *pOpen, void* pBuffer, INT32U* pCount)
 {
     PjdfErrCode retval;
-    PjdfContextLcdILI9341 *pContext = (PjdfContextLcdILI9341*) pDriver->deviceContext;
+    PjdfOpenLcdILI9341 *pContext = (PjdfOpenLcdILI9341*) pOpen;
     HANDLE hSPI = pContext->spiHandle;
     
     retval = Ioctl(hSPI, PJDF_CTRL_SPI_WAIT_FOR_LOCK, 0, 0); // wait for exclusive access
@@ -90,10 +92,10 @@ static PjdfErrCode ReadLCD(DriverInternal *pDriver, void* pBuffer, INT32U* pCoun
 // pBuffer: the data to write to the device
 // pCount: the number of bytes to write
 // Returns: PJDF_ERR_NONE if there was no error, otherwise an error code.
-static PjdfErrCode WriteLCD(DriverInternal *pDriver, void* pBuffer, INT32U* pCount)
+static PjdfErrCode WriteLCD(DriverInternal *pDriver, void *pOpen, void* pBuffer, INT32U* pCount)
 {
     PjdfErrCode retval;
-    PjdfContextLcdILI9341 *pContext = (PjdfContextLcdILI9341*) pDriver->deviceContext;
+    PjdfOpenLcdILI9341 *pContext = (PjdfOpenLcdILI9341*) pOpen;
     HANDLE hSPI = pContext->spiHandle;
     
     retval = Ioctl(hSPI, PJDF_CTRL_SPI_WAIT_FOR_LOCK, 0, 0);  // wait for exclusive access
@@ -112,17 +114,98 @@ static PjdfErrCode WriteLCD(DriverInternal *pDriver, void* pBuffer, INT32U* pCou
     return retval;
 }
 
+// WriteVLCD
+// Writes the segments under one SPI lock and one chip select assertion,
+// driving D/C low for PJDF_SEG_COMMAND segments and high for data segments.
+// D/C is left as the last segment set it, as if selected through Ioctl().
+//
+// pDriver: pointer to an initialized ILI9341 LCD driver
+// pSegments: the segments to write in order
+// count: the number of segments
+// Returns: PJDF_ERR_NONE if there was no error, otherwise an error code.
+static PjdfErrCode WriteVLCD(DriverInternal *pDriver, void *pOpen, PjdfSegment *pSegments, INT8U count)
+{
+    PjdfErrCode retval;
+    PjdfOpenLcdILI9341 *pContext = (PjdfOpenLcdILI9341*) pOpen;
+    HANDLE hSPI = pContext->spiHandle;
+    INT8U i;
+    
+    retval = Ioctl(hSPI, PJDF_CTRL_SPI_WAIT_FOR_LOCK, 0, 0);  // wait for exclusive access
+    if (retval != PJDF_ERR_NONE) while(1);
+    
+    // adjust SPI transmission rate
+    retval = Ioctl(hSPI, PJDF_CTRL_SPI_SET_DATARATE, (void*)&LcdSpiDataRate, (INT32U*)&SizeofLcdSpiDataRate); 
+    if (retval != PJDF_ERR_NONE) while(1);
+    
+    LCD_ILI9341_CS_ASSERT(); // assert LCD SPI
+    for (i = 0; i < count; i++)
+    {
+        // a polled or blocking Write() has shifted out its last bit when it returns
+        if (pSegments[i].flags & PJDF_SEG_COMMAND)
+        {
+            LCD_ILI9341_DC_LOW();
+        }
+        else
+        {
+            LCD_ILI9341_DC_HIGH();
+        }
+        retval = Write(hSPI, pSegments[i].pBuffer, &pSegments[i].length);
+        if (PJDF_IS_ERROR(retval)) break;
+    }
+    LCD_ILI9341_CS_DEASSERT(); // de-assert LCD SPI
+    
+    if (Ioctl(hSPI, PJDF_CTRL_SPI_RELEASE_LOCK, 0, 0) != PJDF_ERR_NONE) while(1);
+    return retval;
+}
+
+
+// FillLCD
+// Writes fill->count pixels of fill->value to the current address window
+// while holding the SPI lock. When the SPI fill stops early for a reserved
+// handle (the MP3 decoder), the lock is handed over and taken back and the
+// fill carries on: the ILI9341 stays in memory write while chip select is
+// high, as long as no command is sent.
+static PjdfErrCode FillLCD(PjdfOpenLcdILI9341 *pContext, PjdfSpiFill *fill)
+{
+    PjdfErrCode retval;
+    HANDLE hSPI = pContext->spiHandle;
+    PjdfSpiFill rest = *fill;
+    INT32U size = sizeof(PjdfSpiFill);
+    
+    retval = Ioctl(hSPI, PJDF_CTRL_SPI_WAIT_FOR_LOCK, 0, 0);  // wait for exclusive access
+    if (retval != PJDF_ERR_NONE) while(1);
+    
+    LCD_ILI9341_DC_HIGH();
+    while (1)
+    {
+        retval = Ioctl(hSPI, PJDF_CTRL_SPI_SET_DATARATE, (void*)&LcdSpiDataRate, (INT32U*)&SizeofLcdSpiDataRate); 
+        if (retval != PJDF_ERR_NONE) while(1);
+        
+        LCD_ILI9341_CS_ASSERT(); // assert LCD SPI
+        retval = Ioctl(hSPI, PJDF_CTRL_SPI_FILL, &rest, &size);
+        LCD_ILI9341_CS_DEASSERT(); // de-assert LCD SPI
+        if (PJDF_IS_ERROR(retval) || rest.count == 0) break;
+        
+        // let the reserved handle in, then wait for the bus again
+        if (Ioctl(hSPI, PJDF_CTRL_SPI_RELEASE_LOCK, 0, 0) != PJDF_ERR_NONE) while(1);
+        if (Ioctl(hSPI, PJDF_CTRL_SPI_WAIT_FOR_LOCK, 0, 0) != PJDF_ERR_NONE) while(1);
+    }
+    
+    if (Ioctl(hSPI, PJDF_CTRL_SPI_RELEASE_LOCK, 0, 0) != PJDF_ERR_NONE) while(1);
+    return retval;
+}
+
 // IoctlLCD
 // pDriver: pointer to an initialized ILI9341 LCD driver
 // request: a request code chosen from those in pjdfCtrlLcdILI9341.h
 // pArgs [in/out]: pointer to any data needed to fulfill the request
 // pSize: the number of bytes pointed to by pArgs
 // Returns: PJDF_ERR_NONE if there was no error, otherwise an error code.
-static PjdfErrCode IoctlLCD(DriverInternal *pDriver, INT8U request, void* pArgs, INT32U* pSize)
+static PjdfErrCode IoctlLCD(DriverInternal *pDriver, void *pOpen, INT8U request, void* pArgs, INT32U* pSize)
 {
     HANDLE handle;
     PjdfErrCode retval = PJDF_ERR_NONE;
-    PjdfContextLcdILI9341 *pContext = (PjdfContextLcdILI9341*) pDriver->deviceContext;
+    PjdfOpenLcdILI9341 *pContext = (PjdfOpenLcdILI9341*) pOpen;
     switch (request)
     {
     case PJDF_CTRL_LCD_SELECT_COMMAND:
@@ -143,6 +226,13 @@ static PjdfErrCode IoctlLCD(DriverInternal *pDriver, INT8U request, void* pArgs,
         }
         pContext->spiHandle = handle;
         break;
+    case PJDF_CTRL_LCD_FILL:
+        if (*pSize < sizeof(PjdfSpiFill))
+        {
+            return PJDF_ERR_ARG;
+        }
+        retval = FillLCD(pContext, (PjdfSpiFill*)pArgs);
+        break;
     default:
         retval = PJDF_ERR_UNKNOWN_CTRL_REQUEST;
         break;
@@ -160,8 +250,10 @@ PjdfErrCode InitLcdILI9341(DriverInternal *pDriver, char *pName)
     pDriver->sem = OSSemCreate(1); 
     if (pDriver->sem == NULL) while (1);  // not enough semaphores available
     pDriver->refCount = 0; // number of Open handles to the device
-    pDriver->maxRefCount = 1; // only one open handle allowed
-    pDriver->deviceContext = &ili9341Context;
+    pDriver->maxRefCount = LCD_ILI9341_MAX_REFS;
+    pDriver->deviceContext = NULL;
+    pDriver->openContexts = ili9341Opens;
+    pDriver->openContextSize = sizeof(PjdfOpenLcdILI9341);
     
     BspLcdInitILI9341(); // Initialize related GPIO
   
@@ -171,6 +263,7 @@ PjdfErrCode InitLcdILI9341(DriverInternal *pDriver, char *pName)
     pDriver->Read = ReadLCD;
     pDriver->Write = WriteLCD;
     pDriver->Ioctl = IoctlLCD;
+    pDriver->WriteV = WriteVLCD;
     
     pDriver->initialized = OS_TRUE;
     return PJDF_ERR_NONE;
@@ -11,33 +11,44 @@
 #include "bsp.h"
 #include "pjdf.h"
 #include "pjdfInternal.h"
+#include "traceUtil.h"
 
 
-// SPI link, etc for VS1053 MP3 decoder hardware
+// DREQ interrupt etc for VS1053 MP3 decoder hardware
 typedef struct _PjdfContextMp3VS1053
+{
+    OS_EVENT *dreqSem; // posted by the DREQ interrupt
+} PjdfContextMp3VS1053;
+
+// SPI link and modes of one open handle to the VS1053
+typedef struct _PjdfOpenMp3VS1053
 {
     HANDLE spiHandle; // SPI communication link to VS1053
     INT8U chipSelect; // 0 means command, 1 means data
-} PjdfContextMp3VS1053;
+    INT8U dreqInterrupt; // 0 means poll DREQ, 1 means pend on the DREQ interrupt
+} PjdfOpenMp3VS1053;
+
+#define MP3_VS1053_MAX_REFS 1 // only one open handle allowed
 
 static PjdfContextMp3VS1053 mp3VS1053Context = { 0 };
+static PjdfOpenMp3VS1053 mp3VS1053Opens[MP3_VS1053_MAX_REFS];
 
 static const INT16U Mp3SpiDataRate = MP3_SPI_DATARATE;
 static const INT32U SizeofMp3SpiDataRate = sizeof(Mp3SpiDataRate);
 
 // OpenMP3
 // Nothing to do.
-static PjdfErrCode OpenMP3(DriverInternal *pDriver, INT8U flags)
+static PjdfErrCode OpenMP3(DriverInternal *pDriver, void *pOpen, INT8U flags)
 {
     return PJDF_ERR_NONE; 
 }
 
 // CloseMP3
 // Ensure that the dependent SPI handle is closed.
-static PjdfErrCode CloseMP3(DriverInternal *pDriver)
+static PjdfErrCode CloseMP3(DriverInternal *pDriver, void *pOpen)
 {
-    PjdfContextMp3VS1053 *pContext = (PjdfContextMp3VS1053*) pDriver->deviceContext;
-    return Close(pContext->spiHandle);
+    PjdfOpenMp3VS1053 *pOpenMp3 = (PjdfOpenMp3VS1053*) pOpen;
+    return Close(pOpenMp3->spiHandle);
 }
 
 // ReadMP3
@@ -54,11 +65,11 @@ static PjdfErrCode CloseMP3(DriverInternal *pDriver)
 //     the resulting data from the device
 // pCount: the number of bytes to write/read
 // Returns: PJDF_ERR_NONE if there was no error, otherwise an error code.
-static PjdfErrCode ReadMP3(DriverInternal *pDriver, void* pBuffer, INT32U* pCount)
+static PjdfErrCode ReadMP3(DriverInternal *pDriver, void *pOpen, void* pBuffer, INT32U* pCount)
 {
     PjdfErrCode retval;
-    PjdfContextMp3VS1053 *pContext = (PjdfContextMp3VS1053*) pDriver->deviceContext;
-    HANDLE hSPI = pContext->spiHandle;
+    PjdfOpenMp3VS1053 *pOpenMp3 = (PjdfOpenMp3VS1053*) pOpen;
+    HANDLE hSPI = pOpenMp3->spiHandle;
     
     retval = Ioctl(hSPI, PJDF_CTRL_SPI_WAIT_FOR_LOCK, 0, 0);   // wait for exclusive access
     if (retval != PJDF_ERR_NONE) while(1);
@@ -70,7 +81,7 @@ static PjdfErrCode ReadMP3(DriverInternal *pDriver, void* pBuffer, INT32U* pCoun
     // Wait for device ready
     while (!GPIO_ReadInputDataBit(MP3_VS1053_DREQ_GPIO, MP3_VS1053_DREQ_GPIO_Pin));
     
-    switch (pContext->chipSelect) {
+    switch (pOpenMp3->chipSelect) {
     case 0: /* send command */
         MP3_VS1053_MCS_ASSERT(); // assert command chip-select
         retval = Read(hSPI, pBuffer, pCount);
@@ -85,29 +96,55 @@ static PjdfErrCode ReadMP3(DriverInternal *pDriver, void* pBuffer, INT32U* pCoun
 }
 
 
-// WriteMP3
-// Writes the contents of the buffer to the given device.
-// Before writing, select the VS1053 command or data interface by passing one 
-// of the following requests to Ioctl():
-//     PJDF_CTRL_MP3_SELECT_COMMAND
-//     PJDF_CTRL_MP3_SELECT_DATA
-//
-// The above selection will persist until changed by another call to Ioctl()
-//
-// pDriver: pointer to an initialized VS1053 MP3 driver
-// pBuffer: the data to write to the device
-// pCount: the number of bytes to write
-// Returns: PJDF_ERR_NONE if there was no error, otherwise an error code.
-static PjdfErrCode WriteMP3(DriverInternal *pDriver, void* pBuffer, INT32U* pCount)
+// WaitForDreqMP3
+// Blocks the calling task until DREQ is high without holding the SPI lock.
+// The DREQ interrupt is armed before the pin is re-checked so a rising edge
+// between the check and the pend cannot be missed. The pend times out
+// periodically as a guard against a lost edge.
+static void WaitForDreqMP3(PjdfContextMp3VS1053 *pContext)
+{
+    INT8U err;
+    INT16U pends = 0;
+    
+    TRACE(TRACE_EV_DREQ_WAIT, 0, 0);
+    while (!GPIO_ReadInputDataBit(MP3_VS1053_DREQ_GPIO, MP3_VS1053_DREQ_GPIO_Pin))
+    {
+        BspMp3ArmDreqInterrupt();
+        if (GPIO_ReadInputDataBit(MP3_VS1053_DREQ_GPIO, MP3_VS1053_DREQ_GPIO_Pin))
+        {
+            BspMp3DisarmDreqInterrupt();
+            break;
+        }
+        OSSemPend(pContext->dreqSem, MP3_DREQ_WAIT_TIMEOUT, &err);
+        if (err != OS_ERR_NONE && err != OS_ERR_TIMEOUT) while(1);
+        pends++;
+    }
+    
+    // discard a post left over from an edge that raced the re-check above
+    while (OSSemAccept(pContext->dreqSem) > 0);
+    TRACE(TRACE_EV_DREQ_WAIT | TRACE_EXIT, pends, 0);
+}
+
+
+// LockReadyMP3
+// Returns holding the SPI lock, at the VS1053 data rate, with DREQ high.
+// While the VS1053 is busy the lock is not held: the caller either polls
+// DREQ with OSTimeDly() or, after PJDF_CTRL_MP3_DREQ_INTERRUPT, pends on the
+// DREQ interrupt.
+static void LockReadyMP3(PjdfContextMp3VS1053 *pContext, PjdfOpenMp3VS1053 *pOpenMp3)
 {
     PjdfErrCode retval;
-    PjdfContextMp3VS1053 *pContext = (PjdfContextMp3VS1053*) pDriver->deviceContext;
-    HANDLE hSPI = pContext->spiHandle;
+    HANDLE hSPI = pOpenMp3->spiHandle;
+    
+    if (pOpenMp3->dreqInterrupt)
+    {
+        WaitForDreqMP3(pContext);
+    }
     
     retval = Ioctl(hSPI, PJDF_CTRL_SPI_WAIT_FOR_LOCK, 0, 0); // wait for exclusive access
     if (retval != PJDF_ERR_NONE) while(1);
     
-    // Wait for device ready
+    // Wait for device ready (only loops in polling mode)
     while (!GPIO_ReadInputDataBit(MP3_VS1053_DREQ_GPIO, MP3_VS1053_DREQ_GPIO_Pin))
     {
         // Device not ready so release it and delay before trying again
@@ -119,15 +156,21 @@ static PjdfErrCode WriteMP3(DriverInternal *pDriver, void* pBuffer, INT32U* pCou
         retval = Ioctl(hSPI, PJDF_CTRL_SPI_WAIT_FOR_LOCK, 0, 0); // wait for exclusive access
         if (retval != PJDF_ERR_NONE) while(1);
     }
-        
-        
     
     // adjust SPI transmission rate
     retval = Ioctl(hSPI, PJDF_CTRL_SPI_SET_DATARATE, (void*)&Mp3SpiDataRate, (INT32U*)&SizeofMp3SpiDataRate); 
     if (retval != PJDF_ERR_NONE) while(1);
+}
+
 
+// WriteSegmentMP3
+// Sends one buffer to the command (SCI) or data (SDI) interface with its
+// chip select asserted around it. The caller holds the SPI lock.
+static PjdfErrCode WriteSegmentMP3(HANDLE hSPI, INT8U chipSelect, void* pBuffer, INT32U* pCount)
+{
+    PjdfErrCode retval;
     
-    switch (pContext->chipSelect) {
+    switch (chipSelect) {
     case 0: /* send command */
         MP3_VS1053_MCS_ASSERT(); // assert command chip-select
         retval = Write(hSPI, pBuffer, pCount);
@@ -141,8 +184,96 @@ static PjdfErrCode WriteMP3(DriverInternal *pDriver, void* pBuffer, INT32U* pCou
     default:
         while(1);
     }
-    retval = Ioctl(hSPI, PJDF_CTRL_SPI_RELEASE_LOCK, 0, 0);
-    if (retval != PJDF_ERR_NONE) while(1);
+    return retval;
+}
+
+
+// WriteMP3
+// Writes the contents of the buffer to the given device.
+// Before writing, select the VS1053 command or data interface by passing one 
+// of the following requests to Ioctl():
+//     PJDF_CTRL_MP3_SELECT_COMMAND
+//     PJDF_CTRL_MP3_SELECT_DATA
+//
+// The above selection will persist until changed by another call to Ioctl()
+//
+// Data longer than MP3_DECODER_BUF_SIZE is sent MP3_DECODER_BUF_SIZE bytes 
+// each time DREQ is high, keeping the SPI lock for as long as the decoder 
+// keeps accepting, so a whole sector usually refills the FIFO in one hold.
+// While the VS1053 is busy the caller waits as described for LockReadyMP3().
+//
+// pDriver: pointer to an initialized VS1053 MP3 driver
+// pBuffer: the data to write to the device
+// pCount: the number of bytes to write
+// Returns: PJDF_ERR_NONE if there was no error, otherwise an error code.
+static PjdfErrCode WriteMP3(DriverInternal *pDriver, void *pOpen, void* pBuffer, INT32U* pCount)
+{
+    PjdfErrCode retval = PJDF_ERR_NONE;
+    PjdfContextMp3VS1053 *pContext = (PjdfContextMp3VS1053*) pDriver->deviceContext;
+    PjdfOpenMp3VS1053 *pOpenMp3 = (PjdfOpenMp3VS1053*) pOpen;
+    HANDLE hSPI = pOpenMp3->spiHandle;
+    INT8U *pData = (INT8U*) pBuffer;
+    INT32U sent;
+    INT32U chunk;
+    
+    LockReadyMP3(pContext, pOpenMp3);
+    if (pOpenMp3->chipSelect == 0)
+    {
+        retval = WriteSegmentMP3(hSPI, 0, pBuffer, pCount);
+    }
+    else
+    {
+        for (sent = 0; sent < *pCount; sent += chunk)
+        {
+            if (sent > 0 && !GPIO_ReadInputDataBit(MP3_VS1053_DREQ_GPIO, MP3_VS1053_DREQ_GPIO_Pin))
+            {
+                if (Ioctl(hSPI, PJDF_CTRL_SPI_RELEASE_LOCK, 0, 0) != PJDF_ERR_NONE) while(1);
+                LockReadyMP3(pContext, pOpenMp3);
+            }
+            chunk = *pCount - sent;
+            if (chunk > MP3_DECODER_BUF_SIZE) chunk = MP3_DECODER_BUF_SIZE;
+            retval = WriteSegmentMP3(hSPI, 1, &pData[sent], &chunk);
+            if (PJDF_IS_ERROR(retval)) break;
+        }
+    }
+    if (Ioctl(hSPI, PJDF_CTRL_SPI_RELEASE_LOCK, 0, 0) != PJDF_ERR_NONE) while(1);
+    return retval;
+}
+
+
+// WriteVMP3
+// Writes the segments to the SCI (PJDF_SEG_COMMAND) or SDI (data) interface
+// under one SPI lock. The VS1053 needs its chip select raised after every
+// SCI command and DREQ high before the next one, so each segment gets its
+// own chip select assertion and DREQ is checked between segments; the lock
+// is only given up if the VS1053 is still busy, e.g. after a soft reset.
+// The Ioctl() selected interface of the handle is not changed.
+//
+// pDriver: pointer to an initialized VS1053 MP3 driver
+// pSegments: the segments to write in order
+// count: the number of segments
+// Returns: PJDF_ERR_NONE if there was no error, otherwise an error code.
+static PjdfErrCode WriteVMP3(DriverInternal *pDriver, void *pOpen, PjdfSegment *pSegments, INT8U count)
+{
+    PjdfErrCode retval = PJDF_ERR_NONE;
+    PjdfContextMp3VS1053 *pContext = (PjdfContextMp3VS1053*) pDriver->deviceContext;
+    PjdfOpenMp3VS1053 *pOpenMp3 = (PjdfOpenMp3VS1053*) pOpen;
+    HANDLE hSPI = pOpenMp3->spiHandle;
+    INT8U i;
+    
+    LockReadyMP3(pContext, pOpenMp3);
+    for (i = 0; i < count; i++)
+    {
+        if (i > 0 && !GPIO_ReadInputDataBit(MP3_VS1053_DREQ_GPIO, MP3_VS1053_DREQ_GPIO_Pin))
+        {
+            if (Ioctl(hSPI, PJDF_CTRL_SPI_RELEASE_LOCK, 0, 0) != PJDF_ERR_NONE) while(1);
+            LockReadyMP3(pContext, pOpenMp3);
+        }
+        retval = WriteSegmentMP3(hSPI, (pSegments[i].flags & PJDF_SEG_COMMAND) ? 0 : 1,
+            pSegments[i].pBuffer, &pSegments[i].length);
+        if (PJDF_IS_ERROR(retval)) break;
+    }
+    if (Ioctl(hSPI, PJDF_CTRL_SPI_RELEASE_LOCK, 0, 0) != PJDF_ERR_NONE) while(1);
     return retval;
 }
 
@@ -152,18 +283,27 @@ static PjdfErrCode WriteMP3(DriverInternal *pDriver, void* pBuffer, INT32U* pCou
 // pArgs [in/out]: pointer to any data needed to fulfill the request
 // pSize: the number of bytes pointed to by pArgs
 // Returns: PJDF_ERR_NONE if there was no error, otherwise an error code.
-static PjdfErrCode IoctlMP3(DriverInternal *pDriver, INT8U request, void* pArgs, INT32U* pSize)
+static PjdfErrCode IoctlMP3(DriverInternal *pDriver, void *pOpen, INT8U request, void* pArgs, INT32U* pSize)
 {
     HANDLE handle;
+    BOOLEAN reserved;
+    INT32U size;
     PjdfErrCode retval = PJDF_ERR_NONE;
-    PjdfContextMp3VS1053 *pContext = (PjdfContextMp3VS1053*) pDriver->deviceContext;
+    PjdfOpenMp3VS1053 *pOpenMp3 = (PjdfOpenMp3VS1053*) pOpen;
     switch (request)
     {
     case PJDF_CTRL_MP3_SELECT_COMMAND:
-        pContext->chipSelect = 0;
+        pOpenMp3->chipSelect = 0;
         break;
     case PJDF_CTRL_MP3_SELECT_DATA:
-        pContext->chipSelect = 1;
+        pOpenMp3->chipSelect = 1;
+        break;
+    case PJDF_CTRL_MP3_DREQ_INTERRUPT:
+        pOpenMp3->dreqInterrupt = 1;
+        break;
+    case PJDF_CTRL_MP3_DREQ_POLL:
+        pOpenMp3->dreqInterrupt = 0;
+        BspMp3DisarmDreqInterrupt();
         break;
     case PJDF_CTRL_MP3_SET_SPI_HANDLE:
         if (*pSize < sizeof(HANDLE))
@@ -175,7 +315,12 @@ static PjdfErrCode IoctlMP3(DriverInternal *pDriver, INT8U request, void* pArgs,
         {
             return PJDF_ERR_INVALID_HANDLE;
         }
-        pContext->spiHandle = handle;
+        pOpenMp3->spiHandle = handle;
+        
+        // the decoder FIFO must not run dry behind a long LCD fill
+        reserved = OS_TRUE;
+        size = sizeof(reserved);
+        retval = Ioctl(handle, PJDF_CTRL_SPI_SET_RESERVED, &reserved, &size);
         break;
     default:
         retval = PJDF_ERR_UNKNOWN_CTRL_REQUEST;
@@ -194,10 +339,17 @@ PjdfErrCode InitMp3VS1053(DriverInternal *pDriver, char *pName)
     pDriver->sem = OSSemCreate(1); 
     if (pDriver->sem == NULL) while (1);  // not enough semaphores available
     pDriver->refCount = 0; // number of Open handles to the device
-    pDriver->maxRefCount = 1; // only one open handle allowed
+    pDriver->maxRefCount = MP3_VS1053_MAX_REFS;
     pDriver->deviceContext = &mp3VS1053Context;
+    pDriver->openContexts = mp3VS1053Opens;
+    pDriver->openContextSize = sizeof(PjdfOpenMp3VS1053);
     
     BspMp3InitVS1053(); // Initialize related GPIO
+    
+    // Initialize semaphore posted by the DREQ interrupt
+    mp3VS1053Context.dreqSem = OSSemCreate(0);
+    if (mp3VS1053Context.dreqSem == NULL) while (1);  // not enough semaphores available
+    BspMp3InitDreqInterrupt(mp3VS1053Context.dreqSem);
   
     // Assign implemented functions to the interface pointers
     pDriver->Open = OpenMP3;
@@ -205,6 +357,7 @@ PjdfErrCode InitMp3VS1053(DriverInternal *pDriver, char *pName)
     pDriver->Read = ReadMP3;
     pDriver->Write = WriteMP3;
     pDriver->Ioctl = IoctlMP3;
+    pDriver->WriteV = WriteVMP3;
     
     pDriver->initialized = OS_TRUE;
     return PJDF_ERR_NONE;
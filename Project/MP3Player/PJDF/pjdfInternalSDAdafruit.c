@@ -13,31 +13,33 @@
 #include "pjdfInternal.h"
 
 
-// SPI link, etc for SD hardware
-typedef struct _PjdfContextSD
+// SPI link, etc of one open handle to the SD card
+typedef struct _PjdfOpenSD
 {
     HANDLE spiHandle; // SPI communication link to SD card on Adafruit shield
     BOOLEAN spiLocked; // true iff we have exclusive access to the SPI
     BOOLEAN csAsserted; // true iff SPI chip select is asserted
-} PjdfContextSD;
+} PjdfOpenSD;
 
-static PjdfContextSD SDContext = { 0 };
+#define SD_MAX_REFS 1 // only one open handle allowed
+
+static PjdfOpenSD SDOpens[SD_MAX_REFS];
 
 static const INT16U SDSpiDataRate = SD_SPI_DATARATE;
 static const INT32U SizeofSDSpiDataRate = sizeof(SDSpiDataRate);
 
 // OpenSDAdafruit
 // Nothing to do.
-static PjdfErrCode OpenSDAdafruit(DriverInternal *pDriver, INT8U flags)
+static PjdfErrCode OpenSDAdafruit(DriverInternal *pDriver, void *pOpen, INT8U flags)
 {
     return PJDF_ERR_NONE; 
 }
 
 // CloseSDAdafruit
 // Ensure that the dependent SPI handle is closed.
-static PjdfErrCode CloseSDAdafruit(DriverInternal *pDriver)
+static PjdfErrCode CloseSDAdafruit(DriverInternal *pDriver, void *pOpen)
 {
-    PjdfContextSD *pContext = (PjdfContextSD*) pDriver->deviceContext;
+    PjdfOpenSD *pContext = (PjdfOpenSD*) pOpen;
     return Close(pContext->spiHandle);
 }
 
@@ -57,10 +59,10 @@ static PjdfErrCode CloseSDAdafruit(DriverInternal *pDriver)
 //     the resulting data from the device
 // pCount: the number of bytes to write/read
 // Returns: PJDF_ERR_NONE if there was no error, otherwise an error code.
-static PjdfErrCode ReadSDAdafruit(DriverInternal *pDriver, void* pBuffer, INT32U* pCount)
+static PjdfErrCode ReadSDAdafruit(DriverInternal *pDriver, void *pOpen, void* pBuffer, INT32U* pCount)
 {
     PjdfErrCode retval;
-    PjdfContextSD *pContext = (PjdfContextSD*) pDriver->deviceContext;
+    PjdfOpenSD *pContext = (PjdfOpenSD*) pOpen;
     HANDLE hSPI = pContext->spiHandle;
     
     if (!pContext->spiLocked) while(1);
@@ -89,10 +91,10 @@ static PjdfErrCode ReadSDAdafruit(DriverInternal *pDriver, void* pBuffer, INT32U
 // pBuffer: the data to write to the device
 // pCount: the number of bytes to write
 // Returns: PJDF_ERR_NONE if there was no error, otherwise an error code.
-static PjdfErrCode WriteSDAdafruit(DriverInternal *pDriver, void* pBuffer, INT32U* pCount)
+static PjdfErrCode WriteSDAdafruit(DriverInternal *pDriver, void *pOpen, void* pBuffer, INT32U* pCount)
 {
     PjdfErrCode retval;
-    PjdfContextSD *pContext = (PjdfContextSD*) pDriver->deviceContext;
+    PjdfOpenSD *pContext = (PjdfOpenSD*) pOpen;
     HANDLE hSPI = pContext->spiHandle;
     
     if (!pContext->spiLocked) while(1);
@@ -113,11 +115,11 @@ static PjdfErrCode WriteSDAdafruit(DriverInternal *pDriver, void* pBuffer, INT32
 // pArgs [in/out]: pointer to any data needed to fulfill the request
 // pSize: the number of bytes pointed to by pArgs
 // Returns: PJDF_ERR_NONE if there was no error, otherwise an error code.
-static PjdfErrCode IoctlSDAdafruit(DriverInternal *pDriver, INT8U request, void* pArgs, INT32U* pSize)
+static PjdfErrCode IoctlSDAdafruit(DriverInternal *pDriver, void *pOpen, INT8U request, void* pArgs, INT32U* pSize)
 {
     HANDLE handle;
     PjdfErrCode retval = PJDF_ERR_NONE;
-    PjdfContextSD *pContext = (PjdfContextSD*) pDriver->deviceContext;
+    PjdfOpenSD *pContext = (PjdfOpenSD*) pOpen;
     switch (request)
     {
     case PJDF_CTRL_SD_ASSERT_CS:
@@ -172,8 +174,10 @@ PjdfErrCode InitSDAdafruit(DriverInternal *pDriver, char *pName)
     pDriver->sem = OSSemCreate(1); 
     if (pDriver->sem == NULL) while (1);  // not enough semaphores available
     pDriver->refCount = 0; // number of Open handles to the device
-    pDriver->maxRefCount = 1; // only one open handle allowed
-    pDriver->deviceContext = &SDContext;
+    pDriver->maxRefCount = SD_MAX_REFS;
+    pDriver->deviceContext = NULL;
+    pDriver->openContexts = SDOpens;
+    pDriver->openContextSize = sizeof(PjdfOpenSD);
     
     BspSDInitAdafruit(); // Initialize related GPIO
   
@@ -16,15 +16,29 @@
 typedef struct _PjdfContextSpi
 {
     SPI_TypeDef *spiMemMap; // Memory mapped register block for a SPI interface
+    OS_EVENT *dmaIdleSem; // count is 1 while no DMA transfer is in flight
+    OS_EVENT *dmaDoneSem; // posted when a blocking DMA transfer completes
+    INT16U fillValue; // DMA source of the fill in progress
+    INT8U reservedWaiting; // reserved handles pending on the bus lock
 } PjdfContextSpi;
 
-static PjdfContextSpi spi1Context = { PJDF_SPI1 };
+// State of one open handle to a SPI interface
+typedef struct _PjdfOpenSpi
+{
+    OS_EVENT *asyncSem; // caller's completion semaphore, NULL for blocking transfers
+    BOOLEAN reserved; // true iff fills on other handles give way while this one waits for the lock
+} PjdfOpenSpi;
+
+#define SPI1_MAX_REFS 10 // Maximum refcount allowed for SPI1
+
+static PjdfContextSpi spi1Context = { PJDF_SPI1, NULL, NULL, 0, 0 };
+static PjdfOpenSpi spi1Opens[SPI1_MAX_REFS];
 
 
 
 // OpenSPI
 // No special action required to open SPI device
-static PjdfErrCode OpenSPI(DriverInternal *pDriver, INT8U flags)
+static PjdfErrCode OpenSPI(DriverInternal *pDriver, void *pOpen, INT8U flags)
 {
     // Nothing to do
     return PJDF_ERR_NONE;
@@ -32,12 +46,107 @@ static PjdfErrCode OpenSPI(DriverInternal *pDriver, INT8U flags)
 
 // CloseSPI
 // No special action required to close SPI device
-static PjdfErrCode CloseSPI(DriverInternal *pDriver)
+static PjdfErrCode CloseSPI(DriverInternal *pDriver, void *pOpen)
 {
     // Nothing to do
     return PJDF_ERR_NONE;
 }
 
+// TransferSPI
+// Moves the buffer over the SPI link. Transfers of at least SPI_DMA_MIN_LENGTH
+// bytes go through DMA and the calling task sleeps until the transfer completes,
+// or, if an async semaphore has been set, returns immediately and the semaphore
+// is posted on completion. Shorter transfers are polled, and the async semaphore
+// (if any) is posted before returning so callers see the same completion signal.
+// asyncSem: the async semaphore of the calling handle, or NULL
+// receive: if true the buffer is OVERWRITTEN with the data output by the device
+static void TransferSPI(PjdfContextSpi *pContext, OS_EVENT *asyncSem, INT8U *pBuffer, INT32U count, BOOLEAN receive)
+{
+    INT8U osErr;
+    
+    // Wait for the previous async transfer to release the bus
+    OSSemPend(pContext->dmaIdleSem, 0, &osErr);
+    if (osErr != OS_ERR_NONE) while(1);
+    
+    if (count < SPI_DMA_MIN_LENGTH || count > SPI_DMA_MAX_LENGTH || OSRunning != OS_TRUE)
+    {
+        if (receive)
+            SPI_GetBuffer(pContext->spiMemMap, pBuffer, count);
+        else
+            SPI_SendBuffer(pContext->spiMemMap, pBuffer, count);
+        OSSemPost(pContext->dmaIdleSem);
+        if (asyncSem != NULL) OSSemPost(asyncSem);
+        return;
+    }
+    
+    if (asyncSem != NULL)
+    {
+        SPI_StartDMA(pContext->spiMemMap, pBuffer, count, receive, asyncSem);
+        return;
+    }
+    
+    SPI_StartDMA(pContext->spiMemMap, pBuffer, count, receive, pContext->dmaDoneSem);
+    OSSemPend(pContext->dmaDoneSem, 0, &osErr);
+    if (osErr != OS_ERR_NONE) while(1);
+}
+
+// FillSPI
+// Sends pFill->count copies of the 16 bit value. Fills of at least 
+// SPI_DMA_MIN_LENGTH values go through DMA from a fixed source address, in 
+// slices of SPI_FILL_SLICE_LENGTH, while the calling task sleeps. If a 
+// reserved handle is waiting for the lock after a slice, the fill stops
+// and pFill->count is left holding the values not sent. Shorter fills are 
+// sent by a polled loop. Fills always block; the async semaphore (if any)
+// is posted before returning so callers see the same completion signal.
+static void FillSPI(PjdfContextSpi *pContext, PjdfOpenSpi *pOpenSpi, PjdfSpiFill *pFill)
+{
+    INT8U osErr;
+    INT32U count = pFill->count;
+    INT32U chunk;
+    
+    OSSemPend(pContext->dmaIdleSem, 0, &osErr);
+    if (osErr != OS_ERR_NONE) while(1);
+    
+    if (count < SPI_DMA_MIN_LENGTH || OSRunning != OS_TRUE)
+    {
+        SPI_FillBuffer(pContext->spiMemMap, pFill->value, count);
+        OSSemPost(pContext->dmaIdleSem);
+        count = 0;
+    }
+    else
+    {
+        pContext->fillValue = pFill->value;
+        while (1)
+        {
+            chunk = (count > SPI_FILL_SLICE_LENGTH) ? SPI_FILL_SLICE_LENGTH : count;
+            SPI_StartDMAFill(pContext->spiMemMap, &pContext->fillValue, chunk, pContext->dmaDoneSem);
+            OSSemPend(pContext->dmaDoneSem, 0, &osErr);
+            if (osErr != OS_ERR_NONE) while(1);
+            count -= chunk;
+            if (count == 0) break;
+            
+            // give way to the decoder (the completion interrupt has already posted dmaIdleSem)
+            if (pContext->reservedWaiting != 0 && !pOpenSpi->reserved) break;
+            
+            // the completion interrupt also posted dmaIdleSem, take it back for the next chunk
+            OSSemPend(pContext->dmaIdleSem, 0, &osErr);
+            if (osErr != OS_ERR_NONE) while(1);
+        }
+    }
+    pFill->count = count;
+    if (pOpenSpi->asyncSem != NULL) OSSemPost(pOpenSpi->asyncSem);
+}
+
+// WaitForDmaSPI
+// Blocks until any DMA transfer in flight has completed.
+static void WaitForDmaSPI(PjdfContextSpi *pContext)
+{
+    INT8U osErr;
+    OSSemPend(pContext->dmaIdleSem, 0, &osErr);
+    if (osErr != OS_ERR_NONE) while(1);
+    OSSemPost(pContext->dmaIdleSem);
+}
+
 // ReadSPI
 // Writes the contents of the buffer to the given device while concurrently reading
 // the full duplex output of the device. The caller must first
@@ -48,11 +157,13 @@ static PjdfErrCode CloseSPI(DriverInternal *pDriver)
 //     note: the buffer must not reside in readonly memory.
 // pCount: the number of bytes to write/read.
 // Returns: PJDF_ERR_NONE if there was no error, otherwise an error code.
-static PjdfErrCode ReadSPI(DriverInternal *pDriver, void* pBuffer, INT32U* pCount)
+//     In async mode the buffer is not valid, and the chip select must stay
+//     asserted, until the async semaphore is posted (see pjdfCtrlSpi.h).
+static PjdfErrCode ReadSPI(DriverInternal *pDriver, void *pOpen, void* pBuffer, INT32U* pCount)
 {
     PjdfContextSpi *pContext = (PjdfContextSpi*) pDriver->deviceContext;
     if (pContext == NULL) while(1);
-    SPI_GetBuffer(pContext->spiMemMap, (INT8U*) pBuffer, *pCount);
+    TransferSPI(pContext, ((PjdfOpenSpi*) pOpen)->asyncSem, (INT8U*) pBuffer, *pCount, OS_TRUE);
     return PJDF_ERR_NONE;
 }
 
@@ -65,33 +176,72 @@ static PjdfErrCode ReadSPI(DriverInternal *pDriver, void* pBuffer, INT32U* pCoun
 // pBuffer: the data to write to the device
 // pCount: the number of bytes to write
 // Returns: PJDF_ERR_NONE if there was no error, otherwise an error code.
-static PjdfErrCode WriteSPI(DriverInternal *pDriver, void* pBuffer, INT32U* pCount)
+//     In async mode the buffer must not be reused, and the chip select must
+//     stay asserted, until the async semaphore is posted (see pjdfCtrlSpi.h).
+static PjdfErrCode WriteSPI(DriverInternal *pDriver, void *pOpen, void* pBuffer, INT32U* pCount)
 {
     PjdfContextSpi *pContext = (PjdfContextSpi*) pDriver->deviceContext;
     if (pContext == NULL) while(1);
-    SPI_SendBuffer(pContext->spiMemMap, (INT8U*) pBuffer, *pCount);
+    TransferSPI(pContext, ((PjdfOpenSpi*) pOpen)->asyncSem, (INT8U*) pBuffer, *pCount, OS_FALSE);
     return PJDF_ERR_NONE;
 }
 
 // IoctlSPI
 // Handles the request codes defined in pjdfCtrlSpi.h
-static PjdfErrCode IoctlSPI(DriverInternal *pDriver, INT8U request, void* pArgs, INT32U* pSize)
+//
+// The bus lock is a mutex with a priority ceiling (see PjdfCreateBusLock()),
+// so a release hands it straight to the highest priority task waiting for it,
+// and while that task waits the holder runs at the ceiling. Reserved handles
+// are counted while they wait so that a fill holding the bus can stop at the
+// end of its current slice.
+static PjdfErrCode IoctlSPI(DriverInternal *pDriver, void *pOpen, INT8U request, void* pArgs, INT32U* pSize)
 {
-    INT8U osErr;
+    OS_CPU_SR cpu_sr;
     PjdfContextSpi *pContext = (PjdfContextSpi*) pDriver->deviceContext;
+    PjdfOpenSpi *pOpenSpi = (PjdfOpenSpi*) pOpen;
     if (pContext == NULL) while(1);
     switch (request)
     {
     case PJDF_CTRL_SPI_WAIT_FOR_LOCK:
-        OSSemPend(pDriver->sem, 0, &osErr);
+        if (!pOpenSpi->reserved)
+        {
+            PjdfLock(pDriver);
+            break;
+        }
+        OS_ENTER_CRITICAL();
+        pContext->reservedWaiting++;
+        OS_EXIT_CRITICAL();
+        PjdfLock(pDriver);
+        OS_ENTER_CRITICAL();
+        pContext->reservedWaiting--;
+        OS_EXIT_CRITICAL();
         break;
     case PJDF_CTRL_SPI_RELEASE_LOCK:
-        osErr = OSSemPost(pDriver->sem);
+        // The next lock holder must not find the bus busy
+        WaitForDmaSPI(pContext);
+        PjdfUnlock(pDriver);
         break;
     case PJDF_CTRL_SPI_SET_DATARATE: // Call BSP code to adjust transmission speed of SPI
         if (*pSize != sizeof(INT16U)) while (1);
+        WaitForDmaSPI(pContext); // don't change the clock under a transfer
         SPI_SetDataRate(pContext->spiMemMap, *(INT16U*)pArgs);
         break;
+    case PJDF_CTRL_SPI_SET_ASYNC: // pArgs points to the OS_EVENT* to post, which may be NULL
+        if (*pSize != sizeof(OS_EVENT*)) while (1);
+        WaitForDmaSPI(pContext);
+        pOpenSpi->asyncSem = *(OS_EVENT**)pArgs;
+        break;
+    case PJDF_CTRL_SPI_WAIT_FOR_DMA:
+        WaitForDmaSPI(pContext);
+        break;
+    case PJDF_CTRL_SPI_FILL: // pArgs points to a PjdfSpiFill
+        if (*pSize != sizeof(PjdfSpiFill)) while (1);
+        FillSPI(pContext, pOpenSpi, (PjdfSpiFill*)pArgs);
+        break;
+    case PJDF_CTRL_SPI_SET_RESERVED: // pArgs points to a BOOLEAN
+        if (*pSize != sizeof(BOOLEAN)) while (1);
+        pOpenSpi->reserved = *(BOOLEAN*)pArgs;
+        break;
     default:
         while(1);
         break;
@@ -105,9 +255,8 @@ PjdfErrCode InitSPI(DriverInternal *pDriver, char *pName)
 {   
     if (strcmp (pName, pDriver->pName) != 0) while(1); // pName should have been initialized in driversInternal[] declaration
     
-    // Initialize semaphore for serializing operations on the device 
-    pDriver->sem = OSSemCreate(1); 
-    if (pDriver->sem == NULL) while (1);  // not enough semaphores available
+    // Initialize the bus lock for serializing operations on the device
+    pDriver->sem = PjdfCreateBusLock();
     pDriver->refCount = 0; // initial number of Open handles to the device
     
     // We may choose to handle multiple hardware instances of the SPI interface
@@ -115,9 +264,16 @@ PjdfErrCode InitSPI(DriverInternal *pDriver, char *pName)
     // the context of the SPI hardware instance specified by pName.
     if (strcmp(pName, PJDF_DEVICE_ID_SPI1) == 0)
     {
-        pDriver->maxRefCount = 10; // Maximum refcount allowed for the device
+        pDriver->maxRefCount = SPI1_MAX_REFS; // Maximum refcount allowed for the device
         pDriver->deviceContext = (void*) &spi1Context;
+        pDriver->openContexts = (void*) spi1Opens;
+        pDriver->openContextSize = sizeof(PjdfOpenSpi);
         BspSPI1Init(); // init SPI1 hardware
+        
+        spi1Context.dmaIdleSem = OSSemCreate(1);
+        spi1Context.dmaDoneSem = OSSemCreate(0);
+        if (spi1Context.dmaIdleSem == NULL || spi1Context.dmaDoneSem == NULL) while (1);  // not enough semaphores available
+        BspSPI1InitDMA(spi1Context.dmaIdleSem); // init SPI1 DMA streams
     }
   
     // Assign implemented functions to the interface pointers
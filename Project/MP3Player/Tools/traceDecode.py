@@ -0,0 +1,193 @@
+#!/usr/bin/env python3
+"""
+    traceDecode.py
+    Turns the output of the shell "trace" command (TraceDump() in
+    App/traceUtil.c) into a Chrome trace / Perfetto JSON timeline.
+
+    Usage: traceDecode.py [capture.txt] [trace.json]
+        capture.txt  serial console log containing a dump, default stdin
+        trace.json   output, default stdout; open it in ui.perfetto.dev
+                     or chrome://tracing
+
+    The "CPU" process shows which task ran when, one thread per priority,
+    plus the ISRs. The "Calls" process shows semaphore and mutex pends, PJDF
+    calls, DREQ waits and SD commands of each task.
+
+    The last field of an entry is as wide as a pointer on the machine that
+    recorded it: 8 hex digits on the target, 16 on a 64 bit host build.
+
+    2026/10 written for the MP3Player project
+"""
+
+import json
+import sys
+
+# Keep in sync with App/traceUtil.h
+TRACE_EXIT = 0x80
+TRACE_EV_TASK_SWITCH = 0x01
+TRACE_EV_ISR = 0x02
+TRACE_EV_SEM_PEND = 0x03
+TRACE_EV_SEM_POST = 0x04
+TRACE_EV_PJDF_OPEN = 0x05
+TRACE_EV_PJDF_READ = 0x06
+TRACE_EV_PJDF_WRITE = 0x07
+TRACE_EV_PJDF_IOCTL = 0x08
+TRACE_EV_DREQ_WAIT = 0x09
+TRACE_EV_SD_CMD = 0x0A
+TRACE_EV_PJDF_WRITEV = 0x0B
+
+PID_CPU = 1
+PID_CALLS = 2
+TID_ISR = 1000
+
+
+def read_dump(lines):
+    """Returns (cycles per second, [(time, event, prio, arg16, arg, argBits)]) of the last dump in lines."""
+    dump = None
+    entries = None
+    for line in lines:
+        fields = line.strip().split()
+        if not fields:
+            continue
+        if fields[0] == "TRACE":
+            if len(fields) >= 2 and fields[1] == "END":
+                if entries is not None:
+                    dump = (cyclesPerSec, entries)
+                entries = None
+            elif len(fields) == 3:
+                cyclesPerSec = int(fields[1])
+                entries = []
+            continue
+        if entries is not None and len(fields) == 5:
+            try:
+                entries.append(tuple(int(f, 16) for f in fields) + (4 * len(fields[4]),))
+            except ValueError:
+                pass  # line garbled on the serial link
+    if dump is None:
+        sys.exit("traceDecode: no complete TRACE ... TRACE END dump found")
+    return dump
+
+
+def isr_name(exception):
+    if exception == 15:
+        return "SysTick"
+    if exception >= 16:
+        return "IRQ %d" % (exception - 16)
+    return "exception %d" % exception
+
+
+def call_name(event, prio, arg16, arg):
+    if event == TRACE_EV_SEM_PEND:
+        return "Pend 0x%x" % arg, {"timeout": arg16}
+    if event == TRACE_EV_PJDF_OPEN:
+        return "Open", {"name": "0x%x" % arg}
+    if event == TRACE_EV_PJDF_READ:
+        return "Read h%d" % arg16, {"length": arg}
+    if event == TRACE_EV_PJDF_WRITE:
+        return "Write h%d" % arg16, {"length": arg}
+    if event == TRACE_EV_PJDF_IOCTL:
+        return "Ioctl h%d" % arg16, {"request": "0x%02x" % arg}
+    if event == TRACE_EV_DREQ_WAIT:
+        return "DREQ wait", {}
+    if event == TRACE_EV_SD_CMD:
+        return "CMD%d" % arg16, {"arg": "0x%08x" % arg}
+    if event == TRACE_EV_PJDF_WRITEV:
+        return "WriteV h%d" % arg16, {"segments": arg}
+    return "event 0x%02x" % event, {}
+
+
+def exit_args(event, arg16, arg, argBits):
+    if event == TRACE_EV_SEM_PEND:
+        return {"err": arg16}
+    if event == TRACE_EV_PJDF_OPEN:
+        return {"result": arg16 - 0x10000 if arg16 & 0x8000 else arg16}
+    if event in (TRACE_EV_PJDF_READ, TRACE_EV_PJDF_WRITE, TRACE_EV_PJDF_IOCTL, TRACE_EV_PJDF_WRITEV):
+        return {"result": arg - (1 << argBits) if arg >> (argBits - 1) else arg}
+    if event == TRACE_EV_DREQ_WAIT:
+        return {"pends": arg16}
+    if event == TRACE_EV_SD_CMD:
+        return {"status": "0x%02x" % arg16}
+    return {}
+
+
+def decode(cyclesPerSec, entries):
+    out = []
+    if not entries:
+        return out
+
+    cycles = 0
+    last = entries[0][0]
+    running = entries[0][2]
+    runStart = 0.0
+    isrDepth = 0
+    depth = {}   # open B events per (pid, tid), unmatched E events are dropped
+    prios = set([running])
+
+    def begin(ts, pid, tid, name, args):
+        depth[(pid, tid)] = depth.get((pid, tid), 0) + 1
+        out.append({"ph": "B", "ts": ts, "pid": pid, "tid": tid, "name": name, "args": args})
+
+    def end(ts, pid, tid, args):
+        if depth.get((pid, tid), 0) == 0:
+            return
+        depth[(pid, tid)] -= 1
+        out.append({"ph": "E", "ts": ts, "pid": pid, "tid": tid, "args": args})
+
+    for time, event, prio, arg16, arg, argBits in entries:
+        cycles += (time - last) & 0xFFFFFFFF
+        last = time
+        ts = cycles * 1e6 / cyclesPerSec
+        exiting = event & TRACE_EXIT
+        event &= ~TRACE_EXIT
+        prios.add(prio)
+
+        if event == TRACE_EV_TASK_SWITCH:
+            out.append({"ph": "X", "ts": runStart, "dur": ts - runStart, "pid": PID_CPU, "tid": prio,
+                        "name": "prio %d" % prio})
+            running = arg16
+            runStart = ts
+            prios.add(running)
+        elif event == TRACE_EV_ISR:
+            if exiting:
+                isrDepth = max(isrDepth - 1, 0)
+                end(ts, PID_CPU, TID_ISR, {})
+            else:
+                isrDepth += 1
+                begin(ts, PID_CPU, TID_ISR, isr_name(arg16), {"task": prio})
+        elif event == TRACE_EV_SEM_POST:
+            tid = TID_ISR if isrDepth else prio
+            pid = PID_CPU if isrDepth else PID_CALLS
+            out.append({"ph": "i", "s": "t", "ts": ts, "pid": pid, "tid": tid,
+                        "name": "Post 0x%x" % arg})
+        elif exiting:
+            end(ts, PID_CALLS, prio, exit_args(event, arg16, arg, argBits))
+        else:
+            name, args = call_name(event, prio, arg16, arg)
+            begin(ts, PID_CALLS, prio, name, args)
+
+    out.append({"ph": "X", "ts": runStart, "dur": ts - runStart, "pid": PID_CPU, "tid": running,
+                "name": "prio %d" % running})
+
+    out.append({"ph": "M", "pid": PID_CPU, "name": "process_name", "args": {"name": "CPU"}})
+    out.append({"ph": "M", "pid": PID_CALLS, "name": "process_name", "args": {"name": "Calls"}})
+    out.append({"ph": "M", "pid": PID_CPU, "tid": TID_ISR, "name": "thread_name", "args": {"name": "ISR"}})
+    for prio in sorted(prios):
+        for pid in (PID_CPU, PID_CALLS):
+            out.append({"ph": "M", "pid": pid, "tid": prio, "name": "thread_name",
+                        "args": {"name": "prio %d" % prio}})
+            out.append({"ph": "M", "pid": pid, "tid": prio, "name": "thread_sort_index",
+                        "args": {"sort_index": prio}})
+    return out
+
+
+def main(argv):
+    source = open(argv[1], errors="replace") if len(argv) > 1 else sys.stdin
+    cyclesPerSec, entries = read_dump(source)
+    events = decode(cyclesPerSec, entries)
+    sink = open(argv[2], "w") if len(argv) > 2 else sys.stdout
+    json.dump({"traceEvents": events, "displayTimeUnit": "ns"}, sink)
+    sink.write("\n")
+
+
+if __name__ == "__main__":
+    main(sys.argv)
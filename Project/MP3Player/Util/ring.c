@@ -0,0 +1,182 @@
+/*
+    ring.c
+    Lock-free single-producer/single-consumer ring of bytes or fixed-size
+    records.
+
+    head is only written by the producer and tail only by the consumer, and
+    each is published after the data it covers, so neither side needs a
+    critical section: an ISR can put while a task gets, or the other way
+    round. There must be only one producer and one consumer at a time.
+
+    RingPut() and RingGet() move all of the given bytes or none, so rings of
+    fixed-size records never show a partial record. A consumer task can wait
+    with RingPend() for a number of bytes; the producer posts the ring's
+    semaphore once that many are available.
+
+    2026/10 written for the MP3Player project
+*/
+
+#include "bsp.h"
+#include "ring.h"
+
+
+// Initializes an empty ring on pBuf, whose size must be a power of 2.
+// pend: OS_TRUE to create the semaphore RingPend() waits on, which needs
+//     OSInit() to have been called
+void RingInit(Ring *pRing, INT8U *pBuf, INT16U size, BOOLEAN pend)
+{
+    if (size == 0 || (size & (size - 1)) != 0 || size > 0x8000) while(1);
+
+    pRing->pBuf = pBuf;
+    pRing->size = size;
+    pRing->head = 0;
+    pRing->tail = 0;
+    pRing->want = 0;
+    pRing->dataSem = NULL;
+    if (pend)
+    {
+        pRing->dataSem = OSSemCreate(0);
+        if (pRing->dataSem == NULL) while(1);  // not enough semaphores available
+    }
+}
+
+
+// Returns the bytes waiting to be taken. The consumer may find more, the
+// producer fewer, by the time it acts on the result.
+INT16U RingCount(Ring *pRing)
+{
+    return (INT16U)(pRing->head - pRing->tail);
+}
+
+
+// Returns the bytes that can be put. The producer may find more, the
+// consumer fewer, by the time it acts on the result.
+INT16U RingSpace(Ring *pRing)
+{
+    return (INT16U)(pRing->size - (INT16U)(pRing->head - pRing->tail));
+}
+
+
+// Called by the producer after publishing head: wakes RingPend() if it now
+// has what it is waiting for
+static void RingSignal(Ring *pRing)
+{
+    INT16U want;
+
+    if (pRing->dataSem == NULL) return;
+    RING_BARRIER();  // head before want, pairs with the barrier in RingPend()
+    want = pRing->want;
+    if (want != 0 && RingCount(pRing) >= want)
+    {
+        pRing->want = 0;
+        OSSemPost(pRing->dataSem);
+    }
+}
+
+
+// Puts length bytes, or nothing if there is not room for all of them.
+// Returns OS_TRUE if the bytes were put.
+BOOLEAN RingPut(Ring *pRing, const void *pData, INT16U length)
+{
+    INT16U head = pRing->head;
+    INT16U offset = head & (pRing->size - 1);
+    INT16U first;
+
+    if (RingSpace(pRing) < length) return OS_FALSE;
+
+    RING_BARRIER();  // tail before reusing the space it freed
+    first = pRing->size - offset;
+    if (first > length) first = length;
+    memcpy(&pRing->pBuf[offset], pData, first);
+    memcpy(pRing->pBuf, (const INT8U*)pData + first, length - first);
+
+    RING_BARRIER();  // data before head
+    pRing->head = head + length;
+    RingSignal(pRing);
+    return OS_TRUE;
+}
+
+
+// Puts one byte. Returns OS_FALSE if the ring is full.
+BOOLEAN RingPutByte(Ring *pRing, INT8U c)
+{
+    INT16U head = pRing->head;
+
+    if ((INT16U)(head - pRing->tail) == pRing->size) return OS_FALSE;
+
+    RING_BARRIER();
+    pRing->pBuf[head & (pRing->size - 1)] = c;
+    RING_BARRIER();
+    pRing->head = head + 1;
+    RingSignal(pRing);
+    return OS_TRUE;
+}
+
+
+// Takes length bytes, or nothing if fewer are waiting.
+// Returns OS_TRUE if the bytes were taken.
+BOOLEAN RingGet(Ring *pRing, void *pData, INT16U length)
+{
+    INT16U tail = pRing->tail;
+    INT16U offset = tail & (pRing->size - 1);
+    INT16U first;
+
+    if ((INT16U)(pRing->head - tail) < length) return OS_FALSE;
+
+    RING_BARRIER();  // head before the data it covers
+    first = pRing->size - offset;
+    if (first > length) first = length;
+    memcpy(pData, &pRing->pBuf[offset], first);
+    memcpy((INT8U*)pData + first, pRing->pBuf, length - first);
+
+    RING_BARRIER();  // data before tail
+    pRing->tail = tail + length;
+    return OS_TRUE;
+}
+
+
+// Takes one byte. Returns OS_FALSE if the ring is empty.
+BOOLEAN RingGetByte(Ring *pRing, INT8U *pc)
+{
+    INT16U tail = pRing->tail;
+
+    if (pRing->head == tail) return OS_FALSE;
+
+    RING_BARRIER();
+    *pc = pRing->pBuf[tail & (pRing->size - 1)];
+    RING_BARRIER();
+    pRing->tail = tail + 1;
+    return OS_TRUE;
+}
+
+
+// Waits up to timeout ticks (0 waits forever) until at least length bytes
+// can be taken. The ring must have been initialized with pend, and only
+// its consumer task may call this. Returns OS_FALSE on timeout.
+BOOLEAN RingPend(Ring *pRing, INT16U length, INT32U timeout)
+{
+    INT8U err;
+
+    if (pRing->dataSem == NULL || length == 0 || length > pRing->size) while(1);
+
+    while (1)
+    {
+        pRing->want = length;
+        RING_BARRIER();  // want before head, pairs with the barrier in RingSignal()
+        if (RingCount(pRing) >= length)
+        {
+            pRing->want = 0;
+            return OS_TRUE;
+        }
+
+        // a post left over from an earlier wait only costs another pass
+        OSSemPend(pRing->dataSem, timeout, &err);
+        if (err == OS_ERR_TIMEOUT)
+        {
+            pRing->want = 0;
+            RING_BARRIER();
+            return (BOOLEAN)(RingCount(pRing) >= length);
+        }
+        if (err != OS_ERR_NONE) while(1);
+    }
+}
@@ -0,0 +1,46 @@
+/*
+    ring.h
+    Lock-free single-producer/single-consumer ring of bytes or fixed-size
+    records, for passing data from an ISR to a task or between two tasks.
+
+    2026/10 written for the MP3Player project
+*/
+
+#ifndef __RING_H
+#define __RING_H
+
+// Orders the data accesses of one side before its index update (or the
+// other way round). On the single core target this only has to stop the
+// compiler reordering; the host port runs producer and consumer on threads.
+#if defined(__ICCARM__)
+#include <intrinsics.h>
+#define RING_BARRIER()  __DMB()
+#else
+#define RING_BARRIER()  __sync_synchronize()
+#endif
+
+typedef struct _Ring
+{
+    INT8U *pBuf;            // storage of size bytes
+    INT16U size;            // a power of 2, at most 32768
+    volatile INT16U head;   // bytes ever put, written only by the producer
+    volatile INT16U tail;   // bytes ever taken, written only by the consumer
+    volatile INT16U want;   // bytes RingPend() is waiting for, 0 if it is not
+    OS_EVENT *dataSem;      // posted when want bytes are available, NULL if RingPend() is not used
+} Ring;
+
+void RingInit(Ring *pRing, INT8U *pBuf, INT16U size, BOOLEAN pend);
+INT16U RingCount(Ring *pRing);
+INT16U RingSpace(Ring *pRing);
+
+// Producer side
+BOOLEAN RingPut(Ring *pRing, const void *pData, INT16U length);
+BOOLEAN RingPutByte(Ring *pRing, INT8U c);
+
+// Consumer side
+BOOLEAN RingGet(Ring *pRing, void *pData, INT16U length);
+BOOLEAN RingGetByte(Ring *pRing, INT8U *pc);
+BOOLEAN RingPend(Ring *pRing, INT16U length, INT32U timeout);
+
+
+#endif